@@ -14,6 +14,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <memory>
 
@@ -81,13 +82,13 @@ namespace {
 
 using namespace sgct;
 
-void readImage(unsigned char* data, int len) {
+void readImage(const std::filesystem::path& path) {
     const std::unique_lock lock(imageMutex);
 
     transImg = std::make_unique<Image>();
 
     try {
-        transImg->load(data, len);
+        transImg->load(path);
     }
     catch (const std::runtime_error& e) {
         Log::Error(e.what());
@@ -108,22 +109,18 @@ void startDataTransfer() {
 
     sendTimer = time();
 
-    // Load from file
-    const std::string& tmpPair = imagePaths[static_cast<size_t>(id)];
-
-    std::ifstream file(tmpPair.c_str(), std::ios::binary);
-    file.seekg(0, std::ios::end);
-    const std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    std::vector<char> buffer(size);
-    if (file.read(buffer.data(), size)) {
-        const int s = static_cast<int>(size);
-        NetworkManager::instance().transferData(buffer.data(), s, id);
-
-        // Read the image on master
-        readImage(reinterpret_cast<unsigned char*>(buffer.data()), s);
+    // The file is sent in chunks, so it is never read into memory as a whole
+    const std::string& path = imagePaths[static_cast<size_t>(id)];
+    try {
+        NetworkManager::instance().transferFile(path, id);
     }
+    catch (const std::runtime_error& e) {
+        Log::Error(e.what());
+        return;
+    }
+
+    // Read the image on master
+    readImage(path);
 }
 
 void uploadTexture() {
@@ -364,18 +361,49 @@ void keyboard(Key key, Modifier, Action action, int, Window*) {
     }
 }
 
-void dataTransferDecoder(void* data, int length, int packageId, int clientIndex) {
+void dataTransferChunk(const char* data, int length, int packageId, uint64_t offset,
+                       uint64_t totalSize, int clientIndex)
+{
+    // The chunks are written straight to a file, which is loaded once it is complete
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / std::format("transfer_{}", packageId);
+    {
+        const std::ios::openmode mode =
+            offset == 0 ? std::ios::out | std::ios::trunc : std::ios::in | std::ios::out;
+        std::fstream file(path, std::ios::binary | mode);
+        if (!file) {
+            Log::Error(std::format(
+                "Could not write transfer id: {} to '{}'", packageId, path.string()
+            ));
+            return;
+        }
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(data, length);
+    }
+
+    if (offset + length < totalSize) {
+        return;
+    }
+
     Log::Info(std::format(
-        "Decoding {} bytes in transfer id: {} on node {}", length, packageId, clientIndex
+        "Decoding {} bytes in transfer id: {} on node {}",
+        totalSize, packageId, clientIndex
     ));
 
     currentPackage = packageId;
-
-    // Read the image on master
-    readImage(reinterpret_cast<unsigned char*>(data), length);
+    readImage(path);
     uploadTexture();
 }
 
+void dataTransferProgress(int packageId, uint64_t received, uint64_t totalSize,
+                          int clientIndex)
+{
+    Log::Debug(std::format(
+        "Transfer id: {} is at {}/{} bytes on node {}",
+        packageId, received, totalSize, clientIndex
+    ));
+}
+
 void dataTransferStatus(bool connected, int clientIndex) {
     Log::Info(std::format(
         "Transfer node {} is {}", clientIndex, connected ? "connected" : "disconnected"
@@ -443,9 +471,10 @@ int main(int argc, char** argv) {
         .cleanup = cleanup,
         .encode = encode,
         .decode = decode,
-        .dataTransferDecode = dataTransferDecoder,
         .dataTransferStatus = dataTransferStatus,
         .dataTransferAcknowledge = dataTransferAcknowledge,
+        .dataTransferChunk = dataTransferChunk,
+        .dataTransferProgress = dataTransferProgress,
         .keyboard = keyboard,
         .drop = drop
     };
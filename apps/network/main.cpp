@@ -125,7 +125,7 @@ void connect() {
         Log::Error(std::format("Network error: {}", err.what()));
         networkPtr->initShutdown();
         std::this_thread::sleep_for(std::chrono::seconds(1));
-        networkPtr->closeNetwork(true);
+        networkPtr->closeNetwork();
         return;
     }
 
@@ -157,7 +157,7 @@ void disconnect() {
         std::this_thread::sleep_for(std::chrono::milliseconds(250));
 
         // Wait for threads to die
-        networkPtr->closeNetwork(false);
+        networkPtr->closeNetwork();
         networkPtr = nullptr;
     }
 }
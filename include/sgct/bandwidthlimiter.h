@@ -0,0 +1,117 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__BANDWIDTHLIMITER__H__
+#define __SGCT__BANDWIDTHLIMITER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace sgct {
+
+/**
+ * Paces the bytes that are sent by one or more threads so that together they don't
+ * exceed a budget of bytes per second. Every sender asks for permission before it sends
+ * a slice of its data and is delayed until the slices before it have been paid for, so
+ * that a large transfer is spread out evenly instead of being handed to the network at
+ * once. A short burst is allowed after the limiter was idle.
+ *
+ * While the limiter backs off, the budget is refilled at a fraction of its rate, which
+ * leaves the network to more important traffic without stopping the transfers entirely.
+ * A change of the rate applies to the senders that are already waiting.
+ */
+class SGCT_EXPORT BandwidthLimiter {
+public:
+    /// The largest number of bytes that a sender should send at once
+    static constexpr size_t SliceSize = 64 * 1024;
+
+    /// The fraction of the rate that is used while the limiter backs off
+    static constexpr double BackoffFraction = 0.1;
+
+    /// The time of sending at the full rate that can be spent at once after being idle
+    static constexpr std::chrono::milliseconds BurstTime = std::chrono::milliseconds(2);
+
+    struct Statistics {
+        /// The number of bytes that were permitted
+        uint64_t nBytes = 0;
+
+        /// The number of times that a sender had to wait before it could send
+        uint64_t nDelays = 0;
+
+        /// The total time that the senders have waited
+        std::chrono::nanoseconds delay = std::chrono::nanoseconds(0);
+    };
+
+    /**
+     * \param bytesPerSecond The budget of the senders, or 0 if they are not limited
+     */
+    explicit BandwidthLimiter(double bytesPerSecond = 0.0);
+
+    /**
+     * Waits until \p bytes can be sent within the budget. This returns immediately if
+     * there is no budget or after the limiter was stopped.
+     */
+    void acquire(size_t bytes);
+
+    /**
+     * Sets the budget to \p bytesPerSecond, or removes it if it is 0.
+     */
+    void setRate(double bytesPerSecond);
+
+    /**
+     * \return The budget in bytes per second, or 0 if the senders are not limited
+     */
+    double rate() const;
+
+    /**
+     * Reduces the budget to the #BackoffFraction of the rate while \p isBackingOff is
+     * `true`. This has no effect if there is no budget.
+     */
+    void setBackoff(bool isBackingOff);
+
+    /**
+     * \return `true` if the budget is currently reduced
+     */
+    bool isBackingOff() const;
+
+    /**
+     * Releases all waiting senders and lets every following sender pass immediately.
+     */
+    void stop();
+
+    Statistics statistics() const;
+
+private:
+    /**
+     * Adds the bytes that the budget has earned since the previous refill at the current
+     * rate. The caller has to hold the `_mutex`.
+     */
+    void refillLocked(std::chrono::steady_clock::time_point now);
+
+    double _rate;
+    bool _isBackingOff = false;
+    bool _isStopped = false;
+
+    // The number of bytes that can be sent right now, which becomes negative once a
+    // slice is sent that has not been paid for yet. It never exceeds the burst time
+    double _budget = 0.0;
+    std::chrono::steady_clock::time_point _lastRefill;
+
+    Statistics _statistics;
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__BANDWIDTHLIMITER__H__
@@ -0,0 +1,117 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__BUFFERPOOL__H__
+#define __SGCT__BUFFERPOOL__H__
+
+#include <sgct/sgctexports.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Keeps buffers that are no longer needed so that the next buffer of a similar size can
+ * be reused instead of being allocated again. The buffers are grouped in size classes
+ * that are powers of two, and a buffer always keeps the full size of its class, so that
+ * a reused buffer is neither reallocated nor filled with zeros again.
+ *
+ * The pool keeps at most its high-water mark in bytes and frees the least recently used
+ * buffers first if a released buffer would exceed it. Buffers that have not been used
+ * for the idle time are returned to the operating system the next time that the pool is
+ * used.
+ */
+class SGCT_EXPORT BufferPool {
+public:
+    /// The smallest size class, which is used for all smaller buffers
+    static constexpr size_t MinBufferSize = 4096;
+
+    /// The number of bytes that the pool keeps by default
+    static constexpr size_t DefaultHighWaterMark = 64 * 1024 * 1024;
+
+    /// The time after which a buffer that was not used is freed by default
+    static constexpr std::chrono::seconds DefaultIdleTime = std::chrono::seconds(5);
+
+    struct Statistics {
+        /// The number of buffers that were acquired from the pool
+        uint64_t nAcquired = 0;
+
+        /// The number of buffers that had to be allocated because none could be reused
+        uint64_t nAllocations = 0;
+
+        /// The number of buffers that were returned to the operating system
+        uint64_t nFreed = 0;
+
+        /// The number of bytes of the buffers that are currently kept for reuse
+        size_t retainedBytes = 0;
+    };
+
+    /**
+     * \param highWaterMark The largest number of bytes that are kept for reuse
+     * \param idleTime The time after which a buffer that was not used is freed
+     */
+    explicit BufferPool(size_t highWaterMark = DefaultHighWaterMark,
+        std::chrono::steady_clock::duration idleTime = DefaultIdleTime);
+
+    /**
+     * \return A buffer that contains at least \p size bytes, which is the size of the
+     *         size class that \p size belongs to. The content of a reused buffer is
+     *         what it contained when it was released
+     */
+    std::vector<char> acquire(size_t size);
+
+    /**
+     * Returns the \p buffer to the pool so that it can be reused. Buffers that were not
+     * acquired from a pool or that are larger than the high-water mark are freed.
+     */
+    void release(std::vector<char> buffer);
+
+    /**
+     * Frees the buffers that have not been used for the idle time.
+     */
+    void trim();
+
+    /**
+     * Frees all buffers that are kept for reuse.
+     */
+    void clear();
+
+    /**
+     * Sets the largest number of \p bytes that are kept for reuse and frees the least
+     * recently used buffers until the pool is below it.
+     */
+    void setHighWaterMark(size_t bytes);
+
+    Statistics statistics() const;
+
+private:
+    struct Entry {
+        std::vector<char> buffer;
+        std::chrono::steady_clock::time_point releaseTime;
+    };
+
+    void trimLocked(std::chrono::steady_clock::time_point now);
+    void shrinkLocked(size_t bytes);
+
+    size_t _highWaterMark;
+    const std::chrono::steady_clock::duration _idleTime;
+
+    // The unused buffers by their size class, most recently released last
+    std::map<size_t, std::vector<Entry>> _buffers;
+    Statistics _statistics;
+    mutable std::mutex _mutex;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__BUFFERPOOL__H__
@@ -11,15 +11,17 @@
 
 #include <sgct/sgctexports.h>
 
+#include <sgct/config.h>
 #include <sgct/math.h>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 namespace sgct {
 
-namespace config { struct Cluster; }
 class Node;
 class User;
 
@@ -113,6 +115,50 @@ public:
      */
     bool firmFrameLockSyncStatus() const;
 
+    /**
+     * \return The number of frames that the server may run ahead of the slowest client
+     *         before it waits for that client, or `std::nullopt` if the frame lock is
+     *         either firm or loose. If this is set, it takes precedence over the firm
+     *         frame lock
+     */
+    std::optional<int> maxFrameLag() const;
+
+    /**
+     * \return The number of packages that are sent to each node before the oldest of
+     *         them has to be acknowledged, or `std::nullopt` if the default is used
+     */
+    std::optional<int> transferWindow() const;
+
+    /**
+     * \return The number of MiB of receive buffers that a data transfer connection keeps
+     *         for the next packages, or `std::nullopt` if the default is used
+     */
+    std::optional<int> transferBufferLimit() const;
+
+    /**
+     * \return The number of Mbit/s that the data transfers may use together, or
+     *         `std::nullopt` if they are not limited
+     */
+    std::optional<float> transferBandwidth() const;
+
+    /**
+     * \return The loop time in milliseconds above which the data transfers back off, or
+     *         `std::nullopt` if they only back off while a frame is in flight
+     */
+    std::optional<float> transferBackoffThreshold() const;
+
+    /**
+     * \return The Differentiated Services Code Point of the sync connections' packets,
+     *         or `std::nullopt` if the default is used
+     */
+    std::optional<int> syncDscp() const;
+
+    /**
+     * \return The directory in which the payloads of the data transfers are kept, or
+     *         `std::nullopt` if every payload is sent to every node
+     */
+    std::optional<std::filesystem::path> transferCache() const;
+
     /**
      * Set if software sync between nodes should be ignored.
      */
@@ -123,6 +169,11 @@ public:
      */
     bool ignoreSync() const;
 
+    /**
+     * \return The multicast settings if the shared data should be sent via multicast
+     */
+    const std::optional<config::Multicast>& multicast() const;
+
 private:
     ClusterManager(const config::Cluster& cluster, int clusterID);
     ClusterManager(const ClusterManager&) = delete;
@@ -136,8 +187,16 @@ private:
 
     const int _thisNodeId;
     bool _firmFrameLockSync;
+    std::optional<int> _maxFrameLag;
+    std::optional<int> _transferWindow;
+    std::optional<int> _transferBufferLimit;
+    std::optional<float> _transferBandwidth;
+    std::optional<float> _transferBackoffThreshold;
+    std::optional<int> _syncDscp;
+    std::optional<std::filesystem::path> _transferCache;
     bool _ignoreSync = false;
     std::string _masterAddress;
+    std::optional<config::Multicast> _multicast;
 
     std::vector<std::unique_ptr<Node>> _nodes;
     std::vector<std::unique_ptr<User>> _users;
@@ -26,7 +26,9 @@ struct SGCT_EXPORT Configuration {
     std::optional<bool> showHelpText;
     std::optional<int> nodeId;
     std::optional<bool> firmSync;
+    std::optional<int> maxFrameLag;
     std::optional<bool> ignoreSync;
+    std::optional<int> syncSpinTime;
     std::optional<int> nCaptureThreads;
     std::optional<std::filesystem::path> screenshotPath;
     std::optional<std::string> screenshotPrefix;
@@ -36,6 +38,10 @@ struct SGCT_EXPORT Configuration {
 
     std::optional<bool> printWaitMessage;
     std::optional<float> waitTimeout;
+
+    std::optional<std::filesystem::path> recordPath;
+    std::optional<std::filesystem::path> replayPath;
+    std::optional<bool> replayAtMaximumRate;
 };
 
 /**
@@ -408,6 +408,9 @@ struct SGCT_EXPORT Node {
     uint16_t port = 0;
     std::optional<uint16_t> dataTransferPort;
     std::optional<bool> swapLock;
+    /// The index of the node that relays the shared data to this node. If it is not
+    /// specified, this node receives the shared data from the master directly
+    std::optional<int> parent;
     std::vector<Window> windows;
 
     bool operator==(const Node&) const noexcept = default;
@@ -443,6 +446,20 @@ struct SGCT_EXPORT Meta {
 
 
 
+struct SGCT_EXPORT Multicast {
+    std::string address;
+    uint16_t port = 0;
+    std::optional<std::string> interfaceAddress;
+    std::optional<int> datagramSize;
+    std::optional<int> ttl;
+    std::optional<int> timeout; // ms
+
+    bool operator==(const Multicast&) const noexcept = default;
+};
+SGCT_EXPORT void validateMulticast(const Multicast& multicast);
+
+
+
 struct SGCT_EXPORT Cluster {
     bool success = false;
 
@@ -450,12 +467,22 @@ struct SGCT_EXPORT Cluster {
     std::optional<bool> debugLog;
     std::optional<int> threadAffinity;
     std::optional<bool> firmSync;
+    // The servers only keep the send times of this many unacknowledged frames per client
+    static constexpr int MaxFrameLagLimit = 64;
+    std::optional<int> maxFrameLag;
+    std::optional<int> transferWindow;
+    std::optional<int> transferBufferLimit;
+    std::optional<float> transferBandwidth; // Mbit/s
+    std::optional<float> transferBackoffThreshold; // ms
+    std::optional<int> syncDscp;
+    std::optional<std::filesystem::path> transferCache;
     std::optional<Scene> scene;
     std::vector<Node> nodes;
     std::vector<User> users;
     std::optional<Capture> capture;
     std::vector<Tracker> trackers;
     std::optional<Settings> settings;
+    std::optional<Multicast> multicast;
 
     std::optional<GeneratorVersion> generator;
     std::optional<Meta> meta;
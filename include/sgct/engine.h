@@ -26,6 +26,7 @@
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -37,6 +38,7 @@ namespace sgct {
 struct Configuration;
 class Node;
 class StatisticsRenderer;
+class SyncReplayer;
 class User;
 
 /**
@@ -98,6 +100,10 @@ public:
         /// The highest time recorded for network communication between master and clients
         std::array<double, HistoryLength> loopTimeMax = {};
 
+        /// The time it took to send the synchronization data completely to each client,
+        /// with one entry per sync connection of the master
+        std::vector<std::array<double, HistoryLength>> sendTimes;
+
         /**
          * \return The frame time (delta time) in seconds
          */
@@ -149,6 +155,12 @@ public:
         /// before aborting
         float syncTimeout = 60.f;
 
+        /// The number of microseconds that the render thread busy-waits for the other
+        /// nodes at the frame lock before it goes to sleep. This avoids the latency of
+        /// waking up the thread, which matters if a frame takes less than a millisecond,
+        /// at the cost of keeping a processor core busy while waiting
+        int syncSpinTime = 0;
+
         struct SS {
             /// The location where the screenshots are being saved
             std::filesystem::path capturePath;
@@ -213,17 +225,31 @@ public:
         /// connected nodes in a clustered setup
         std::vector<std::byte> (*encode)() = nullptr;
 
+        /// This function is called to encode all shared data directly into the buffer
+        /// that is sent to the connected nodes. The function must only append to the
+        /// buffer, which is reused between frames. If set, it is used instead of the
+        /// Callbacks::encode function
+        void (*encodeInto)(std::vector<std::byte>&) = nullptr;
+
         /// This function is called by decode all shared data sent to us from the master.
         /// The parameter is the block of data that contains the data to be decoded
         void (*decode)(const std::vector<std::byte>&) = nullptr;
 
+        /// This function is called to decode all shared data sent to us from the master
+        /// without copying it into a vector of its own. The span points into the
+        /// reference block of SharedData and is only valid during the call. If set, it is
+        /// used instead of the Callbacks::decode function
+        void (*decodeView)(std::span<const std::byte>) = nullptr;
+
         /// This function is called when a TCP message is received
         void (*externalDecode)(const char*, int) = nullptr;
 
         /// This function is called when the connection status changes
         void (*externalStatus)(bool) = nullptr;
 
-        /// This function is called when a TCP message is received
+        /// This function is called when a TCP message is received. It is called on a
+        /// thread of the data transfer connection rather than the network thread, so
+        /// decoding a large package only delays the packages of the same connection
         void (*dataTransferDecode)(void*, int, int, int) = nullptr;
 
         /// This function is called when the connection status changes
@@ -232,6 +258,21 @@ public:
         /// This function is called when data is successfully sent
         void (*dataTransferAcknowledge)(int, int) = nullptr;
 
+        /// This function is called for every chunk of a transfer that is sent with
+        /// NetworkManager::transferFile or NetworkManager::transferStream. The parameters
+        /// are the bytes of the chunk, their number, the package id, the offset of the
+        /// chunk in the transfer, the size of the whole transfer, and the client index.
+        /// An interrupted transfer continues after the last chunk that was passed to
+        /// this function, so the earlier chunks have to be kept until it is complete.
+        /// Like Callbacks::dataTransferDecode, it is called on a thread of the connection
+        void (*dataTransferChunk)(const char*, int, int, uint64_t, uint64_t, int) =
+            nullptr;
+
+        /// This function is called when a node has received a chunk of a transfer, with
+        /// the package id, the number of bytes received so far, the size of the whole
+        /// transfer, and the client index
+        void (*dataTransferProgress)(int, uint64_t, uint64_t, int) = nullptr;
+
         /// This function sets the keyboard callback (GLFW wrapper) for all windows
         void (*keyboard)(Key, Modifier, Action, int, Window*) = nullptr;
 
@@ -591,6 +632,10 @@ private:
     /// this pointer is `nullptr` then no rendering is performed
     std::unique_ptr<StatisticsRenderer> _statisticsRenderer;
 
+    /// Replays a recording of the shared data instead of calling the encode callback if
+    /// it is not `nullptr`
+    std::unique_ptr<SyncReplayer> _replayer;
+
     /// Whether SGCT should take a screenshot in the next frame
     bool _shouldTakeScreenshot = false;
 
@@ -603,8 +648,6 @@ private:
 
     Settings _settings;
 
-    std::unique_ptr<std::thread> _thread;
-
     unsigned int _frameCounter = 0;
     unsigned int _shotCounter = 0;
 };
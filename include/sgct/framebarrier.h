@@ -0,0 +1,98 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__FRAMEBARRIER__H__
+#define __SGCT__FRAMEBARRIER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif // __linux__
+
+namespace sgct {
+
+/**
+ * Lets a single thread wait until the expected number of arrivals of a frame happened.
+ * The arrivals are counted atomically and the waiting thread is only woken up once the
+ * count is complete instead of on every arrival. On Linux, the waiting thread sleeps on
+ * a futex, on other platforms on a condition variable.
+ *
+ * The barrier only tells the waiting thread when to check whether its frame is complete,
+ * so an early release costs one additional check, but no arrival is ever missed.
+ */
+class SGCT_EXPORT FrameBarrier {
+public:
+    FrameBarrier() = default;
+
+    /**
+     * Starts a new frame in which \p nArrivals arrivals are expected. This has to be
+     * called before sending the messages that the arrivals respond to, so that none of
+     * them can arrive before the count is reset.
+     */
+    void reset(int nArrivals);
+
+    /**
+     * Counts an arrival and releases the waiting thread if the arrivals of the current
+     * frame are complete. Every arrival after that releases the waiting thread again.
+     */
+    void arrive();
+
+    /**
+     * Expects one arrival less in the current frame, for example because a connection
+     * was closed, and releases the waiting thread if that completes the frame.
+     */
+    void drop();
+
+    /**
+     * Releases the waiting thread regardless of the number of arrivals.
+     */
+    void release();
+
+    /**
+     * Waits until the barrier was released since the previous call, for at most
+     * \p timeout. This function must not be called from more than one thread at a time.
+     *
+     * \param timeout The longest time that is waited for a release
+     * \param spin The time that is busy-waited before the thread goes to sleep, which
+     *        avoids the latency of waking up if the release is expected to happen soon
+     * \return `true` if the barrier was released, `false` if the wait timed out
+     */
+    bool wait(std::chrono::nanoseconds timeout,
+        std::chrono::nanoseconds spin = std::chrono::nanoseconds(0));
+
+private:
+    FrameBarrier(const FrameBarrier&) = delete;
+    FrameBarrier(FrameBarrier&&) = delete;
+    FrameBarrier& operator=(const FrameBarrier&) = delete;
+    FrameBarrier& operator=(FrameBarrier&&) = delete;
+
+    std::atomic<int> _nExpected = 0;
+    std::atomic<int> _nArrivals = 0;
+
+    // Incremented on every release. The waiting thread sleeps until it differs from the
+    // last value that it has seen, which is the futex word on Linux
+    std::atomic<uint32_t> _generation = 0;
+    uint32_t _seenGeneration = 0;
+    // Lets a release skip the wake-up if nobody is sleeping
+    std::atomic_bool _isSleeping = false;
+
+#ifndef __linux__
+    std::mutex _mutex;
+    std::condition_variable _cond;
+#endif // __linux__
+};
+
+} // namespace sgct
+
+#endif // __SGCT__FRAMEBARRIER__H__
@@ -0,0 +1,88 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__LATENCYHISTOGRAM__H__
+#define __SGCT__LATENCYHISTOGRAM__H__
+
+#include <sgct/sgctexports.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace sgct {
+
+/**
+ * Counts durations in buckets whose widths grow geometrically, so that the percentiles
+ * of any number of durations can be estimated with a fixed amount of memory and a
+ * relative error of at most half a bucket. Durations can be added on one thread while
+ * the percentiles are read on another thread.
+ */
+class SGCT_EXPORT LatencyHistogram {
+public:
+    /// The shortest duration in seconds that is distinguished from 0
+    static constexpr double MinDuration = 1e-6;
+
+    /// The factor by which each bucket is wider than the previous one
+    static constexpr double BucketRatio = 1.1;
+
+    /// Covers durations from #MinDuration up to about a minute
+    static constexpr int NumberOfBuckets = 192;
+
+    LatencyHistogram() = default;
+
+    /**
+     * Adds the duration of \p seconds to the histogram. This function must not be called
+     * from more than one thread at a time.
+     */
+    void add(double seconds);
+
+    /**
+     * Removes all durations from the histogram.
+     */
+    void reset();
+
+    /**
+     * \return The number of durations that were added since the last reset
+     */
+    uint64_t count() const;
+
+    /**
+     * \return The shortest duration that was added, or 0 if the histogram is empty
+     */
+    double min() const;
+
+    /**
+     * \return The longest duration that was added, or 0 if the histogram is empty
+     */
+    double max() const;
+
+    /**
+     * \param fraction The fraction of durations that are at most as long as the returned
+     *        duration, for example 0.99 for the 99th percentile
+     * \return The estimated duration in seconds, or 0 if the histogram is empty
+     */
+    double percentile(double fraction) const;
+
+private:
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram(LatencyHistogram&&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+
+    // The first bucket contains all durations shorter than `MinDuration`, the bucket `i`
+    // those from `MinDuration * BucketRatio^(i-1)` to `MinDuration * BucketRatio^i`
+    std::array<std::atomic<uint64_t>, NumberOfBuckets> _buckets = {};
+    std::atomic<uint64_t> _count = 0;
+    std::atomic<double> _min = 0.0;
+    std::atomic<double> _max = 0.0;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__LATENCYHISTOGRAM__H__
@@ -0,0 +1,239 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__MULTICAST__H__
+#define __SGCT__MULTICAST__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/network.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Sends frames of data to all clients at once using UDP multicast. Each frame is assigned
+ * a sequence number and is split into datagrams that are at most `datagramSize` bytes
+ * large. Every datagram starts with a #DatagramHeaderSize byte header consisting of the
+ * Network::MulticastId, the `uint32_t` sequence number, the `uint32_t` size of the frame,
+ * the `uint16_t` index of the fragment, the `uint16_t` number of fragments, and the
+ * `uint32_t` session of the sender. The session is chosen randomly for every sender, so
+ * that the receivers can ignore the datagrams of other clusters that use the same
+ * multicast group and port.
+ *
+ * The last #HistorySize frames are kept so that they can be resent over TCP to clients
+ * that failed to receive all of the datagrams of a frame.
+ */
+class SGCT_EXPORT MulticastSender {
+public:
+    /// The number of frames that are kept around to be resent
+    static constexpr int HistorySize = 16;
+
+    /// The size of the header at the beginning of every datagram
+    static constexpr int DatagramHeaderSize = Network::HeaderSize + sizeof(uint32_t);
+
+    /// The largest frame that is sent via multicast. The receivers reserve the memory for
+    /// a frame when its first datagram arrives, so they reject larger frames
+    static constexpr uint32_t MaxFrameSize = 64 * 1024 * 1024;
+
+    /// The largest datagram that fits into a single Ethernet frame
+    static constexpr int DefaultDatagramSize = 1472;
+
+    /// Keeps the datagrams inside the local network
+    static constexpr int DefaultTtl = 1;
+
+    /**
+     * \param address The IPv4 multicast group to which the frames are sent
+     * \param port The UDP port to which the frames are sent
+     * \param interfaceAddress The IPv4 address of the network interface that is used to
+     *        send the frames. If it is empty, the operating system's default is used
+     * \param datagramSize The maximum size of each datagram including the header
+     * \param ttl The time-to-live of the datagrams, which determines the number of
+     *        routers that the datagrams can pass
+     */
+    MulticastSender(const std::string& address, int port,
+        const std::string& interfaceAddress, int datagramSize, int ttl);
+    ~MulticastSender();
+
+    /**
+     * Sends the \p length bytes pointed to by \p data to all clients and stores the
+     * frame in the history.
+     *
+     * \return The sequence number that was assigned to the frame
+     * \throw Error If the frame is larger than #MaxFrameSize
+     */
+    uint32_t send(const void* data, int length);
+
+    /**
+     * \return The session that identifies the datagrams of this sender, which the
+     *         clients have to pass to MulticastReceiver::setSession
+     */
+    uint32_t session() const;
+
+    /**
+     * Returns a copy of the frame with the provided \p sequence number, or an empty
+     * vector if the frame is no longer part of the history.
+     */
+    std::vector<char> frame(uint32_t sequence) const;
+
+private:
+    MulticastSender(const MulticastSender&) = delete;
+    MulticastSender(MulticastSender&&) = delete;
+    MulticastSender& operator=(const MulticastSender&) = delete;
+    MulticastSender& operator=(MulticastSender&&) = delete;
+
+    struct Frame {
+        uint32_t sequence = 0;
+        std::vector<char> data;
+    };
+
+    SGCT_SOCKET _socket;
+    uint32_t _address = 0;
+    uint16_t _port = 0;
+    const int _datagramSize;
+    uint32_t _session = 0;
+
+    uint32_t _sequence = 0;
+    std::vector<char> _datagram;
+    mutable std::mutex _historyMutex;
+    std::vector<Frame> _history;
+};
+
+/**
+ * Receives the frames that are sent by a MulticastSender and reassembles them from the
+ * individual datagrams on a separate thread. Only the datagrams of the sender whose
+ * session was passed to #setSession are accepted.
+ *
+ * A frame can be taken without blocking with #takeFrame. If it is not complete yet, the
+ * receiving thread makes the #notification readable once the frame is complete or is
+ * considered lost, so that the frame can be taken by a thread that observes the
+ * notification together with other sockets.
+ */
+class SGCT_EXPORT MulticastReceiver {
+public:
+    static constexpr std::chrono::milliseconds DefaultTimeout =
+        std::chrono::milliseconds(20);
+
+    enum class FrameStatus {
+        /// The frame is not complete yet, and the #notification becomes readable once it
+        /// is complete or lost
+        Pending,
+        /// The frame was received completely
+        Received,
+        /// No datagrams were received for the duration of the timeout
+        Lost
+    };
+
+    /**
+     * \param address The IPv4 multicast group that is joined
+     * \param port The UDP port on which the frames are received
+     * \param interfaceAddress The IPv4 address of the network interface that is used to
+     *        join the multicast group. If it is empty, the operating system's default is
+     *        used
+     * \param timeout The time without receiving any datagrams after which a frame is
+     *        considered to be lost
+     */
+    MulticastReceiver(const std::string& address, int port,
+        const std::string& interfaceAddress, std::chrono::milliseconds timeout);
+    ~MulticastReceiver();
+
+    /**
+     * Accepts only the datagrams of the sender with the \p session from now on. If the
+     * session changed, all frames of the previous session are discarded.
+     */
+    void setSession(uint32_t session);
+
+    /**
+     * Moves the frame with the provided \p sequence number into \p frame if all of its
+     * fragments have been received. If no datagrams were received for the duration of
+     * the timeout since the frame was first asked for, the frame is considered to be
+     * lost. In either case, this frame and all older frames are discarded. This function
+     * never blocks.
+     *
+     * \return Whether the frame was received, is lost, or has to be waited for
+     */
+    FrameStatus takeFrame(uint32_t sequence, std::vector<char>& frame);
+
+    /**
+     * Waits until the frame with the provided \p sequence number is received or lost in
+     * the same way as #takeFrame.
+     *
+     * \return `true` if the frame was received completely, `false` otherwise
+     */
+    bool receiveFrame(uint32_t sequence, std::vector<char>& frame);
+
+    /**
+     * \return The socket that becomes readable when the frame that #takeFrame returned
+     *         FrameStatus::Pending for is complete or lost
+     */
+    SGCT_SOCKET notification() const;
+
+    /**
+     * Makes the #notification unreadable again. This has to be called by the thread that
+     * observes the notification before it takes the frame.
+     */
+    void clearNotification();
+
+private:
+    MulticastReceiver(const MulticastReceiver&) = delete;
+    MulticastReceiver(MulticastReceiver&&) = delete;
+    MulticastReceiver& operator=(const MulticastReceiver&) = delete;
+    MulticastReceiver& operator=(MulticastReceiver&&) = delete;
+
+    struct Frame {
+        std::vector<char> data;
+        std::vector<bool> hasFragment;
+        uint16_t nMissingFragments = 0;
+    };
+
+    void receiveLoop();
+    void handleDatagram(const char* datagram, int length);
+
+    /**
+     * Implements #takeFrame. The caller has to hold the `_mutex`.
+     */
+    FrameStatus takeFrameLocked(uint32_t sequence, std::vector<char>& frame);
+
+    /**
+     * Makes the #notification readable if the awaited frame is complete or lost and this
+     * has not been reported yet. The caller has to hold the `_mutex`.
+     */
+    void notifyLocked();
+
+    SGCT_SOCKET _socket;
+    SGCT_SOCKET _notification;
+    const std::chrono::milliseconds _timeout;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::map<uint32_t, Frame> _frames;
+    uint32_t _session = 0;
+    uint32_t _lastSequence = 0;
+    std::chrono::steady_clock::time_point _lastDatagramTime;
+
+    // The frame that is waited for, or 0 if there is none, the time since which it is
+    // waited for, and whether it has been reported through the notification
+    uint32_t _awaitedSequence = 0;
+    std::chrono::steady_clock::time_point _awaitStart;
+    bool _isAwaitedNotified = false;
+
+    std::atomic_bool _shouldTerminate = false;
+    std::thread _thread;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__MULTICAST__H__
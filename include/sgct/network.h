@@ -11,14 +11,24 @@
 
 #include <sgct/sgctexports.h>
 
+#include <sgct/bufferpool.h>
+#include <sgct/latencyhistogram.h>
+#include <sgct/transfercache.h>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #ifdef WIN32
@@ -27,10 +37,21 @@ using SGCT_SOCKET = size_t;
 using SGCT_SOCKET = int;
 #endif // WIN32
 
+struct addrinfo;
+struct z_stream_s;
+
 namespace sgct {
 
+class BandwidthLimiter;
+class MulticastReceiver;
+class SharedMemoryChannel;
+
 /**
- * Network manages peer-to-peer tcp connections.
+ * Network manages peer-to-peer tcp connections. The sockets of all connections are read
+ * by the NetworkReactor's thread, which is also the thread that calls all of the
+ * callbacks, except for the package and chunk decoder callbacks of a data transfer
+ * connection. Those are called on a thread of the connection, so that a slow decoder
+ * does not stall the other connections.
  */
 class SGCT_EXPORT Network {
 public:
@@ -40,16 +61,65 @@ public:
     static constexpr char DataId = 17;
     static constexpr char ConnectedId = 18;
     static constexpr char DisconnectId = 19;
+    static constexpr char DeltaId = 20;
+    static constexpr char Nack = 21;
+    static constexpr char MulticastId = 22;
+    static constexpr char KeyframeId = 23;
+    static constexpr char SharedMemoryId = 24;
+    static constexpr char ChunkId = 25;
+    static constexpr char ChunkAckId = 26;
+    static constexpr char ContentOfferId = 27;
+    static constexpr char ContentReplyId = 28;
+    static constexpr char ChunkResumeId = 29;
+    static constexpr char ChunkResumeReplyId = 30;
 
     enum class ConnectionType { SyncConnection, DataTransfer };
 
     static constexpr size_t HeaderSize = 13;
 
+    /// The time that is waited for the other side to close the connection during the
+    /// shutdown, which is otherwise done after a single round trip
+    static constexpr std::chrono::milliseconds ShutdownTimeout = std::chrono::seconds(1);
+
+    /// The number of packages that are sent with #sendPackage before the oldest of them
+    /// has to be acknowledged by default
+    static constexpr int DefaultTransferWindow = 8;
+
+    /// The payload of a chunk starts with the offset of the chunk in its transfer and the
+    /// size of the whole transfer, both as 64 bit integers. The acknowledgement of a
+    /// chunk and the question for the offset at which a transfer is resumed, as well as
+    /// its reply, consist of the same two integers
+    static constexpr uint32_t ChunkHeaderSize = 2 * sizeof(uint64_t);
+
+    /// The payload of a content offer consists of the hash of the package's payload and
+    /// its size, both as 64 bit integers
+    static constexpr uint32_t ContentOfferSize = 2 * sizeof(uint64_t);
+
+    /// The number of acknowledged frames from which the clock offset is estimated
+    static constexpr int ClockSamples = 8;
+
     /**
      * \return The last error code
      */
     static int lastError();
 
+    /**
+     * Sends the same \p payload to all \p connections, each preceded by its own header.
+     * The sockets are written without blocking, or with overlapped sends on Windows, so
+     * that a client whose socket buffer is full does not hold up the other clients, and
+     * the header and payload are sent with a single vectored write per connection.
+     *
+     * \param connections The connections to which the data is sent
+     * \param headers The header that is sent to each of the \p connections
+     * \param payload The data that is sent to all connections after their header
+     * \param length The number of bytes of the \p payload
+     * \return The time in seconds after which the data was sent completely to each of
+     *         the \p connections
+     */
+    static std::vector<double> sendToAll(const std::vector<Network*>& connections,
+        const std::vector<std::array<char, HeaderSize>>& headers, const void* payload,
+        int length);
+
     /**
      * \param port The network port (TCP)
      * \param address The hostname, IPv4 address or IPv6 address
@@ -59,16 +129,155 @@ public:
     Network(int port, const std::string& address, bool isServer, ConnectionType t);
     ~Network();
 
+    /**
+     * Starts listening for the client on a server. A client starts connecting to the
+     * server in the background and retries until the server accepts the connection, so
+     * this function does not wait for the server to be started.
+     */
     void initialize();
-    void closeNetwork(bool forced);
+    void closeNetwork();
+
+    /**
+     * Tells the other side that this side is closing the connection and closes the
+     * sending direction of the socket, while messages can still be received until the
+     * other side has closed the connection as well. Calling this for all connections
+     * before calling #initShutdown on them lets all of them close at the same time.
+     */
+    void sendDisconnect();
+
+    /**
+     * Closes the connection after the other side has closed it in response to the
+     * #sendDisconnect message, which is sent if that has not happened yet. The other side
+     * is only waited for up to the #ShutdownTimeout. Once this function returns, none of
+     * the callbacks are running or will be called again.
+     */
     void initShutdown();
 
+    /**
+     * Same as #initShutdown, but the other side is only waited for until the
+     * \p deadline. Shutting down several connections with the same deadline bounds the
+     * time for all of them together.
+     */
+    void initShutdown(std::chrono::steady_clock::time_point deadline);
+
     void setDecodeFunction(std::function<void(const char*, int)> fn);
+    void setDeltaDecodeFunction(std::function<void(const char*, int)> fn);
+    void setKeyframeDecodeFunction(std::function<void(const char*, int)> fn);
     void setPackageDecodeFunction(std::function<void(void*, int, int, int)> fn);
     void setUpdateFunction(std::function<void(Network&)> fn);
     void setConnectedFunction(std::function<void (void)> fn);
     void setAcknowledgeFunction(std::function<void(int, int)> fn);
 
+    /**
+     * Sets the function that is called on a data transfer connection for every chunk of
+     * a transfer that is sent in chunks. The function is called with the bytes of the
+     * chunk, their number, the package id, the offset of the chunk in the transfer, the
+     * size of the whole transfer, and the id of the connection. The bytes are only valid
+     * during the call, which happens on the thread that decodes the packages of this
+     * connection rather than on the NetworkReactor's thread.
+     */
+    void setChunkDecodeFunction(
+        std::function<void(const char*, int, int, uint64_t, uint64_t, int)> fn);
+
+    /**
+     * Sets the function that is called on a data transfer connection when the other side
+     * has received a chunk that was sent with #sendChunk. The function is called with
+     * the package id, the number of bytes of the transfer that have been received, the
+     * size of the whole transfer, and the id of the connection.
+     */
+    void setChunkAcknowledgeFunction(
+        std::function<void(int, uint64_t, uint64_t, int)> fn);
+
+    /**
+     * Sets the largest number of \p packages that are sent with #sendPackage on this
+     * connection before the oldest of them has been acknowledged.
+     */
+    void setTransferWindow(int packages);
+
+    /**
+     * Sets the function that is called whenever packages that were sent with
+     * #sendPackage were acknowledged or the connection was closed, so that more packages
+     * fit into the transfer window.
+     */
+    void setTransferWindowFunction(std::function<void(void)> fn);
+
+    /**
+     * Sets the number of bytes of receive buffers that a data transfer connection keeps
+     * for the next packages after a package has been handled. Buffers beyond this are
+     * returned to the operating system, as are buffers that were not used for a while.
+     */
+    void setBufferPoolLimit(size_t bytes);
+
+    /**
+     * \return The statistics of the receive buffers of a data transfer connection
+     */
+    BufferPool::Statistics bufferPoolStatistics() const;
+
+    /**
+     * Paces the payloads that are sent with #sendMessage, #sendPackage, and #sendChunk
+     * through the \p limiter, which can be shared by several connections so that they
+     * stay within a common budget. The \p limiter has to outlive this connection, and
+     * `nullptr` sends the payloads as fast as the network allows.
+     */
+    void setBandwidthLimiter(BandwidthLimiter* limiter);
+
+    /**
+     * Marks the packets of this connection with the Differentiated Services Code Point
+     * \p dscp, so that switches that are configured for it can prioritize them. On
+     * Linux, the socket also gets a priority for the queue of the network interface that
+     * matches the \p dscp.
+     */
+    void setDscp(int dscp);
+
+    /**
+     * Sets the \p cache from which a data transfer connection takes the packages that
+     * are offered with #offerContent and to which it adds the offered packages that it
+     * receives. The \p cache has to outlive this connection, and `nullptr` lets the
+     * connection receive every package that is offered.
+     */
+    void setTransferCache(const TransferCache* cache);
+
+    /**
+     * Sets the function that is called on the server when a client failed to receive a
+     * frame via multicast. The function is called with the connection and the sequence
+     * number of the frame, which should then be resent over this connection.
+     */
+    void setResendFunction(std::function<void(Network&, uint32_t)> fn);
+
+    /**
+     * Sets the function that is called on a sync connection every time a frame of shared
+     * data was received on a client or the acknowledgement of a frame was received on a
+     * server, after the frame number has been updated.
+     */
+    void setArrivalFunction(std::function<void(void)> fn);
+
+    /**
+     * Sets the function that is called on a client with every received frame of shared
+     * data instead of decoding it directly, so that the frame can be forwarded to other
+     * nodes before it is decoded. The function is called with the header of the frame,
+     * the payload as it was received, its size, and a function that decodes the frame,
+     * which has to be called by the relay function.
+     */
+    void setRelayFunction(std::function<void(const std::array<char, HeaderSize>&,
+        const char*, uint32_t, const std::function<void()>&)> fn);
+
+    /**
+     * Sets the receiver that is used by a client to receive the frames that the server
+     * sends via multicast. If a client receives a notification about a multicast frame
+     * without having a receiver, or if the frame is lost, it is requested over TCP.
+     */
+    void setMulticastReceiver(std::unique_ptr<MulticastReceiver> receiver);
+
+    /**
+     * Enables exchanging the messages of a sync connection through a
+     * SharedMemoryChannel instead of the TCP connection if the other side is on the same
+     * machine. The TCP connection is still used to establish the channel and to detect
+     * when the other side disconnects. If the channel can't be established, the TCP
+     * connection is used for all messages. This has to be set on both sides before the
+     * connection is initialized.
+     */
+    void setSharedMemoryEnabled(bool enabled);
+
     void setConnectedStatus(bool state);
     void closeSocket(SGCT_SOCKET lSocket);
 
@@ -86,6 +295,29 @@ public:
      */
     double loopTime() const;
 
+    /**
+     * \return The times in seconds from sending a frame until its acknowledgement
+     *         arrived for all frames since the client connected, including the time that
+     *         the client needed before acknowledging the frame. Only the server measures
+     *         these times
+     */
+    const LatencyHistogram& loopTimes() const;
+
+    /**
+     * \return The #loopTimes without the time between the client receiving a frame and
+     *         acknowledging it, which is the time that was spent in the network
+     */
+    const LatencyHistogram& roundTripTimes() const;
+
+    /**
+     * \return The estimated difference in seconds between the clock of the client and
+     *         the clock of the server, so that the time `t` on the client corresponds
+     *         to `t - clockOffset()` on the server. Like in NTP, the offset is estimated
+     *         from the acknowledgement with the shortest round trip time of the last
+     *         #ClockSamples frames. Only the server estimates the offset
+     */
+    double clockOffset() const;
+
     /**
      * This function compares the received frame number with the sent frame number. The
      * server starts by sending a frame sync number to the client. The client receives the
@@ -97,13 +329,88 @@ public:
     bool isUpdated() const;
     void sendData(const void* data, int length) const;
 
+    /**
+     * Sends the \p header followed by the \p payload as a single message without copying
+     * them into one buffer first.
+     */
+    void sendMessage(const std::array<char, HeaderSize>& header,
+        std::span<const char> payload) const;
+
+    /**
+     * Sends the \p data as the chunk at \p offset of the transfer with the \p packageId,
+     * which contains \p totalSize bytes in total. The other side acknowledges every
+     * chunk and additionally acknowledges the package once the last byte of the transfer
+     * has been received.
+     */
+    void sendChunk(int packageId, uint64_t offset, uint64_t totalSize,
+        std::span<const char> data) const;
+
+    /**
+     * Sends the \p data as the package with the \p packageId in the same way as
+     * `NetworkManager::transferData`, but numbers the package so that an acknowledgement
+     * from the other side also covers all packages that were sent before it. The
+     * \p onAcknowledged function is called with `true` once the other side has decoded
+     * the package, or with `false` if the connection was closed before that. The caller
+     * has to check #transferWindowSpace before sending the next package.
+     */
+    void sendPackage(int packageId, std::span<const char> data,
+        std::function<void(bool)> onAcknowledged);
+
+    /**
+     * \return The number of packages that can be sent with #sendPackage before the
+     *         transfer window is full of packages that wait for their acknowledgement
+     */
+    int transferWindowSpace() const;
+
+    /**
+     * Offers the package with the \p packageId, whose payload of \p size bytes has the
+     * \p hash, to the other side before it is sent. If the other side has the payload in
+     * its TransferCache, it decodes the package from there and acknowledges it as if it
+     * had been sent. The \p onReply function is called with `true` in that case, or with
+     * `false` if the package has to be sent as usual or the connection was closed before
+     * the other side replied.
+     */
+    void offerContent(int packageId, uint64_t hash, uint64_t size,
+        std::function<void(bool)> onReply);
+
+    /**
+     * Asks the other side how many bytes of the transfer with the \p packageId and
+     * \p totalSize it has received, so that an interrupted transfer can continue from
+     * there. The other side remembers the bytes that it has passed to the chunk decoder
+     * callback across reconnects until the transfer is complete, but not after it was
+     * restarted. The \p onReply function is called with the number of bytes, or with 0
+     * if the connection was closed before the other side replied.
+     */
+    void queryChunkOffset(int packageId, uint64_t totalSize,
+        std::function<void(uint64_t)> onReply);
+
+    /**
+     * \return The number of frames that were sent by the server on this connection but
+     *         have not yet been acknowledged by the client
+     */
+    int unacknowledgedFrames() const;
+
     /**
      * Iterates the send frame number and returns the new frame number.
      */
     int iterateFrameCounter();
 
     /**
-     * The client sends ack message to server + console messages.
+     * Marks that the client on this connection has no state that the next frame could be
+     * applied to, which is the case after it (re)connected, so that the server sends it
+     * the full state instead.
+     */
+    void requestKeyframe();
+
+    /**
+     * \return `true` if a keyframe was requested for this connection since the last
+     *         call. The request is reset by this function
+     */
+    bool consumeKeyframeRequest();
+
+    /**
+     * The client acknowledges the last received frame to the server, including the times
+     * at which the frame was received and acknowledged.
      */
     void pushClientMessage();
 
@@ -115,6 +422,32 @@ public:
     std::condition_variable& startConnectionConditionVar();
 
 private:
+    struct InflateDeleter {
+        void operator()(z_stream_s* stream) const;
+    };
+
+    struct AddressDeleter {
+        void operator()(addrinfo* address) const;
+    };
+
+    // A package or a chunk that was received on a data transfer connection, which is
+    // handed to the `_decodeThread` together with the buffer that it was received into
+    struct ReceivedPackage {
+        // `DataId` for a package or `ChunkId` for a chunk of a transfer
+        char type = DataId;
+        int32_t packageId = -1;
+        uint32_t sequence = 0;
+        std::vector<char> data;
+        uint32_t size = 0;
+        // The hash with which an offered package is added to the transfer cache
+        std::optional<uint64_t> hash;
+        // The offered package if it was found in the transfer cache instead
+        std::optional<TransferCache::Payload> cached;
+        // The position of a chunk in its transfer
+        uint64_t offset = 0;
+        uint64_t totalSize = 0;
+    };
+
     Network(const Network&) = delete;
     Network(Network&&) = delete;
     Network& operator=(const Network&) = delete;
@@ -122,18 +455,233 @@ private:
 
     void setRecvFrame(int i);
     void updateBuffer(std::vector<char>& buffer, uint32_t reqSize, uint32_t& currSize);
-    int readSyncMessage(char* header, int32_t& syncFrame, uint32_t& dataSize,
-        uint32_t& uncompressedDataSize);
-    int readDataTransferMessage(char* header, int32_t& packageId, uint32_t& dataSize,
-        uint32_t& uncompressedDataSize);
-    int readExternalMessage();
 
-    void communicationHandler();
-    void connectionHandler();
+    /**
+     * Registers the listening socket with the NetworkReactor so that the next client can
+     * connect to this server.
+     */
+    void startListening();
+
+    /**
+     * Called by the NetworkReactor when a client is waiting to connect to the server.
+     */
+    void acceptConnection();
+
+    /**
+     * Runs on the `_connectThread` of a client and tries to connect to the server until
+     * it succeeds or the connection is shut down. The delay between the attempts starts
+     * in the range of milliseconds and grows exponentially while the server is not
+     * available.
+     */
+    void connectToServer();
+
+    /**
+     * Stops the `_connectThread` if the client is still trying to connect.
+     */
+    void stopConnecting();
+
+    /**
+     * Starts receiving messages on the connected socket.
+     */
+    void establishConnection();
+
+    /**
+     * Closes the connected socket and, on the server, waits for the next client.
+     */
+    void closeConnection();
+
+    /**
+     * Hands the \p package to the `_decodeThread`.
+     */
+    void queueReceivedPackage(ReceivedPackage package);
+
+    /**
+     * Takes the buffer that the current message was received into, so that the next
+     * message is received into a buffer from the `_bufferPool`.
+     */
+    std::vector<char> takeReceiveBuffer();
+
+    /**
+     * Runs on the `_decodeThread` of a data transfer connection and handles the received
+     * packages and chunks in the order in which they arrived until #stopDecoding is
+     * called.
+     */
+    void decodeReceivedPackages();
+
+    /**
+     * Adds an offered \p package to the transfer cache, passes it to the package decoder
+     * callback, acknowledges it, and returns its buffer to the `_bufferPool`.
+     */
+    void decodePackage(ReceivedPackage& package);
+
+    /**
+     * Passes the \p chunk to the chunk decoder callback, acknowledges it, and returns its
+     * buffer to the `_bufferPool`.
+     */
+    void decodeChunk(ReceivedPackage& chunk);
+
+    /**
+     * Stops the `_decodeThread`. A package that is being decoded is finished, the queued
+     * ones are dropped.
+     */
+    void stopDecoding();
+
+    /**
+     * Called by the NetworkReactor when data can be read from the connected socket. The
+     * data is read until it would block, and every message that is completed is handled.
+     */
+    void receiveMessages();
+
+    /**
+     * Reads the messages that are available in the shared memory channel in the same
+     * way as #receiveMessages.
+     */
+    void receiveSharedMemoryMessages();
+
+    /**
+     * \return The part of the current message that has not been received yet, which is
+     *         either the rest of the header or of the payload
+     */
+    std::span<char> receiveBuffer();
+
+    /**
+     * Advances the current message by \p nBytes that were received into the
+     * #receiveBuffer and handles the message if it is complete.
+     */
+    void handleReceived(size_t nBytes);
+
+    /**
+     * Parses the header in `_recvHeader` after it was received completely.
+     */
+    void handleHeader();
+
+    /**
+     * Handles the message after its header and its payload were received completely.
+     */
+    void handleMessage();
+
+    /**
+     * Adds the acknowledgement of the current frame to the latency statistics.
+     */
+    void handleAcknowledgement();
+
+    /**
+     * Hands the received chunk of a transfer to the `_decodeThread`.
+     */
+    void handleChunk();
+
+    /**
+     * Passes how much of a transfer the other side has received to the chunk acknowledge
+     * callback.
+     */
+    void handleChunkAcknowledgement();
+
+    /**
+     * Tells the other side how many bytes of a transfer have been received.
+     */
+    void handleChunkResume();
+
+    /**
+     * Passes the reply to #queryChunkOffset to the function that was provided with it.
+     */
+    void handleChunkResumeReply();
+
+    /**
+     * Completes the packages that were sent with #sendPackage up to and including the
+     * package with the \p sequence number.
+     */
+    void handlePackageAcknowledgement(uint32_t sequence);
+
+    /**
+     * Tells the other side whether the package of a content offer has to be sent and
+     * hands the package to the `_decodeThread` if it is in the `_transferCache`.
+     */
+    void handleContentOffer();
+
+    /**
+     * Passes the reply to a content offer to the function that was provided with the
+     * offer.
+     */
+    void handleContentReply();
+
+    /**
+     * Completes all packages that were sent with #sendPackage and are not acknowledged
+     * yet as failed and all content offers and questions for the offset of a transfer as
+     * not answered, as the connection was closed.
+     */
+    void failInFlightPackages();
+
+    /**
+     * Decompresses the \p dataSize bytes pointed to by \p data into the
+     * `_uncompressBuffer`, which has to be able to hold \p uncompressedSize bytes.
+     */
+    void decompress(const char* data, uint32_t dataSize, uint32_t uncompressedSize);
+
+    /**
+     * Passes the \p dataSize bytes pointed to by \p data to the decoder callback that
+     * corresponds to the \p headerId after decompressing them if \p uncompressedSize is
+     * not 0.
+     */
+    void decodeSyncData(char headerId, const char* data, uint32_t dataSize,
+        uint32_t uncompressedSize);
+
+    /**
+     * Decodes the pending multicast frames in order until all are decoded or one of them
+     * is lost, in which case that frame is requested from the server over TCP.
+     */
+    void receiveMulticastFrames();
+
+    /**
+     * Continues with the pending multicast frames once the multicast receiver signals
+     * that the frame that is waited for is complete or lost.
+     */
+    void receiveMulticastNotification();
+
+    /**
+     * Creates the shared memory channel on the server and offers it to the client.
+     */
+    void offerSharedMemory();
+
+    /**
+     * Handles the messages with which both sides switch from the TCP connection to the
+     * shared memory channel. The client accepts the offered channel if it can open it and
+     * then sends all further messages through the channel. The server starts receiving
+     * from the channel once it was accepted and tells the client that it switches too.
+     */
+    void handleSharedMemoryMessage();
+
+    /**
+     * Starts receiving through the shared memory channel and reads the messages that
+     * were written before this side started to wait for them.
+     */
+    void startReceivingSharedMemory();
+
+    /**
+     * Stops using the shared memory channel and closes it.
+     */
+    void closeSharedMemory();
+
+    /**
+     * Sends the \p length bytes pointed to by \p data through the shared memory channel
+     * or the socket. The caller has to hold the `_sendMutex`.
+     */
+    void sendLocked(const void* data, int length) const;
+
+    /**
+     * Sends the \p data in the same way as #sendLocked, but in slices that are paced by
+     * the `_bandwidthLimiter`. The caller has to hold the `_sendMutex`.
+     */
+    void sendPacedLocked(std::span<const char> data) const;
 
     SGCT_SOCKET _socket;
     SGCT_SOCKET _listenSocket;
 
+    // The resolved address of the server, which a client connects to on its
+    // `_connectThread`
+    std::string _address;
+    std::unique_ptr<addrinfo, AddressDeleter> _serverAddress;
+    std::thread _connectThread;
+
     const ConnectionType _connectionType = ConnectionType::SyncConnection;
     std::atomic_bool _isServer;
     std::atomic_bool _isConnected = false;
@@ -143,13 +691,70 @@ private:
     std::atomic<int32_t> _currentRecvFrame = 0;
     std::atomic<int32_t> _previousRecvFrame = -1;
     std::atomic_bool _shouldTerminate = false; // set to true upon exit
+    std::atomic_bool _isKeyframeRequested = false;
+    std::atomic_bool _isDisconnectSent = false;
 
     mutable std::mutex _connectionMutex;
-    std::unique_ptr<std::thread> _commThread;
-    std::unique_ptr<std::thread> _mainThread;
+    mutable std::mutex _sendMutex;
 
     double _timeStampSend = 0.0;
+    std::atomic<double> _timeStampRecv = 0.0;
     std::atomic<double> _timeStampTotal = 0.0;
+
+    // The frames that were sent to a client but are not acknowledged yet, oldest first.
+    // Guarded by `_connectionMutex`
+    struct InFlightFrame {
+        int frame = 0;
+        double sendTime = 0.0;
+    };
+    std::deque<InFlightFrame> _inFlightFrames;
+
+    // The number of bytes of the incomplete transfers that were passed to the chunk
+    // decoder callback, by package id and total size. These are kept when the connection
+    // is lost. Guarded by `_connectionMutex`
+    std::map<std::pair<int32_t, uint64_t>, uint64_t> _receivedChunkBytes;
+
+    // The questions for the offset of a transfer that the other side has not replied to
+    // yet, oldest first. Guarded by `_connectionMutex`
+    struct PendingChunkResume {
+        int32_t packageId = 0;
+        uint64_t totalSize = 0;
+        std::function<void(uint64_t)> onReply;
+    };
+    std::deque<PendingChunkResume> _pendingChunkResumes;
+
+    // The packages that were sent with `sendPackage` but are not acknowledged yet, oldest
+    // first. Guarded by `_connectionMutex`
+    struct InFlightPackage {
+        uint32_t sequence = 0;
+        std::function<void(bool)> onAcknowledged;
+    };
+    std::deque<InFlightPackage> _inFlightPackages;
+    uint32_t _nextPackageSequence = 1;
+    int _transferWindow = DefaultTransferWindow;
+
+    // The content offers that the other side has not replied to yet, oldest first.
+    // Guarded by `_connectionMutex`
+    struct PendingOffer {
+        int32_t packageId = 0;
+        uint64_t hash = 0;
+        std::function<void(bool)> onReply;
+    };
+    std::deque<PendingOffer> _pendingOffers;
+
+    // The hashes of the offered packages that were not in the cache by package id, which
+    // are added to the cache once they are received. Guarded by `_connectionMutex`
+    std::map<int32_t, uint64_t> _expectedContent;
+
+    struct ClockSample {
+        double offset = 0.0;
+        double roundTripTime = 0.0;
+    };
+    LatencyHistogram _loopTimes;
+    LatencyHistogram _roundTripTimes;
+    std::array<ClockSample, ClockSamples> _clockSamples;
+    size_t _nClockSamples = 0;
+    std::atomic<double> _clockOffset = 0.0;
     int _id;
     uint32_t _bufferSize = 1024;
     uint32_t _uncompressedBufferSize = _bufferSize;
@@ -158,15 +763,75 @@ private:
 
     std::vector<char> _recvBuffer;
     std::vector<char> _uncompressBuffer;
+    // The receive buffers of a data transfer connection that are kept between packages
+    BufferPool _bufferPool;
+    BandwidthLimiter* _bandwidthLimiter = nullptr;
+    const TransferCache* _transferCache = nullptr;
+
+    // The packages and chunks that were received but not decoded yet, oldest first.
+    // Guarded by `_decodeMutex`
+    std::deque<ReceivedPackage> _receivedPackages;
+    bool _isDecodeRunning = true;
+    std::mutex _decodeMutex;
+    std::condition_variable _decodeCond;
+    // Adds the packages of a data transfer connection to the transfer cache and decodes
+    // them and their chunks, so that neither of them stalls the NetworkReactor's thread
+    std::thread _decodeThread;
+
+    // The code point that the packets are marked with, or -1 if they are left unmarked
+    int _dscp = -1;
+    std::unique_ptr<z_stream_s, InflateDeleter> _inflateStream;
     char _headerId = 0;
 
+    // The state of the message that is currently being received
+    std::array<char, HeaderSize> _recvHeader = {};
+    size_t _nHeaderBytes = 0;
+    uint32_t _nPayloadBytes = 0;
+    uint32_t _dataSize = 0;
+    uint32_t _uncompressedDataSize = 0;
+    int32_t _packageId = -1;
+    // The number of a package that was sent with `sendPackage`, or 0 for other packages
+    uint32_t _packageSequence = 0;
+
+    struct MulticastFrame {
+        int32_t frame = 0;
+        uint32_t sequence = 0;
+        bool isRequested = false;
+    };
+    std::unique_ptr<MulticastReceiver> _multicastReceiver;
+    std::deque<MulticastFrame> _multicastFrames;
+    std::vector<char> _multicastBuffer;
+
+    bool _useSharedMemory = false;
+    std::unique_ptr<SharedMemoryChannel> _sharedMemory;
+    // Set once the messages of the other side arrive through `_sharedMemory`
+    std::atomic_bool _isReceivingSharedMemory = false;
+    // Set once the messages to the other side are sent through `_sharedMemory`. Only
+    // changes while the `_sendMutex` is held
+    bool _isSendingSharedMemory = false;
+
     std::condition_variable _startConnectionCond;
 
+    // Set once the connection was closed completely, which is waited for during the
+    // shutdown. Protected by the `_connectionMutex`
+    bool _isClosed = true;
+    std::condition_variable _closedCond;
+
     std::function<void(const char*, int)> decoderCallback;
+    std::function<void(const char*, int)> _deltaDecoderCallback;
+    std::function<void(const char*, int)> _keyframeDecoderCallback;
     std::function<void(void*, int, int, int)> _packageDecoderCallback;
     std::function<void(Network&)> _updateCallback;
     std::function<void(void)> _connectedCallback;
     std::function<void(int, int)> _acknowledgeCallback;
+    std::function<void(const char*, int, int, uint64_t, uint64_t, int)>
+        _chunkDecoderCallback;
+    std::function<void(int, uint64_t, uint64_t, int)> _chunkAcknowledgeCallback;
+    std::function<void(void)> _transferWindowCallback;
+    std::function<void(Network&, uint32_t)> _resendCallback;
+    std::function<void(void)> _arrivalCallback;
+    std::function<void(const std::array<char, HeaderSize>&, const char*, uint32_t,
+        const std::function<void()>&)> _relayCallback;
 };
 
 } // namespace sgct
@@ -11,19 +11,35 @@
 
 #include <sgct/sgctexports.h>
 
+#include <sgct/bandwidthlimiter.h>
+#include <sgct/bufferpool.h>
+#include <sgct/framebarrier.h>
 #include <sgct/network.h>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace sgct {
 
+class MulticastSender;
 class Network;
+class SyncRecorder;
+class TransferCache;
 
 /**
  * The network manager manages all network connections for SGCT.
@@ -33,11 +49,65 @@ public:
     enum class SyncMode { SendDataToClients = 0, Acknowledge };
     enum class NetworkMode { Remote = 0, LocalServer, LocalClient };
 
+    /// The largest number of bytes that are sent in one chunk by #transferFile and
+    /// #transferStream, which is also the most memory that a chunk needs on either side
+    static constexpr uint32_t TransferChunkSize = 1024 * 1024;
+
+    /// The Differentiated Services Code Point of the sync connections' packets if the
+    /// configuration doesn't specify one, which is Expedited Forwarding
+    static constexpr int DefaultSyncDscp = 46;
+
+    /// The smallest package that is offered to the nodes before it is sent if the
+    /// configuration enables the transfer cache. Smaller packages are sent directly, as
+    /// the round trip of the offer would take longer than sending them
+    static constexpr int TransferCacheMinSize = 64 * 1024;
+
+    /// The longest time that a transfer waits for the replies to its offer. A node that
+    /// has not replied by then is sent the package, even if it turns out to have it
+    static constexpr std::chrono::milliseconds TransferOfferTimeout =
+        std::chrono::milliseconds(250);
+
+    /// The longest time that #transferFile and #transferStream wait for a node to tell
+    /// them where an interrupted transfer continues. A node that has not replied by then
+    /// is sent the whole transfer
+    static constexpr std::chrono::milliseconds TransferResumeTimeout =
+        std::chrono::milliseconds(250);
+
+    /**
+     * The latency statistics of the sync connection to a node that receives the shared
+     * data from this node. All times are in seconds.
+     */
+    struct ConnectionStatistics {
+        struct Percentiles {
+            double p50 = 0.0;
+            double p95 = 0.0;
+            double p99 = 0.0;
+        };
+
+        /// The index of the node in the cluster
+        int node = -1;
+
+        /// The number of acknowledged frames that the statistics are based on
+        uint64_t nFrames = 0;
+
+        /// The time from sending a frame until its acknowledgement arrived
+        Percentiles loopTime;
+
+        /// The loop time without the time the node needed to acknowledge the frame
+        Percentiles roundTripTime;
+
+        /// The time `t` on the node corresponds to `t - clockOffset` on this node
+        double clockOffset = 0.0;
+    };
+
     static NetworkManager& instance();
     static void create(NetworkMode nm,
         std::function<void(void*, int, int, int)> dataTransferDecode,
         std::function<void(bool, int)> dataTransferStatus,
-        std::function<void(int, int)> dataTransferAcknowledge);
+        std::function<void(int, int)> dataTransferAcknowledge,
+        std::function<void(const char*, int, int, uint64_t, uint64_t, int)>
+            dataTransferChunk,
+        std::function<void(int, uint64_t, uint64_t, int)> dataTransferProgress);
     static void destroy();
 
     static std::condition_variable cond;
@@ -53,7 +123,37 @@ public:
      *         the clients. If it was the acknowledge data call or no connections are
      *         available, a `nullopt` is returned
      */
-    std::optional<std::pair<double, double>> sync(SyncMode sm) const;
+    std::optional<std::pair<double, double>> sync(SyncMode sm);
+
+    /**
+     * Records every frame of shared data that is sent to the clients into the file at
+     * \p path, which can later be replayed with the SyncReplayer. This only has an effect
+     * on the server.
+     *
+     * \throw Error If the file could not be created
+     */
+    void startRecording(const std::filesystem::path& path);
+
+    /**
+     * \return The time in seconds that it took to send the last frame completely to each
+     *         of the sync connections. The time is 0 for connections that are not
+     *         connected
+     */
+    const std::vector<double>& sendTimes() const;
+
+    /**
+     * \return The latency statistics of the nodes that receive the shared data from this
+     *         node, which are all other nodes on the server unless some of them receive
+     *         the shared data from a relay. A relay measures the statistics of its nodes
+     *         relative to itself instead
+     */
+    std::vector<ConnectionStatistics> connectionStatistics() const;
+
+    /**
+     * \return The statistics of the pacing of the data transfers, which are only delayed
+     *         if the configuration limits their bandwidth
+     */
+    BandwidthLimiter::Statistics transferBandwidthStatistics() const;
 
     /**
      * Compare if the last frame and current frames are different -> data update and if
@@ -61,6 +161,19 @@ public:
      */
     bool isSyncComplete() const;
 
+    /**
+     * Waits until the current frame might be complete, which is the case once all nodes
+     * that were sent the frame have acknowledged it on the server, or once the next frame
+     * has been received on a client. The waiting thread is also woken up if a connection
+     * changes its status, so #isSyncComplete has to be checked after this function
+     * returns. This function must only be called from the render thread.
+     *
+     * \param timeout The longest time that is waited
+     * \param spin The time that is busy-waited before the thread goes to sleep
+     * \return `false` if the wait timed out
+     */
+    bool waitForSync(std::chrono::nanoseconds timeout, std::chrono::nanoseconds spin);
+
     bool matchesAddress(std::string_view address) const;
 
     /**
@@ -68,11 +181,96 @@ public:
      */
     bool isComputerServer() const;
     bool isRunning() const;
+
+    /**
+     * \return `true` once all nodes of the cluster are connected. The #cond is notified
+     *         when this changes
+     */
     bool areAllNodesConnected() const;
+
+    /**
+     * Waits until all nodes of the cluster are connected or the \p timeout has passed.
+     * The #cond is waited for with the mutex that guards the connection state, so that
+     * the notification can't get lost between checking the state and waiting.
+     *
+     * \return `true` if all nodes of the cluster are connected
+     */
+    bool waitForAllNodesConnected(std::chrono::milliseconds timeout) const;
+
+    /**
+     * \return The time in seconds from the creation of the NetworkManager until all
+     *         nodes were connected for the first time, or `nullopt` if not all nodes
+     *         have been connected yet
+     */
+    std::optional<double> timeToAllNodesConnected() const;
+
+    /**
+     * Sends the \p length bytes of \p data as the package with the \p packageId to all
+     * data transfer connections that are connected. If the configuration enables the
+     * transfer cache, the hash of the package is offered to the nodes first, and the
+     * package is only sent to the nodes that don't have it in their cache yet. The
+     * replies to the offer are waited for at most #TransferOfferTimeout. When called
+     * from a callback of a connection, which runs on the thread that receives the
+     * replies, the package is sent to all nodes without an offer.
+     */
     void transferData(const void* data, int length, int packageId) const;
+
+    /**
+     * Sends the package in the same way as the other #transferData, but only to the
+     * \p connection.
+     */
     void transferData(const void* data, int length, int packageId,
         const Network& connection) const;
 
+    /**
+     * Sends the \p data as the package with the \p packageId to all data transfer
+     * connections that are connected, without waiting for it to be sent. The packages
+     * are sent in order on a separate thread, and each connection receives further
+     * packages while up to its transfer window of earlier packages are not acknowledged
+     * yet, so that the packages are not delayed by the round trip to the nodes. The
+     * acknowledge callback is called for every node as with #transferData.
+     *
+     * \param data The payload of the package
+     * \param packageId The id that identifies the package on the receiving nodes
+     * \return A future that becomes `true` once all nodes have acknowledged the package,
+     *         or `false` if the connection to any of them was lost before that
+     */
+    std::future<bool> transferDataAsync(std::vector<char> data, int packageId);
+
+    /**
+     * Sends the file at \p path to all data transfer connections in chunks of at most
+     * #TransferChunkSize bytes, so that neither side has to hold the whole file in
+     * memory. On Linux, the file is mapped into memory, so that the chunks are sent
+     * directly from the page cache. The receivers are called with every chunk and
+     * acknowledge each of them, which is reported through the progress callback. If an
+     * earlier transfer with the same \p packageId and size was interrupted, for example
+     * because the connection was lost, each node is asked how much of it it has
+     * received, and the transfer continues from there. A node that was restarted in the
+     * meantime receives the whole transfer again. As the nodes can't tell two transfers
+     * with the same \p packageId and size apart, a different file has to be sent with a
+     * different \p packageId while an earlier transfer is incomplete.
+     *
+     * \param path The file that is sent
+     * \param packageId The id that identifies the transfer on the receiving nodes
+     * \throw Error If the file could not be opened
+     */
+    void transferFile(const std::filesystem::path& path, int packageId) const;
+
+    /**
+     * Sends \p totalSize bytes that are produced by the \p source to all data transfer
+     * connections in the same way as #transferFile. The \p source is called with the
+     * offset of the next chunk in the transfer and a buffer of at most
+     * #TransferChunkSize bytes, and returns how many bytes of the chunk it has written
+     * to the buffer. As an interrupted transfer continues from the bytes that a node has
+     * received, the source has to be able to produce the bytes at any offset.
+     *
+     * \param source The function that produces the bytes of the transfer
+     * \param totalSize The number of bytes of the whole transfer
+     * \param packageId The id that identifies the transfer on the receiving nodes
+     */
+    void transferStream(std::function<size_t(uint64_t, std::span<char>)> source,
+        uint64_t totalSize, int packageId) const;
+
     unsigned int activeConnectionsCount() const;
     int connectionsCount() const;
     int syncConnectionsCount() const;
@@ -85,21 +283,135 @@ private:
     NetworkManager(NetworkMode nm,
         std::function<void(void*, int, int, int)> dataTransferDecode,
         std::function<void(bool, int)> dataTransferStatus,
-        std::function<void(int, int)> dataTransferAcknowledge);
+        std::function<void(int, int)> dataTransferAcknowledge,
+        std::function<void(const char*, int, int, uint64_t, uint64_t, int)>
+            dataTransferChunk,
+        std::function<void(int, uint64_t, uint64_t, int)> dataTransferProgress);
     NetworkManager(const NetworkManager&) = delete;
     NetworkManager(NetworkManager&&) = delete;
     NetworkManager& operator=(const NetworkManager&) = delete;
     NetworkManager& operator=(NetworkManager&&) = delete;
 
 
-    void addConnection(int port, std::string address,
-        Network::ConnectionType connectionType = Network::ConnectionType::SyncConnection);
+    /**
+     * Creates and initializes a connection to the node at \p address, or a server for
+     * it if \p isServer is `true`. If \p useSharedMemory is `true`, the node is on the
+     * same machine and the messages are exchanged through shared memory if possible.
+     */
+    void addConnection(int port, std::string address, bool isServer,
+        Network::ConnectionType connectionType = Network::ConnectionType::SyncConnection,
+        bool useSharedMemory = false);
     void updateConnectionStatus(Network& connection);
     void setAllNodesConnected();
 
+    /**
+     * Records and logs the time until all nodes were connected the first time that this
+     * function is called.
+     */
+    void reportAllNodesConnected();
+
+    /**
+     * Waits until the addresses of this computer have been looked up in the background
+     * and stores them in `_localAddresses`.
+     */
+    void waitForLocalAddresses() const;
+
+    /**
+     * Updates whether all nodes are connected on a client, which is the case once the
+     * server has reported that its nodes are connected and, on a relay, all nodes that
+     * receive the shared data from this node are connected as well. A relay forwards the
+     * message to these nodes when they are all connected.
+     */
+    void updateAllNodesConnected();
+
+    /**
+     * Queues the frame of shared data that a relay received with the \p header to be
+     * forwarded to the nodes that receive the shared data from this node before the
+     * frame is decoded by calling \p decode. The \p size bytes of \p data are forwarded
+     * as they were received, so the frame is neither decompressed nor encoded again.
+     * Nodes that just connected receive a keyframe of the decoded state instead.
+     */
+    void relayFrame(const std::array<char, Network::HeaderSize>& header, const char* data,
+        uint32_t size, const std::function<void()>& decode);
+
+    /**
+     * Sends the frames that #relayFrame queued in order. This runs on its own thread so
+     * that a node that is slow to receive doesn't stall the NetworkReactor thread, which
+     * also receives the acknowledgements of the other nodes.
+     */
+    void sendRelayedFrames();
+
+    /**
+     * Sends the keyframe of the current shared data with the \p frame number to the
+     * \p connection.
+     */
+    void sendKeyframe(Network& connection, int frame) const;
+
+    /**
+     * Waits until none of the clients lag behind so far that a frame they might request
+     * is no longer part of the multicast history. This resets the `_syncBarrier`.
+     */
+    void waitForMulticastAcknowledgements();
+
+    /**
+     * Resends the multicast frame with the \p sequence number over TCP to the client on
+     * the provided \p connection.
+     */
+    void resendMulticastFrame(Network& connection, uint32_t sequence) const;
+
+    /**
+     * Sends a transfer of \p totalSize bytes to each connected data transfer connection
+     * in chunks, starting with the first byte that the node has not received yet.
+     * The \p send function is called with the connection, the offset, and the size of
+     * each chunk, and returns the number of bytes that it has sent.
+     */
+    void transferChunks(int packageId, uint64_t totalSize,
+        const std::function<uint32_t(const Network&, uint64_t, uint32_t)>& send) const;
+
+    /**
+     * Offers the package with the \p packageId and its \p length bytes of \p data to the
+     * \p connections if the data transfers use a TransferCache and waits for their
+     * replies for at most #TransferOfferTimeout. A node that does not reply in time is
+     * treated as not having the package.
+     *
+     * \return The connections that don't have the package in their cache, to which it
+     *         has to be sent
+     */
+    std::vector<Network*> offerTransfer(std::vector<Network*> connections,
+        const void* data, int length, int packageId) const;
+
+    /**
+     * Asks the \p connection how many bytes of the transfer with the \p packageId and
+     * \p totalSize it has received and waits for at most #TransferResumeTimeout.
+     *
+     * \return The offset at which the transfer continues, which is 0 if the node has
+     *         not received any of it or did not reply in time
+     */
+    uint64_t resumeOffset(Network& connection, int packageId, uint64_t totalSize) const;
+
+    /**
+     * Sends the packages of #transferDataAsync to the connections whose transfer window
+     * is open until `_isTransferRunning` is set to `false`. Runs on `_transferThread`.
+     */
+    void sendQueuedTransfers();
+
+    /**
+     * Wakes up the `_transferThread` after a transfer window was opened.
+     */
+    void notifyTransfers();
+
+    /**
+     * Lets the data transfers back off while a frame has not been acknowledged by all
+     * nodes or while the loop time of the previous frame was above the threshold.
+     */
+    void updateTransferBackoff();
+
     std::function<void(void*, int, int, int)> _dataTransferDecodeFn;
     std::function<void(bool, int)> _dataTransferStatusFn;
     std::function<void(int, int)> _dataTransferAcknowledgeFn;
+    std::function<void(const char*, int, int, uint64_t, uint64_t, int)>
+        _dataTransferChunkFn;
+    std::function<void(int, uint64_t, uint64_t, int)> _dataTransferProgressFn;
 
     // This could be a std::vector<Network>, but Network is not move-constructible
     // because of the std::condition_variable in it
@@ -107,15 +419,94 @@ private:
     std::vector<Network*> _syncConnections;
     std::vector<Network*> _dataTransferConnections;
 
-    std::vector<std::string> _localAddresses;
+    mutable std::future<std::vector<std::string>> _localAddressesLookup;
+    mutable std::vector<std::string> _localAddresses;
+
+    std::unique_ptr<MulticastSender> _multicastSender;
+
+    // Counts the acknowledgements or received frames of the sync connections, so that
+    // the render thread is only woken up once the frame is complete
+    FrameBarrier _syncBarrier;
+
+    // Reused between frames to avoid allocating memory when sending the sync data
+    std::vector<Network*> _sendConnections;
+    std::vector<std::array<char, Network::HeaderSize>> _sendHeaders;
+    std::vector<double> _sendTimes;
+    // The connections that receive a keyframe this frame and their frame numbers
+    std::vector<std::pair<Network*, int>> _keyframeConnections;
+
+    // The connections to the nodes that receive the shared data from this node if it is
+    // a relay
+    std::vector<Network*> _relayConnections;
+
+    // A frame that is forwarded to the nodes of a relay, each of which gets its own
+    // header, and the keyframe for the nodes that just connected
+    struct RelayedFrame {
+        std::vector<Network*> connections;
+        std::vector<std::array<char, Network::HeaderSize>> headers;
+        std::vector<char> data;
+        uint32_t size = 0;
+        std::vector<std::pair<Network*, int>> keyframeConnections;
+        std::vector<char> keyframe;
+        size_t keyframeSize = 0;
+    };
+    // The frames that were received but not forwarded yet, oldest first. Guarded by
+    // `_relayMutex`
+    std::deque<RelayedFrame> _relayedFrames;
+    bool _isRelayRunning = true;
+    std::mutex _relayMutex;
+    std::condition_variable _relayCond;
+    std::thread _relayThread;
+    // Holds the copies of the frames, as they are forwarded after the receive buffer was
+    // reused
+    BufferPool _relayBufferPool;
+
+    std::unique_ptr<SyncRecorder> _recorder;
+
+    // The state of a package that was queued with `transferDataAsync`, which is shared
+    // by the connections that it is sent to
+    struct AsyncTransfer {
+        void complete(bool isPackageAcknowledged);
+
+        std::vector<char> data;
+        int packageId = -1;
+        // The connections that the package has not been sent to yet
+        std::vector<Network*> connections;
+        std::promise<bool> result;
+        std::atomic_int nPending = 0;
+        std::atomic_bool isAcknowledged = true;
+    };
+    // The packages that are not sent to all of their connections yet, oldest first.
+    // Guarded by `_transferMutex`
+    std::deque<std::shared_ptr<AsyncTransfer>> _asyncTransfers;
+    bool _isTransferRunning = true;
+    std::mutex _transferMutex;
+    std::condition_variable _transferCond;
+    std::thread _transferThread;
+
+    // Paces the payloads of all data transfer connections to a common budget
+    BandwidthLimiter _bandwidthLimiter;
+    // Set if the loop time of a node was above the threshold in the previous frame
+    std::atomic_bool _isLoopTimeHigh = false;
+    std::mutex _backoffMutex;
+
+    // The payloads of the data transfers that this node has received, if the
+    // configuration enables the transfer cache
+    std::unique_ptr<TransferCache> _transferCache;
 
     bool _isServer = true;
     bool _isRunning = true;
     bool _allNodesConnected = false;
+    // Whether a client has received the message that the server's nodes are connected
+    bool _isClusterConnected = false;
     const NetworkMode _mode;
     unsigned int _nActiveConnections = 0;
     unsigned int _nActiveSyncConnections = 0;
     unsigned int _nActiveDataTransferConnections = 0;
+
+    const std::chrono::steady_clock::time_point _creationTime =
+        std::chrono::steady_clock::now();
+    std::optional<double> _timeToAllNodesConnected;
 };
 
 } // namespace sgct
@@ -0,0 +1,89 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__NETWORKREACTOR__H__
+#define __SGCT__NETWORKREACTOR__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/network.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace sgct {
+
+/**
+ * Waits for incoming data on any number of sockets using a single thread and calls the
+ * function that was registered for a socket whenever data can be read from it. On Linux
+ * the sockets are observed using `epoll`, on all other platforms using `poll`.
+ *
+ * All registered functions are called on the reactor's thread, so they should never
+ * block for longer periods of time as this would delay all other sockets.
+ */
+class SGCT_EXPORT NetworkReactor {
+public:
+    /**
+     * \return The reactor that is shared by all Network connections
+     */
+    static NetworkReactor& instance();
+
+    NetworkReactor();
+    ~NetworkReactor();
+
+    /**
+     * Starts observing the \p socket and calls \p onReadable every time that data can be
+     * read from the socket or if the socket was closed by the remote side. A socket can
+     * only be registered once at a time.
+     */
+    void add(SGCT_SOCKET socket, std::function<void()> onReadable);
+
+    /**
+     * Stops observing the \p socket. Once this function returns, the function that was
+     * registered for the \p socket is no longer running and will not be called again,
+     * unless this function is called from the reactor's thread itself. Removing a socket
+     * that is not registered does nothing.
+     */
+    void remove(SGCT_SOCKET socket);
+
+    /**
+     * \return `true` if this function is called from the reactor's thread
+     */
+    bool isReactorThread() const;
+
+private:
+    NetworkReactor(const NetworkReactor&) = delete;
+    NetworkReactor(NetworkReactor&&) = delete;
+    NetworkReactor& operator=(const NetworkReactor&) = delete;
+    NetworkReactor& operator=(NetworkReactor&&) = delete;
+
+    void run();
+    void dispatch(SGCT_SOCKET socket);
+
+#ifdef __linux__
+    int _epoll = -1;
+    int _wakeup = -1;
+#endif // __linux__
+
+    // Protects the registered functions
+    std::mutex _mutex;
+    std::map<SGCT_SOCKET, std::shared_ptr<std::function<void()>>> _handlers;
+
+    // Held by the reactor's thread while it is calling the registered functions
+    std::mutex _dispatchMutex;
+
+    std::atomic_bool _shouldTerminate = false;
+    std::thread _thread;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__NETWORKREACTOR__H__
@@ -57,10 +57,17 @@ public:
      */
     int dataTransferPort() const;
 
+    /**
+     * \return The index of the node that relays the shared data to this node, or -1 if
+     *         this node receives the shared data from the master directly
+     */
+    int parent() const;
+
 private:
     const std::string _address;
     const uint16_t _syncPort;
     const uint16_t _dataTransferPort;
+    const int _parent;
     const bool _useSwapGroups;
 
     std::vector<std::unique_ptr<Window>> _windows;
@@ -11,16 +11,28 @@
 
 #include <sgct/sgctexports.h>
 
+#include <sgct/error.h>
 #include <sgct/network.h>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+struct z_stream_s;
+
 namespace sgct {
 
 /**
@@ -33,8 +45,83 @@ public:
     static void destroy();
 
     void setEncodeFunction(std::function<std::vector<std::byte>()> function);
+
+    /**
+     * Sets the function that encodes the shared data directly into the buffer that is
+     * sent to the clients. The buffer that is passed to the \p function already contains
+     * the network header and the function must only append to it, for example using the
+     * `serializeObject` functions. As the buffer is reused and retains its capacity
+     * between frames, encoding the same amount of data every frame does not require any
+     * memory allocations or additional copies. Setting this function replaces any
+     * function that was set previously.
+     *
+     * \param function The function that appends the shared data to the provided buffer
+     */
+    void setEncodeFunction(std::function<void(std::vector<std::byte>&)> function);
     void setDecodeFunction(std::function<void(const std::vector<std::byte>&)> function);
 
+    /**
+     * Sets the function that decodes the shared data without copying it into a vector of
+     * its own. The span that is passed to the \p function points into the reference
+     * block in which SharedData keeps the last received frame and is only valid until
+     * the function returns. The view-returning `deserializeObject` functions can be used
+     * to access strings and arrays in place. Setting this function replaces any function
+     * that was set previously.
+     *
+     * \param function The function that decodes the shared data in the provided span
+     */
+    void setDecodeViewFunction(std::function<void(std::span<const std::byte>)> function);
+
+    /**
+     * Enables or disables the compression of the shared data before it is sent to the
+     * clients. The compression is decided for each frame individually; a frame is only
+     * sent compressed if it is larger than #CompressionMinimumSize bytes and if the
+     * compressed version is at most #CompressionMaximumRatio of the original size.
+     * Otherwise the raw data is sent. The clients detect compressed frames automatically
+     * and do not have to enable this setting.
+     *
+     * \param enabled Whether the compression should be used or not
+     * \param level The zlib compression level between 1 (fastest) and 9 (smallest)
+     */
+    void setCompression(bool enabled, int level = 1);
+
+    /**
+     * Enables or disables the delta encoding of the shared data. If enabled, only the
+     * byte ranges that changed compared to the previous frame are sent to the clients,
+     * which then patch their copy of the previous frame before the decode function is
+     * called. A full frame (keyframe) is sent every \p keyframeInterval frames, whenever
+     * a keyframe was requested through #requestKeyframe, and whenever the delta would not
+     * be smaller than the full frame. As all clients receive all frames in order, the
+     * previous frame is the reference for every connected client. The clients detect
+     * delta frames automatically and do not have to enable this setting.
+     *
+     * \param enabled Whether the delta encoding should be used or not
+     * \param keyframeInterval The number of frames after which a full frame is sent
+     */
+    void setDeltaEncoding(bool enabled,
+        int keyframeInterval = DefaultKeyframeInterval);
+
+    /**
+     * Forces the next encoded frame to be a full frame that also contains the values of
+     * all shared variables, which is sent to all clients. A client that (re)connects
+     * receives its own keyframe through #keyframe instead.
+     */
+    void requestKeyframe();
+
+    /**
+     * This function is called internally by SGCT and shouldn't be used by the user.
+     * Returns the full state of the last encoded frame, which is sent to a client that
+     * has just (re)connected instead of the frame that the other clients receive. The
+     * returned block consists of a header with the Network::KeyframeId, the values of
+     * all shared variables, and the full frame, even if the other clients receive a
+     * delta. After decoding the keyframe, the client holds the same reference frame as
+     * the other clients, so the following deltas apply to it as well. The keyframe is
+     * only created once per encoded frame, no matter how many clients request it. On a
+     * node that relays the shared data, the keyframe is created from the last decoded
+     * frame instead.
+     */
+    std::span<std::byte> keyframe();
+
     /**
      * This fuction is called internally by SGCT and shouldn't be used by the user.
      */
@@ -45,19 +132,99 @@ public:
      */
     void decode(const char* receivedData, int receivedLength);
 
+    /**
+     * This function is called internally by SGCT and shouldn't be used by the user. The
+     * \p receivedData contains the byte ranges that have changed since the previous
+     * frame. It starts with the size of the full frame as a `uint32_t`, followed by any
+     * number of ranges, each consisting of a `uint32_t` offset, a `uint32_t` length, and
+     * the `length` bytes that should be written at the `offset`.
+     */
+    void decodeDelta(const char* receivedData, int receivedLength);
+
+    /**
+     * This function is called internally by SGCT and shouldn't be used by the user. The
+     * \p receivedData is the payload of a frame that was created by #keyframe.
+     */
+    void decodeKeyframe(const char* receivedData, int receivedLength);
+
     unsigned char* dataBlock();
     int dataSize();
     int bufferSize();
 
+    /// The smallest payload in bytes for which compression is attempted
+    static constexpr uint32_t CompressionMinimumSize = 1024;
+
+    /// The largest ratio between compressed and uncompressed size for which the
+    /// compressed frame is sent instead of the raw frame
+    static constexpr double CompressionMaximumRatio = 0.9;
+
+    /// The default number of frames after which a full frame is sent when delta encoding
+    static constexpr int DefaultKeyframeInterval = 100;
+
 private:
+    struct DeflateDeleter {
+        void operator()(z_stream_s* stream) const;
+    };
+
     SharedData();
 
+    /**
+     * Compresses the payload of the `_dataBlock` into `_compressedBlock` if the
+     * resulting size is small enough to warrant sending the compressed version.
+     */
+    void compress();
+
+    /**
+     * Replaces the `_dataBlock` with a delta against the `_previousBlock` stored in the
+     * `_deltaBlock` if the delta is smaller than the full frame and no keyframe is due.
+     */
+    void encodeDelta();
+
+    /**
+     * Applies the shared variables at the beginning of the \p frame and passes the rest
+     * of the frame to the decode function.
+     */
+    void decodeFrame(std::span<const std::byte> frame);
+
+    /**
+     * Returns the block that is sent before compression is applied, which is either the
+     * full frame or the delta frame.
+     */
+    const std::vector<std::byte>& uncompressedBlock() const;
+
     std::function<std::vector<std::byte>()> _encodeFn;
+    std::function<void(std::vector<std::byte>&)> _encodeIntoFn;
     std::function<void(const std::vector<std::byte>&)> _decodeFn;
+    std::function<void(std::span<const std::byte>)> _decodeViewFn;
+    // The application's part of the frame if it is preceded by shared variables
+    std::vector<std::byte> _applicationBlock;
 
     static SharedData* _instance;
     std::vector<std::byte> _dataBlock;
+    // The encoded frame is preceded by the network header, a decoded frame is not
+    size_t _dataBlockOffset = Network::HeaderSize;
     std::array<std::byte, Network::HeaderSize> _headerSpace;
+
+    bool _useCompression = false;
+    int _compressionLevel = 1;
+    bool _isCompressed = false;
+    size_t _compressedSize = 0;
+    std::vector<std::byte> _compressedBlock;
+    std::unique_ptr<z_stream_s, DeflateDeleter> _deflateStream;
+
+    bool _useDeltaEncoding = false;
+    int _keyframeInterval = DefaultKeyframeInterval;
+    int _framesSinceKeyframe = 0;
+    std::atomic_bool _keyframeRequested = false;
+    std::atomic_bool _allVariablesRequested = false;
+    bool _isDelta = false;
+    bool _hasReferenceFrame = false;
+    std::vector<std::byte> _previousBlock;
+    std::vector<std::byte> _deltaBlock;
+
+    // The full state for clients that just connected, which is created on demand
+    std::vector<std::byte> _keyframeBlock;
+    bool _hasKeyframe = false;
 };
 
 template <typename T>
@@ -110,7 +277,7 @@ void deserializeObject(const std::vector<std::byte>& buffer, unsigned int& pos,
         "Type has to be a plain-old data type"
     );
 
-    value = *reinterpret_cast<const T*>(&buffer[pos]);
+    std::memcpy(&value, buffer.data() + pos, sizeof(T));
     pos += sizeof(T);
 }
 
@@ -143,6 +310,683 @@ template <>
 SGCT_EXPORT void deserializeObject(const std::vector<std::byte>& buffer, unsigned int& pos,
     std::wstring& value);
 
+/**
+ * \throw Error If the \p buffer does not contain a `T` at the position \p pos
+ */
+template <typename T>
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos, T& value) {
+    static_assert(
+        std::is_standard_layout_v<T> && std::is_trivial_v<T>,
+        "Type has to be a plain-old data type"
+    );
+
+    if (pos > buffer.size() || sizeof(T) > buffer.size() - pos) {
+        throw Error(Error::Component::Network, 5061, "Shared data value exceeds buffer");
+    }
+    std::memcpy(&value, buffer.data() + pos, sizeof(T));
+    pos += sizeof(T);
+}
+
+/**
+ * Reads an array that was serialized from a `std::vector<T>` without copying it. The
+ * returned \p value points into the \p buffer and is only valid as long as the buffer
+ * is. The array has to be placed at a position in the buffer that is suitably aligned
+ * for `T`, for example by serializing arrays of larger types before smaller types.
+ *
+ * \throw Error If the array exceeds the \p buffer or is not aligned for `T`
+ */
+template <typename T>
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+                       std::span<const T>& value)
+{
+    static_assert(
+        std::is_standard_layout_v<T> && std::is_trivial_v<T>,
+        "Type has to be a plain-old data type"
+    );
+
+    uint32_t size = 0;
+    deserializeObject(buffer, pos, size);
+    if (static_cast<uint64_t>(size) * sizeof(T) > buffer.size() - pos) {
+        throw Error(Error::Component::Network, 5061, "Shared data array exceeds buffer");
+    }
+    const std::byte* data = buffer.data() + pos;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+        throw Error(Error::Component::Network, 5062, "Shared data array is not aligned");
+    }
+    value = std::span<const T>(reinterpret_cast<const T*>(data), size);
+    pos += size * sizeof(T);
+}
+
+/**
+ * Reads an array that was serialized from a `std::vector<T>`. Unlike the view, the
+ * array does not have to be aligned in the \p buffer.
+ *
+ * \throw Error If the array exceeds the \p buffer
+ */
+template <typename T>
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+                       std::vector<T>& value)
+{
+    static_assert(
+        std::is_standard_layout_v<T> && std::is_trivial_v<T>,
+        "Type has to be a plain-old data type"
+    );
+
+    uint32_t size = 0;
+    deserializeObject(buffer, pos, size);
+    if (static_cast<uint64_t>(size) * sizeof(T) > buffer.size() - pos) {
+        throw Error(Error::Component::Network, 5061, "Shared data array exceeds buffer");
+    }
+    value.resize(size);
+    if (size > 0) {
+        std::memcpy(value.data(), buffer.data() + pos, size * sizeof(T));
+    }
+    pos += size * sizeof(T);
+}
+
+/**
+ * Reads a string that was serialized from a `std::string` or `std::string_view` without
+ * copying it. The returned \p value points into the \p buffer and is only valid as long
+ * as the buffer is.
+ */
+SGCT_EXPORT void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+    std::string_view& value);
+
+SGCT_EXPORT void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+    std::string& value);
+
+template <typename T>
+void deserializeObject(const std::vector<std::byte>& buffer, unsigned int& pos,
+                       std::span<const T>& value)
+{
+    deserializeObject(std::span<const std::byte>(buffer), pos, value);
+}
+
+inline void deserializeObject(const std::vector<std::byte>& buffer, unsigned int& pos,
+                              std::string_view& value)
+{
+    deserializeObject(std::span<const std::byte>(buffer), pos, value);
+}
+
+SGCT_EXPORT void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+    std::wstring& value);
+
+/**
+ * A cursor that reads the values that were written using the `serializeObject` functions
+ * from a buffer. Every read checks whether the buffer contains enough bytes for the
+ * requested value and loads the value using `memcpy`, so the buffer does not have to be
+ * aligned for any of the read types. If a read fails, the value is left unchanged, the
+ * deserializer enters an error state, and all subsequent reads fail as well. This means
+ * that a sequence of reads can be checked once at the end using #hasError.
+ */
+class SGCT_EXPORT Deserializer {
+public:
+    explicit Deserializer(std::span<const std::byte> buffer);
+
+    /**
+     * Reads a single trivially copyable value.
+     *
+     * \return `true` if the value was read, `false` if the deserializer is in the error
+     *         state
+     */
+    template <typename T>
+    bool read(T& value);
+
+    /**
+     * Reads exactly `values.size()` consecutive values into the provided \p values
+     * without a preceding length. This is the counterpart to serializing an array
+     * element by element and copies all values with a single `memcpy`.
+     *
+     * \return `true` if the values were read, `false` if the deserializer is in the
+     *         error state
+     */
+    template <typename T>
+    bool read(std::span<T> values);
+
+    /**
+     * Reads an array that was serialized from a `std::vector<T>`.
+     *
+     * \return `true` if the array was read, `false` if the deserializer is in the error
+     *         state
+     */
+    template <typename T>
+    bool read(std::vector<T>& value);
+
+    bool read(std::string& value);
+    bool read(std::wstring& value);
+
+    /**
+     * Reads an array that was serialized from a `std::vector<T>` without copying it. The
+     * resulting \p view points into the buffer of the deserializer. Reading fails if the
+     * array is not suitably aligned for `T` in memory.
+     *
+     * \return `true` if the array was read, `false` if the deserializer is in the error
+     *         state
+     */
+    template <typename T>
+    bool readView(std::span<const T>& view);
+
+    /**
+     * Reads a string that was serialized from a `std::string` or `std::string_view`
+     * without copying it. The resulting \p view points into the buffer of the
+     * deserializer.
+     *
+     * \return `true` if the string was read, `false` if the deserializer is in the error
+     *         state
+     */
+    bool readView(std::string_view& view);
+
+    /**
+     * \return The number of bytes that have been read so far
+     */
+    size_t position() const;
+
+    /**
+     * \return The number of bytes that have not been read yet
+     */
+    size_t remaining() const;
+
+    /**
+     * \return `true` if any of the reads failed
+     */
+    bool hasError() const;
+
+    /**
+     * Puts the deserializer into the error state. This can be used by higher-level
+     * deserialization functions that detect invalid data in values that were read
+     * successfully.
+     */
+    void setError();
+
+private:
+    /**
+     * Returns a pointer to the next \p size bytes and advances the cursor past them, or
+     * returns `nullptr` and enters the error state if fewer bytes remain.
+     */
+    const std::byte* advance(size_t size);
+
+    /**
+     * Reads the `uint32_t` length of an array and returns a pointer to the array's
+     * \p elementSize * length bytes, which are skipped. Returns `nullptr` if the array
+     * does not fit into the remaining bytes.
+     */
+    const std::byte* advanceArray(size_t elementSize, uint32_t& length);
+
+    std::span<const std::byte> _buffer;
+    size_t _pos = 0;
+    bool _hasError = false;
+};
+
+// This function is defined in the header so that it can be inlined into the reads of
+// small values, where a function call would be more expensive than the read itself
+inline const std::byte* Deserializer::advance(size_t size) {
+    if (_hasError || size > _buffer.size() - _pos) {
+        _hasError = true;
+        return nullptr;
+    }
+    const std::byte* p = _buffer.data() + _pos;
+    _pos += size;
+    return p;
+}
+
+template <typename T>
+bool Deserializer::read(T& value) {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "Type has to be a trivially copyable type"
+    );
+
+    const std::byte* p = advance(sizeof(T));
+    if (!p) {
+        return false;
+    }
+    std::memcpy(&value, p, sizeof(T));
+    return true;
+}
+
+template <typename T>
+bool Deserializer::read(std::span<T> values) {
+    static_assert(
+        std::is_trivially_copyable_v<T> && !std::is_const_v<T>,
+        "Type has to be a non-const trivially copyable type"
+    );
+
+    const std::byte* p = advance(values.size_bytes());
+    if (!p) {
+        return false;
+    }
+    if (!values.empty()) {
+        std::memcpy(values.data(), p, values.size_bytes());
+    }
+    return true;
+}
+
+template <typename T>
+bool Deserializer::read(std::vector<T>& value) {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "Type has to be a trivially copyable type"
+    );
+
+    uint32_t length = 0;
+    const std::byte* p = advanceArray(sizeof(T), length);
+    if (!p) {
+        return false;
+    }
+    value.resize(length);
+    if (length > 0) {
+        std::memcpy(value.data(), p, length * sizeof(T));
+    }
+    return true;
+}
+
+template <typename T>
+bool Deserializer::readView(std::span<const T>& view) {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "Type has to be a trivially copyable type"
+    );
+
+    uint32_t length = 0;
+    const std::byte* p = advanceArray(sizeof(T), length);
+    if (!p) {
+        return false;
+    }
+    if (reinterpret_cast<std::uintptr_t>(p) % alignof(T) != 0) {
+        _hasError = true;
+        return false;
+    }
+    view = std::span<const T>(reinterpret_cast<const T*>(p), length);
+    return true;
+}
+
+//
+// Generic serialization
+//
+// The `serialize` and `deserialize` functions handle arbitrarily nested combinations of
+// the following types:
+//   - Trivially copyable types, except for optionals and pairs, which are copied as a
+//     whole
+//   - `std::string`, `std::wstring`, `std::vector`, `std::map`, and `std::unordered_map`,
+//     which are prefixed with their number of elements as a `uint32_t`
+//   - `std::optional`, which is prefixed with a `uint8_t` that is 1 if it has a value
+//   - `std::array` and `std::pair`, which are serialized element by element
+//   - Aggregates with up to 16 fields, which are serialized field by field
+//   - Types that declare the members that should be serialized by returning a tuple of
+//     member pointers from a static `serializedFields` function, for example:
+//       static constexpr auto serializedFields() {
+//           return std::tuple(&Foo::a, &Foo::b);
+//       }
+// Trivially copyable values, strings, and vectors of trivially copyable values result in
+// the same bytes as the corresponding `serializeObject` functions.
+//
+
+namespace detail {
+    template <typename T>
+    struct IsOptional : std::false_type {};
+    template <typename T>
+    struct IsOptional<std::optional<T>> : std::true_type {};
+
+    template <typename T>
+    struct IsPair : std::false_type {};
+    template <typename T, typename U>
+    struct IsPair<std::pair<T, U>> : std::true_type {};
+
+    // Optionals and pairs are excluded even if they are trivially copyable as their
+    // layout, including the padding, differs between standard library implementations
+    template <typename T>
+    constexpr bool IsTriviallySerializable =
+        std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> &&
+        !std::is_member_pointer_v<T> && !IsOptional<T>::value && !IsPair<T>::value;
+
+    template <typename T>
+    concept HasSerializedFields = requires { T::serializedFields(); };
+
+    template <typename T>
+    struct IsVector : std::false_type {};
+    template <typename T, typename A>
+    struct IsVector<std::vector<T, A>> : std::true_type {};
+
+    template <typename T>
+    struct IsTrivialVector : std::false_type {};
+    template <typename T, typename A>
+    struct IsTrivialVector<std::vector<T, A>>
+        : std::bool_constant<IsTriviallySerializable<T>> {};
+
+    template <typename T>
+    struct IsArray : std::false_type {};
+    template <typename T, size_t N>
+    struct IsArray<std::array<T, N>> : std::true_type {};
+
+    template <typename T>
+    struct IsMap : std::false_type {};
+    template <typename K, typename V, typename C, typename A>
+    struct IsMap<std::map<K, V, C, A>> : std::true_type {};
+    template <typename K, typename V, typename H, typename E, typename A>
+    struct IsMap<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+    // Converts to any type and is used to count the number of fields of an aggregate by
+    // finding the largest number of initializers that the aggregate can be created with
+    struct AnyField {
+        template <typename T>
+        operator T() const;
+    };
+
+    template <typename T, typename... Fields>
+    consteval size_t fieldCount() {
+        if constexpr (requires { T{ std::declval<Fields>()..., AnyField{} }; }) {
+            return fieldCount<T, Fields..., AnyField>();
+        }
+        else {
+            return sizeof...(Fields);
+        }
+    }
+
+    // Returns a tuple of references to all fields of the aggregate `value`
+    template <typename T>
+    auto tieFields(T& value) {
+        constexpr size_t N = fieldCount<std::remove_const_t<T>>();
+        static_assert(N <= 16, "Aggregates with more than 16 fields are not supported");
+
+        if constexpr (N == 0) {
+            return std::tie();
+        }
+        else if constexpr (N == 1) {
+            auto& [a] = value;
+            return std::tie(a);
+        }
+        else if constexpr (N == 2) {
+            auto& [a, b] = value;
+            return std::tie(a, b);
+        }
+        else if constexpr (N == 3) {
+            auto& [a, b, c] = value;
+            return std::tie(a, b, c);
+        }
+        else if constexpr (N == 4) {
+            auto& [a, b, c, d] = value;
+            return std::tie(a, b, c, d);
+        }
+        else if constexpr (N == 5) {
+            auto& [a, b, c, d, e] = value;
+            return std::tie(a, b, c, d, e);
+        }
+        else if constexpr (N == 6) {
+            auto& [a, b, c, d, e, f] = value;
+            return std::tie(a, b, c, d, e, f);
+        }
+        else if constexpr (N == 7) {
+            auto& [a, b, c, d, e, f, g] = value;
+            return std::tie(a, b, c, d, e, f, g);
+        }
+        else if constexpr (N == 8) {
+            auto& [a, b, c, d, e, f, g, h] = value;
+            return std::tie(a, b, c, d, e, f, g, h);
+        }
+        else if constexpr (N == 9) {
+            auto& [a, b, c, d, e, f, g, h, i] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i);
+        }
+        else if constexpr (N == 10) {
+            auto& [a, b, c, d, e, f, g, h, i, j] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j);
+        }
+        else if constexpr (N == 11) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+        }
+        else if constexpr (N == 12) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+        }
+        else if constexpr (N == 13) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+        }
+        else if constexpr (N == 14) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n);
+        }
+        else if constexpr (N == 15) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o);
+        }
+        else {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p] = value;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p);
+        }
+    }
+
+    // Calls `fn` with a reference to every field of `value` that should be serialized
+    template <typename T, typename Fn>
+    void forEachField(T& value, Fn&& fn) {
+        using Type = std::remove_const_t<T>;
+        if constexpr (HasSerializedFields<Type>) {
+            std::apply(
+                [&](auto... members) { (fn(value.*members), ...); },
+                Type::serializedFields()
+            );
+        }
+        else {
+            static_assert(
+                std::is_aggregate_v<Type>,
+                "Type has to be trivially copyable, a supported container, an aggregate, "
+                "or declare its serializedFields"
+            );
+            std::apply([&](auto&... fields) { (fn(fields), ...); }, tieFields(value));
+        }
+    }
+
+    // Writes the serialized bytes to a buffer that is known to be large enough
+    struct Writer {
+        template <typename T>
+        void write(const T& value) {
+            std::memcpy(p, &value, sizeof(T));
+            p += sizeof(T);
+        }
+
+        void write(const void* data, size_t size) {
+            if (size > 0) {
+                std::memcpy(p, data, size);
+                p += size;
+            }
+        }
+
+        std::byte* p;
+    };
+
+    template <typename T>
+    size_t serializedSize(const T& value);
+
+    template <typename T>
+    void serialize(Writer& writer, const T& value);
+
+    template <typename T>
+    void deserialize(Deserializer& deserializer, T& value);
+
+    template <typename T>
+    size_t serializedSize(const T& value) {
+        if constexpr (IsTriviallySerializable<T> && !HasSerializedFields<T>) {
+            return sizeof(T);
+        }
+        else if constexpr (std::is_same_v<T, std::string> ||
+                           std::is_same_v<T, std::wstring>)
+        {
+            return sizeof(uint32_t) + value.size() * sizeof(typename T::value_type);
+        }
+        else if constexpr (IsVector<T>::value || IsMap<T>::value || IsArray<T>::value) {
+            using V = typename T::value_type;
+            size_t size = IsArray<T>::value ? 0 : sizeof(uint32_t);
+            if constexpr (IsTriviallySerializable<V>) {
+                size += value.size() * sizeof(V);
+            }
+            else {
+                for (const V& v : value) {
+                    size += detail::serializedSize(v);
+                }
+            }
+            return size;
+        }
+        else if constexpr (IsOptional<T>::value) {
+            const size_t size = value.has_value() ? detail::serializedSize(*value) : 0;
+            return sizeof(uint8_t) + size;
+        }
+        else if constexpr (IsPair<T>::value) {
+            return detail::serializedSize(value.first) +
+                detail::serializedSize(value.second);
+        }
+        else {
+            size_t size = 0;
+            forEachField(value, [&size](const auto& f) {
+                size += detail::serializedSize(f);
+            });
+            return size;
+        }
+    }
+
+    template <typename T>
+    void serialize(Writer& writer, const T& value) {
+        if constexpr (IsTriviallySerializable<T> && !HasSerializedFields<T>) {
+            writer.write(value);
+        }
+        else if constexpr (std::is_same_v<T, std::string> ||
+                           std::is_same_v<T, std::wstring>)
+        {
+            writer.write(static_cast<uint32_t>(value.size()));
+            writer.write(value.data(), value.size() * sizeof(typename T::value_type));
+        }
+        else if constexpr (IsVector<T>::value || IsMap<T>::value || IsArray<T>::value) {
+            using V = typename T::value_type;
+            if constexpr (!IsArray<T>::value) {
+                writer.write(static_cast<uint32_t>(value.size()));
+            }
+            if constexpr (IsTrivialVector<T>::value) {
+                writer.write(value.data(), value.size() * sizeof(V));
+            }
+            else {
+                for (const V& v : value) {
+                    detail::serialize(writer, v);
+                }
+            }
+        }
+        else if constexpr (IsOptional<T>::value) {
+            writer.write(static_cast<uint8_t>(value.has_value() ? 1 : 0));
+            if (value.has_value()) {
+                detail::serialize(writer, *value);
+            }
+        }
+        else if constexpr (IsPair<T>::value) {
+            detail::serialize(writer, value.first);
+            detail::serialize(writer, value.second);
+        }
+        else {
+            forEachField(value, [&writer](const auto& f) {
+                detail::serialize(writer, f);
+            });
+        }
+    }
+
+    template <typename T>
+    void deserialize(Deserializer& deserializer, T& value) {
+        if constexpr (IsTriviallySerializable<T> && !HasSerializedFields<T>) {
+            deserializer.read(std::span<T>(&value, 1));
+        }
+        else if constexpr (std::is_same_v<T, std::string> ||
+                           std::is_same_v<T, std::wstring> || IsTrivialVector<T>::value)
+        {
+            deserializer.read(value);
+        }
+        else if constexpr (IsVector<T>::value || IsMap<T>::value) {
+            uint32_t size = 0;
+            if (!deserializer.read(size)) {
+                return;
+            }
+            // Every element occupies at least one byte, so this prevents allocating
+            // large amounts of memory for malformed sizes
+            if (size > deserializer.remaining()) {
+                deserializer.setError();
+                return;
+            }
+            value.clear();
+            if constexpr (IsVector<T>::value) {
+                value.resize(size);
+                for (uint32_t i = 0; i < size && !deserializer.hasError(); i++) {
+                    detail::deserialize(deserializer, value[i]);
+                }
+            }
+            else {
+                for (uint32_t i = 0; i < size && !deserializer.hasError(); i++) {
+                    std::pair<typename T::key_type, typename T::mapped_type> v;
+                    detail::deserialize(deserializer, v);
+                    value.insert(std::move(v));
+                }
+            }
+        }
+        else if constexpr (IsArray<T>::value) {
+            for (auto& v : value) {
+                detail::deserialize(deserializer, v);
+            }
+        }
+        else if constexpr (IsOptional<T>::value) {
+            uint8_t hasValue = 0;
+            if (!deserializer.read(hasValue)) {
+                return;
+            }
+            if (hasValue > 1) {
+                deserializer.setError();
+            }
+            else if (hasValue == 1) {
+                detail::deserialize(deserializer, value.emplace());
+            }
+            else {
+                value = std::nullopt;
+            }
+        }
+        else if constexpr (IsPair<T>::value) {
+            detail::deserialize(deserializer, value.first);
+            detail::deserialize(deserializer, value.second);
+        }
+        else {
+            forEachField(value, [&deserializer](auto& f) {
+                detail::deserialize(deserializer, f);
+            });
+        }
+    }
+} // namespace detail
+
+/**
+ * \return The number of bytes that #serialize appends to the buffer for the \p value
+ */
+template <typename T>
+size_t serializedSize(const T& value) {
+    return detail::serializedSize(value);
+}
+
+/**
+ * Appends the \p value to the \p buffer. The size of the serialized value is computed
+ * first so that the buffer grows at most once, after which the bytes are written without
+ * any further checks or allocations.
+ */
+template <typename T>
+void serialize(std::vector<std::byte>& buffer, const T& value) {
+    const size_t offset = buffer.size();
+    buffer.resize(offset + detail::serializedSize(value));
+    detail::Writer writer = { buffer.data() + offset };
+    detail::serialize(writer, value);
+}
+
+/**
+ * Reads a \p value that was written using #serialize from the \p deserializer.
+ *
+ * \return `true` if the value was read, `false` if the deserializer is in the error
+ *         state. In the latter case, the \p value might have been partially modified
+ */
+template <typename T>
+bool deserialize(Deserializer& deserializer, T& value) {
+    detail::deserialize(deserializer, value);
+    return !deserializer.hasError();
+}
+
 } // namespace sgct
 
 #endif // __SGCT__SHAREDDATA__H__
@@ -0,0 +1,146 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SHAREDMEMORY__H__
+#define __SGCT__SHAREDMEMORY__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/network.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+
+namespace sgct {
+
+/**
+ * A bidirectional channel between two processes on the same machine that is used instead
+ * of a TCP connection. Each direction is a single-producer, single-consumer ring buffer
+ * in a shared memory segment, so that a message is copied only once and no system call
+ * is needed while the receiving side is busy. A side that finds its ring empty marks
+ * itself as waiting and is woken up by the next write through a named pipe, which can be
+ * observed by the NetworkReactor just like a socket.
+ *
+ * The channel is created by the server under a name that is unique to the connection and
+ * opened by the client using that name. As a client on a different machine can't open
+ * the name, a failure to open the channel means that the TCP connection has to be used.
+ * Shared memory channels are not supported on Windows.
+ */
+class SGCT_EXPORT SharedMemoryChannel {
+public:
+    enum class Mode { Create, Open };
+
+    /// The size of the ring buffer in each direction
+    static constexpr size_t RingSize = 4 * 1024 * 1024;
+
+    /**
+     * \return A name for the channel of the server on \p port that is not used by any
+     *         other channel
+     */
+    static std::string uniqueName(int port);
+
+    /**
+     * Creates the channel called \p name in Mode::Create, or opens the channel that was
+     * created by the other side in Mode::Open.
+     *
+     * \throw Error If the channel could not be created or opened
+     */
+    SharedMemoryChannel(std::string name, Mode mode);
+    ~SharedMemoryChannel();
+
+    const std::string& name() const;
+
+    /**
+     * Removes the names of the shared memory segment and the pipes once both sides have
+     * opened them, so that nothing is left behind if one of the processes terminates.
+     */
+    void unlink();
+
+    /**
+     * Marks the channel as closed, which stops the other side from waiting for space in
+     * a full ring buffer.
+     */
+    void close();
+
+    /**
+     * Writes all of the \p buffers to the other side, waiting for space to become
+     * available if the ring buffer is full.
+     *
+     * \return `false` if the channel was closed by either side while waiting for space
+     */
+    bool write(std::initializer_list<std::span<const char>> buffers);
+
+    /**
+     * Reads up to \p size bytes that were written by the other side into \p buffer. If no
+     * data is available, the next write by the other side makes the #notification
+     * readable.
+     *
+     * \return The number of bytes that were read
+     */
+    size_t read(char* buffer, size_t size);
+
+    /**
+     * \return The descriptor that becomes readable when data was written after #read
+     *         returned 0
+     */
+    SGCT_SOCKET notification() const;
+
+private:
+    SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel(SharedMemoryChannel&&) = delete;
+    SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel& operator=(SharedMemoryChannel&&) = delete;
+
+    // Keeps the positions that are written by different processes on separate cache
+    // lines
+    static constexpr size_t CacheLineSize = 64;
+
+    // The control block at the beginning of the shared memory segment, followed by the
+    // data of both ring buffers. The positions only ever increase and are wrapped around
+    // the size of the ring buffer when accessing the data
+    struct Control {
+        struct Ring {
+            // The position up to which the reader has consumed the data
+            alignas(CacheLineSize) std::atomic<uint64_t> head = 0;
+            // The position up to which the writer has published data
+            alignas(CacheLineSize) std::atomic<uint64_t> tail = 0;
+            // Set by the reader when it found the ring empty and has to be woken up
+            alignas(CacheLineSize) std::atomic<uint32_t> isWaiting = 0;
+        };
+
+        std::array<char, 8> magic = { 'S', 'G', 'C', 'T', 'S', 'H', 'M', '1' };
+        uint64_t ringSize = RingSize;
+        std::atomic<uint32_t> isClosed = 0;
+        std::array<Ring, 2> rings;
+    };
+
+    static constexpr size_t DataOffset =
+        (sizeof(Control) + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+
+    const std::string _name;
+    const Mode _mode;
+    bool _isLinked = false;
+
+    std::byte* _memory = nullptr;
+    size_t _size = 0;
+    Control* _control = nullptr;
+
+    // The ring buffer that this side writes to and the one that it reads from
+    int _writeRing = 0;
+    int _readRing = 1;
+    // The pipes are indexed by the ring buffer whose reader they wake up
+    std::array<int, 2> _pipes = { -1, -1 };
+};
+
+} // namespace sgct
+
+#endif // __SGCT__SHAREDMEMORY__H__
@@ -0,0 +1,257 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SHAREDOBJECT__H__
+#define __SGCT__SHAREDOBJECT__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/shareddata.h>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * The base class of all variables that are automatically shared between the nodes of a
+ * cluster. Every variable registers itself with the SharedObjectRegistry once it is fully
+ * constructed and receives an id that identifies it on all nodes. As the ids are
+ * assigned in the order in which the variables are created, all nodes have to create
+ * their shared variables in the same order, which is the case if the same application
+ * runs on all of them.
+ */
+class SGCT_EXPORT SharedVariable {
+public:
+    SharedVariable() = default;
+    virtual ~SharedVariable();
+
+    /**
+     * \return The id that identifies this variable on all nodes of the cluster
+     */
+    uint16_t id() const;
+
+    /**
+     * \return `true` if the variable was changed since it was last sent to the clients
+     */
+    bool isDirty() const;
+
+protected:
+    /**
+     * Adds the variable to the SharedObjectRegistry, which encodes and decodes its value
+     * from then on. As this happens concurrently to the encoding of the frames, the
+     * derived class has to call this at the end of its constructor, once its value
+     * exists.
+     */
+    void registerVariable();
+
+    /**
+     * Removes the variable from the SharedObjectRegistry. The derived class has to call
+     * this at the start of its destructor, before its value is destroyed.
+     */
+    void unregisterVariable();
+
+    /**
+     * \return The mutex that the SharedObjectRegistry holds while it encodes or decodes
+     *         the values of the variables, which has to be held to change a value
+     */
+    static std::mutex& valueMutex();
+
+    /**
+     * Marks the variable as changed so that it is sent in the next frame. The caller has
+     * to hold the #valueMutex.
+     */
+    void markDirty();
+
+private:
+    SharedVariable(const SharedVariable&) = delete;
+    SharedVariable(SharedVariable&&) = delete;
+    SharedVariable& operator=(const SharedVariable&) = delete;
+    SharedVariable& operator=(SharedVariable&&) = delete;
+
+    friend class SharedObjectRegistry;
+
+    /**
+     * Appends the current value of the variable to the \p buffer.
+     */
+    virtual void serializeValue(std::vector<std::byte>& buffer) const = 0;
+
+    /**
+     * Replaces the value of the variable with the value that is read from the
+     * \p deserializer.
+     *
+     * \return `true` if the value was read successfully
+     */
+    virtual bool deserializeValue(Deserializer& deserializer) = 0;
+
+    uint16_t _id = 0;
+    bool _isDirty = true;
+};
+
+/**
+ * A variable of type \p T whose value is set on the master and automatically replicated
+ * to all clients. Only variables whose value changed since the previous frame are sent.
+ * The clients apply the received values before the `postSyncPreDraw` callback is called.
+ * \p T can be any type that is supported by the #serialize function.
+ *
+ * The value can be changed from any thread, as the changes are serialized with the
+ * encoding of the frames.
+ */
+template <typename T>
+class SharedObject final : public SharedVariable {
+public:
+    explicit SharedObject(T value = T());
+    ~SharedObject() override;
+
+    /**
+     * \return The current value of the variable. The reference must only be used while
+     *         no other thread changes the value, which on a client is the thread that
+     *         decodes the frames
+     */
+    const T& value() const;
+
+    /**
+     * Sets the \p value of the variable, which is then sent to the clients in the next
+     * frame. If \p T can be compared and the value did not change, nothing is sent.
+     */
+    void setValue(T value);
+
+    /**
+     * Calls the \p fn with a reference to the value, which allows for changing parts of a
+     * larger value in place. The value is always sent to the clients in the next frame.
+     * The \p fn is called while the #valueMutex is held, so it must not change any other
+     * shared variable.
+     */
+    template <typename Fn>
+    void modify(Fn&& fn);
+
+private:
+    void serializeValue(std::vector<std::byte>& buffer) const override;
+    bool deserializeValue(Deserializer& deserializer) override;
+
+    T _value;
+};
+
+/**
+ * Keeps track of all SharedVariable objects and encodes the changed variables into the
+ * shared data frames on the master and applies them on the clients. Each frame with
+ * shared variables starts with the number of encoded variables as a `uint16_t`, followed
+ * by each variable's `uint16_t` id and its serialized value. The section is padded to a
+ * multiple of `alignof(std::max_align_t)` bytes, so that the application's data after it
+ * stays as aligned as the frame itself. The section is only part of the frame if any
+ * shared variables exist, so applications that do not use them are not affected.
+ */
+class SGCT_EXPORT SharedObjectRegistry {
+public:
+    static SharedObjectRegistry& instance();
+
+    /**
+     * \return `true` if any shared variables exist
+     */
+    bool hasVariables();
+
+    /**
+     * Appends all changed variables to the \p buffer, or all variables if \p includeAll
+     * is `true`, and marks them as unchanged.
+     */
+    void encode(std::vector<std::byte>& buffer, bool includeAll);
+
+    /**
+     * Appends all variables to the \p buffer in the same format as #encode, but without
+     * marking them as unchanged, so that the changes are still sent with the next frame.
+     */
+    void encodeAll(std::vector<std::byte>& buffer);
+
+    /**
+     * Applies the variables that were encoded by #encode and reads them from the
+     * \p deserializer, which is left at the first byte after the variables.
+     *
+     * \throw Error If the data is malformed or refers to an unknown variable
+     */
+    void decode(Deserializer& deserializer);
+
+private:
+    friend class SharedVariable;
+
+    SharedObjectRegistry() = default;
+
+    /**
+     * Assigns the next id to the \p variable and adds it to the `_variables`.
+     */
+    void add(SharedVariable* variable);
+    void remove(SharedVariable* variable);
+
+    /**
+     * Adds the \p variable to the `_dirtyVariables`. The caller has to hold the `_mutex`.
+     */
+    void markDirty(SharedVariable* variable);
+
+    // Guards the variables and their values, see SharedVariable::valueMutex
+    std::mutex _mutex;
+    // The id of each variable is its index. The slots of removed variables are not reused
+    // as that could lead to differing ids between the nodes
+    std::vector<SharedVariable*> _variables;
+    size_t _nVariables = 0;
+    // The ids of the variables that have changed since the last encoded frame, so that
+    // the unchanged variables don't have to be visited when encoding
+    std::vector<uint16_t> _dirtyVariables;
+};
+
+template <typename T>
+SharedObject<T>::SharedObject(T value)
+    : _value(std::move(value))
+{
+    registerVariable();
+}
+
+template <typename T>
+SharedObject<T>::~SharedObject() {
+    unregisterVariable();
+}
+
+template <typename T>
+const T& SharedObject<T>::value() const {
+    return _value;
+}
+
+template <typename T>
+void SharedObject<T>::setValue(T value) {
+    const std::unique_lock lock(valueMutex());
+    if constexpr (std::equality_comparable<T>) {
+        if (_value == value) {
+            return;
+        }
+    }
+    _value = std::move(value);
+    markDirty();
+}
+
+template <typename T>
+template <typename Fn>
+void SharedObject<T>::modify(Fn&& fn) {
+    const std::unique_lock lock(valueMutex());
+    fn(_value);
+    markDirty();
+}
+
+template <typename T>
+void SharedObject<T>::serializeValue(std::vector<std::byte>& buffer) const {
+    serialize(buffer, _value);
+}
+
+template <typename T>
+bool SharedObject<T>::deserializeValue(Deserializer& deserializer) {
+    return deserialize(deserializer, _value);
+}
+
+} // namespace sgct
+
+#endif // __SGCT__SHAREDOBJECT__H__
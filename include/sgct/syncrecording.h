@@ -0,0 +1,209 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SYNCRECORDING__H__
+#define __SGCT__SYNCRECORDING__H__
+
+#include <sgct/sgctexports.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * A file that is mapped into memory, either for writing with a size that can grow or
+ * for reading.
+ */
+class SGCT_EXPORT MappedFile {
+public:
+    enum class Mode { Read, Write };
+
+    /**
+     * Opens the file at the \p path. In Mode::Write, the file is created or truncated.
+     *
+     * \throw Error If the file could not be opened or mapped
+     */
+    MappedFile(const std::filesystem::path& path, Mode mode);
+    ~MappedFile();
+
+    /**
+     * Changes the size of a file that was opened in Mode::Write to \p size bytes and
+     * maps the whole file. This invalidates all pointers into the previous mapping.
+     *
+     * \throw Error If the file could not be resized or mapped
+     */
+    void resize(size_t size);
+
+    std::byte* data();
+    const std::byte* data() const;
+    size_t size() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    void map();
+    void unmap();
+
+    Mode _mode;
+#ifdef WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    int _file = -1;
+#endif // WIN32
+    std::byte* _data = nullptr;
+    size_t _size = 0;
+};
+
+/**
+ * Records the shared data frames that the master sends to its clients into a file. The
+ * file starts with #Magic and the #Version, followed by one record per frame that
+ * consists of the `uint64_t` frame number, the `double` time in seconds since the
+ * recording started, the `uint32_t` size of the frame, and the frame itself including
+ * its network header. When the recording is finished, an index with the `uint64_t`
+ * offset of every record is appended, followed by the `uint64_t` number of frames, the
+ * `uint64_t` offset of the index, and #IndexMagic.
+ *
+ * The frames are only copied into a buffer on the calling thread and written to the
+ * memory-mapped file on a separate thread, so that recording does not slow down the
+ * master.
+ */
+class SGCT_EXPORT SyncRecorder {
+public:
+    /**
+     * Creates the recording at \p path, overwriting any existing file.
+     *
+     * \throw Error If the file could not be created
+     */
+    explicit SyncRecorder(const std::filesystem::path& path);
+
+    /**
+     * Writes all pending frames and the index and closes the file.
+     */
+    ~SyncRecorder();
+
+    /**
+     * Adds the \p frame, which includes the network header, to the recording.
+     */
+    void record(std::span<const std::byte> frame);
+
+    /// The identifier at the beginning of every recording
+    static constexpr std::array<char, 8> Magic = {
+        'S', 'G', 'C', 'T', 'S', 'Y', 'N', 'C'
+    };
+
+    /// The identifier at the end of every completed recording
+    static constexpr std::array<char, 8> IndexMagic = {
+        'S', 'G', 'C', 'T', 'I', 'N', 'D', 'X'
+    };
+
+    /// The version of the file format
+    static constexpr uint32_t Version = 1;
+
+    /// The size of the file header consisting of the magic, version, and padding
+    static constexpr size_t FileHeaderSize = 16;
+
+    /// The size of the frame number, time stamp, and size that precede every frame
+    static constexpr size_t RecordHeaderSize =
+        sizeof(uint64_t) + sizeof(double) + sizeof(uint32_t);
+
+private:
+    /**
+     * Writes the frames that were recorded until there are no more frames and the
+     * recorder is shutting down.
+     */
+    void writeFrames();
+
+    /**
+     * Appends the \p data to the file, growing the file if necessary.
+     */
+    void append(std::span<const std::byte> data);
+
+    MappedFile _file;
+    size_t _writePos = 0;
+    std::vector<uint64_t> _offsets;
+
+    const std::chrono::steady_clock::time_point _start;
+    uint64_t _frameNumber = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    // Frames that were recorded but not written yet. This buffer is swapped with
+    // `_writing` by the writing thread so that both retain their memory between frames
+    std::vector<std::byte> _pending;
+    std::vector<std::byte> _writing;
+    bool _shouldTerminate = false;
+    std::thread _thread;
+};
+
+/**
+ * Reads a recording that was created by the SyncRecorder and passes its frames into the
+ * SharedData, like the frames would be received by a client, without requiring a master.
+ */
+class SGCT_EXPORT SyncReplayer {
+public:
+    struct Frame {
+        uint64_t frameNumber = 0;
+        double timestamp = 0.0;
+        /// The frame including the network header
+        std::span<const std::byte> data;
+    };
+
+    /**
+     * Opens the recording at \p path. If \p useOriginalRate is `true`, #decodeNextFrame
+     * waits until the frame is due based on the time at which it was recorded, otherwise
+     * the frames are replayed as fast as possible.
+     *
+     * \throw Error If the file could not be opened or is not a valid recording
+     */
+    SyncReplayer(const std::filesystem::path& path, bool useOriginalRate);
+
+    /**
+     * \return The number of frames in the recording
+     */
+    size_t nFrames() const;
+
+    /**
+     * \return The frame with the provided \p index, which has to be smaller than #nFrames
+     */
+    Frame frame(size_t index) const;
+
+    /**
+     * Passes the next frame to the SharedData, decompressing it first if necessary.
+     *
+     * \return `false` if all frames have been replayed already
+     * \throw Error If the frame could not be decompressed
+     */
+    bool decodeNextFrame();
+
+private:
+    MappedFile _file;
+    std::vector<uint64_t> _offsets;
+    size_t _nextFrame = 0;
+
+    bool _useOriginalRate = false;
+    std::chrono::steady_clock::time_point _start;
+
+    std::vector<char> _uncompressBuffer;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__SYNCRECORDING__H__
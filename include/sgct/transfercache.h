@@ -0,0 +1,105 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__TRANSFERCACHE__H__
+#define __SGCT__TRANSFERCACHE__H__
+
+#include <sgct/sgctexports.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Keeps the payloads of data transfers in a directory on disk, addressed by the hash of
+ * their content, so that a payload that a node has received before does not have to be
+ * sent to it again. Every payload is stored in its own file that is named after its
+ * hash. A file is written under a temporary name first and renamed once it is complete,
+ * so that the directory can be shared by nodes that run on the same machine.
+ */
+class SGCT_EXPORT TransferCache {
+public:
+    /**
+     * A payload from the cache. On Linux, the file is mapped into memory, so that the
+     * payload is read from the page cache without being copied. The mapping is private,
+     * so changing the bytes does not change the cached file.
+     */
+    class SGCT_EXPORT Payload {
+    public:
+        Payload(Payload&& rhs) noexcept;
+        ~Payload();
+
+        char* data();
+        size_t size() const;
+
+    private:
+        friend class TransferCache;
+
+        Payload() = default;
+        Payload(const Payload&) = delete;
+        Payload& operator=(const Payload&) = delete;
+        Payload& operator=(Payload&&) = delete;
+
+        char* _data = nullptr;
+        size_t _size = 0;
+        bool _isMapped = false;
+        // Holds the bytes on the platforms on which the file is not mapped
+        std::vector<char> _buffer;
+    };
+
+    /**
+     * Hashes the \p data with the 64 bit variant of xxHash, which is fast enough to hash
+     * a payload at the speed at which it is read from memory.
+     *
+     * \param data The bytes that are hashed
+     * \return The hash of the \p data
+     */
+    static uint64_t hash(std::span<const char> data);
+
+    /**
+     * \param directory The directory in which the payloads are kept, which is created if
+     *        it does not exist yet
+     * \throw Error If the directory could not be created
+     */
+    explicit TransferCache(std::filesystem::path directory);
+
+    /**
+     * \return The payload with the \p hash if it is in the cache and has \p size bytes,
+     *         or `std::nullopt` if it has to be received
+     */
+    std::optional<Payload> find(uint64_t hash, uint64_t size) const;
+
+    /**
+     * Adds the \p data with the \p hash to the cache. A failure to write the file is only
+     * logged, as the payload is then received again the next time.
+     *
+     * \return `true` if the payload was added to the cache
+     */
+    bool store(uint64_t hash, std::span<const char> data) const;
+
+    /**
+     * \return The file in which the payload with the \p hash is kept
+     */
+    std::filesystem::path path(uint64_t hash) const;
+
+private:
+    const std::filesystem::path _directory;
+    // Distinguishes the temporary files of this cache from those of other processes that
+    // share the directory
+    std::string _suffix;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__TRANSFERCACHE__H__
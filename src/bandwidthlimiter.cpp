@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/bandwidthlimiter.h>
+
+#include <algorithm>
+
+namespace sgct {
+
+BandwidthLimiter::BandwidthLimiter(double bytesPerSecond)
+    : _rate(bytesPerSecond)
+{}
+
+void BandwidthLimiter::acquire(size_t bytes) {
+    using namespace std::chrono;
+
+    std::unique_lock lock(_mutex);
+    _statistics.nBytes += bytes;
+    const steady_clock::time_point start = steady_clock::now();
+    bool isDelayed = false;
+    while (_rate > 0.0 && !_isStopped) {
+        const steady_clock::time_point now = steady_clock::now();
+        refillLocked(now);
+        if (_budget >= 0.0) {
+            break;
+        }
+
+        // The slices of the other senders are paid for first. A change of the rate wakes
+        // up the sender, which then waits for the time at the new rate instead
+        isDelayed = true;
+        const double rate = _isBackingOff ? _rate * BackoffFraction : _rate;
+        const duration<double> wait = duration<double>(-_budget / rate);
+        _cond.wait_until(lock, now + duration_cast<steady_clock::duration>(wait));
+    }
+    _budget -= static_cast<double>(bytes);
+
+    if (isDelayed) {
+        _statistics.nDelays++;
+        _statistics.delay += duration_cast<nanoseconds>(steady_clock::now() - start);
+    }
+}
+
+void BandwidthLimiter::setRate(double bytesPerSecond) {
+    {
+        const std::unique_lock lock(_mutex);
+        refillLocked(std::chrono::steady_clock::now());
+        _rate = bytesPerSecond;
+    }
+    _cond.notify_all();
+}
+
+double BandwidthLimiter::rate() const {
+    const std::unique_lock lock(_mutex);
+    return _rate;
+}
+
+void BandwidthLimiter::setBackoff(bool isBackingOff) {
+    {
+        const std::unique_lock lock(_mutex);
+        if (_isBackingOff == isBackingOff) {
+            return;
+        }
+        refillLocked(std::chrono::steady_clock::now());
+        _isBackingOff = isBackingOff;
+    }
+    _cond.notify_all();
+}
+
+bool BandwidthLimiter::isBackingOff() const {
+    const std::unique_lock lock(_mutex);
+    return _isBackingOff && _rate > 0.0;
+}
+
+void BandwidthLimiter::stop() {
+    {
+        const std::unique_lock lock(_mutex);
+        _isStopped = true;
+    }
+    _cond.notify_all();
+}
+
+BandwidthLimiter::Statistics BandwidthLimiter::statistics() const {
+    const std::unique_lock lock(_mutex);
+    return _statistics;
+}
+
+void BandwidthLimiter::refillLocked(std::chrono::steady_clock::time_point now) {
+    using namespace std::chrono;
+
+    const double rate = _isBackingOff ? _rate * BackoffFraction : _rate;
+    const double elapsed = duration<double>(now - _lastRefill).count();
+    const double burst = _rate * duration<double>(BurstTime).count();
+    _budget = std::min(_budget + elapsed * rate, burst);
+    _lastRefill = now;
+}
+
+} // namespace sgct
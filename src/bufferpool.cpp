@@ -0,0 +1,118 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/bufferpool.h>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+
+namespace sgct {
+
+BufferPool::BufferPool(size_t highWaterMark, std::chrono::steady_clock::duration idleTime)
+    : _highWaterMark(highWaterMark)
+    , _idleTime(idleTime)
+{}
+
+std::vector<char> BufferPool::acquire(size_t size) {
+    const size_t sizeClass = std::bit_ceil(std::max(size, MinBufferSize));
+
+    const std::unique_lock lock(_mutex);
+    trimLocked(std::chrono::steady_clock::now());
+    _statistics.nAcquired++;
+
+    const auto it = _buffers.find(sizeClass);
+    if (it != _buffers.end() && !it->second.empty()) {
+        std::vector<char> buffer = std::move(it->second.back().buffer);
+        it->second.pop_back();
+        _statistics.retainedBytes -= buffer.size();
+        return buffer;
+    }
+
+    _statistics.nAllocations++;
+    return std::vector<char>(sizeClass);
+}
+
+void BufferPool::release(std::vector<char> buffer) {
+    const size_t size = buffer.size();
+    if (size < MinBufferSize || !std::has_single_bit(size)) {
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const std::unique_lock lock(_mutex);
+    trimLocked(now);
+    if (size > _highWaterMark) {
+        _statistics.nFreed++;
+        return;
+    }
+
+    shrinkLocked(_highWaterMark - size);
+    _buffers[size].push_back({ std::move(buffer), now });
+    _statistics.retainedBytes += size;
+}
+
+void BufferPool::trim() {
+    const std::unique_lock lock(_mutex);
+    trimLocked(std::chrono::steady_clock::now());
+}
+
+void BufferPool::clear() {
+    const std::unique_lock lock(_mutex);
+    shrinkLocked(0);
+}
+
+void BufferPool::setHighWaterMark(size_t bytes) {
+    const std::unique_lock lock(_mutex);
+    _highWaterMark = bytes;
+    shrinkLocked(bytes);
+}
+
+BufferPool::Statistics BufferPool::statistics() const {
+    const std::unique_lock lock(_mutex);
+    return _statistics;
+}
+
+void BufferPool::trimLocked(std::chrono::steady_clock::time_point now) {
+    for (auto& [sizeClass, entries] : _buffers) {
+        // The entries of a size class are ordered by the time they were released
+        const auto it = std::find_if(
+            entries.begin(),
+            entries.end(),
+            [&](const Entry& e) { return now - e.releaseTime < _idleTime; }
+        );
+        const size_t nFreed = static_cast<size_t>(std::distance(entries.begin(), it));
+        _statistics.nFreed += nFreed;
+        _statistics.retainedBytes -= nFreed * sizeClass;
+        entries.erase(entries.begin(), it);
+    }
+}
+
+void BufferPool::shrinkLocked(size_t bytes) {
+    while (_statistics.retainedBytes > bytes) {
+        // Free the least recently released buffer of all size classes
+        auto oldest = _buffers.end();
+        for (auto it = _buffers.begin(); it != _buffers.end(); it++) {
+            if (it->second.empty()) {
+                continue;
+            }
+            if (oldest == _buffers.end() ||
+                it->second.front().releaseTime < oldest->second.front().releaseTime)
+            {
+                oldest = it;
+            }
+        }
+
+        oldest->second.erase(oldest->second.begin());
+        _statistics.nFreed++;
+        _statistics.retainedBytes -= oldest->first;
+    }
+}
+
+} // namespace sgct
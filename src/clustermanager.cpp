@@ -63,7 +63,15 @@ void ClusterManager::destroy() {
 ClusterManager::ClusterManager(const config::Cluster& cluster, int clusterID)
     : _thisNodeId(clusterID)
     , _firmFrameLockSync(cluster.firmSync.value_or(false))
+    , _maxFrameLag(cluster.maxFrameLag)
+    , _transferWindow(cluster.transferWindow)
+    , _transferBufferLimit(cluster.transferBufferLimit)
+    , _transferBandwidth(cluster.transferBandwidth)
+    , _transferBackoffThreshold(cluster.transferBackoffThreshold)
+    , _syncDscp(cluster.syncDscp)
+    , _transferCache(cluster.transferCache)
     , _masterAddress(cluster.masterAddress)
+    , _multicast(cluster.multicast)
 {
     ZoneScoped;
 
@@ -137,6 +145,10 @@ void ClusterManager::setUseIgnoreSync(bool state) {
     _ignoreSync = state;
 }
 
+const std::optional<config::Multicast>& ClusterManager::multicast() const {
+    return _multicast;
+}
+
 const std::string& ClusterManager::masterAddress() const {
     return _masterAddress;
 }
@@ -161,4 +173,32 @@ bool ClusterManager::firmFrameLockSyncStatus() const {
     return _firmFrameLockSync;
 }
 
+std::optional<int> ClusterManager::maxFrameLag() const {
+    return _maxFrameLag;
+}
+
+std::optional<int> ClusterManager::transferWindow() const {
+    return _transferWindow;
+}
+
+std::optional<int> ClusterManager::transferBufferLimit() const {
+    return _transferBufferLimit;
+}
+
+std::optional<float> ClusterManager::transferBandwidth() const {
+    return _transferBandwidth;
+}
+
+std::optional<float> ClusterManager::transferBackoffThreshold() const {
+    return _transferBackoffThreshold;
+}
+
+std::optional<int> ClusterManager::syncDscp() const {
+    return _syncDscp;
+}
+
+std::optional<std::filesystem::path> ClusterManager::transferCache() const {
+    return _transferCache;
+}
+
 } // namespace sgct
@@ -8,6 +8,8 @@
 
 #include <sgct/commandline.h>
 
+#include <sgct/config.h>
+#include <algorithm>
 #include <iostream>
 #include <string_view>
 
@@ -62,10 +64,22 @@ Configuration parseArguments(std::vector<std::string>& arg) {
             config.firmSync = false;
             arg.erase(arg.begin() + i);
         }
+        else if (arg[i] == "--max-frame-lag" && arg.size() > (i + 1)) {
+            config.maxFrameLag = std::clamp(
+                std::stoi(arg[i + 1]),
+                0,
+                config::Cluster::MaxFrameLagLimit
+            );
+            arg.erase(arg.begin() + i, arg.begin() + i + 2);
+        }
         else if (arg[i] == "--ignore-sync") {
             config.ignoreSync = true;
             arg.erase(arg.begin() + i);
         }
+        else if (arg[i] == "--sync-spin" && arg.size() > (i + 1)) {
+            config.syncSpinTime = std::max(std::stoi(arg[i + 1]), 0);
+            arg.erase(arg.begin() + i, arg.begin() + i + 2);
+        }
         else if (arg[i] == "--number-capture-threads" && arg.size() > (i + 1)) {
             config.nCaptureThreads = std::max(std::stoi(arg[i + 1]), 1);
             arg.erase(arg.begin() + i, arg.begin() + i + 2);
@@ -94,6 +108,18 @@ Configuration parseArguments(std::vector<std::string>& arg) {
             config.waitTimeout = std::stof(arg[i + 1]);
             arg.erase(arg.begin() + 1, arg.begin() + i + 2);
         }
+        else if (arg[i] == "--record" && arg.size() > (i + 1)) {
+            config.recordPath = arg[i + 1];
+            arg.erase(arg.begin() + i, arg.begin() + i + 2);
+        }
+        else if (arg[i] == "--replay" && arg.size() > (i + 1)) {
+            config.replayPath = arg[i + 1];
+            arg.erase(arg.begin() + i, arg.begin() + i + 2);
+        }
+        else if (arg[i] == "--replay-max-rate") {
+            config.replayAtMaximumRate = true;
+            arg.erase(arg.begin() + i);
+        }
         else {
             // Ignore unknown commands
             i++;
@@ -120,8 +146,15 @@ Parameters:
     Enable firm frame sync
 --loose-sync
     Disable firm frame sync
+--max-frame-lag <integer>
+    Let the server run up to this many frames ahead of the slowest client, while the
+    clients render the newest frame they received. 0 is the same as firm frame sync
+    and values above 64 are reduced to 64
 --ignore-sync
     Disable frame sync
+--sync-spin <integer>
+    Busy-wait for this many microseconds for the other nodes at the frame lock before
+    sleeping, which reduces the latency of frames that are shorter than a millisecond
 --notify <"error", "warning", "info", or "debug">
     Set the notify level used in the Log
 --capture-jpg
@@ -140,6 +173,14 @@ Parameters:
     If set, screenshots will not contain the name of the window if multiple windows exist
 --number-capture-threads <integer>
     Set the maximum amount of thread that should be used during framecapture
+--record <filename>
+    Records the shared data that the server sends to the clients into the file
+--replay <filename>
+    Replays the shared data from a file created with --record instead of calling the
+    encode callback. This should be used with a single node, for example with
+    --local 0 and a configuration that only contains one node
+--replay-max-rate
+    Replays the shared data as fast as possible instead of with the recorded timing
 )";
 }
 
@@ -333,6 +333,27 @@ void validateNode(const Node& n) {
     }
 }
 
+void validateMulticast(const Multicast& m) {
+    if (m.address.empty()) {
+        throw Err(1130, "Multicast address must not be empty");
+    }
+    if (m.port <= 0) {
+        throw Err(1131, "Multicast port must be a positive number");
+    }
+    if (m.interfaceAddress && m.interfaceAddress->empty()) {
+        throw Err(1132, "Multicast interface address must not be empty");
+    }
+    if (m.datagramSize && (*m.datagramSize < 64 || *m.datagramSize > 65507)) {
+        throw Err(1133, "Multicast datagram size must be between 64 and 65507");
+    }
+    if (m.ttl && (*m.ttl < 0 || *m.ttl > 255)) {
+        throw Err(1134, "Multicast time-to-live must be between 0 and 255");
+    }
+    if (m.timeout && *m.timeout <= 0) {
+        throw Err(1135, "Multicast timeout must be a positive number");
+    }
+}
+
 void validateCluster(const Cluster& c) {
     if (c.masterAddress.empty()) {
         throw Err(1120, "Cluster master address must not be empty");
@@ -346,6 +367,9 @@ void validateCluster(const Cluster& c) {
     if (c.settings) {
         validateSettings(*c.settings);
     }
+    if (c.multicast) {
+        validateMulticast(*c.multicast);
+    }
 
     if (c.users.empty()) {
         throw Err(1122, "There must be at least one user in the cluster");
@@ -439,6 +463,28 @@ void validateCluster(const Cluster& c) {
         throw Err(1127, "Configuration must contain at least one node");
     }
     std::for_each(c.nodes.cbegin(), c.nodes.cend(), validateNode);
+
+    const int nNodes = static_cast<int>(c.nodes.size());
+    for (int i = 0; i < nNodes; i++) {
+        const std::optional<int>& parent = c.nodes[i].parent;
+        if (parent && (*parent < 0 || *parent >= nNodes || *parent == i)) {
+            throw Err(1136, "Node parent must be the index of another node");
+        }
+        if (parent && c.multicast) {
+            throw Err(1137, "Node parents can not be used together with multicast");
+        }
+    }
+    for (int i = 0; i < nNodes; i++) {
+        // Following the parents from any node has to end at a node without a parent
+        // after at most as many steps as there are nodes
+        int node = i;
+        for (int step = 0; c.nodes[node].parent; step++) {
+            if (step == nNodes) {
+                throw Err(1138, "Node parents must not form a cycle");
+            }
+            node = *c.nodes[node].parent;
+        }
+    }
 }
 
 void validateGeneratorVersion(const GeneratorVersion&) {}
@@ -1862,6 +1908,7 @@ static void from_json(const nlohmann::json& j, Node& n) {
 
     parseValue(j, "datatransferport", n.dataTransferPort);
     parseValue(j, "swaplock", n.swapLock);
+    parseValue(j, "parent", n.parent);
 
     parseValue(j, "windows", n.windows);
     if (n.windows.size() > std::numeric_limits<int8_t>::max()) {
@@ -1886,6 +1933,10 @@ static void to_json(nlohmann::json& j, const Node& n) {
         j["swaplock"] = *n.swapLock;
     }
 
+    if (n.parent.has_value()) {
+        j["parent"] = *n.parent;
+    }
+
     if (!n.windows.empty()) {
         j["windows"] = n.windows;
     }
@@ -1929,6 +1980,48 @@ static void to_json(nlohmann::json& j, const Meta& m) {
     }
 }
 
+static void from_json(const nlohmann::json& j, Multicast& m) {
+    if (auto it = j.find("address");  it != j.end()) {
+        it->get_to(m.address);
+    }
+    else {
+        throw Err(6090, "Missing field address in multicast");
+    }
+
+    if (auto it = j.find("port");  it != j.end()) {
+        it->get_to(m.port);
+    }
+    else {
+        throw Err(6091, "Missing field port in multicast");
+    }
+
+    parseValue(j, "interface", m.interfaceAddress);
+    parseValue(j, "datagramsize", m.datagramSize);
+    parseValue(j, "ttl", m.ttl);
+    parseValue(j, "timeout", m.timeout);
+}
+
+static void to_json(nlohmann::json& j, const Multicast& m) {
+    j["address"] = m.address;
+    j["port"] = m.port;
+
+    if (m.interfaceAddress.has_value()) {
+        j["interface"] = *m.interfaceAddress;
+    }
+
+    if (m.datagramSize.has_value()) {
+        j["datagramsize"] = *m.datagramSize;
+    }
+
+    if (m.ttl.has_value()) {
+        j["ttl"] = *m.ttl;
+    }
+
+    if (m.timeout.has_value()) {
+        j["timeout"] = *m.timeout;
+    }
+}
+
 static void from_json(const nlohmann::json& j, Cluster& c) {
     if (auto it = j.find("masteraddress");  it != j.end()) {
         it->get_to(c.masterAddress);
@@ -1945,11 +2038,47 @@ static void from_json(const nlohmann::json& j, Cluster& c) {
         throw Err(6088, "Thread Affinity must be 0 or positive");
     }
     parseValue(j, "firmsync", c.firmSync);
+    parseValue(j, "maxframelag", c.maxFrameLag);
+    if (c.maxFrameLag &&
+        (*c.maxFrameLag < 0 || *c.maxFrameLag > Cluster::MaxFrameLagLimit))
+    {
+        throw Err(
+            6092,
+            std::format(
+                "Maximum frame lag must be between 0 and {}", Cluster::MaxFrameLagLimit
+            )
+        );
+    }
+    parseValue(j, "transferwindow", c.transferWindow);
+    if (c.transferWindow && *c.transferWindow < 1) {
+        throw Err(6094, "Transfer window must be positive");
+    }
+    parseValue(j, "transferbufferlimit", c.transferBufferLimit);
+    if (c.transferBufferLimit && *c.transferBufferLimit < 0) {
+        throw Err(6093, "Transfer buffer limit must be 0 or positive");
+    }
+    parseValue(j, "transferbandwidth", c.transferBandwidth);
+    if (c.transferBandwidth && *c.transferBandwidth <= 0.f) {
+        throw Err(6095, "Transfer bandwidth must be positive");
+    }
+    parseValue(j, "transferbackoffthreshold", c.transferBackoffThreshold);
+    if (c.transferBackoffThreshold && *c.transferBackoffThreshold <= 0.f) {
+        throw Err(6096, "Transfer backoff threshold must be positive");
+    }
+    parseValue(j, "syncdscp", c.syncDscp);
+    if (c.syncDscp && (*c.syncDscp < 0 || *c.syncDscp > 63)) {
+        throw Err(6097, "Sync DSCP must be between 0 and 63");
+    }
+    parseValue(j, "transfercache", c.transferCache);
+    if (c.transferCache && c.transferCache->empty()) {
+        throw Err(6098, "Transfer cache must not be empty");
+    }
 
     parseValue(j, "scene", c.scene);
     parseValue(j, "users", c.users);
     parseValue(j, "settings", c.settings);
     parseValue(j, "capture", c.capture);
+    parseValue(j, "multicast", c.multicast);
 
     parseValue(j, "trackers", c.trackers);
     parseValue(j, "nodes", c.nodes);
@@ -1973,6 +2102,34 @@ static void to_json(nlohmann::json& j, const Cluster& c) {
         j["firmsync"] = *c.firmSync;
     }
 
+    if (c.maxFrameLag.has_value()) {
+        j["maxframelag"] = *c.maxFrameLag;
+    }
+
+    if (c.transferWindow.has_value()) {
+        j["transferwindow"] = *c.transferWindow;
+    }
+
+    if (c.transferBufferLimit.has_value()) {
+        j["transferbufferlimit"] = *c.transferBufferLimit;
+    }
+
+    if (c.transferBandwidth.has_value()) {
+        j["transferbandwidth"] = *c.transferBandwidth;
+    }
+
+    if (c.transferBackoffThreshold.has_value()) {
+        j["transferbackoffthreshold"] = *c.transferBackoffThreshold;
+    }
+
+    if (c.syncDscp.has_value()) {
+        j["syncdscp"] = *c.syncDscp;
+    }
+
+    if (c.transferCache.has_value()) {
+        j["transfercache"] = *c.transferCache;
+    }
+
     if (c.scene.has_value()) {
         j["scene"] = *c.scene;
     }
@@ -1989,6 +2146,10 @@ static void to_json(nlohmann::json& j, const Cluster& c) {
         j["capture"] = *c.capture;
     }
 
+    if (c.multicast.has_value()) {
+        j["multicast"] = *c.multicast;
+    }
+
     if (!c.trackers.empty()) {
         j["trackers"] = c.trackers;
     }
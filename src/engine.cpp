@@ -20,6 +20,7 @@
 #include <sgct/shadermanager.h>
 #include <sgct/shareddata.h>
 #include <sgct/statisticsrenderer.h>
+#include <sgct/syncrecording.h>
 #include <sgct/texturemanager.h>
 #ifdef SGCT_HAS_VRPN
 #include <sgct/trackingmanager.h>
@@ -29,7 +30,6 @@
 #include <iostream>
 #include <iterator>
 #include <numeric>
-#include <mutex>
 #include <stdexcept>
 
 #ifdef WIN32
@@ -51,12 +51,10 @@
 namespace sgct {
 
 namespace {
-    constexpr bool RunFrameLockCheckThread = true;
+    // The render thread wakes up at least this often while waiting for the other nodes
+    // in order to print the waiting message
     constexpr std::chrono::milliseconds FrameLockTimeout(100);
 
-    bool sRunUpdateFrameLockLoop = true;
-    std::mutex FrameSync;
-
     // Callback wrappers for GLFW
     std::function<void(Key, Modifier, Action, int, Window*)> gKeyboardCallback = nullptr;
     std::function<void(unsigned int, int, Window*)> gCharCallback = nullptr;
@@ -66,20 +64,6 @@ namespace {
     std::function<void(double, double, Window*)> gMouseScrollCallback = nullptr;
     std::function<void(std::vector<std::string_view>)> gDropCallback = nullptr;
 
-    // For feedback: Breaks a frame lock wait condition every time interval
-    // (FrameLockTimeout) in order to print waiting message.
-    void updateFrameLockLoop(void*) {
-        bool run = true;
-
-        while (run) {
-            FrameSync.lock();
-            run = sRunUpdateFrameLockLoop;
-            FrameSync.unlock();
-            NetworkManager::cond.notify_all();
-            std::this_thread::sleep_for(FrameLockTimeout);
-        }
-    }
-
     void addValue(std::array<double, Engine::Statistics::HistoryLength>& a, double v) {
         std::rotate(std::rbegin(a), std::rbegin(a) + 1, std::rend(a));
         a[0] = v;
@@ -93,6 +77,7 @@ namespace {
             config.nCaptureThreads.value_or(res.capture.nCaptureThreads);
         res.createDebugContext =
             config.useOpenGLDebugContext.value_or(res.createDebugContext);
+        res.syncSpinTime = config.syncSpinTime.value_or(res.syncSpinTime);
         res.capture.capturePath = config.screenshotPath.value_or(res.capture.capturePath);
         res.capture.prefix = config.screenshotPrefix.value_or(res.capture.prefix);
         res.capture.addNodeName =
@@ -241,8 +226,18 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
 {
     ZoneScoped;
 
-    SharedData::instance().setEncodeFunction(std::move(callbacks.encode));
-    SharedData::instance().setDecodeFunction(std::move(callbacks.decode));
+    if (callbacks.encodeInto) {
+        SharedData::instance().setEncodeFunction(std::move(callbacks.encodeInto));
+    }
+    else {
+        SharedData::instance().setEncodeFunction(std::move(callbacks.encode));
+    }
+    if (callbacks.decodeView) {
+        SharedData::instance().setDecodeViewFunction(std::move(callbacks.decodeView));
+    }
+    else {
+        SharedData::instance().setDecodeFunction(std::move(callbacks.decode));
+    }
 
     gKeyboardCallback = std::move(callbacks.keyboard);
     gCharCallback = std::move(callbacks.character);
@@ -268,6 +263,9 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
     if (config.firmSync) {
         cluster.firmSync = config.firmSync;
     }
+    if (config.maxFrameLag) {
+        cluster.maxFrameLag = config.maxFrameLag;
+    }
 
     if (cluster.threadAffinity) {
 #ifdef WIN32
@@ -276,6 +274,23 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
         Log::Error("Using thread affinity on an operating system that is not supported");
 #endif // WIN32
     }
+
+    Log::Info(std::format("SGCT version: {}", Version));
+
+    Log::Debug("Validating cluster configuration");
+    config::validateCluster(cluster);
+
+    // The NetworkManager looks up the addresses of this computer in the background while
+    // GLFW is initialized
+    NetworkManager::create(
+        netMode,
+        std::move(callbacks.dataTransferDecode),
+        std::move(callbacks.dataTransferStatus),
+        std::move(callbacks.dataTransferAcknowledge),
+        std::move(callbacks.dataTransferChunk),
+        std::move(callbacks.dataTransferProgress)
+    );
+
     {
         ZoneScopedN("GLFW initialization");
 
@@ -286,21 +301,10 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
         );
         const int res = glfwInit();
         if (res == GLFW_FALSE) {
+            NetworkManager::destroy();
             throw Err(3000, "Failed to initialize GLFW");
         }
     }
-
-    Log::Info(std::format("SGCT version: {}", Version));
-
-    Log::Debug("Validating cluster configuration");
-    config::validateCluster(cluster);
-
-    NetworkManager::create(
-        netMode,
-        std::move(callbacks.dataTransferDecode),
-        std::move(callbacks.dataTransferStatus),
-        std::move(callbacks.dataTransferAcknowledge)
-    );
 #ifdef SGCT_HAS_VRPN
     for (const config::Tracker& tracker : cluster.trackers) {
         TrackingManager::instance().applyTracker(tracker);
@@ -346,6 +350,16 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
     }
 
     NetworkManager::instance().initialize();
+
+    if (config.recordPath) {
+        NetworkManager::instance().startRecording(*config.recordPath);
+    }
+    if (config.replayPath) {
+        _replayer = std::make_unique<SyncReplayer>(
+            *config.replayPath,
+            !config.replayAtMaximumRate.value_or(false)
+        );
+    }
 }
 
 void Engine::initialize() {
@@ -417,10 +431,6 @@ void Engine::initialize() {
     glClearColor(0.f, 0.f, 0.f, 0.f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    if (RunFrameLockCheckThread && ClusterManager::instance().numberOfNodes() > 1) {
-        _thread = std::make_unique<std::thread>(updateFrameLockLoop, nullptr);
-    }
-
     // Window resolution may have been set by the config. However, it only sets a pending
     // resolution, so it needs to apply it using the same routine as in the end of a frame
     const std::vector<std::unique_ptr<Window>>& wins = thisNode.windows();
@@ -599,19 +609,6 @@ Engine::~Engine() {
     gMouseScrollCallback = nullptr;
     gDropCallback = nullptr;
 
-    // kill thread
-    if (_thread) {
-        Log::Debug("Waiting for frameLock thread to finish");
-
-        FrameSync.lock();
-        sRunUpdateFrameLockLoop = false;
-        FrameSync.unlock();
-
-        _thread->join();
-        _thread = nullptr;
-        Log::Debug("Done");
-    }
-
     // Deinit window and unbind swapgroups
     // There might not be any thisNode as its creation might have failed
     if (hasNode) {
@@ -677,6 +674,12 @@ void Engine::frameLockPreStage() {
     if (minMax) {
         addValue(_statistics.loopTimeMin, minMax->first);
         addValue(_statistics.loopTimeMax, minMax->second);
+
+        const std::vector<double>& sendTimes = nm.sendTimes();
+        _statistics.sendTimes.resize(sendTimes.size());
+        for (size_t i = 0; i < sendTimes.size(); i++) {
+            addValue(_statistics.sendTimes[i], sendTimes[i]);
+        }
     }
     if (nm.isComputerServer()) {
         addValue(_statistics.syncTimes, static_cast<float>(glfwGetTime() - ts));
@@ -688,10 +691,10 @@ void Engine::frameLockPreStage() {
     }
 
     // Not server
+    const std::chrono::microseconds spin(_settings.syncSpinTime);
     const double t0 = glfwGetTime();
     while (nm.isRunning() && !nm.isSyncComplete()) {
-        std::unique_lock lock(FrameSync);
-        NetworkManager::cond.wait(lock);
+        nm.waitForSync(FrameLockTimeout, spin);
 
         if (glfwGetTime() - t0 <= 1.0) {
             continue;
@@ -729,16 +732,16 @@ void Engine::frameLockPreStage() {
 void Engine::frameLockPostStage() {
     ZoneScoped;
 
-    const NetworkManager& nm = NetworkManager::instance();
+    NetworkManager& nm = NetworkManager::instance();
     // Post stage
     if (ClusterManager::instance().ignoreSync() || !nm.isComputerServer()) {
         return;
     }
 
+    const std::chrono::microseconds spin(_settings.syncSpinTime);
     const double t0 = glfwGetTime();
     while (nm.isRunning() && nm.activeConnectionsCount() > 0 && !nm.isSyncComplete()) {
-        std::unique_lock lock(FrameSync);
-        NetworkManager::cond.wait(lock);
+        nm.waitForSync(FrameLockTimeout, spin);
 
         if (glfwGetTime() - t0 <= 1.0) {
             continue;
@@ -800,7 +803,13 @@ void Engine::exec() {
             _preSyncFn();
         }
 
-        if (NetworkManager::instance().isComputerServer()) {
+        if (_replayer) {
+            if (!_replayer->decodeNextFrame()) {
+                Log::Info("Finished replaying the recording");
+                break;
+            }
+        }
+        else if (NetworkManager::instance().isComputerServer()) {
             SharedData::instance().encode();
         }
         else if (!NetworkManager::instance().isRunning()) {
@@ -988,7 +997,10 @@ void Engine::waitForAllWindowsInSwapGroupToOpen() {
             break;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // The NetworkManager notifies the condition as soon as all nodes are connected,
+        // but the windows are still updated regularly while waiting
+        constexpr std::chrono::milliseconds UpdateInterval(100);
+        NetworkManager::instance().waitForAllNodesConnected(UpdateInterval);
     }
 }
 
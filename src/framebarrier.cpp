@@ -0,0 +1,128 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/framebarrier.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <unistd.h>
+#endif // __linux__
+
+#include <algorithm>
+
+namespace {
+#ifdef __linux__
+    // The futex system call operates on the plain 32 bit integer inside of the atomic
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    void futexWait(std::atomic<uint32_t>& word, uint32_t value,
+                   std::chrono::nanoseconds timeout)
+    {
+        using namespace std::chrono;
+        const seconds s = duration_cast<seconds>(timeout);
+        timespec ts = {
+            .tv_sec = static_cast<time_t>(s.count()),
+            .tv_nsec = static_cast<long>((timeout - s).count())
+        };
+        // Returns immediately if the word no longer contains `value`, so that a wake-up
+        // between checking the word and going to sleep is not lost
+        syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, value, &ts, nullptr, 0);
+    }
+
+    void futexWakeOne(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+#endif // __linux__
+} // namespace
+
+namespace sgct {
+
+void FrameBarrier::reset(int nArrivals) {
+    _nArrivals = 0;
+    _nExpected = nArrivals;
+}
+
+void FrameBarrier::arrive() {
+    const int nArrivals = _nArrivals.fetch_add(1) + 1;
+    if (nArrivals >= _nExpected.load()) {
+        release();
+    }
+}
+
+void FrameBarrier::drop() {
+    const int nExpected = _nExpected.fetch_sub(1) - 1;
+    if (_nArrivals.load() >= nExpected) {
+        release();
+    }
+}
+
+void FrameBarrier::release() {
+    // Either the waiting thread sees the new generation before it goes to sleep or this
+    // thread sees that it is sleeping, as both sides are sequentially consistent
+    _generation.fetch_add(1);
+    if (!_isSleeping.load()) {
+        return;
+    }
+
+#ifdef __linux__
+    futexWakeOne(_generation);
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    // Taking the mutex ensures that the waiting thread is inside `wait_until`
+    const std::unique_lock lock(_mutex);
+    _cond.notify_one();
+#endif // __linux__
+}
+
+bool FrameBarrier::wait(std::chrono::nanoseconds timeout, std::chrono::nanoseconds spin)
+{
+    using namespace std::chrono;
+
+    auto isReleased = [this]() {
+        const uint32_t generation = _generation.load();
+        if (generation == _seenGeneration) {
+            return false;
+        }
+        _seenGeneration = generation;
+        return true;
+    };
+
+    const steady_clock::time_point start = steady_clock::now();
+    const steady_clock::time_point end = start + timeout;
+    const steady_clock::time_point spinEnd = start + std::min(spin, timeout);
+    do {
+        if (isReleased()) {
+            return true;
+        }
+    } while (steady_clock::now() < spinEnd);
+
+#ifdef __linux__
+    _isSleeping = true;
+    bool isTimedOut = false;
+    while (!isReleased()) {
+        const nanoseconds remaining = end - steady_clock::now();
+        if (remaining <= nanoseconds(0)) {
+            isTimedOut = true;
+            break;
+        }
+        futexWait(_generation, _seenGeneration, remaining);
+    }
+    _isSleeping = false;
+    return !isTimedOut;
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    std::unique_lock lock(_mutex);
+    _isSleeping = true;
+    const bool isReleasedInTime = _cond.wait_until(lock, end, isReleased);
+    _isSleeping = false;
+    return isReleasedInTime;
+#endif // __linux__
+}
+
+} // namespace sgct
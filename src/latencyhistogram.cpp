@@ -0,0 +1,99 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/latencyhistogram.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    int bucketIndex(double seconds) {
+        using sgct::LatencyHistogram;
+
+        if (seconds < LatencyHistogram::MinDuration) {
+            return 0;
+        }
+        const double exponent = std::log(seconds / LatencyHistogram::MinDuration) /
+            std::log(LatencyHistogram::BucketRatio);
+        return std::min(
+            1 + static_cast<int>(exponent),
+            LatencyHistogram::NumberOfBuckets - 1
+        );
+    }
+} // namespace
+
+namespace sgct {
+
+void LatencyHistogram::add(double seconds) {
+    seconds = std::max(seconds, 0.0);
+
+    // There is only a single writer, so the extremes don't need to be compared atomically
+    if (_count == 0 || seconds < _min) {
+        _min = seconds;
+    }
+    if (_count == 0 || seconds > _max) {
+        _max = seconds;
+    }
+    _buckets[bucketIndex(seconds)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyHistogram::reset() {
+    _count = 0;
+    for (std::atomic<uint64_t>& bucket : _buckets) {
+        bucket = 0;
+    }
+    _min = 0.0;
+    _max = 0.0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return _count;
+}
+
+double LatencyHistogram::min() const {
+    return _min;
+}
+
+double LatencyHistogram::max() const {
+    return _max;
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+    const uint64_t count = _count.load(std::memory_order_acquire);
+    if (count == 0) {
+        return 0.0;
+    }
+
+    const uint64_t rank = std::clamp<uint64_t>(
+        static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * count)),
+        1,
+        count
+    );
+    uint64_t nBelow = 0;
+    for (int i = 0; i < NumberOfBuckets; i++) {
+        nBelow += _buckets[i].load(std::memory_order_relaxed);
+        if (nBelow < rank) {
+            continue;
+        }
+
+        // The geometric center of the bucket is at most half a bucket away from any
+        // duration in it, and the actual durations are never outside of the extremes.
+        // The last bucket contains all durations that are too long for the other ones
+        if (i == NumberOfBuckets - 1) {
+            return max();
+        }
+        const double center = i == 0 ?
+            0.0 :
+            MinDuration * std::pow(BucketRatio, i - 0.5);
+        return std::max(min(), std::min(center, max()));
+    }
+    return max();
+}
+
+} // namespace sgct
@@ -0,0 +1,517 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/multicast.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#include <winsock2.h>
+#include <ws2def.h>
+#include <ws2tcpip.h>
+#define SGCT_ERRNO WSAGetLastError()
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define SOCKET_ERROR (-1)
+#define INVALID_SOCKET (~0)
+#define SGCT_ERRNO errno
+#endif // WIN32
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
+
+namespace {
+    // Large socket buffers reduce the chance of dropping datagrams when a frame is sent
+    // in a quick burst. The operating system might limit this to a smaller value
+    constexpr int SocketBufferSize = 4 * 1024 * 1024;
+
+    // The number of incomplete frames that are kept before the oldest is discarded
+    constexpr size_t MaxIncompleteFrames = 16;
+
+    // The longest time after which the receiving thread checks whether it should
+    // terminate. It wakes up more often if that is necessary to notice a lost frame
+    constexpr std::chrono::milliseconds MaxReceiveTimeout =
+        std::chrono::milliseconds(100);
+
+    // The largest payload that fits into a UDP datagram
+    constexpr int MaxDatagramSize = 65507;
+
+    uint32_t parseAddress(const std::string& address) {
+        in_addr addr;
+        if (inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+            throw Err(
+                5033,
+                std::format("Invalid IPv4 address '{}' for multicast", address)
+            );
+        }
+        return addr.s_addr;
+    }
+
+    void closeSocket(SGCT_SOCKET socket) {
+#ifdef WIN32
+        closesocket(socket);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        close(socket);
+#endif // WIN32
+    }
+
+    // Creates a UDP socket on the loopback interface that is connected to itself, so that
+    // sending a datagram to it makes it readable. Unlike a pipe, it can be observed
+    // together with the sockets of the connections on all platforms
+    SGCT_SOCKET createNotification() {
+        SGCT_SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == INVALID_SOCKET) {
+            throw Err(
+                5035,
+                std::format("Failed to create multicast notification: {}", SGCT_ERRNO)
+            );
+        }
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t addrSize = sizeof(addr);
+        const bool isConnected =
+            bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            getsockname(s, reinterpret_cast<sockaddr*>(&addr), &addrSize) == 0 &&
+            connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (!isConnected) {
+            const int error = SGCT_ERRNO;
+            closeSocket(s);
+            throw Err(
+                5035,
+                std::format("Failed to create multicast notification: {}", error)
+            );
+        }
+
+#ifdef WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(s, FIONBIO, &nonBlocking);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+#endif // WIN32
+        return s;
+    }
+
+    template <typename T>
+    void setOption(SGCT_SOCKET socket, int level, int option, const T& value,
+                   std::string_view name)
+    {
+        const int res = setsockopt(
+            socket,
+            level,
+            option,
+            reinterpret_cast<const char*>(&value),
+            sizeof(T)
+        );
+        if (res == SOCKET_ERROR) {
+            closeSocket(socket);
+            throw Err(
+                5034,
+                std::format("Failed to set multicast option {}: {}", name, SGCT_ERRNO)
+            );
+        }
+    }
+} // namespace
+
+namespace sgct {
+
+MulticastSender::MulticastSender(const std::string& address, int port,
+                                 const std::string& interfaceAddress, int datagramSize,
+                                 int ttl)
+    : _socket(INVALID_SOCKET)
+    , _address(parseAddress(address))
+    , _port(static_cast<uint16_t>(port))
+    , _datagramSize(std::clamp(datagramSize, DatagramHeaderSize + 1, MaxDatagramSize))
+    , _history(HistorySize)
+{
+    // The receivers don't accept any datagrams before they know the session
+    std::random_device device;
+    while (_session == 0) {
+        _session = device();
+    }
+
+    if (!IN_MULTICAST(ntohl(_address))) {
+        throw Err(5033, std::format("Address '{}' is not a multicast address", address));
+    }
+
+    _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_socket == INVALID_SOCKET) {
+        throw Err(5035, std::format("Failed to create multicast socket: {}", SGCT_ERRNO));
+    }
+
+    const unsigned char timeToLive = static_cast<unsigned char>(std::clamp(ttl, 0, 255));
+    setOption(_socket, IPPROTO_IP, IP_MULTICAST_TTL, timeToLive, "time-to-live");
+
+    // Clients running on the same computer as the server also need to receive the frames
+    const unsigned char loop = 1;
+    setOption(_socket, IPPROTO_IP, IP_MULTICAST_LOOP, loop, "loopback");
+
+    if (!interfaceAddress.empty()) {
+        in_addr addr;
+        addr.s_addr = parseAddress(interfaceAddress);
+        setOption(_socket, IPPROTO_IP, IP_MULTICAST_IF, addr, "interface");
+    }
+
+    setOption(_socket, SOL_SOCKET, SO_SNDBUF, SocketBufferSize, "send buffer");
+
+    _datagram.resize(_datagramSize);
+}
+
+MulticastSender::~MulticastSender() {
+    closeSocket(_socket);
+}
+
+uint32_t MulticastSender::send(const void* data, int length) {
+    ZoneScoped;
+
+    const uint32_t frameSize = static_cast<uint32_t>(length);
+    const int payloadSize = _datagramSize - DatagramHeaderSize;
+    const int fragments = std::max((length + payloadSize - 1) / payloadSize, 1);
+    if (frameSize > MaxFrameSize || fragments > std::numeric_limits<uint16_t>::max()) {
+        throw Err(
+            5036,
+            std::format("Frame of {} bytes is too large to send via multicast", length)
+        );
+    }
+    const uint16_t nFragments = static_cast<uint16_t>(fragments);
+    _sequence++;
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = _address;
+    addr.sin_port = htons(_port);
+
+    _datagram[0] = Network::MulticastId;
+    std::memcpy(_datagram.data() + 1, &_sequence, sizeof(uint32_t));
+    std::memcpy(_datagram.data() + 5, &frameSize, sizeof(uint32_t));
+    std::memcpy(_datagram.data() + 11, &nFragments, sizeof(uint16_t));
+    std::memcpy(_datagram.data() + 13, &_session, sizeof(uint32_t));
+
+    const char* d = reinterpret_cast<const char*>(data);
+    for (uint16_t fragment = 0; fragment < nFragments; fragment++) {
+        const int offset = fragment * payloadSize;
+        const int size = std::min(payloadSize, length - offset);
+        std::memcpy(_datagram.data() + 9, &fragment, sizeof(uint16_t));
+        std::memcpy(_datagram.data() + DatagramHeaderSize, d + offset, size);
+
+        const long res = sendto(
+            _socket,
+            _datagram.data(),
+            DatagramHeaderSize + size,
+            0,
+            reinterpret_cast<const sockaddr*>(&addr),
+            sizeof(addr)
+        );
+        if (res == SOCKET_ERROR) {
+            throw Err(5037, std::format("Failed to send multicast data: {}", SGCT_ERRNO));
+        }
+    }
+
+    {
+        const std::unique_lock lock(_historyMutex);
+        Frame& f = _history[_sequence % HistorySize];
+        f.sequence = _sequence;
+        f.data.assign(d, d + length);
+    }
+
+    return _sequence;
+}
+
+std::vector<char> MulticastSender::frame(uint32_t sequence) const {
+    const std::unique_lock lock(_historyMutex);
+    const Frame& f = _history[sequence % HistorySize];
+    return f.sequence == sequence ? f.data : std::vector<char>();
+}
+
+uint32_t MulticastSender::session() const {
+    return _session;
+}
+
+
+MulticastReceiver::MulticastReceiver(const std::string& address, int port,
+                                     const std::string& interfaceAddress,
+                                     std::chrono::milliseconds timeout)
+    : _socket(INVALID_SOCKET)
+    , _notification(INVALID_SOCKET)
+    , _timeout(timeout)
+{
+    ip_mreq request;
+    std::memset(&request, 0, sizeof(request));
+    request.imr_multiaddr.s_addr = parseAddress(address);
+    request.imr_interface.s_addr =
+        interfaceAddress.empty() ? htonl(INADDR_ANY) : parseAddress(interfaceAddress);
+
+    _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_socket == INVALID_SOCKET) {
+        throw Err(5035, std::format("Failed to create multicast socket: {}", SGCT_ERRNO));
+    }
+
+    // Multiple clients on the same computer have to be able to share the port
+    const int reuse = 1;
+    setOption(_socket, SOL_SOCKET, SO_REUSEADDR, reuse, "reuse address");
+    setOption(_socket, SOL_SOCKET, SO_RCVBUF, SocketBufferSize, "receive buffer");
+
+    // The receiving thread reports a lost frame, so it has to wake up several times
+    // within the timeout even if no datagrams arrive
+    const std::chrono::milliseconds wakeup = std::clamp(
+        timeout / 4,
+        std::chrono::milliseconds(1),
+        MaxReceiveTimeout
+    );
+#ifdef WIN32
+    const DWORD receiveTimeout = static_cast<DWORD>(wakeup.count());
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    timeval receiveTimeout = { 0, static_cast<suseconds_t>(wakeup.count() * 1000) };
+#endif // WIN32
+    setOption(_socket, SOL_SOCKET, SO_RCVTIMEO, receiveTimeout, "receive timeout");
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    const int bindRes =
+        bind(_socket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    if (bindRes == SOCKET_ERROR) {
+        closeSocket(_socket);
+        throw Err(5038, std::format("Failed to bind multicast port {}", port));
+    }
+
+    setOption(_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, request, "membership");
+
+    try {
+        _notification = createNotification();
+    }
+    catch (const Error&) {
+        closeSocket(_socket);
+        throw;
+    }
+
+    _lastDatagramTime = std::chrono::steady_clock::now();
+    _thread = std::thread([this]() { receiveLoop(); });
+}
+
+MulticastReceiver::~MulticastReceiver() {
+    _shouldTerminate = true;
+    _thread.join();
+    closeSocket(_socket);
+    closeSocket(_notification);
+}
+
+void MulticastReceiver::setSession(uint32_t session) {
+    const std::unique_lock lock(_mutex);
+    if (session == _session) {
+        return;
+    }
+
+    // The sequence numbers of a different sender start over
+    _session = session;
+    _frames.clear();
+    _lastSequence = 0;
+}
+
+MulticastReceiver::FrameStatus
+MulticastReceiver::takeFrame(uint32_t sequence, std::vector<char>& frame) {
+    ZoneScoped;
+
+    const std::unique_lock lock(_mutex);
+    return takeFrameLocked(sequence, frame);
+}
+
+bool MulticastReceiver::receiveFrame(uint32_t sequence, std::vector<char>& frame) {
+    ZoneScoped;
+
+    std::unique_lock lock(_mutex);
+    while (true) {
+        const FrameStatus status = takeFrameLocked(sequence, frame);
+        if (status != FrameStatus::Pending) {
+            return status == FrameStatus::Received;
+        }
+        _cond.wait_for(lock, _timeout);
+    }
+}
+
+SGCT_SOCKET MulticastReceiver::notification() const {
+    return _notification;
+}
+
+void MulticastReceiver::clearNotification() {
+    char buffer[16];
+    while (recv(_notification, buffer, sizeof(buffer), 0) > 0) {}
+}
+
+MulticastReceiver::FrameStatus
+MulticastReceiver::takeFrameLocked(uint32_t sequence, std::vector<char>& frame) {
+    // The notification about a frame might arrive before its datagrams have been
+    // processed, so we have to wait at least the timeout before giving up on a frame
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (sequence != _awaitedSequence) {
+        _awaitedSequence = sequence;
+        _awaitStart = now;
+        _isAwaitedNotified = false;
+    }
+
+    auto it = _frames.find(sequence);
+    const bool isComplete = it != _frames.end() && it->second.nMissingFragments == 0;
+    const bool isDiscarded = it == _frames.end() && sequence <= _lastSequence;
+    const bool isLost = isDiscarded ||
+        now - std::max(_awaitStart, _lastDatagramTime) > _timeout;
+    if (!isComplete && !isLost) {
+        return FrameStatus::Pending;
+    }
+
+    if (isComplete) {
+        frame = std::move(it->second.data);
+    }
+    _frames.erase(_frames.begin(), _frames.upper_bound(sequence));
+    _lastSequence = std::max(_lastSequence, sequence);
+    _awaitedSequence = 0;
+    return isComplete ? FrameStatus::Received : FrameStatus::Lost;
+}
+
+void MulticastReceiver::notifyLocked() {
+    if (_awaitedSequence == 0 || _isAwaitedNotified) {
+        return;
+    }
+
+    const auto it = _frames.find(_awaitedSequence);
+    const bool isComplete = it != _frames.end() && it->second.nMissingFragments == 0;
+    const bool isLost = std::chrono::steady_clock::now() -
+        std::max(_awaitStart, _lastDatagramTime) > _timeout;
+    if (!isComplete && !isLost) {
+        return;
+    }
+
+    // The datagram only has to make the socket readable, a failure means that it is
+    // readable already
+    const char signal = 1;
+    send(_notification, &signal, sizeof(signal), 0);
+    _isAwaitedNotified = true;
+}
+
+void MulticastReceiver::receiveLoop() {
+    std::vector<char> datagram(MaxDatagramSize);
+    while (!_shouldTerminate) {
+        const long res = recv(_socket, datagram.data(), MaxDatagramSize, 0);
+        if (res > 0) {
+            handleDatagram(datagram.data(), static_cast<int>(res));
+        }
+
+        // A frame can only be considered lost while no datagrams arrive, which is when
+        // `recv` times out
+        const std::unique_lock lock(_mutex);
+        notifyLocked();
+    }
+}
+
+void MulticastReceiver::handleDatagram(const char* datagram, int length) {
+    if (length < MulticastSender::DatagramHeaderSize ||
+        datagram[0] != Network::MulticastId)
+    {
+        return;
+    }
+
+    uint32_t sequence = 0;
+    std::memcpy(&sequence, datagram + 1, sizeof(uint32_t));
+    uint32_t frameSize = 0;
+    std::memcpy(&frameSize, datagram + 5, sizeof(uint32_t));
+    uint16_t fragment = 0;
+    std::memcpy(&fragment, datagram + 9, sizeof(uint16_t));
+    uint16_t nFragments = 0;
+    std::memcpy(&nFragments, datagram + 11, sizeof(uint16_t));
+    uint32_t session = 0;
+    std::memcpy(&session, datagram + 13, sizeof(uint32_t));
+    const size_t payloadSize = length - MulticastSender::DatagramHeaderSize;
+
+    // All fragments but the last are full, so the size of the frame has to fit to the
+    // number of fragments. This rejects malformed datagrams before the memory for the
+    // frame is reserved
+    const bool isLast = fragment + 1 == nFragments;
+    const uint64_t nFull = static_cast<uint64_t>(nFragments - 1) * payloadSize;
+    const bool isValid = fragment < nFragments &&
+        frameSize <= MulticastSender::MaxFrameSize && payloadSize <= frameSize &&
+        (isLast || (nFull < frameSize && nFull + payloadSize >= frameSize));
+    if (!isValid) {
+        return;
+    }
+
+    const std::unique_lock lock(_mutex);
+    if (session != _session) {
+        // Datagrams of another cluster must not keep a lost frame from being noticed
+        return;
+    }
+    _lastDatagramTime = std::chrono::steady_clock::now();
+    if (sequence <= _lastSequence) {
+        return;
+    }
+
+    auto it = _frames.find(sequence);
+    if (it == _frames.end()) {
+        if (_frames.size() >= MaxIncompleteFrames) {
+            if (_frames.begin()->first > sequence) {
+                return;
+            }
+            _frames.erase(_frames.begin());
+        }
+
+        Frame f;
+        f.data.resize(frameSize);
+        f.hasFragment.resize(nFragments, false);
+        f.nMissingFragments = nFragments;
+        it = _frames.emplace(sequence, std::move(f)).first;
+    }
+
+    Frame& frame = it->second;
+    if (frame.hasFragment.size() != nFragments || frame.data.size() != frameSize ||
+        frame.hasFragment[fragment])
+    {
+        return;
+    }
+
+    // All fragments but the last have the same size, which gives us the offset
+    const size_t offset = fragment == nFragments - 1 ?
+        frameSize - payloadSize :
+        fragment * payloadSize;
+    if (offset + payloadSize > frameSize) {
+        return;
+    }
+    std::memcpy(
+        frame.data.data() + offset,
+        datagram + MulticastSender::DatagramHeaderSize,
+        payloadSize
+    );
+    frame.hasFragment[fragment] = true;
+    frame.nMissingFragments--;
+
+    if (frame.nMissingFragments == 0) {
+        _cond.notify_all();
+        if (sequence == _awaitedSequence) {
+            notifyLocked();
+        }
+    }
+}
+
+} // namespace sgct
@@ -21,7 +21,10 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <cerrno>
+#include <fcntl.h>
 #include <netdb.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define SOCKET_ERROR (-1)
 #define INVALID_SOCKET (~0)
@@ -29,18 +32,27 @@
 #define SGCT_ERRNO errno
 #endif // WIN32
 
+#include <sgct/bandwidthlimiter.h>
 #include <sgct/clustermanager.h>
 #include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/format.h>
 #include <sgct/log.h>
+#include <sgct/multicast.h>
 #include <sgct/networkmanager.h>
+#include <sgct/networkreactor.h>
 #include <sgct/profiling.h>
 #include <sgct/shareddata.h>
+#include <sgct/sharedmemory.h>
+#include <sgct/transfercache.h>
+#include <zlib.h>
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -48,39 +60,184 @@
 #define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
 
 namespace {
-    constexpr int MaxNumberOfAttempts = 10;
-
     constexpr int MaxNetworkSyncFrameNumber = 10000;
 
-    int receiveData(SGCT_SOCKET lsocket, char* buffer, int length, int flags) {
-        long iResult = 0;
-        int attempts = 1;
+    // The number of sent frames whose send times are kept until they are acknowledged.
+    // With the largest frame lag, the server sends one more frame while the client lags
+    // behind by that many frames
+    constexpr size_t MaxInFlightFrames = sgct::config::Cluster::MaxFrameLagLimit + 1;
 
-        while (iResult < length) {
-            const long tmpRes = recv(lsocket, buffer + iResult, length - iResult, flags);
-            if (tmpRes > 0) {
-                iResult += tmpRes;
-            }
+    // The sockets stay blocking for sending, so they are read without blocking explicitly
+    // to not stall the reactor's thread. As the flag does not exist on Windows, only a
+    // single `recv` is done there every time that the socket becomes readable
+#ifdef WIN32
+    constexpr int ReceiveFlags = 0;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    constexpr int ReceiveFlags = MSG_DONTWAIT;
+#endif // WIN32
+
+    // Sending to a connection that the other side has closed already has to fail with an
+    // error instead of raising SIGPIPE, which would terminate the application. The flag
+    // only exists on Linux, the other POSIX platforms set SO_NOSIGPIPE on the socket
+#ifdef __linux__
+    constexpr int SendFlags = MSG_NOSIGNAL;
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    constexpr int SendFlags = 0;
+#endif // __linux__
+
+    bool wouldBlock(int error) {
+#ifdef WIN32
+        return error == WSAEWOULDBLOCK;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        return error == EAGAIN || error == EWOULDBLOCK;
+#endif // WIN32
+    }
+
+    bool isInterrupted(int error) {
+#ifdef WIN32
+        return error == WSAEINTR;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        return error == EINTR;
+#endif // WIN32
+    }
+
+    // The header of a chunk is followed by the offset of the chunk and the size of the
+    // whole transfer, which are sent together before the bytes of the chunk
+    std::array<char, sgct::Network::HeaderSize + sgct::Network::ChunkHeaderSize>
+    chunkHeader(int packageId, uint64_t offset, uint64_t totalSize, uint32_t size)
+    {
+        using namespace sgct;
+
+        std::array<char, Network::HeaderSize + Network::ChunkHeaderSize> header = {};
+        const uint32_t dataSize = Network::ChunkHeaderSize + size;
+        header[0] = Network::ChunkId;
+        std::memcpy(header.data() + 1, &packageId, sizeof(packageId));
+        std::memcpy(header.data() + 5, &dataSize, sizeof(dataSize));
+        std::memcpy(header.data() + Network::HeaderSize, &offset, sizeof(offset));
+        std::memcpy(
+            header.data() + Network::HeaderSize + sizeof(offset),
+            &totalSize,
+            sizeof(totalSize)
+        );
+        return header;
+    }
+
+    bool isRefused(int error) {
+#ifdef WIN32
+        return error == WSAECONNREFUSED;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        return error == ECONNREFUSED;
+#endif // WIN32
+    }
+
+    // A client retries to connect to the server with delays that start short, as the
+    // server is usually started at about the same time as the clients, and that double
+    // with every attempt up to the maximum
+    constexpr std::chrono::milliseconds MinConnectDelay = std::chrono::milliseconds(1);
+    constexpr std::chrono::milliseconds MaxConnectDelay = std::chrono::seconds(1);
+
+    // A connection attempt is abandoned after this time if the server's machine does not
+    // answer at all, and checks in shorter intervals whether it should stop early
+    constexpr std::chrono::milliseconds ConnectTimeout = std::chrono::seconds(1);
+    constexpr std::chrono::milliseconds ConnectPollInterval =
+        std::chrono::milliseconds(10);
+
+    void setNonBlocking(SGCT_SOCKET socket, bool isNonBlocking) {
+#ifdef WIN32
+        u_long mode = isNonBlocking ? 1 : 0;
+        ioctlsocket(socket, FIONBIO, &mode);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        const int flags = fcntl(socket, F_GETFL);
+        fcntl(socket, F_SETFL, isNonBlocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+#endif // WIN32
+    }
+
+    // Waits until the connection attempt on the non-blocking `socket` finished and
+    // returns its error code, which is 0 if the socket is connected
+    int waitForConnect(SGCT_SOCKET socket, const std::atomic_bool& shouldStop) {
+        using namespace std::chrono;
+
+        const steady_clock::time_point end = steady_clock::now() + ConnectTimeout;
+        while (!shouldStop && steady_clock::now() < end) {
 #ifdef WIN32
-            else if (SGCT_ERRNO == WSAEINTR && attempts <= MaxNumberOfAttempts) {
+            // A failed connection attempt is reported as an exception on Windows
+            fd_set writable;
+            FD_ZERO(&writable);
+            FD_SET(socket, &writable);
+            fd_set failed;
+            FD_ZERO(&failed);
+            FD_SET(socket, &failed);
+            const microseconds interval = ConnectPollInterval;
+            timeval timeout = { 0, static_cast<long>(interval.count()) };
+            const int n = select(0, nullptr, &writable, &failed, &timeout);
 #else // ^^^^ WIN32 // !WIN32 vvvv
-            else if (SGCT_ERRNO == EINTR && attempts <= MaxNumberOfAttempts) {
+            pollfd fd = { socket, POLLOUT, 0 };
+            const int n = poll(&fd, 1, static_cast<int>(ConnectPollInterval.count()));
 #endif // WIN32
-                sgct::Log::Warning(std::format(
-                    "Receiving data after interrupted system error (attempt {})", attempts
-                ));
-                attempts++;
+            if (n > 0) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(
+                    socket,
+                    SOL_SOCKET,
+                    SO_ERROR,
+                    reinterpret_cast<char*>(&error),
+                    &length
+                );
+                return error;
             }
-            else {
-                // Capture error
-                iResult = tmpRes;
-                break;
+            if (n == SOCKET_ERROR && !isInterrupted(SGCT_ERRNO)) {
+                return SGCT_ERRNO;
             }
+        }
+#ifdef WIN32
+        return WSAETIMEDOUT;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        return ETIMEDOUT;
+#endif // WIN32
+    }
+
+    // Connects the `socket` to the `address` without blocking for longer than the
+    // ConnectTimeout, which could otherwise take minutes if the server's machine does not
+    // answer, and returns the error code of the attempt, which is 0 on success
+    int connectSocket(SGCT_SOCKET socket, const addrinfo& address,
+                      const std::atomic_bool& shouldStop)
+    {
+        setNonBlocking(socket, true);
+        int error = 0;
+        const int addrlen = static_cast<int>(address.ai_addrlen);
+        if (connect(socket, address.ai_addr, addrlen) == SOCKET_ERROR) {
+            error = SGCT_ERRNO;
+#ifdef WIN32
+            const bool isInProgress = error == WSAEWOULDBLOCK;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            const bool isInProgress = error == EINPROGRESS;
+#endif // WIN32
+            if (isInProgress) {
+                error = waitForConnect(socket, shouldStop);
             }
+        }
+        setNonBlocking(socket, false);
+        return error;
+    }
 
-        // POXIX requires `recv` to return ssize_t which is -> long. We are not going to get
-        // enough data to fill this, so we should be fine
-        return static_cast<int>(iResult);
+    // See SendFlags, the option is not passed on to accepted sockets on every platform
+    void disableSigPipe([[maybe_unused]] SGCT_SOCKET socket) {
+#if !defined(WIN32) && !defined(__linux__)
+        constexpr int TrueFlag = 1;
+        const int res = setsockopt(
+            socket,
+            SOL_SOCKET,
+            SO_NOSIGPIPE,
+            &TrueFlag,
+            sizeof(TrueFlag)
+        );
+        if (res == SOCKET_ERROR) {
+            sgct::Log::Warning(std::format(
+                "Failed to disable SIGPIPE on socket: {}", SGCT_ERRNO
+            ));
+        }
+#endif // !WIN32 && !__linux__
     }
 
     void setOptions(SGCT_SOCKET socket, sgct::Network::ConnectionType connectionType) {
@@ -137,6 +294,38 @@ namespace {
                 throw Err(5009, std::format("Failed to set keep alive: {}", SGCT_ERRNO));
             }
         }
+
+        disableSigPipe(socket);
+    }
+
+    // Marks the packets with the Differentiated Services Code Point, which is stored in
+    // the upper six bits of the type of service field. The packets are delivered either
+    // way, so a failure only means that they are not prioritized
+    void setTrafficClass(SGCT_SOCKET socket, int dscp) {
+        const int tos = dscp << 2;
+        const int res = setsockopt(
+            socket,
+            IPPROTO_IP,
+            IP_TOS,
+            reinterpret_cast<const char*>(&tos),
+            sizeof(tos)
+        );
+        if (res == SOCKET_ERROR) {
+            sgct::Log::Warning(std::format(
+                "Failed to set DSCP {} on socket: {}", dscp, SGCT_ERRNO
+            ));
+        }
+
+#ifdef __linux__
+        // The priority selects the band of the interface's queue. The class selector of
+        // the code point is used, but priorities above 6 require elevated permissions
+        const int priority = std::min(dscp >> 3, 6);
+        if (setsockopt(socket, SOL_SOCKET, SO_PRIORITY, &priority, sizeof(priority))) {
+            sgct::Log::Warning(std::format(
+                "Failed to set priority {} on socket: {}", priority, SGCT_ERRNO
+            ));
+        }
+#endif // __linux__
     }
 
     std::string typeStr(sgct::Network::ConnectionType ct) {
@@ -147,6 +336,31 @@ namespace {
         }
     }
 
+    // The messages with the Network::SharedMemoryId, which are stored after the id
+    enum class SharedMemoryMessage : int32_t { Offer = 0, Accept, Reject, Switch };
+
+    std::array<char, sgct::Network::HeaderSize> sharedMemoryHeader(
+                                               SharedMemoryMessage message, uint32_t size)
+    {
+        std::array<char, sgct::Network::HeaderSize> header = {};
+        header[0] = sgct::Network::SharedMemoryId;
+        std::memcpy(header.data() + 1, &message, sizeof(message));
+        std::memcpy(header.data() + 5, &size, sizeof(size));
+        return header;
+    }
+
+    // The acknowledgement of a package on a data transfer connection, which repeats the
+    // number of the package if it was sent with `sendPackage`
+    std::array<char, sgct::Network::HeaderSize> packageAcknowledgement(int32_t packageId,
+                                                                       uint32_t sequence)
+    {
+        std::array<char, sgct::Network::HeaderSize> header = {};
+        header[0] = sgct::Network::Ack;
+        std::memcpy(header.data() + 1, &packageId, sizeof(packageId));
+        std::memcpy(header.data() + 9, &sequence, sizeof(sequence));
+        return header;
+    }
+
     bool isDisconnectPackage(const char* header) {
         constexpr std::array<const char, 8> rhs = {
             sgct::Network::DisconnectId, 24, '\r', '\n', 27, '\r', '\n', '\0'
@@ -225,93 +439,405 @@ Network::Network(int port, const std::string& address, bool isServer, Connection
 #endif // WIN32
             throw Err(5003, "Listen call failed");
         }
+
+        // The listening socket is observed by the reactor, which must never block in
+        // `accept` if the connection was already gone by then
+#ifdef WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(_listenSocket, FIONBIO, &nonBlocking);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        fcntl(_listenSocket, F_SETFL, fcntl(_listenSocket, F_GETFL) | O_NONBLOCK);
+#endif // WIN32
+        freeaddrinfo(res);
     }
     else {
-        // Client socket: Connect to server
-        while (!_shouldTerminate) {
-            Log::Info(std::format(
-                "Attempting to connect to server (id: {}, ip: {}, type: {})",
-                _id, address, typeStr(type())
-            ));
+        // The client connects to the server in the background once it is initialized,
+        // so that the server does not have to be running when the client is created
+        _address = address;
+        _serverAddress.reset(res);
+    }
+}
 
-            _socket = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-            if (_socket == INVALID_SOCKET) {
-                freeaddrinfo(res);
-                throw Err(5004, "Failed to init client socket");
-            }
+Network::~Network() {
+    closeNetwork();
+}
+
+void Network::initialize() {
+    if (_isServer) {
+        startListening();
+    }
+    else {
+        _connectThread = std::thread(&Network::connectToServer, this);
+    }
 
-            setOptions(_socket, type());
+    if (type() == ConnectionType::DataTransfer) {
+        _decodeThread = std::thread(&Network::decodeReceivedPackages, this);
+    }
+}
 
-            const int r = connect(
-                _socket,
-                res->ai_addr,
-                static_cast<int>(res->ai_addrlen)
-            );
-            if (r != SOCKET_ERROR) {
-                break;
+void Network::connectToServer() {
+    Log::Info(std::format(
+        "Attempting to connect to server (id: {}, ip: {}, type: {})",
+        _id, _address, typeStr(type())
+    ));
+
+    std::chrono::milliseconds delay = MinConnectDelay;
+    while (!_shouldTerminate) {
+        const SGCT_SOCKET s = socket(
+            _serverAddress->ai_family,
+            _serverAddress->ai_socktype,
+            _serverAddress->ai_protocol
+        );
+        if (s == INVALID_SOCKET) {
+            Log::Error(std::format(
+                "Failed to init client socket {}. Error: {}", _id, SGCT_ERRNO
+            ));
+            return;
+        }
+
+        int error = 0;
+        try {
+            setOptions(s, type());
+            if (_dscp != -1) {
+                setTrafficClass(s, _dscp);
             }
+            error = connectSocket(s, *_serverAddress, _shouldTerminate);
+        }
+        catch (const Error& e) {
+            Log::Error(e.what());
+            closeSocket(s);
+            return;
+        }
 
-            if (SGCT_ERRNO == 10061) {
-                Log::Debug("Waiting for connection...");
+        if (error == 0) {
+            bool isShutDown = false;
+            {
+                const std::unique_lock lock(_sendMutex);
+                isShutDown = _shouldTerminate;
+                if (!isShutDown) {
+                    _socket = s;
+                }
+            }
+            if (isShutDown) {
+                closeSocket(s);
             }
             else {
-                Log::Debug(std::format("Connect error code: {}", SGCT_ERRNO));
+                establishConnection();
             }
-            // Wait for next attempt
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            return;
+        }
+
+        closeSocket(s);
+        if (isRefused(error)) {
+            Log::Debug("Waiting for connection...");
+        }
+        else {
+            Log::Debug(std::format("Connect error code: {}", error));
         }
+
+        // Wait for the next attempt, unless the connection is shut down before that
+        std::unique_lock lock(_connectionMutex);
+        _startConnectionCond.wait_for(
+            lock,
+            delay,
+            [this]() { return _shouldTerminate.load(); }
+        );
+        delay = std::min(2 * delay, MaxConnectDelay);
     }
+}
 
-    freeaddrinfo(res);
+void Network::stopConnecting() {
+    {
+        // The client might be about to wait for its next attempt
+        const std::unique_lock lock(_connectionMutex);
+        _shouldTerminate = true;
+    }
+    _startConnectionCond.notify_all();
+    if (_connectThread.joinable() &&
+        _connectThread.get_id() != std::this_thread::get_id())
+    {
+        _connectThread.join();
+    }
 }
 
-Network::~Network() {
-    closeNetwork(false);
+void Network::queueReceivedPackage(ReceivedPackage package) {
+    {
+        const std::unique_lock lock(_decodeMutex);
+        _receivedPackages.push_back(std::move(package));
+    }
+    _decodeCond.notify_one();
 }
 
-void Network::initialize() {
-    _mainThread = std::make_unique<std::thread>([this]() { connectionHandler(); });
+std::vector<char> Network::takeReceiveBuffer() {
+    const std::unique_lock lock(_connectionMutex);
+    _uncompressBuffer.clear();
+    _bufferSize = 0;
+    _uncompressedBufferSize = 0;
+    return std::exchange(_recvBuffer, {});
 }
 
-void Network::connectionHandler() {
-    if (_isServer) {
-        while (!_shouldTerminate) {
-            if (!_isConnected) {
-                if (_commThread) {
-                    _commThread->join();
-                    _commThread = nullptr;
-                }
+void Network::decodeReceivedPackages() {
+    while (true) {
+        std::unique_lock lock(_decodeMutex);
+        _decodeCond.wait(
+            lock,
+            [this]() { return !_isDecodeRunning || !_receivedPackages.empty(); }
+        );
+        if (!_isDecodeRunning) {
+            return;
+        }
+        ReceivedPackage package = std::move(_receivedPackages.front());
+        _receivedPackages.pop_front();
+        lock.unlock();
 
-                // Start a new connection enabling the client to reconnect
-                _commThread = std::make_unique<std::thread>([this]() {
-                    try {
-                        communicationHandler();
-                    }
-                    catch (const std::runtime_error& e) {
-                        Log::Error(e.what());
-                    }
-                });
+        try {
+            if (package.type == ChunkId) {
+                decodeChunk(package);
             }
-
-            // Wait for signal until next iteration in loop
-            if (!_shouldTerminate) {
-                std::unique_lock lock(_connectionMutex);
-                _startConnectionCond.wait(lock);
+            else {
+                decodePackage(package);
             }
         }
+        catch (const std::runtime_error& e) {
+            // The NetworkReactor thread handles the connection that was lost
+            Log::Warning(std::format(
+                "Failed to handle package {} on connection {}: {}",
+                package.packageId, _id, e.what()
+            ));
+        }
     }
-    else {
-        _commThread = std::make_unique<std::thread>([this]() {
-            try {
-                communicationHandler();
-            }
-            catch (const std::runtime_error& e) {
-                Log::Error(e.what());
-            }
-        });
+}
+
+void Network::decodePackage(ReceivedPackage& package) {
+    ZoneScoped;
+
+    // An offered package that was not in the cache is added to it before it is decoded,
+    // as the decoder is allowed to change the bytes
+    if (package.hash) {
+        const std::span<const char> payload(package.data.data(), package.size);
+        if (TransferCache::hash(payload) == *package.hash) {
+            _transferCache->store(*package.hash, payload);
+        }
+        else {
+            Log::Warning(std::format(
+                "Package {} on connection {} does not match its offer",
+                package.packageId, _id
+            ));
+        }
+    }
+
+    // A package from the cache is decoded from the cached payload instead of a buffer
+    char* data = package.cached ? package.cached->data() : package.data.data();
+
+    // A numbered package is acknowledged even if it can't be decoded, as the sender
+    // would otherwise wait for its acknowledgement forever
+    if (_packageDecoderCallback && package.size > 0) {
+        _packageDecoderCallback(
+            data,
+            static_cast<int>(package.size),
+            package.packageId,
+            _id
+        );
+    }
+
+    // The buffer is kept in the pool for the next package, unless the pool has to free
+    // memory
+    _bufferPool.release(std::move(package.data));
+
+    // Send acknowledge, which repeats the number of the package
+    const std::array<char, HeaderSize> ack =
+        packageAcknowledgement(package.packageId, package.sequence);
+    sendData(ack.data(), HeaderSize);
+}
+
+void Network::decodeChunk(ReceivedPackage& chunk) {
+    ZoneScoped;
+
+    if (_chunkDecoderCallback) {
+        _chunkDecoderCallback(
+            chunk.data.data() + ChunkHeaderSize,
+            static_cast<int>(chunk.size),
+            chunk.packageId,
+            chunk.offset,
+            chunk.totalSize,
+            _id
+        );
+    }
+    _bufferPool.release(std::move(chunk.data));
+
+    // Every chunk is acknowledged with the number of bytes that have been received, and
+    // the last chunk also acknowledges the package in the same way as `transferData`
+    const uint64_t received = chunk.offset + chunk.size;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        if (received >= chunk.totalSize) {
+            _receivedChunkBytes.erase({ chunk.packageId, chunk.totalSize });
+        }
+        else {
+            _receivedChunkBytes[{ chunk.packageId, chunk.totalSize }] = received;
+        }
+    }
+
+    std::array<char, 2 * HeaderSize + ChunkHeaderSize> sendBuffer = {};
+    sendBuffer[0] = ChunkAckId;
+    std::memcpy(sendBuffer.data() + 1, &chunk.packageId, sizeof(chunk.packageId));
+    std::memcpy(sendBuffer.data() + 5, &ChunkHeaderSize, sizeof(ChunkHeaderSize));
+    std::memcpy(sendBuffer.data() + HeaderSize, &received, sizeof(received));
+    std::memcpy(
+        sendBuffer.data() + HeaderSize + sizeof(received),
+        &chunk.totalSize,
+        sizeof(chunk.totalSize)
+    );
+    int length = static_cast<int>(HeaderSize + ChunkHeaderSize);
+    if (received >= chunk.totalSize) {
+        sendBuffer[length] = Ack;
+        std::memcpy(
+            sendBuffer.data() + length + 1,
+            &chunk.packageId,
+            sizeof(chunk.packageId)
+        );
+        length += static_cast<int>(HeaderSize);
+    }
+    sendData(sendBuffer.data(), length);
+}
+
+void Network::stopDecoding() {
+    {
+        const std::unique_lock lock(_decodeMutex);
+        _isDecodeRunning = false;
+        _receivedPackages.clear();
+    }
+    _decodeCond.notify_all();
+    if (_decodeThread.joinable() &&
+        _decodeThread.get_id() != std::this_thread::get_id())
+    {
+        _decodeThread.join();
+    }
+}
+
+void Network::startListening() {
+    Log::Info(std::format("Waiting for client {} to connect on port {}", _id, _port));
+    NetworkReactor::instance().add(_listenSocket, [this]() { acceptConnection(); });
+}
+
+void Network::acceptConnection() {
+    const SGCT_SOCKET s = accept(_listenSocket, nullptr, nullptr);
+    if (s == INVALID_SOCKET) {
+        // The reactor reports the socket again if the client is still waiting
+        if (!wouldBlock(SGCT_ERRNO) && !isInterrupted(SGCT_ERRNO)) {
+            Log::Error(
+                std::format("Accept connection {} failed. Error: {}", _id, SGCT_ERRNO)
+            );
+        }
+        return;
+    }
+
+    // Only a single client can be connected at a time
+    NetworkReactor::instance().remove(_listenSocket);
+
+#ifdef WIN32
+    // Sockets that are accepted from a non-blocking socket are non-blocking on Windows
+    u_long nonBlocking = 0;
+    ioctlsocket(s, FIONBIO, &nonBlocking);
+#endif // WIN32
+    disableSigPipe(s);
+
+    // Not every platform passes the marking of the listening socket on to accepted ones
+    if (_dscp != -1) {
+        setTrafficClass(s, _dscp);
+    }
+
+    {
+        const std::unique_lock lock(_sendMutex);
+        _socket = s;
+    }
+
+    // The frame numbers of a newly connected client start from the beginning
+    _currentSendFrame = 0;
+    _previousSendFrame = 0;
+    _currentRecvFrame = 0;
+    _previousRecvFrame = -1;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _inFlightFrames.clear();
+    }
+
+    // The new client might be a different process on a different machine
+    _loopTimes.reset();
+    _roundTripTimes.reset();
+    _nClockSamples = 0;
+    _clockOffset = 0.0;
+
+    establishConnection();
+}
+
+void Network::establishConnection() {
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _recvBuffer.resize(_bufferSize);
+        _uncompressBuffer.resize(_uncompressedBufferSize);
+        _isClosed = false;
+    }
+    _nHeaderBytes = 0;
+    _nPayloadBytes = 0;
+    _isDisconnectSent = false;
+
+    setConnectedStatus(true);
+    Log::Info(std::format("Connection {} established", _id));
+
+    // The connection has to be known as established before the first message arrives
+    if (_updateCallback) {
+        _updateCallback(*this);
+    }
+
+    NetworkReactor::instance().add(_socket, [this]() { receiveMessages(); });
+
+    if (_isServer && _useSharedMemory && type() == ConnectionType::SyncConnection) {
+        offerSharedMemory();
+    }
+}
+
+void Network::closeConnection() {
+    setConnectedStatus(false);
+    NetworkReactor::instance().remove(_socket);
+    closeSharedMemory();
+
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _recvBuffer.clear();
+        _uncompressBuffer.clear();
+    }
+    {
+        // The other side fails the packages that it has not seen the acknowledgement for
+        const std::unique_lock lock(_decodeMutex);
+        _receivedPackages.clear();
     }
+    _bufferPool.clear();
+    failInFlightPackages();
 
-    Log::Info(std::format("Exiting connection handler for connection {}", _id));
+    SGCT_SOCKET s = INVALID_SOCKET;
+    {
+        const std::unique_lock lock(_sendMutex);
+        std::swap(s, _socket);
+    }
+    closeSocket(s);
+
+    if (_updateCallback) {
+        _updateCallback(*this);
+    }
+
+    Log::Info(std::format("Node {} disconnected", _id));
+
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _isClosed = true;
+    }
+    _closedCond.notify_all();
+
+    // Allow the client to reconnect
+    if (_isServer && !_shouldTerminate) {
+        startListening();
+    }
 }
 
 int Network::port() const {
@@ -345,22 +871,50 @@ int Network::iterateFrameCounter() {
     {
         const std::unique_lock lock(_connectionMutex);
         _timeStampSend = time();
+
+        // The frame is in flight until it is acknowledged, which might only happen after
+        // the following frames have been sent if the server is allowed to run ahead
+        if (_inFlightFrames.size() == MaxInFlightFrames) {
+            _inFlightFrames.pop_front();
+        }
+        _inFlightFrames.push_back({ _currentSendFrame, _timeStampSend });
     }
 
     return _currentSendFrame;
 }
 
+void Network::requestKeyframe() {
+    _isKeyframeRequested = true;
+}
+
+bool Network::consumeKeyframeRequest() {
+    return _isKeyframeRequested.exchange(false);
+}
+
 void Network::pushClientMessage() {
-    // The servers' render function is locked until an ack message is received
-    const int currentFrame = iterateFrameCounter();
-    uint32_t localSyncHeaderSize = 0;
+    // The servers' render function is locked until an ack message is received. The
+    // newest received frame is acknowledged, which also acknowledges the frames that
+    // arrived while the previous one was rendered if the server is allowed to run ahead
+    _isUpdated = false;
+    const int currentFrame = _currentRecvFrame;
+    _currentSendFrame = currentFrame;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _timeStampSend = time();
+    }
+
+    // The times let the server separate the time that was spent on this node from the
+    // time that was spent in the network
+    const std::array<double, 2> times = { _timeStampRecv.load(), time() };
+    const uint32_t size = sizeof(times);
 
-    std::array<char, HeaderSize> data = {};
-    data[0] = Network::DataId;
+    std::array<char, HeaderSize + sizeof(times)> data = {};
+    data[0] = Network::Ack;
     std::memcpy(data.data() + 1, &currentFrame, sizeof(currentFrame));
-    std::memcpy(data.data() + 5, &localSyncHeaderSize, sizeof(localSyncHeaderSize));
+    std::memcpy(data.data() + 5, &size, sizeof(size));
     std::memset(data.data() + 9, DefaultId, 4);
-    sendData(data.data(), HeaderSize);
+    std::memcpy(data.data() + HeaderSize, times.data(), sizeof(times));
+    sendData(data.data(), static_cast<int>(data.size()));
 }
 
 int Network::sendFrameCurrent() const {
@@ -379,18 +933,47 @@ double Network::loopTime() const {
     return _timeStampTotal;
 }
 
-bool Network::isUpdated() const {
-    bool state = false;
-    if (_isServer) {
-        state = ClusterManager::instance().firmFrameLockSyncStatus() ?
-            // Master sends first -> so on reply they should be equal
-            (_currentRecvFrame == _currentSendFrame) :
-            // Don't check if loose sync
-            true;
-    }
-    else {
-        state = ClusterManager::instance().firmFrameLockSyncStatus() ?
-            // Clients receive first and then send so the prev should be equal to the send
+const LatencyHistogram& Network::loopTimes() const {
+    return _loopTimes;
+}
+
+const LatencyHistogram& Network::roundTripTimes() const {
+    return _roundTripTimes;
+}
+
+double Network::clockOffset() const {
+    return _clockOffset;
+}
+
+int Network::unacknowledgedFrames() const {
+    return (_currentSendFrame - _currentRecvFrame + MaxNetworkSyncFrameNumber) %
+        MaxNetworkSyncFrameNumber;
+}
+
+bool Network::isUpdated() const {
+    const ClusterManager& cm = ClusterManager::instance();
+    bool state = false;
+    if (_isServer) {
+        if (const std::optional<int> maxLag = cm.maxFrameLag(); maxLag) {
+            // The server may run ahead of the client by a bounded number of frames
+            state = unacknowledgedFrames() <= *maxLag;
+        }
+        else {
+            state = cm.firmFrameLockSyncStatus() ?
+                // Master sends first -> so on reply they should be equal
+                (_currentRecvFrame == _currentSendFrame) :
+                // Don't check if loose sync
+                true;
+        }
+    }
+    else if (cm.maxFrameLag()) {
+        // The client renders the newest frame once any frame has arrived since the
+        // previous acknowledgement, no matter how many frames it has skipped
+        state = _isUpdated;
+    }
+    else {
+        state = cm.firmFrameLockSyncStatus() ?
+            // Clients receive first and then send so the prev should be equal to the send
             (_previousRecvFrame == _currentSendFrame) :
             // If loose sync just check if updated
             _isUpdated.load();
@@ -403,6 +986,14 @@ void Network::setDecodeFunction(std::function<void(const char*, int)> fn) {
     decoderCallback = std::move(fn);
 }
 
+void Network::setDeltaDecodeFunction(std::function<void(const char*, int)> fn) {
+    _deltaDecoderCallback = std::move(fn);
+}
+
+void Network::setKeyframeDecodeFunction(std::function<void(const char*, int)> fn) {
+    _keyframeDecoderCallback = std::move(fn);
+}
+
 void Network::setPackageDecodeFunction(std::function<void(void*, int, int, int)> fn) {
     _packageDecoderCallback = std::move(fn);
 }
@@ -419,6 +1010,84 @@ void Network::setAcknowledgeFunction(std::function<void(int, int)> fn) {
     _acknowledgeCallback = std::move(fn);
 }
 
+void Network::setChunkDecodeFunction(
+                   std::function<void(const char*, int, int, uint64_t, uint64_t, int)> fn)
+{
+    _chunkDecoderCallback = std::move(fn);
+}
+
+void Network::setChunkAcknowledgeFunction(
+                                     std::function<void(int, uint64_t, uint64_t, int)> fn)
+{
+    _chunkAcknowledgeCallback = std::move(fn);
+}
+
+void Network::setTransferWindow(int packages) {
+    const std::unique_lock lock(_connectionMutex);
+    _transferWindow = std::max(packages, 1);
+}
+
+void Network::setTransferWindowFunction(std::function<void(void)> fn) {
+    _transferWindowCallback = std::move(fn);
+}
+
+void Network::setBufferPoolLimit(size_t bytes) {
+    _bufferPool.setHighWaterMark(bytes);
+}
+
+BufferPool::Statistics Network::bufferPoolStatistics() const {
+    return _bufferPool.statistics();
+}
+
+void Network::setBandwidthLimiter(BandwidthLimiter* limiter) {
+    _bandwidthLimiter = limiter;
+}
+
+void Network::setTransferCache(const TransferCache* cache) {
+    _transferCache = cache;
+}
+
+void Network::setDscp(int dscp) {
+    // The socket of a client is created once it connects and uses the stored value
+    _dscp = dscp;
+    if (_listenSocket != INVALID_SOCKET) {
+        setTrafficClass(_listenSocket, _dscp);
+    }
+}
+
+void Network::setResendFunction(std::function<void(Network&, uint32_t)> fn) {
+    _resendCallback = std::move(fn);
+}
+
+void Network::setArrivalFunction(std::function<void(void)> fn) {
+    _arrivalCallback = std::move(fn);
+}
+
+void Network::setRelayFunction(std::function<void(const std::array<char, HeaderSize>&,
+                                 const char*, uint32_t, const std::function<void()>&)> fn)
+{
+    _relayCallback = std::move(fn);
+}
+
+void Network::setMulticastReceiver(std::unique_ptr<MulticastReceiver> receiver) {
+    if (_multicastReceiver) {
+        NetworkReactor::instance().remove(_multicastReceiver->notification());
+    }
+    _multicastReceiver = std::move(receiver);
+    if (_multicastReceiver) {
+        // The receiving thread of the multicast receiver signals when the frame that is
+        // waited for is complete or lost, so the reactor never blocks on it
+        NetworkReactor::instance().add(
+            _multicastReceiver->notification(),
+            [this]() { receiveMulticastNotification(); }
+        );
+    }
+}
+
+void Network::setSharedMemoryEnabled(bool enabled) {
+    _useSharedMemory = enabled;
+}
+
 void Network::setConnectedStatus(bool state) {
     const std::unique_lock lock(_connectionMutex);
     _isConnected = state;
@@ -445,7 +1114,9 @@ void Network::setRecvFrame(int i) {
     _previousRecvFrame.store(_currentRecvFrame.load());
     _currentRecvFrame = i;
     _isUpdated = true;
-    _timeStampTotal = time() - _timeStampSend;
+    const double now = time();
+    _timeStampRecv = now;
+    _timeStampTotal = now - _timeStampSend;
 }
 
 void Network::updateBuffer(std::vector<char>& buffer, uint32_t reqSize,
@@ -461,286 +1132,926 @@ void Network::updateBuffer(std::vector<char>& buffer, uint32_t reqSize,
     currSize = reqSize;
 }
 
-int Network::readSyncMessage(char* header, int32_t& syncFrame, uint32_t& dataSize,
-                             uint32_t& uncompressedDataSize)
-{
-    int iResult = receiveData(_socket, header, static_cast<int>(HeaderSize), 0);
+void Network::handleHeader() {
+    _headerId = _recvHeader[0];
+    _dataSize = 0;
+    _uncompressedDataSize = 0;
+    _packageId = -1;
 
-    if (iResult == static_cast<int>(HeaderSize)) {
-        _headerId = header[0];
-        if (_headerId == DataId) {
-            std::memcpy(&syncFrame, header + 1, sizeof(syncFrame));
-            std::memcpy(&dataSize, header + 5, sizeof(dataSize));
-            std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
+    // Resize buffer request
+    if (type() != ConnectionType::DataTransfer && _requestedSize > _bufferSize) {
+        Log::Info(std::format(
+            "Re-sizing buffer {} -> {}", _bufferSize, _requestedSize.load()
+        ));
+        updateBuffer(_recvBuffer, _requestedSize, _bufferSize);
+    }
 
+    if (type() == ConnectionType::SyncConnection &&
+        (_headerId == DataId || _headerId == DeltaId || _headerId == KeyframeId ||
+         _headerId == Ack))
+    {
+        int32_t syncFrame = -1;
+        std::memcpy(&syncFrame, _recvHeader.data() + 1, sizeof(syncFrame));
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+        std::memcpy(&_uncompressedDataSize, _recvHeader.data() + 9, sizeof(uint32_t));
+
+        // A frame that is resent after it was lost via multicast belongs to the first
+        // pending notification instead
+        if (_multicastFrames.empty()) {
             setRecvFrame(syncFrame);
-            if (syncFrame < 0) {
-                throw Err(
-                    5010,
-                    std::format(
-                        "Error in sync frame {} for connection {}", syncFrame, _id
-                    )
-                );
-            }
-
-            // Resize buffer if needed
-            updateBuffer(_recvBuffer, dataSize, _bufferSize);
-            updateBuffer(
-                _uncompressBuffer,
-                uncompressedDataSize,
-                _uncompressedBufferSize
+        }
+        if (syncFrame < 0) {
+            throw Err(
+                5010,
+                std::format("Error in sync frame {} for connection {}", syncFrame, _id)
             );
         }
     }
-
-    // Get the data/message
-    if (dataSize > 0) {
-        iResult = receiveData(_socket, _recvBuffer.data(), dataSize, 0);
+    else if (type() == ConnectionType::DataTransfer && _headerId == DataId) {
+        // Parse the package _id
+        std::memcpy(&_packageId, _recvHeader.data() + 1, sizeof(_packageId));
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+        // Packages are not compressed, so the bytes of the uncompressed size contain the
+        // number of a package that was sent with `sendPackage` instead
+        std::memcpy(&_packageSequence, _recvHeader.data() + 9, sizeof(_packageSequence));
+        if (_packageId < 0) {
+            _dataSize = 0;
+        }
     }
-
-    return iResult;
-}
-
-int Network::readDataTransferMessage(char* header, int32_t& packageId, uint32_t& dataSize,
-                                     uint32_t& uncompressedDataSize)
-{
-    int iResult = receiveData(_socket, header, static_cast<int>(HeaderSize), 0);
-
-    if (iResult == static_cast<int>(HeaderSize)) {
-        _headerId = header[0];
-        if (_headerId == DataId) {
-            // Parse the package _id
-            std::memcpy(&packageId, header + 1, sizeof(packageId));
-            std::memcpy(&dataSize, header + 5, sizeof(dataSize));
-            std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
-
-            // Resize buffer if needed
-            updateBuffer(_recvBuffer, dataSize, _bufferSize);
-            updateBuffer(
-                _uncompressBuffer,
-                uncompressedDataSize,
-                _uncompressedBufferSize
+    else if (type() == ConnectionType::SyncConnection && _headerId == MulticastId) {
+        // The notification about a multicast frame contains the session of the sender
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+        if (_dataSize != sizeof(uint32_t)) {
+            throw Err(
+                5060,
+                std::format(
+                    "Invalid multicast notification of {} bytes for connection {}",
+                    _dataSize, _id
+                )
             );
         }
-        else if (_headerId == Ack && _acknowledgeCallback != nullptr) {
-            std::memcpy(&packageId, header + 1, sizeof(packageId));
+    }
+    else if (type() == ConnectionType::SyncConnection && _headerId == SharedMemoryId) {
+        // The offer of a shared memory channel contains the name of the channel
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+    }
+    else if (type() == ConnectionType::DataTransfer &&
+             (_headerId == ChunkId || _headerId == ChunkAckId ||
+              _headerId == ChunkResumeId || _headerId == ChunkResumeReplyId))
+    {
+        std::memcpy(&_packageId, _recvHeader.data() + 1, sizeof(_packageId));
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+        if (_dataSize < ChunkHeaderSize ||
+            (_headerId != ChunkId && _dataSize != ChunkHeaderSize))
+        {
+            throw Err(
+                5055,
+                std::format("Invalid chunk of {} bytes for connection {}", _dataSize, _id)
+            );
+        }
+    }
+    else if (type() == ConnectionType::DataTransfer &&
+             (_headerId == ContentOfferId || _headerId == ContentReplyId))
+    {
+        std::memcpy(&_packageId, _recvHeader.data() + 1, sizeof(_packageId));
+        std::memcpy(&_dataSize, _recvHeader.data() + 5, sizeof(_dataSize));
+        const uint32_t size =
+            _headerId == ContentOfferId ? ContentOfferSize : sizeof(uint64_t);
+        if (_dataSize != size) {
+            throw Err(
+                5058,
+                std::format(
+                    "Invalid content message of {} bytes for connection {}",
+                    _dataSize, _id
+                )
+            );
+        }
+    }
+    else if (type() == ConnectionType::DataTransfer && _headerId == Ack) {
+        int32_t packageId = -1;
+        uint32_t sequence = 0;
+        std::memcpy(&packageId, _recvHeader.data() + 1, sizeof(packageId));
+        std::memcpy(&sequence, _recvHeader.data() + 9, sizeof(sequence));
+        if (_acknowledgeCallback) {
             _acknowledgeCallback(packageId, _id);
         }
+        if (sequence != 0) {
+            handlePackageAcknowledgement(sequence);
+        }
     }
 
-    // Get the data/message
-    if (dataSize > 0 && packageId > -1) {
-        iResult = receiveData(_socket, _recvBuffer.data(), dataSize, 0);
+    // The packages of a data transfer can have any size, so their buffers are taken from
+    // the pool instead of growing a single buffer that is filled with zeros every time
+    if (type() == ConnectionType::DataTransfer && _dataSize > _bufferSize) {
+        const std::unique_lock lock(_connectionMutex);
+        _bufferPool.release(std::move(_recvBuffer));
+        _recvBuffer = _bufferPool.acquire(_dataSize);
+        _bufferSize = static_cast<uint32_t>(
+            std::min<size_t>(_recvBuffer.size(), std::numeric_limits<uint32_t>::max())
+        );
     }
 
-    return iResult;
+    // Resize buffer if needed
+    updateBuffer(_recvBuffer, _dataSize, _bufferSize);
+    updateBuffer(_uncompressBuffer, _uncompressedDataSize, _uncompressedBufferSize);
 }
 
-int Network::readExternalMessage() {
-    long iResult = recv(_socket, _recvBuffer.data(), _bufferSize, 0);
+void Network::handleAcknowledgement() {
+    // The client's times at which it received and acknowledged the frame
+    std::array<double, 2> times;
+    if (_dataSize != sizeof(times)) {
+        return;
+    }
+    std::memcpy(times.data(), _recvBuffer.data(), sizeof(times));
 
-    // If read fails try for x attempts
-    int attempts = 1;
-#ifdef WIN32
-    while (iResult <= 0 && SGCT_ERRNO == WSAEINTR && attempts <= MaxNumberOfAttempts) {
-#else // ^^^^ WIN32 // !WIN32 vvvv
-    while (iResult <= 0 && SGCT_ERRNO == EINTR && attempts <= MaxNumberOfAttempts) {
-#endif // WIN32
-        iResult = recv(_socket, _recvBuffer.data(), _bufferSize, 0);
-        Log::Info(std::format(
-            "Receiving data after interrupted system error (attempt {})", attempts
-        ));
-        attempts++;
+    double sent = 0.0;
+    {
+        // The acknowledgement of a frame also covers all frames that were sent before it
+        const std::unique_lock lock(_connectionMutex);
+        const auto it = std::find_if(
+            _inFlightFrames.cbegin(),
+            _inFlightFrames.cend(),
+            [frame = _currentRecvFrame.load()](const InFlightFrame& f) {
+                return f.frame == frame;
+            }
+        );
+        if (it == _inFlightFrames.cend()) {
+            return;
+        }
+        sent = it->sendTime;
+        _inFlightFrames.erase(_inFlightFrames.cbegin(), it + 1);
     }
+    const double received = _timeStampRecv;
+
+    const double loopTime = received - sent;
+    _timeStampTotal = loopTime;
+    const double roundTripTime = std::max(loopTime - (times[1] - times[0]), 0.0);
+    _loopTimes.add(loopTime);
+    _roundTripTimes.add(roundTripTime);
+
+    // The sample with the shortest round trip is the least affected by the network
+    // delays in both directions being different
+    _clockSamples[_nClockSamples % ClockSamples] = {
+        .offset = ((times[0] - sent) + (times[1] - received)) / 2.0,
+        .roundTripTime = roundTripTime
+    };
+    _nClockSamples++;
+    const auto it = std::min_element(
+        _clockSamples.cbegin(),
+        _clockSamples.cbegin() + std::min<size_t>(_nClockSamples, ClockSamples),
+        [](const ClockSample& lhs, const ClockSample& rhs) {
+            return lhs.roundTripTime < rhs.roundTripTime;
+        }
+    );
+    _clockOffset = it->offset;
+}
 
-    return static_cast<int>(iResult);
+void Network::handleChunk() {
+    ReceivedPackage chunk = {
+        .type = ChunkId,
+        .packageId = _packageId,
+        .size = _dataSize - ChunkHeaderSize
+    };
+    std::memcpy(&chunk.offset, _recvBuffer.data(), sizeof(chunk.offset));
+    std::memcpy(
+        &chunk.totalSize,
+        _recvBuffer.data() + sizeof(chunk.offset),
+        sizeof(chunk.totalSize)
+    );
+    chunk.data = takeReceiveBuffer();
+    queueReceivedPackage(std::move(chunk));
 }
 
-void Network::communicationHandler() {
-    if (_shouldTerminate) {
-        return;
-    }
+void Network::handleChunkAcknowledgement() {
+    uint64_t received = 0;
+    uint64_t totalSize = 0;
+    std::memcpy(&received, _recvBuffer.data(), sizeof(received));
+    std::memcpy(&totalSize, _recvBuffer.data() + sizeof(received), sizeof(totalSize));
 
-    // Listen for client if server
-    if (_isServer) {
-        Log::Info(
-            std::format("Waiting for client {} to connect on port {}", _id, _port)
-        );
+    if (_chunkAcknowledgeCallback) {
+        _chunkAcknowledgeCallback(_packageId, received, totalSize, _id);
+    }
+}
 
-        _socket = accept(_listenSocket, nullptr, nullptr);
+void Network::handleChunkResume() {
+    uint64_t totalSize = 0;
+    std::memcpy(&totalSize, _recvBuffer.data() + sizeof(uint64_t), sizeof(totalSize));
 
-#ifdef WIN32
-        while (!_shouldTerminate && _socket == INVALID_SOCKET && SGCT_ERRNO == WSAEINTR) {
-#else // ^^^^ WIN32 // !WIN32 vvvv
-        while (!_shouldTerminate && _socket == INVALID_SOCKET && SGCT_ERRNO == EINTR) {
-#endif // WIN32
-            Log::Info(
-                std::format("Re-accept after interrupted system on connection {}", _id)
-            );
-            _socket = accept(_listenSocket, nullptr, nullptr);
+    uint64_t received = 0;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        const auto it = _receivedChunkBytes.find({ _packageId, totalSize });
+        if (it != _receivedChunkBytes.end()) {
+            received = it->second;
         }
+    }
+    std::array<char, HeaderSize + ChunkHeaderSize> reply =
+        chunkHeader(_packageId, received, totalSize, 0);
+    reply[0] = ChunkResumeReplyId;
+    sendData(reply.data(), static_cast<int>(reply.size()));
+}
 
-        if (_socket == INVALID_SOCKET) {
-            Log::Error(
-                std::format("Accept connection {} failed. Error: {}", _id, SGCT_ERRNO)
-            );
+void Network::handleChunkResumeReply() {
+    uint64_t received = 0;
+    uint64_t totalSize = 0;
+    std::memcpy(&received, _recvBuffer.data(), sizeof(received));
+    std::memcpy(&totalSize, _recvBuffer.data() + sizeof(received), sizeof(totalSize));
 
-            if (_updateCallback) {
-                _updateCallback(*this);
+    std::function<void(uint64_t)> onReply;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        const auto it = std::find_if(
+            _pendingChunkResumes.begin(),
+            _pendingChunkResumes.end(),
+            [this, totalSize](const PendingChunkResume& r) {
+                return r.packageId == _packageId && r.totalSize == totalSize;
             }
+        );
+        if (it == _pendingChunkResumes.end()) {
             return;
         }
+        onReply = std::move(it->onReply);
+        _pendingChunkResumes.erase(it);
     }
+    if (onReply) {
+        onReply(received);
+    }
+}
 
-    setConnectedStatus(true);
-    Log::Info(std::format("Connection {} established", _id));
+void Network::handlePackageAcknowledgement(uint32_t sequence) {
+    std::deque<InFlightPackage> acknowledged;
+    {
+        // The acknowledgement of a package also covers all packages that were sent
+        // before it
+        const std::unique_lock lock(_connectionMutex);
+        const auto it = std::find_if(
+            _inFlightPackages.begin(),
+            _inFlightPackages.end(),
+            [sequence](const InFlightPackage& p) { return p.sequence == sequence; }
+        );
+        if (it == _inFlightPackages.end()) {
+            return;
+        }
+        acknowledged.assign(
+            std::make_move_iterator(_inFlightPackages.begin()),
+            std::make_move_iterator(it + 1)
+        );
+        _inFlightPackages.erase(_inFlightPackages.begin(), it + 1);
+    }
 
-    if (_updateCallback) {
-        _updateCallback(*this);
+    for (const InFlightPackage& package : acknowledged) {
+        if (package.onAcknowledged) {
+            package.onAcknowledged(true);
+        }
     }
+    if (_transferWindowCallback) {
+        _transferWindowCallback();
+    }
+}
 
-    // Init buffers
-    std::array<char, HeaderSize> RecvHeader = {};
-    std::memset(RecvHeader.data(), DefaultId, HeaderSize);
+void Network::handleContentOffer() {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    std::memcpy(&hash, _recvBuffer.data(), sizeof(hash));
+    std::memcpy(&size, _recvBuffer.data() + sizeof(hash), sizeof(size));
+
+    // The decoder callback can only be given payloads whose size fits into an int
+    const bool isCacheable =
+        _transferCache && size <= static_cast<uint64_t>(std::numeric_limits<int>::max());
+    std::optional<TransferCache::Payload> payload =
+        isCacheable ? _transferCache->find(hash, size) : std::nullopt;
+    if (!payload && _transferCache) {
+        const std::unique_lock lock(_connectionMutex);
+        _expectedContent[_packageId] = hash;
+    }
 
+    // The other side is told first, so that it can go on with the other nodes while this
+    // side decodes the package on the `_decodeThread`
+    const uint32_t isAvailable = payload ? 1 : 0;
+    const uint32_t replySize = sizeof(hash);
+    std::array<char, HeaderSize + sizeof(hash)> reply = {};
+    reply[0] = ContentReplyId;
+    std::memcpy(reply.data() + 1, &_packageId, sizeof(_packageId));
+    std::memcpy(reply.data() + 5, &replySize, sizeof(replySize));
+    std::memcpy(reply.data() + 9, &isAvailable, sizeof(isAvailable));
+    std::memcpy(reply.data() + HeaderSize, &hash, sizeof(hash));
+    sendData(reply.data(), static_cast<int>(reply.size()));
+    if (!payload) {
+        return;
+    }
+
+    Log::Debug(std::format(
+        "Package {} on connection {} was taken from the transfer cache", _packageId, _id
+    ));
+    queueReceivedPackage({
+        .packageId = _packageId,
+        .size = static_cast<uint32_t>(size),
+        .cached = std::move(payload)
+    });
+}
+
+void Network::handleContentReply() {
+    uint64_t hash = 0;
+    uint32_t isAvailable = 0;
+    std::memcpy(&hash, _recvBuffer.data(), sizeof(hash));
+    std::memcpy(&isAvailable, _recvHeader.data() + 9, sizeof(isAvailable));
+
+    std::function<void(bool)> onReply;
     {
         const std::unique_lock lock(_connectionMutex);
-        _recvBuffer.resize(_bufferSize);
-        _uncompressBuffer.resize(_uncompressedBufferSize);
+        const auto it = std::find_if(
+            _pendingOffers.begin(),
+            _pendingOffers.end(),
+            [this, hash](const PendingOffer& o) {
+                return o.packageId == _packageId && o.hash == hash;
+            }
+        );
+        if (it == _pendingOffers.end()) {
+            return;
+        }
+        onReply = std::move(it->onReply);
+        _pendingOffers.erase(it);
+    }
+    if (onReply) {
+        onReply(isAvailable != 0);
     }
+}
 
-    // Receive data until the server closes the connection
-    int iResult = 0;
-    do {
-        // Resize buffer request
-        if (type() != ConnectionType::DataTransfer && _requestedSize > _bufferSize) {
-            Log::Info(std::format(
-                "Re-sizing buffer {} -> {}", _bufferSize, _requestedSize.load()
-            ));
-            updateBuffer(_recvBuffer, _requestedSize, _bufferSize);
+void Network::failInFlightPackages() {
+    std::deque<InFlightPackage> failed;
+    std::deque<PendingOffer> unanswered;
+    std::deque<PendingChunkResume> unansweredResumes;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        std::swap(failed, _inFlightPackages);
+        std::swap(unanswered, _pendingOffers);
+        std::swap(unansweredResumes, _pendingChunkResumes);
+        _expectedContent.clear();
+    }
+
+    for (const InFlightPackage& package : failed) {
+        if (package.onAcknowledged) {
+            package.onAcknowledged(false);
         }
-        int32_t packageId = -1;
-        uint32_t dataSize = 0;
-        uint32_t uncompressedDataSize = 0;
+    }
+    for (const PendingOffer& offer : unanswered) {
+        if (offer.onReply) {
+            offer.onReply(false);
+        }
+    }
+    for (const PendingChunkResume& resume : unansweredResumes) {
+        if (resume.onReply) {
+            resume.onReply(0);
+        }
+    }
+    if (_transferWindowCallback) {
+        _transferWindowCallback();
+    }
+}
 
-        _headerId = DefaultId;
+void Network::queryChunkOffset(int packageId, uint64_t totalSize,
+                               std::function<void(uint64_t)> onReply)
+{
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _pendingChunkResumes.push_back({ packageId, totalSize, std::move(onReply) });
+    }
 
-        if (type() == ConnectionType::SyncConnection) {
-            int32_t syncFrameNumber = -1;
-            iResult = readSyncMessage(
-                RecvHeader.data(),
-                syncFrameNumber,
-                dataSize,
-                uncompressedDataSize
+    std::array<char, HeaderSize + ChunkHeaderSize> message =
+        chunkHeader(packageId, 0, totalSize, 0);
+    message[0] = ChunkResumeId;
+    try {
+        sendData(message.data(), static_cast<int>(message.size()));
+    }
+    catch (const std::runtime_error&) {
+        // The question is unanswered right away, unless the connection was closed already
+        std::function<void(uint64_t)> onFailed;
+        {
+            const std::unique_lock lock(_connectionMutex);
+            const auto it = std::find_if(
+                _pendingChunkResumes.begin(),
+                _pendingChunkResumes.end(),
+                [packageId, totalSize](const PendingChunkResume& r) {
+                    return r.packageId == packageId && r.totalSize == totalSize;
+                }
             );
+            if (it != _pendingChunkResumes.end()) {
+                onFailed = std::move(it->onReply);
+                _pendingChunkResumes.erase(it);
+            }
         }
-        else if (type() == ConnectionType::DataTransfer) {
-            iResult = readDataTransferMessage(
-                RecvHeader.data(),
-                packageId,
-                dataSize,
-                uncompressedDataSize
-            );
+        if (onFailed) {
+            onFailed(0);
         }
-        else {
-            iResult = readExternalMessage();
+        throw;
+    }
+}
+
+void Network::decompress(const char* data, uint32_t dataSize, uint32_t uncompressedSize) {
+    ZoneScoped;
+
+    if (!_inflateStream) {
+        _inflateStream = std::unique_ptr<z_stream_s, InflateDeleter>(new z_stream);
+        std::memset(_inflateStream.get(), 0, sizeof(z_stream));
+        const int res = inflateInit(_inflateStream.get());
+        if (res != Z_OK) {
+            // Don't use the deleter as the stream was never successfully initialized
+            delete _inflateStream.release();
+            throw Err(5030, std::format("Failed to initialize decompression: {}", res));
         }
+    }
+    else {
+        inflateReset(_inflateStream.get());
+    }
 
-        // Handle failed receive
-        if (iResult == 0) {
-            setConnectedStatus(false);
-            Log::Info(std::format("TCP connection {} closed", _id));
+    z_stream& stream = *_inflateStream;
+    // The input is never modified, but zlib might be compiled without const pointers
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = dataSize;
+    stream.next_out = reinterpret_cast<Bytef*>(_uncompressBuffer.data());
+    stream.avail_out = uncompressedSize;
+    const int res = inflate(&stream, Z_FINISH);
+    if (res != Z_STREAM_END || stream.total_out != uncompressedSize) {
+        throw Err(
+            5031,
+            std::format("Failed to decompress data for connection {}: {}", _id, res)
+        );
+    }
+}
+
+void Network::decodeSyncData(char headerId, const char* data, uint32_t dataSize,
+                             uint32_t uncompressedSize)
+{
+    // Full frames, deltas against the previous frame, and keyframes for a client that
+    // just connected are decoded by different functions, but are compressed the same way
+    const std::function<void(const char*, int)>& callback =
+        headerId == DataId ? decoderCallback :
+        headerId == DeltaId ? _deltaDecoderCallback :
+        _keyframeDecoderCallback;
+    if (!callback || dataSize == 0) {
+        return;
+    }
+
+    if (uncompressedSize > 0) {
+        decompress(data, dataSize, uncompressedSize);
+        callback(_uncompressBuffer.data(), uncompressedSize);
+    }
+    else {
+        callback(data, dataSize);
+    }
+}
+
+void Network::receiveMulticastNotification() {
+    ZoneScoped;
+
+    try {
+        _multicastReceiver->clearNotification();
+        receiveMulticastFrames();
+    }
+    catch (const std::runtime_error&) {
+        if (_socket != INVALID_SOCKET) {
+            closeConnection();
         }
-        else if (iResult < 0) {
-            setConnectedStatus(false);
+        throw;
+    }
+}
+
+void Network::receiveMulticastFrames() {
+    ZoneScoped;
+
+    while (!_multicastFrames.empty() && !_multicastFrames.front().isRequested) {
+        MulticastFrame& f = _multicastFrames.front();
+
+        const MulticastReceiver::FrameStatus status = _multicastReceiver ?
+            _multicastReceiver->takeFrame(f.sequence, _multicastBuffer) :
+            MulticastReceiver::FrameStatus::Lost;
+        if (status == MulticastReceiver::FrameStatus::Pending) {
+            // The receiver's notification continues once the frame is complete or lost
+            return;
+        }
+        if (status == MulticastReceiver::FrameStatus::Lost) {
+            Log::Debug(std::format(
+                "Requesting lost multicast frame {} on connection {}", f.sequence, _id
+            ));
+            std::array<char, HeaderSize> data = {};
+            std::fill(data.begin(), data.end(), DefaultId);
+            data[0] = Nack;
+            std::memcpy(data.data() + 1, &f.sequence, sizeof(f.sequence));
+            sendData(data.data(), HeaderSize);
+            f.isRequested = true;
+            return;
+        }
+
+        // The multicast frame is the same data block that would otherwise be sent over
+        // TCP, including its header
+        uint32_t dataSize = 0;
+        uint32_t uncompressedSize = 0;
+        if (_multicastBuffer.size() >= HeaderSize) {
+            std::memcpy(&dataSize, _multicastBuffer.data() + 5, sizeof(dataSize));
+            std::memcpy(&uncompressedSize, _multicastBuffer.data() + 9, sizeof(uint32_t));
+        }
+        if (_multicastBuffer.size() < HeaderSize ||
+            dataSize != _multicastBuffer.size() - HeaderSize)
+        {
             throw Err(
-                5013,
-                std::format("TCP connection {} receive failed: {}", _id, SGCT_ERRNO)
+                5039,
+                std::format("Received malformed multicast frame {}", f.sequence)
             );
         }
+        updateBuffer(_uncompressBuffer, uncompressedSize, _uncompressedBufferSize);
+
+        setRecvFrame(f.frame);
+        _multicastFrames.pop_front();
+        decodeSyncData(
+            _multicastBuffer[0],
+            _multicastBuffer.data() + HeaderSize,
+            dataSize,
+            uncompressedSize
+        );
+        if (_arrivalCallback) {
+            _arrivalCallback();
+        }
+    }
+}
 
-        if (type() == ConnectionType::SyncConnection) {
-            // Handle sync disconnect
-            if (isDisconnectPackage(RecvHeader.data())) {
-                setConnectedStatus(false);
-
-                // Terminate client only. The server only resets the connection,
-                // allowing clients to connect.
-                if (!_isServer) {
-                    _shouldTerminate = true;
-                }
+void Network::receiveMessages() {
+    ZoneScoped;
 
-                Log::Info(std::format("Client {} terminated connection", _id));
-                break;
+    try {
+        while (_socket != INVALID_SOCKET) {
+            const std::span<char> buffer = receiveBuffer();
+            const long res = recv(
+                _socket,
+                buffer.data(),
+                static_cast<int>(buffer.size()),
+                ReceiveFlags
+            );
+            if (res == 0) {
+                Log::Info(std::format("TCP connection {} closed", _id));
+                closeConnection();
+                return;
             }
-            // Handle sync communication
-            if (_headerId == DataId && decoderCallback) {
-                if (dataSize > 0) {
-                    decoderCallback(_recvBuffer.data(), dataSize);
+            if (res < 0) {
+                if (wouldBlock(SGCT_ERRNO)) {
+                    return;
+                }
+                if (isInterrupted(SGCT_ERRNO)) {
+                    continue;
                 }
+                throw Err(
+                    5013,
+                    std::format("TCP connection {} receive failed: {}", _id, SGCT_ERRNO)
+                );
+            }
+
+            handleReceived(static_cast<size_t>(res));
 
-                NetworkManager::cond.notify_all();
+#ifdef WIN32
+            // Another `recv` might block, so we wait for the next notification instead
+            return;
+#endif // WIN32
+        }
+    }
+    catch (const std::runtime_error&) {
+        // The stream can't be parsed any further after an error
+        if (_socket != INVALID_SOCKET) {
+            closeConnection();
+        }
+        throw;
+    }
+}
+
+void Network::receiveSharedMemoryMessages() {
+    ZoneScoped;
+
+    try {
+        // Handling a message might close the connection, which also closes the channel
+        while (_isReceivingSharedMemory) {
+            const std::span<char> buffer = receiveBuffer();
+            const size_t res = _sharedMemory->read(buffer.data(), buffer.size());
+            if (res == 0) {
+                return;
             }
-            else if (_headerId == ConnectedId && _connectedCallback) {
-                _connectedCallback();
-                NetworkManager::cond.notify_all();
+            handleReceived(res);
+        }
+    }
+    catch (const std::runtime_error&) {
+        if (_socket != INVALID_SOCKET) {
+            closeConnection();
+        }
+        throw;
+    }
+}
+
+std::span<char> Network::receiveBuffer() {
+    // Each message is a header that is followed by `_dataSize` bytes of payload, both of
+    // which might arrive in any number of pieces
+    if (_nHeaderBytes < HeaderSize) {
+        return std::span(_recvHeader).subspan(_nHeaderBytes);
+    }
+    return std::span(_recvBuffer.data() + _nPayloadBytes, _dataSize - _nPayloadBytes);
+}
+
+void Network::handleReceived(size_t nBytes) {
+    if (_nHeaderBytes < HeaderSize) {
+        _nHeaderBytes += nBytes;
+        if (_nHeaderBytes == HeaderSize) {
+            handleHeader();
+        }
+    }
+    else {
+        _nPayloadBytes += static_cast<uint32_t>(nBytes);
+    }
+
+    if (_nHeaderBytes == HeaderSize && _nPayloadBytes == _dataSize) {
+        _nHeaderBytes = 0;
+        _nPayloadBytes = 0;
+        handleMessage();
+    }
+}
+
+void Network::handleMessage() {
+    if (type() == ConnectionType::SyncConnection) {
+        // Handle sync disconnect
+        if (isDisconnectPackage(_recvHeader.data())) {
+            // Terminate client only. The server only resets the connection, allowing
+            // clients to connect.
+            if (!_isServer) {
+                _shouldTerminate = true;
             }
+
+            Log::Info(std::format("Client {} terminated connection", _id));
+            closeConnection();
+            return;
         }
-        // Handle data transfer communication
-        else if (type() == ConnectionType::DataTransfer) {
-            // Disconnect if requested
-            if (isDisconnectPackage(RecvHeader.data())) {
-                setConnectedStatus(false);
-                Log::Info(std::format("File connection {} terminated", _id));
+        // Handle sync communication
+        if (_headerId == DataId || _headerId == DeltaId || _headerId == KeyframeId) {
+            const bool isResent = !_multicastFrames.empty();
+            if (isResent) {
+                setRecvFrame(_multicastFrames.front().frame);
+                _multicastFrames.pop_front();
+            }
+
+            auto decode = [this]() {
+                decodeSyncData(
+                    _headerId,
+                    _recvBuffer.data(),
+                    _dataSize,
+                    _uncompressedDataSize
+                );
+            };
+            if (_relayCallback) {
+                _relayCallback(_recvHeader, _recvBuffer.data(), _dataSize, decode);
             }
-            //  Handle communication
             else {
-                if (_headerId == DataId && _packageDecoderCallback && dataSize > 0) {
-                    _packageDecoderCallback(_recvBuffer.data(), dataSize, packageId, _id);
-
-                    // Send acknowledge
-                    uint32_t pLength = 0;
-                    std::array<char, HeaderSize> sendBuffer = {};
-                    sendBuffer[0] = Ack;
-                    std::memcpy(sendBuffer.data() + 1, &packageId, sizeof(packageId));
-                    std::memcpy(sendBuffer.data() + 5, &pLength, sizeof(pLength));
-                    sendData(sendBuffer.data(), HeaderSize);
-
-                    {
-                        // Clear the buffers
-                        const std::unique_lock lock(_connectionMutex);
-
-                        _recvBuffer.clear();
-                        _uncompressBuffer.clear();
-
-                        _bufferSize = 0;
-                        _uncompressedBufferSize = 0;
+                decode();
+            }
+            if (_arrivalCallback) {
+                _arrivalCallback();
+            }
+
+            if (isResent) {
+                // Continue with the frames that arrived while waiting for this one
+                receiveMulticastFrames();
+            }
+        }
+        else if (_headerId == Ack) {
+            handleAcknowledgement();
+            if (_arrivalCallback) {
+                _arrivalCallback();
+            }
+        }
+        else if (_headerId == MulticastId) {
+            // The frame itself is sent via multicast, the header only contains the frame
+            // number and the sequence number of the multicast frame and the payload the
+            // session of the sender
+            MulticastFrame f;
+            std::memcpy(&f.frame, _recvHeader.data() + 1, sizeof(f.frame));
+            std::memcpy(&f.sequence, _recvHeader.data() + 9, sizeof(f.sequence));
+            uint32_t session = 0;
+            std::memcpy(&session, _recvBuffer.data(), sizeof(session));
+            if (f.frame < 0) {
+                throw Err(
+                    5010,
+                    std::format("Error in sync frame {} for connection {}", f.frame, _id)
+                );
+            }
+            if (_multicastReceiver) {
+                _multicastReceiver->setSession(session);
+            }
+            _multicastFrames.push_back(f);
+
+            // If we are still waiting for a resent frame, this frame has to wait
+            receiveMulticastFrames();
+        }
+        else if (_headerId == Nack && _resendCallback) {
+            uint32_t sequence = 0;
+            std::memcpy(&sequence, _recvHeader.data() + 1, sizeof(sequence));
+            _resendCallback(*this, sequence);
+        }
+        else if (_headerId == ConnectedId && _connectedCallback) {
+            _connectedCallback();
+            NetworkManager::cond.notify_all();
+        }
+        else if (_headerId == SharedMemoryId) {
+            handleSharedMemoryMessage();
+        }
+    }
+    // Handle data transfer communication
+    else if (type() == ConnectionType::DataTransfer) {
+        // Disconnect if requested. The socket is closed once the other side closes it
+        if (isDisconnectPackage(_recvHeader.data())) {
+            setConnectedStatus(false);
+            Log::Info(std::format("File connection {} terminated", _id));
+        }
+        //  Handle communication
+        else if (_headerId == DataId &&
+                 ((_packageDecoderCallback && _dataSize > 0) || _packageSequence != 0))
+        {
+            // The cache and the decoder are handled on the `_decodeThread`, which takes
+            // over the receive buffer. The next package gets a buffer from the pool
+            ReceivedPackage package = {
+                .packageId = _packageId,
+                .sequence = _packageSequence,
+                .size = _dataSize
+            };
+            {
+                const std::unique_lock lock(_connectionMutex);
+                const auto it = _expectedContent.find(_packageId);
+                if (it != _expectedContent.end()) {
+                    if (_transferCache) {
+                        package.hash = it->second;
                     }
-                }
-                else if (_headerId == ConnectedId && _connectedCallback) {
-                    _connectedCallback();
-                    NetworkManager::cond.notify_all();
+                    _expectedContent.erase(it);
                 }
             }
+            package.data = takeReceiveBuffer();
+            queueReceivedPackage(std::move(package));
+        }
+        else if (_headerId == ChunkId) {
+            handleChunk();
+        }
+        else if (_headerId == ChunkAckId) {
+            handleChunkAcknowledgement();
+        }
+        else if (_headerId == ChunkResumeId) {
+            handleChunkResume();
+        }
+        else if (_headerId == ChunkResumeReplyId) {
+            handleChunkResumeReply();
+        }
+        else if (_headerId == ContentOfferId) {
+            handleContentOffer();
         }
-    } while (iResult > 0 || _isConnected);
+        else if (_headerId == ContentReplyId) {
+            handleContentReply();
+        }
+        else if (_headerId == ConnectedId && _connectedCallback) {
+            _connectedCallback();
+            NetworkManager::cond.notify_all();
+        }
+    }
+}
 
-    _recvBuffer.clear();
-    _uncompressBuffer.clear();
+void Network::sendData(const void* data, int length) const {
+    ZoneScoped;
 
-    // Close socket; contains mutex
-    closeSocket(_socket);
+    // Clients request lost multicast frames and the server resends them from the
+    // communication thread, which must not interleave with the main thread's messages
+    const std::unique_lock lock(_sendMutex);
+    sendLocked(data, length);
+}
 
-    if (_updateCallback) {
-        _updateCallback(*this);
+void Network::sendMessage(const std::array<char, HeaderSize>& header,
+                          std::span<const char> payload) const
+{
+    ZoneScoped;
+
+    const std::unique_lock lock(_sendMutex);
+    sendLocked(header.data(), static_cast<int>(header.size()));
+    sendPacedLocked(payload);
+}
+
+void Network::sendPackage(int packageId, std::span<const char> data,
+                          std::function<void(bool)> onAcknowledged)
+{
+    ZoneScoped;
+
+    uint32_t sequence = 0;
+    {
+        const std::unique_lock lock(_connectionMutex);
+        sequence = _nextPackageSequence++;
+        if (_nextPackageSequence == 0) {
+            // 0 marks the packages that are not numbered
+            _nextPackageSequence = 1;
+        }
+        _inFlightPackages.push_back({ sequence, std::move(onAcknowledged) });
     }
 
-    Log::Info(std::format("Node {} disconnected", _id));
+    const uint32_t size = static_cast<uint32_t>(data.size());
+    std::array<char, HeaderSize> header = {};
+    header[0] = DataId;
+    std::memcpy(header.data() + 1, &packageId, sizeof(packageId));
+    std::memcpy(header.data() + 5, &size, sizeof(size));
+    std::memcpy(header.data() + 9, &sequence, sizeof(sequence));
+    try {
+        sendMessage(header, data);
+    }
+    catch (const std::runtime_error&) {
+        // The package has failed right away, unless the connection was closed already
+        std::function<void(bool)> onFailed;
+        {
+            const std::unique_lock lock(_connectionMutex);
+            const auto it = std::find_if(
+                _inFlightPackages.begin(),
+                _inFlightPackages.end(),
+                [sequence](const InFlightPackage& p) { return p.sequence == sequence; }
+            );
+            if (it != _inFlightPackages.end()) {
+                onFailed = std::move(it->onAcknowledged);
+                _inFlightPackages.erase(it);
+            }
+        }
+        if (onFailed) {
+            onFailed(false);
+        }
+        throw;
+    }
 }
 
-void Network::sendData(const void* data, int length) const {
+void Network::offerContent(int packageId, uint64_t hash, uint64_t size,
+                           std::function<void(bool)> onReply)
+{
+    ZoneScoped;
+
+    {
+        const std::unique_lock lock(_connectionMutex);
+        _pendingOffers.push_back({ packageId, hash, std::move(onReply) });
+    }
+
+    std::array<char, HeaderSize + ContentOfferSize> message = {};
+    message[0] = ContentOfferId;
+    std::memcpy(message.data() + 1, &packageId, sizeof(packageId));
+    std::memcpy(message.data() + 5, &ContentOfferSize, sizeof(ContentOfferSize));
+    std::memcpy(message.data() + HeaderSize, &hash, sizeof(hash));
+    std::memcpy(message.data() + HeaderSize + sizeof(hash), &size, sizeof(size));
+    try {
+        sendData(message.data(), static_cast<int>(message.size()));
+    }
+    catch (const std::runtime_error&) {
+        // The offer is unanswered right away, unless the connection was closed already
+        std::function<void(bool)> onFailed;
+        {
+            const std::unique_lock lock(_connectionMutex);
+            const auto it = std::find_if(
+                _pendingOffers.begin(),
+                _pendingOffers.end(),
+                [packageId, hash](const PendingOffer& o) {
+                    return o.packageId == packageId && o.hash == hash;
+                }
+            );
+            if (it != _pendingOffers.end()) {
+                onFailed = std::move(it->onReply);
+                _pendingOffers.erase(it);
+            }
+        }
+        if (onFailed) {
+            onFailed(false);
+        }
+        throw;
+    }
+}
+
+int Network::transferWindowSpace() const {
+    const std::unique_lock lock(_connectionMutex);
+    return std::max(_transferWindow - static_cast<int>(_inFlightPackages.size()), 0);
+}
+
+void Network::sendChunk(int packageId, uint64_t offset, uint64_t totalSize,
+                        std::span<const char> data) const
+{
     ZoneScoped;
 
+    const std::array<char, HeaderSize + ChunkHeaderSize> header = chunkHeader(
+        packageId,
+        offset,
+        totalSize,
+        static_cast<uint32_t>(data.size())
+    );
+    const std::unique_lock lock(_sendMutex);
+    sendLocked(header.data(), static_cast<int>(header.size()));
+    sendPacedLocked(data);
+}
+
+void Network::sendLocked(const void* data, int length) const {
+    if (_isSendingSharedMemory) {
+        const std::span<const char> d(reinterpret_cast<const char*>(data), length);
+        if (!_sharedMemory->write({ d })) {
+            throw Err(5014, "Send data failed: Shared memory channel was closed");
+        }
+        return;
+    }
+
     long sendSize = length;
 
     while (sendSize > 0) {
@@ -749,7 +2060,7 @@ void Network::sendData(const void* data, int length) const {
             _socket,
             reinterpret_cast<const char*>(data) + offset,
             sendSize,
-            0
+            SendFlags
         );
         if (sentLen == SOCKET_ERROR) {
             throw Err(5014, std::format("Send data failed: {}", SGCT_ERRNO));
@@ -758,62 +2069,517 @@ void Network::sendData(const void* data, int length) const {
     }
 }
 
-void Network::closeNetwork(bool forced) {
+void Network::sendPacedLocked(std::span<const char> data) const {
+    // The shared memory channel doesn't use the network
+    if (!_bandwidthLimiter || _isSendingSharedMemory) {
+        sendLocked(data.data(), static_cast<int>(data.size()));
+        return;
+    }
+
+    while (!data.empty()) {
+        const size_t size = std::min(data.size(), BandwidthLimiter::SliceSize);
+        _bandwidthLimiter->acquire(size);
+        sendLocked(data.data(), static_cast<int>(size));
+        data = data.subspan(size);
+    }
+}
+
+std::vector<double> Network::sendToAll(const std::vector<Network*>& connections,
+                                 const std::vector<std::array<char, HeaderSize>>& headers,
+                                       const void* payload, int length)
+{
+    ZoneScoped;
+
+    using namespace std::chrono;
+    const steady_clock::time_point start = steady_clock::now();
+    auto elapsed = [&start]() {
+        return duration<double>(steady_clock::now() - start).count();
+    };
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(connections.size());
+    for (Network* connection : connections) {
+        locks.emplace_back(connection->_sendMutex);
+    }
+
+    const char* data = reinterpret_cast<const char*>(payload);
+    const size_t total = HeaderSize + length;
+    std::vector<size_t> sent(connections.size(), 0);
+    std::vector<double> times(connections.size(), 0.0);
+
+    // Nodes on the same machine only need the data to be copied into their channel
+    for (size_t i = 0; i < connections.size(); i++) {
+        if (!connections[i]->_isSendingSharedMemory) {
+            continue;
+        }
+
+        const bool isWritten = connections[i]->_sharedMemory->write({
+            std::span<const char>(headers[i]),
+            std::span<const char>(data, length)
+        });
+        if (!isWritten) {
+            throw Err(5014, "Send data failed: Shared memory channel was closed");
+        }
+        sent[i] = total;
+        times[i] = elapsed();
+    }
+
+#ifdef WIN32
+    // Non-blocking sockets would also affect the receiving thread on Windows, so every
+    // connection gets an overlapped send instead. All of them are in progress at the
+    // same time, so that a node that is slow to receive doesn't delay the others
+    std::vector<WSAOVERLAPPED> overlapped(connections.size());
+    // Whether the send to a connection is in progress and its buffers are still in use
+    std::vector<bool> isInProgress(connections.size(), false);
+    std::vector<size_t> pending;
+    pending.reserve(connections.size());
+    auto post = [&](size_t i) {
+        std::array<WSABUF, 2> buffers;
+        DWORD nBuffers = 0;
+        if (sent[i] < HeaderSize) {
+            buffers[nBuffers].buf = const_cast<char*>(headers[i].data() + sent[i]);
+            buffers[nBuffers].len = static_cast<ULONG>(HeaderSize - sent[i]);
+            nBuffers++;
+        }
+        const size_t offset = sent[i] > HeaderSize ? sent[i] - HeaderSize : 0;
+        buffers[nBuffers].buf = const_cast<char*>(data + offset);
+        buffers[nBuffers].len = static_cast<ULONG>(length - offset);
+        nBuffers++;
+
+        // The event is signaled even if the send completes right away
+        const int res = WSASend(
+            connections[i]->_socket,
+            buffers.data(),
+            nBuffers,
+            nullptr,
+            0,
+            &overlapped[i],
+            nullptr
+        );
+        if (res == SOCKET_ERROR && SGCT_ERRNO != WSA_IO_PENDING) {
+            throw Err(5014, std::format("Send data failed: {}", SGCT_ERRNO));
+        }
+        isInProgress[i] = true;
+    };
+    auto closeEvents = [&overlapped]() {
+        for (WSAOVERLAPPED& o : overlapped) {
+            if (o.hEvent) {
+                WSACloseEvent(o.hEvent);
+            }
+        }
+    };
+
+    try {
+        for (size_t i = 0; i < connections.size(); i++) {
+            if (sent[i] == total) {
+                continue;
+            }
+
+            overlapped[i].hEvent = WSACreateEvent();
+            if (overlapped[i].hEvent == WSA_INVALID_EVENT) {
+                throw Err(5014, std::format("Send data failed: {}", SGCT_ERRNO));
+            }
+            pending.push_back(i);
+            post(i);
+        }
+
+        std::vector<WSAEVENT> events;
+        while (!pending.empty()) {
+            // Only a limited number of events can be waited for at once, the remaining
+            // sends continue in the meantime
+            const size_t nEvents =
+                std::min<size_t>(pending.size(), WSA_MAXIMUM_WAIT_EVENTS);
+            events.clear();
+            for (size_t k = 0; k < nEvents; k++) {
+                events.push_back(overlapped[pending[k]].hEvent);
+            }
+            const DWORD res = WSAWaitForMultipleEvents(
+                static_cast<DWORD>(nEvents),
+                events.data(),
+                FALSE,
+                WSA_INFINITE,
+                FALSE
+            );
+            if (res == WSA_WAIT_FAILED) {
+                throw Err(
+                    5040,
+                    std::format("Waiting for sockets failed: {}", SGCT_ERRNO)
+                );
+            }
+
+            const size_t k = res - WSA_WAIT_EVENT_0;
+            const size_t i = pending[k];
+            DWORD sentLen = 0;
+            DWORD flags = 0;
+            const BOOL isSent = WSAGetOverlappedResult(
+                connections[i]->_socket,
+                &overlapped[i],
+                &sentLen,
+                FALSE,
+                &flags
+            );
+            isInProgress[i] = false;
+            if (!isSent) {
+                throw Err(5014, std::format("Send data failed: {}", SGCT_ERRNO));
+            }
+            WSAResetEvent(overlapped[i].hEvent);
+            sent[i] += sentLen;
+            if (sent[i] < total) {
+                post(i);
+            }
+            else {
+                times[i] = elapsed();
+                pending.erase(pending.begin() + k);
+            }
+        }
+    }
+    catch (const Error&) {
+        // The buffers of the sends that are still in progress have to outlive them
+        for (size_t i : pending) {
+            if (!isInProgress[i]) {
+                continue;
+            }
+            HANDLE s = reinterpret_cast<HANDLE>(connections[i]->_socket);
+            CancelIoEx(s, &overlapped[i]);
+            DWORD sentLen = 0;
+            DWORD flags = 0;
+            WSAGetOverlappedResult(
+                connections[i]->_socket,
+                &overlapped[i],
+                &sentLen,
+                TRUE,
+                &flags
+            );
+        }
+        closeEvents();
+        throw;
+    }
+    closeEvents();
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    std::vector<size_t> pending;
+    pending.reserve(connections.size());
+    for (size_t i = 0; i < connections.size(); i++) {
+        if (sent[i] < total) {
+            pending.push_back(i);
+        }
+    }
+    std::vector<pollfd> fds;
+    fds.reserve(connections.size());
+
+    while (!pending.empty()) {
+        // Write as much as every socket accepts and wait for the remaining sockets to
+        // become writable again
+        auto it = std::remove_if(
+            pending.begin(),
+            pending.end(),
+            [&](size_t i) {
+                while (sent[i] < total) {
+                    std::array<iovec, 2> buffers;
+                    size_t nBuffers = 0;
+                    if (sent[i] < HeaderSize) {
+                        buffers[nBuffers].iov_base =
+                            const_cast<char*>(headers[i].data() + sent[i]);
+                        buffers[nBuffers].iov_len = HeaderSize - sent[i];
+                        nBuffers++;
+                    }
+                    const size_t offset = sent[i] > HeaderSize ? sent[i] - HeaderSize : 0;
+                    buffers[nBuffers].iov_base = const_cast<char*>(data + offset);
+                    buffers[nBuffers].iov_len = length - offset;
+                    nBuffers++;
+
+                    msghdr message = {};
+                    message.msg_iov = buffers.data();
+                    message.msg_iovlen = nBuffers;
+                    const long sentLen = sendmsg(
+                        connections[i]->_socket,
+                        &message,
+                        MSG_DONTWAIT | SendFlags
+                    );
+                    if (sentLen == SOCKET_ERROR) {
+                        if (SGCT_ERRNO == EAGAIN || SGCT_ERRNO == EWOULDBLOCK) {
+                            return false;
+                        }
+                        if (SGCT_ERRNO == EINTR) {
+                            continue;
+                        }
+                        throw Err(5014, std::format("Send data failed: {}", SGCT_ERRNO));
+                    }
+                    sent[i] += sentLen;
+                }
+                times[i] = elapsed();
+                return true;
+            }
+        );
+        pending.erase(it, pending.end());
+        if (pending.empty()) {
+            break;
+        }
+
+        fds.clear();
+        for (size_t i : pending) {
+            fds.push_back({ connections[i]->_socket, POLLOUT, 0 });
+        }
+        const int res = poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+        if (res == SOCKET_ERROR && SGCT_ERRNO != EINTR) {
+            throw Err(5040, std::format("Waiting for sockets failed: {}", SGCT_ERRNO));
+        }
+    }
+#endif // WIN32
+
+    return times;
+}
+
+void Network::offerSharedMemory() {
+    try {
+        _sharedMemory = std::make_unique<SharedMemoryChannel>(
+            SharedMemoryChannel::uniqueName(_port),
+            SharedMemoryChannel::Mode::Create
+        );
+    }
+    catch (const Error& e) {
+        Log::Debug(std::format(
+            "Connection {} can't use shared memory: {}", _id, e.message
+        ));
+        return;
+    }
+
+    const std::string& name = _sharedMemory->name();
+    const std::array<char, HeaderSize> header = sharedMemoryHeader(
+        SharedMemoryMessage::Offer,
+        static_cast<uint32_t>(name.size())
+    );
+    std::vector<char> message(header.begin(), header.end());
+    message.insert(message.end(), name.begin(), name.end());
+    sendData(message.data(), static_cast<int>(message.size()));
+}
+
+void Network::handleSharedMemoryMessage() {
+    int32_t message = 0;
+    std::memcpy(&message, _recvHeader.data() + 1, sizeof(message));
+
+    switch (static_cast<SharedMemoryMessage>(message)) {
+        case SharedMemoryMessage::Offer:
+        {
+            // The channel can only be opened if the server is on the same machine
+            bool isOpen = false;
+            if (_useSharedMemory) {
+                try {
+                    _sharedMemory = std::make_unique<SharedMemoryChannel>(
+                        std::string(_recvBuffer.data(), _dataSize),
+                        SharedMemoryChannel::Mode::Open
+                    );
+                    isOpen = true;
+                }
+                catch (const Error& e) {
+                    Log::Debug(std::format(
+                        "Connection {} can't use shared memory: {}", _id, e.message
+                    ));
+                }
+            }
+
+            // All messages after the acceptance are sent through the channel
+            const std::array<char, HeaderSize> reply = sharedMemoryHeader(
+                isOpen ? SharedMemoryMessage::Accept : SharedMemoryMessage::Reject,
+                0
+            );
+            const std::unique_lock lock(_sendMutex);
+            sendLocked(reply.data(), HeaderSize);
+            _isSendingSharedMemory = isOpen;
+            break;
+        }
+        case SharedMemoryMessage::Accept:
+        {
+            if (!_sharedMemory) {
+                break;
+            }
+
+            // Both sides have opened the channel, so the names are no longer needed
+            _sharedMemory->unlink();
+            startReceivingSharedMemory();
+
+            const std::array<char, HeaderSize> reply =
+                sharedMemoryHeader(SharedMemoryMessage::Switch, 0);
+            {
+                const std::unique_lock lock(_sendMutex);
+                sendLocked(reply.data(), HeaderSize);
+                _isSendingSharedMemory = true;
+            }
+            Log::Info(std::format("Connection {} uses shared memory", _id));
+            break;
+        }
+        case SharedMemoryMessage::Reject:
+            closeSharedMemory();
+            break;
+        case SharedMemoryMessage::Switch:
+            if (_sharedMemory) {
+                startReceivingSharedMemory();
+                Log::Info(std::format("Connection {} uses shared memory", _id));
+            }
+            break;
+        default:
+            throw Err(5054, std::format("Unknown shared memory message {}", message));
+    }
+}
+
+void Network::startReceivingSharedMemory() {
+    _isReceivingSharedMemory = true;
+    NetworkReactor::instance().add(
+        _sharedMemory->notification(),
+        [this]() { receiveSharedMemoryMessages(); }
+    );
+
+    // No notification is sent for the messages that were written before this side
+    // waited for them for the first time
+    receiveSharedMemoryMessages();
+}
+
+void Network::closeSharedMemory() {
+    if (!_sharedMemory) {
+        return;
+    }
+
+    // Closing the channel stops a send that waits for space in the channel, which
+    // would otherwise hold the `_sendMutex`
+    _sharedMemory->close();
+    NetworkReactor::instance().remove(_sharedMemory->notification());
+    _isReceivingSharedMemory = false;
+
+    // Only this thread switches the sending to the channel, so the `_sendMutex` is only
+    // needed if messages are sent through it. A send to all connections holds the mutex
+    // until the receiving thread has read from the other connections, so a rejected offer
+    // must not wait for it
+    if (_isSendingSharedMemory) {
+        const std::unique_lock lock(_sendMutex);
+        _isSendingSharedMemory = false;
+    }
+    _sharedMemory = nullptr;
+}
+
+void Network::closeNetwork() {
     ZoneScoped;
 
+    // Once the sockets are removed from the reactor and the `_decodeThread` is stopped,
+    // none of the callbacks are running
+    stopConnecting();
+    NetworkReactor::instance().remove(_socket);
+    NetworkReactor::instance().remove(_listenSocket);
+    if (_multicastReceiver) {
+        NetworkReactor::instance().remove(_multicastReceiver->notification());
+    }
+    closeSharedMemory();
+    stopDecoding();
+    failInFlightPackages();
+
     decoderCallback = nullptr;
+    _deltaDecoderCallback = nullptr;
+    _keyframeDecoderCallback = nullptr;
     _updateCallback = nullptr;
     _connectedCallback = nullptr;
     _acknowledgeCallback = nullptr;
+    _chunkDecoderCallback = nullptr;
+    _chunkAcknowledgeCallback = nullptr;
+    _transferWindowCallback = nullptr;
+    _resendCallback = nullptr;
+    _arrivalCallback = nullptr;
+    _relayCallback = nullptr;
     _packageDecoderCallback = nullptr;
 
     // Release conditions
     NetworkManager::cond.notify_all();
     _startConnectionCond.notify_all();
 
-    // Blocking sockets -> cannot wait for thread so just kill it brutally
+    Log::Info(std::format("Connection {} successfully terminated", _id));
+}
+
+void Network::InflateDeleter::operator()(z_stream_s* stream) const {
+    inflateEnd(stream);
+    delete stream;
+}
+
+void Network::AddressDeleter::operator()(addrinfo* address) const {
+    freeaddrinfo(address);
+}
 
-    if (_commThread && !forced) {
-        _commThread->join();
+void Network::sendDisconnect() {
+    if (!_isConnected || _isDisconnectSent.exchange(true)) {
+        return;
     }
-    _commThread = nullptr;
 
-    if (_mainThread && !forced) {
-        _mainThread->join();
+    constexpr std::array<char, HeaderSize> GameOver = {
+        DisconnectId, 24, '\r', '\n', 27, '\r', '\n', '\0', DefaultId
+    };
+    try {
+        sendData(GameOver.data(), HeaderSize);
+    }
+    catch (const Error&) {
+        // The other side has closed the connection already
+        return;
     }
-    _mainThread = nullptr;
 
-    Log::Info(std::format("Connection {} successfully terminated", _id));
+    // The other side receives the end of the stream after the disconnect message
+    const std::unique_lock lock(_sendMutex);
+    if (_socket != INVALID_SOCKET) {
+#ifdef WIN32
+        shutdown(_socket, SD_SEND);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        shutdown(_socket, SHUT_WR);
+#endif // WIN32
+    }
 }
 
 void Network::initShutdown() {
+    initShutdown(std::chrono::steady_clock::now() + ShutdownTimeout);
+}
+
+void Network::initShutdown(std::chrono::steady_clock::time_point deadline) {
     ZoneScoped;
 
-    if (_isConnected) {
-        constexpr std::array<char, 9> GameOver = {
-            DisconnectId, 24, '\r', '\n', 27, '\r', '\n', '\0', DefaultId
-        };
-        sendData(GameOver.data(), HeaderSize);
+    Log::Info(std::format("Closing connection {}", _id));
+
+    stopConnecting();
+
+    // The other side closes the connection once it received the disconnect message,
+    // which the reactor handles like any other disconnect. The reactor's thread itself
+    // can't wait for that
+    sendDisconnect();
+    if (!NetworkReactor::instance().isReactorThread()) {
+        std::unique_lock lock(_connectionMutex);
+        _closedCond.wait_until(lock, deadline, [this]() { return _isClosed; });
     }
+    _isConnected = false;
 
-    Log::Info(std::format("Closing connection {}", _id));
+    // Removing the connected socket first waits for a disconnect that is currently being
+    // handled, which might otherwise start listening again
+    SGCT_SOCKET s = INVALID_SOCKET;
+    {
+        const std::unique_lock lock(_sendMutex);
+        s = _socket;
+    }
+    NetworkReactor::instance().remove(s);
+    NetworkReactor::instance().remove(_listenSocket);
+    if (_multicastReceiver) {
+        NetworkReactor::instance().remove(_multicastReceiver->notification());
+    }
+    closeSharedMemory();
+    stopDecoding();
 
     {
         ZoneScopedN("Decoder callback lock");
         const std::unique_lock lock(_connectionMutex);
         decoderCallback = nullptr;
+        _deltaDecoderCallback = nullptr;
+        _keyframeDecoderCallback = nullptr;
+        _relayCallback = nullptr;
     }
 
-    _isConnected = false;
-    _shouldTerminate = true;
-
-    // Wake up the connection handler thread (in order to finish)
-    if (_isServer) {
-        _startConnectionCond.notify_all();
+    {
+        const std::unique_lock lock(_sendMutex);
+        s = INVALID_SOCKET;
+        std::swap(s, _socket);
     }
-
-    closeSocket(_socket);
+    closeSocket(s);
     closeSocket(_listenSocket);
+    _listenSocket = INVALID_SOCKET;
 }
 
 } // namespace sgct
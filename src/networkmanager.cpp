@@ -17,17 +17,24 @@
 #include <sgct/error.h>
 #include <sgct/format.h>
 #include <sgct/log.h>
+#include <sgct/multicast.h>
 #include <sgct/mutexes.h>
+#include <sgct/networkreactor.h>
 #include <sgct/node.h>
 #include <sgct/profiling.h>
 #include <sgct/shareddata.h>
+#include <sgct/syncrecording.h>
+#include <sgct/transfercache.h>
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstring>
+#include <fstream>
+#include <iterator>
 #include <limits>
+#include <mutex>
+#include <span>
 #include <stdexcept>
-#include <thread>
 
 #ifdef WIN32
 #include <ws2def.h>
@@ -40,34 +47,123 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // __linux__
 #endif // WIN32
 
 #define Err(code, msg) Error(Error::Component::Network, code, msg)
 
 namespace {
 
-    void prepareTransferData(const void* data, std::vector<char>& buffer, int& length,
-                             int packageId)
+    // The header of a package that is sent with `transferData`. The payload is sent
+    // after the header directly from the caller's memory
+    std::array<char, sgct::Network::HeaderSize> transferHeader(int length, int packageId)
     {
-        int messageLength = length;
+        std::array<char, sgct::Network::HeaderSize> header = {};
+        header[0] = sgct::Network::DataId;
+        std::memcpy(header.data() + 1, &packageId, sizeof(packageId));
+        std::memcpy(header.data() + 5, &length, sizeof(length));
 
-        length += static_cast<int>(sgct::Network::HeaderSize);
-        buffer.resize(length);
+        // Set uncompressed size to DefaultId since compression is not used
+        std::memset(header.data() + 9, sgct::Network::DefaultId, sizeof(int));
+        return header;
+    }
 
-        buffer[0] = sgct::Network::DataId;
-        std::memcpy(buffer.data() + 1, &packageId, sizeof(packageId));
+#ifdef __linux__
+    // A file that is mapped into memory while it is transferred, so that the chunks are
+    // sent directly from the page cache without reading them into a buffer first
+    struct FileMapping {
+        ~FileMapping() {
+            if (data) {
+                munmap(data, size);
+            }
+        }
 
-        // Set uncompressed size to DefaultId since compression is not used
-        std::memset(buffer.data() + 9, sgct::Network::DefaultId, sizeof(int));
+        void* data = nullptr;
+        size_t size = 0;
+    };
+#endif // __linux__
+
+    // Returns the host name and the addresses of this computer, all in lower case
+    std::vector<std::string> lookUpLocalAddresses() {
+        using namespace sgct;
+
+        ZoneScoped;
 
-        // Add data to buffer
-        std::memcpy(
-            buffer.data() + sgct::Network::HeaderSize,
-            data,
-            length - sgct::Network::HeaderSize
+        std::vector<std::string> addresses;
+
+        // Get name & local IPs. retrieves the standard host name for the local computer
+        std::array<char, 256> Buffer = {};
+        {
+            ZoneScopedN("gethostname");
+#ifdef WIN32
+            const int res = gethostname(Buffer.data(), static_cast<int>(Buffer.size()));
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            const size_t res = gethostname(Buffer.data(), Buffer.size());
+#endif // WIN32
+            if (res != 0) {
+                throw Err(5027, "Failed to get local host name");
+            }
+        }
+
+        std::string hostName = Buffer.data();
+        // Add hostname and adress in lower case
+        std::transform(
+            hostName.cbegin(),
+            hostName.cend(),
+            hostName.begin(),
+            [](char c) { return static_cast<char>(::tolower(c)); }
         );
+        addresses.push_back(hostName);
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        // hints.ai_family = AF_UNSPEC; // either IPV4 or IPV6
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_CANONNAME;
+
+        addrinfo* info = nullptr;
+        {
+            ZoneScopedN("getaddrinfo");
+            const int result = getaddrinfo(Buffer.data(), "http", &hints, &info);
+            if (result != 0) {
+                std::string err = std::to_string(Network::lastError());
+                throw Err(5028, std::format("Failed to get address info: {}", err));
+            }
+        }
+        std::vector<std::string> dnsNames;
+        std::array<char, INET_ADDRSTRLEN> addr = {};
+        for (addrinfo* p = info; p != nullptr; p = p->ai_next) {
+            ZoneScopedN("inet_ntop");
+            sockaddr_in* sockaddr_ipv4 = reinterpret_cast<sockaddr_in*>(p->ai_addr);
+            inet_ntop(AF_INET, &sockaddr_ipv4->sin_addr, addr.data(), INET_ADDRSTRLEN);
+            if (p->ai_canonname) {
+                dnsNames.emplace_back(p->ai_canonname);
+            }
+            // Using .data() instead of .begin() + .end() to stop at the first \0
+            addresses.emplace_back(addr.data());
+        }
+
+        freeaddrinfo(info);
+
+        for (std::string& dns : dnsNames) {
+            std::transform(
+                dns.cbegin(),
+                dns.cend(),
+                dns.begin(),
+                [](char c) { return static_cast<char>(::tolower(c)); }
+            );
+            addresses.push_back(std::move(dns));
+        }
 
-        std::memcpy(buffer.data() + 5, &messageLength, sizeof(messageLength));
+        // Add the loop-back
+        addresses.emplace_back("127.0.0.1");
+        addresses.emplace_back("localhost");
+        return addresses;
     }
 } // namespace
 
@@ -84,7 +180,9 @@ NetworkManager& NetworkManager::instance() {
 void NetworkManager::create(NetworkMode nm,
                             std::function<void(void*, int, int, int)> dataTransferDecode,
                             std::function<void(bool, int)> dataTransferStatus,
-                            std::function<void(int, int)> dataTransferAcknowledge)
+                            std::function<void(int, int)> dataTransferAcknowledge,
+    std::function<void(const char*, int, int, uint64_t, uint64_t, int)> dataTransferChunk,
+                   std::function<void(int, uint64_t, uint64_t, int)> dataTransferProgress)
 {
     ZoneScoped;
 
@@ -95,7 +193,9 @@ void NetworkManager::create(NetworkMode nm,
         nm,
         std::move(dataTransferDecode),
         std::move(dataTransferStatus),
-        std::move(dataTransferAcknowledge)
+        std::move(dataTransferAcknowledge),
+        std::move(dataTransferChunk),
+        std::move(dataTransferProgress)
     );
 }
 
@@ -107,10 +207,14 @@ void NetworkManager::destroy() {
 NetworkManager::NetworkManager(NetworkMode nm,
                              std::function<void(void*, int, int, int)> dataTransferDecode,
                                         std::function<void(bool, int)> dataTransferStatus,
-                                    std::function<void(int, int)> dataTransferAcknowledge)
+                                    std::function<void(int, int)> dataTransferAcknowledge,
+    std::function<void(const char*, int, int, uint64_t, uint64_t, int)> dataTransferChunk,
+                   std::function<void(int, uint64_t, uint64_t, int)> dataTransferProgress)
     : _dataTransferDecodeFn(std::move(dataTransferDecode))
     , _dataTransferStatusFn(std::move(dataTransferStatus))
     , _dataTransferAcknowledgeFn(std::move(dataTransferAcknowledge))
+    , _dataTransferChunkFn(std::move(dataTransferChunk))
+    , _dataTransferProgressFn(std::move(dataTransferProgress))
     , _mode(nm)
 {
     ZoneScoped;
@@ -131,108 +235,62 @@ NetworkManager::NetworkManager(NetworkMode nm,
     }
 #endif // WIN32
 
+    // Looking up the addresses can take a while if the host name has to be resolved via
+    // DNS, so it is done in the background until the addresses are first needed
     Log::Debug("Getting host info");
+    _localAddressesLookup = std::async(std::launch::async, lookUpLocalAddresses);
+}
 
-    //
-    // Get host info
-    //
-    // Get name & local IPs. retrieves the standard host name for the local computer
-    std::array<char, 256> Buffer = {};
-    {
-        ZoneScopedN("gethostname");
-#ifdef WIN32
-        const int res = gethostname(Buffer.data(), static_cast<int>(Buffer.size()));
-#else // ^^^^ WIN32 // !WIN32 vvvv
-        const size_t res = gethostname(Buffer.data(), Buffer.size());
-#endif // WIN32
-        if (res != 0) {
-#ifdef WIN32
-            WSACleanup();
-#endif // WIN32
-            throw Err(5027, "Failed to get local host name");
-        }
-    }
+NetworkManager::~NetworkManager() {
+    ZoneScoped;
 
-    std::string hostName = Buffer.data();
-    // Add hostname and adress in lower case
-    std::transform(
-        hostName.cbegin(),
-        hostName.cend(),
-        hostName.begin(),
-        [](char c) { return static_cast<char>(::tolower(c)); }
-    );
-    _localAddresses.push_back(hostName);
+    _isRunning = false;
+    cond.notify_all();
+    _syncBarrier.release();
 
-    addrinfo hints;
-    std::memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    // hints.ai_family = AF_UNSPEC; // either IPV4 or IPV6
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_flags = AI_CANONNAME;
+    // A transfer that waits for its share of the bandwidth would delay the shutdown
+    _bandwidthLimiter.stop();
 
-    addrinfo* info = nullptr;
     {
-        ZoneScopedN("getaddrinfo");
-        const int result = getaddrinfo(Buffer.data(), "http", &hints, &info);
-        if (result != 0) {
-            std::string err = std::to_string(Network::lastError());
-            throw Err(5028, std::format("Failed to get address info: {}", err));
-        }
+        const std::unique_lock lock(_transferMutex);
+        _isTransferRunning = false;
     }
-    std::vector<std::string> dnsNames;
-    std::array<char, INET_ADDRSTRLEN> addr = {};
-    for (addrinfo* p = info; p != nullptr; p = p->ai_next) {
-        ZoneScopedN("inet_ntop");
-        sockaddr_in* sockaddr_ipv4 = reinterpret_cast<sockaddr_in*>(p->ai_addr);
-        inet_ntop(AF_INET, &sockaddr_ipv4->sin_addr, addr.data(), INET_ADDRSTRLEN);
-        if (p->ai_canonname) {
-            dnsNames.emplace_back(p->ai_canonname);
-        }
-        // Using .data() instead of .begin() + .end() as we want to stop at the first \0
-        _localAddresses.emplace_back(addr.data());
+    _transferCond.notify_all();
+    if (_transferThread.joinable()) {
+        _transferThread.join();
     }
 
-    freeaddrinfo(info);
-
-    for (std::string& dns : dnsNames) {
-        std::transform(
-            dns.cbegin(),
-            dns.cend(),
-            dns.begin(),
-            [](char c) { return static_cast<char>(::tolower(c)); }
-        );
-        _localAddresses.push_back(std::move(dns));
+    // A frame that is being relayed is still sent completely, the queued ones are not
+    {
+        const std::unique_lock lock(_relayMutex);
+        _isRelayRunning = false;
     }
-
-    // Add the loop-back
-    _localAddresses.emplace_back("127.0.0.1");
-    _localAddresses.emplace_back("localhost");
-
-    Log::Debug("Detected local addresses:");
-    for (const std::string& address : _localAddresses) {
-        Log::Debug(std::format("  {}", address));
+    _relayCond.notify_all();
+    if (_relayThread.joinable()) {
+        _relayThread.join();
     }
-}
-
-NetworkManager::~NetworkManager() {
-    ZoneScoped;
 
-    _isRunning = false;
-    cond.notify_all();
-
-    // Signal to terminate
+    // All nodes are told about the shutdown before waiting for any of them to close its
+    // connection, so that all connections are closed after a single round trip. Nodes
+    // that don't respond share a single timeout. Once a connection is shut down, none of
+    // its callbacks are running anymore
     for (const std::unique_ptr<Network>& connection : _networkConnections) {
-        connection->initShutdown();
+        connection->sendDisconnect();
+    }
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + Network::ShutdownTimeout;
+    for (const std::unique_ptr<Network>& connection : _networkConnections) {
+        connection->initShutdown(deadline);
     }
 
-    // Wait for all nodes callbacks to run
-    {
-        // @TODO (abock, 2019-12-20) We can probably remove this waiting altogether. The
-        // node callbacks are run synchronously with this function, and either way, what
-        // if the callbacks take longer and we crash anyway?
-        ZoneScopedN("Sleeping");
-        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    // The packages that were sent are failed when their connection is shut down, the
+    // packages that are still queued are failed here
+    for (const std::shared_ptr<AsyncTransfer>& transfer : _asyncTransfers) {
+        for (size_t i = 0; i < transfer->connections.size(); i++) {
+            transfer->complete(false);
+        }
     }
+    _asyncTransfers.clear();
 
     _networkConnections.clear();
     _syncConnections.clear();
@@ -283,9 +341,23 @@ void NetworkManager::initialize() {
 
     // If faking an address (running local) then add it to the search list
     if (_mode != NetworkMode::Remote) {
+        waitForLocalAddresses();
         _localAddresses.push_back(cm.thisNode().address());
     }
 
+    // Nodes on the same machine exchange the shared data through shared memory
+    auto isLocal = [this](std::string_view address) {
+        return _mode != NetworkMode::Remote || matchesAddress(address);
+    };
+
+    if (cm.transferBandwidth()) {
+        // The budget is configured in Mbit/s
+        _bandwidthLimiter.setRate(*cm.transferBandwidth() * 1e6 / 8.0);
+    }
+    if (cm.transferCache()) {
+        _transferCache = std::make_unique<TransferCache>(*cm.transferCache());
+    }
+
     // Add Cluster Functionality
     if (ClusterManager::instance().numberOfNodes() > 1) {
         ZoneScopedN("Create cluster connections");
@@ -307,9 +379,27 @@ void NetworkManager::initialize() {
 
         // If client
         if (!_isServer) {
-            addConnection(cm.thisNode().syncPort(), remoteAddress);
+            // The shared data is received from the parent node if there is one, which
+            // relays it from the server. The data transfer is always done by the server
+            std::string syncAddress = remoteAddress;
+            if (cm.thisNode().parent() >= 0 && _mode == NetworkMode::Remote) {
+                syncAddress = cm.node(cm.thisNode().parent()).address();
+            }
+            addConnection(
+                cm.thisNode().syncPort(),
+                syncAddress,
+                false,
+                Network::ConnectionType::SyncConnection,
+                isLocal(syncAddress)
+            );
             _networkConnections.back()->setDecodeFunction(
-                std::bind_front(&SharedData::decode, SharedData::instance())
+                std::bind_front(&SharedData::decode, &SharedData::instance())
+            );
+            _networkConnections.back()->setDeltaDecodeFunction(
+                std::bind_front(&SharedData::decodeDelta, &SharedData::instance())
+            );
+            _networkConnections.back()->setKeyframeDecodeFunction(
+                std::bind_front(&SharedData::decodeKeyframe, &SharedData::instance())
             );
 
             // Add data transfer connection
@@ -317,6 +407,7 @@ void NetworkManager::initialize() {
                 addConnection(
                     cm.thisNode().dataTransferPort(),
                     remoteAddress,
+                    false,
                     Network::ConnectionType::DataTransfer
                 );
                 if (_dataTransferDecodeFn) {
@@ -331,6 +422,18 @@ void NetworkManager::initialize() {
                         _dataTransferAcknowledgeFn
                     );
                 }
+
+                // Chunked transfer callbacks
+                if (_dataTransferChunkFn) {
+                    _networkConnections.back()->setChunkDecodeFunction(
+                        _dataTransferChunkFn
+                    );
+                }
+                if (_dataTransferProgressFn) {
+                    _networkConnections.back()->setChunkAcknowledgeFunction(
+                        _dataTransferProgressFn
+                    );
+                }
             }
         }
 
@@ -338,23 +441,45 @@ void NetworkManager::initialize() {
         for (int i = 0; i < cm.numberOfNodes(); i++) {
             const Node& n = cm.node(i);
 
+            // Nodes with a parent receive the shared data from their parent instead of
+            // the server, which makes the parent a relay for them
+            if (!_isServer && n.parent() == cm.thisNodeId()) {
+                addConnection(
+                    n.syncPort(),
+                    cm.thisNode().address(),
+                    true,
+                    Network::ConnectionType::SyncConnection,
+                    isLocal(n.address())
+                );
+                _relayConnections.push_back(_networkConnections.back().get());
+            }
+
             // Don't add itself if server
             if (_isServer && !matchesAddress(n.address())) {
-                addConnection(n.syncPort(), remoteAddress);
+                if (n.parent() < 0 || n.parent() == cm.thisNodeId()) {
+                    addConnection(
+                        n.syncPort(),
+                        remoteAddress,
+                        true,
+                        Network::ConnectionType::SyncConnection,
+                        isLocal(n.address())
+                    );
 
-                _networkConnections.back()->setDecodeFunction(
-                    [](const char* data, int length) {
-                        std::vector<char> d(data, data + length);
-                        d.push_back('\0');
-                        Log::Info(std::format("[client]: {} [end]", d.data()));
-                    }
-                );
+                    _networkConnections.back()->setDecodeFunction(
+                        [](const char* data, int length) {
+                            std::vector<char> d(data, data + length);
+                            d.push_back('\0');
+                            Log::Info(std::format("[client]: {} [end]", d.data()));
+                        }
+                    );
+                }
 
                 // Add data transfer connection
                 if (n.dataTransferPort() != 0 && !remoteAddress.empty()) {
                     addConnection(
                         n.dataTransferPort(),
                         remoteAddress,
+                        true,
                         Network::ConnectionType::DataTransfer
                     );
                     if (_dataTransferDecodeFn) {
@@ -369,63 +494,251 @@ void NetworkManager::initialize() {
                             _dataTransferAcknowledgeFn
                         );
                     }
+
+                    // Chunked transfer callbacks
+                    if (_dataTransferChunkFn) {
+                        _networkConnections.back()->setChunkDecodeFunction(
+                            _dataTransferChunkFn
+                        );
+                    }
+                    if (_dataTransferProgressFn) {
+                        _networkConnections.back()->setChunkAcknowledgeFunction(
+                            _dataTransferProgressFn
+                        );
+                    }
                 }
             }
         }
     }
 
-    Log::Debug(
-        std::format("Cluster sync: {}", cm.firmFrameLockSyncStatus() ? "firm" : "loose")
-    );
+    if (!_relayConnections.empty()) {
+        Log::Info(std::format(
+            "Relaying the shared data to {} nodes", _relayConnections.size()
+        ));
+        _syncConnections.front()->setRelayFunction(
+            [this](const std::array<char, Network::HeaderSize>& header, const char* data,
+                   uint32_t size, const std::function<void()>& decode)
+            {
+                relayFrame(header, data, size, decode);
+            }
+        );
+        _relayThread = std::thread([this]() { sendRelayedFrames(); });
+    }
+
+    if (cm.multicast() && !_syncConnections.empty()) {
+        ZoneScopedN("Create multicast");
+        const config::Multicast& m = *cm.multicast();
+        if (_isServer) {
+            _multicastSender = std::make_unique<MulticastSender>(
+                m.address,
+                m.port,
+                m.interfaceAddress.value_or(""),
+                m.datagramSize.value_or(MulticastSender::DefaultDatagramSize),
+                m.ttl.value_or(MulticastSender::DefaultTtl)
+            );
+            for (Network* connection : _syncConnections) {
+                connection->setResendFunction(
+                    [this](Network& c, uint32_t sequence) {
+                        resendMulticastFrame(c, sequence);
+                    }
+                );
+            }
+        }
+        else {
+            const std::chrono::milliseconds timeout = m.timeout ?
+                std::chrono::milliseconds(*m.timeout) :
+                MulticastReceiver::DefaultTimeout;
+            _syncConnections.front()->setMulticastReceiver(
+                std::make_unique<MulticastReceiver>(
+                    m.address,
+                    m.port,
+                    m.interfaceAddress.value_or(""),
+                    timeout
+                )
+            );
+        }
+        Log::Info(std::format("Sending shared data via multicast to {}", m.address));
+    }
+
+    if (cm.maxFrameLag()) {
+        Log::Debug(std::format(
+            "Cluster sync: server at most {} frames ahead", *cm.maxFrameLag()
+        ));
+    }
+    else {
+        Log::Debug(std::format(
+            "Cluster sync: {}", cm.firmFrameLockSyncStatus() ? "firm" : "loose"
+        ));
+    }
 }
 
 void NetworkManager::clearCallbacks() {
     _dataTransferDecodeFn = nullptr;
     _dataTransferStatusFn = nullptr;
     _dataTransferAcknowledgeFn = nullptr;
+    _dataTransferChunkFn = nullptr;
+    _dataTransferProgressFn = nullptr;
 }
 
-std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) const {
-    if (_syncConnections.empty()) {
+void NetworkManager::startRecording(const std::filesystem::path& path) {
+    if (!_isServer) {
+        Log::Warning("Only the server can record the shared data");
+        return;
+    }
+    _recorder = std::make_unique<SyncRecorder>(path);
+}
+
+std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) {
+    // A recording is also made if there are no clients
+    if (_syncConnections.empty() && !_recorder) {
         return std::nullopt;
     }
     if (sm == SyncMode::SendDataToClients) {
+        // A relay only forwards the frames that it receives, see `relayFrame`
+        if (!_isServer) {
+            return std::nullopt;
+        }
+
         double maxTime = -std::numeric_limits<double>::max();
         double minTime = std::numeric_limits<double>::max();
 
-        bool hasFoundConnection = false;
+        // Every node that receives this frame acknowledges it, which can happen as soon
+        // as the frame was sent to it
+        const int nReceivers = static_cast<int>(std::count_if(
+            _syncConnections.cbegin(),
+            _syncConnections.cend(),
+            [](const Network* c) { return c->isServer() && c->isConnected(); }
+        ));
+
+        // With multicast, the data is sent only once to all clients and each connection
+        // only receives the frame number and the sequence number of the multicast frame.
+        // The receivers would discard a frame that is larger than the limit
+        uint32_t sequence = 0;
+        const bool useMulticast = _multicastSender && nReceivers > 0 &&
+            static_cast<uint32_t>(SharedData::instance().dataSize()) <=
+                MulticastSender::MaxFrameSize;
+        if (useMulticast) {
+            // Waiting for the clients uses the barrier, so it has to happen before the
+            // barrier is set up for this frame
+            waitForMulticastAcknowledgements();
+        }
+        _syncBarrier.reset(nReceivers);
+
+        const int currentSize =
+            SharedData::instance().dataSize() - static_cast<int>(Network::HeaderSize);
+        unsigned char* dataBlock = SharedData::instance().dataBlock();
+        std::memcpy(dataBlock + 5, &currentSize, sizeof(currentSize));
+
+        if (_isServer && _recorder) {
+            _recorder->record(std::span(
+                reinterpret_cast<const std::byte*>(dataBlock),
+                SharedData::instance().dataSize()
+            ));
+        }
+
+        if (useMulticast) {
+            sequence = _multicastSender->send(
+                dataBlock,
+                SharedData::instance().dataSize()
+            );
+        }
+
+        // The clients only accept multicast datagrams of the session that they are told
+        const uint32_t session = _multicastSender ? _multicastSender->session() : 0;
+
+        _sendConnections.clear();
+        _sendHeaders.clear();
+        _keyframeConnections.clear();
         for (Network* connection : _syncConnections) {
             if (!connection->isServer() || !connection->isConnected()) {
                 continue;
             }
 
-            hasFoundConnection = true;
-
             const double currentTime = connection->loopTime();
             maxTime = std::max(currentTime, maxTime);
             minTime = std::min(currentTime, minTime);
 
-            const int currentSize =
-                SharedData::instance().dataSize() - static_cast<int>(Network::HeaderSize);
-
             // Iterate counter
             const int currentFrame = connection->iterateFrameCounter();
 
-            unsigned char* dataBlock = SharedData::instance().dataBlock();
-            std::memcpy(dataBlock + 1, &currentFrame, sizeof(currentFrame));
-            std::memcpy(dataBlock + 5, &currentSize, sizeof(currentSize));
+            if (connection->consumeKeyframeRequest()) {
+                _keyframeConnections.emplace_back(connection, currentFrame);
+                continue;
+            }
 
-            connection->sendData(
-                SharedData::instance().dataBlock(),
-                SharedData::instance().dataSize()
+            // Each connection gets its own copy of the header so that the data block
+            // itself is shared between all of them
+            std::array<char, Network::HeaderSize>& header = _sendHeaders.emplace_back();
+            if (useMulticast) {
+                header[0] = Network::MulticastId;
+                std::memcpy(header.data() + 1, &currentFrame, sizeof(currentFrame));
+                const uint32_t size = sizeof(session);
+                std::memcpy(header.data() + 5, &size, sizeof(size));
+                std::memcpy(header.data() + 9, &sequence, sizeof(sequence));
+            }
+            else {
+                std::memcpy(header.data(), dataBlock, Network::HeaderSize);
+                std::memcpy(header.data() + 1, &currentFrame, sizeof(currentFrame));
+            }
+            _sendConnections.push_back(connection);
+        }
+
+        if (_sendConnections.empty() && _keyframeConnections.empty()) {
+            return std::nullopt;
+        }
+
+        // The data transfers make room for the frame until all nodes acknowledged it
+        const std::optional<float> threshold =
+            ClusterManager::instance().transferBackoffThreshold();
+        _isLoopTimeHigh = threshold && maxTime * 1000.0 > *threshold;
+        updateTransferBackoff();
+
+        _sendTimes.assign(_syncConnections.size(), 0.0);
+        auto setSendTime = [this](const Network* connection, double time) {
+            const auto it = std::find(
+                _syncConnections.cbegin(),
+                _syncConnections.cend(),
+                connection
+            );
+            _sendTimes[std::distance(_syncConnections.cbegin(), it)] = time;
+        };
+
+        if (!_sendConnections.empty()) {
+            const std::vector<double> times = Network::sendToAll(
+                _sendConnections,
+                _sendHeaders,
+                useMulticast ?
+                    reinterpret_cast<const unsigned char*>(&session) :
+                    dataBlock + Network::HeaderSize,
+                useMulticast ? static_cast<int>(sizeof(session)) : currentSize
             );
+            for (size_t i = 0; i < _sendConnections.size(); i++) {
+                setSendTime(_sendConnections[i], times[i]);
+            }
         }
 
-        if (hasFoundConnection) {
-            return std::pair(minTime, maxTime);
+        // The keyframes are sent after the regular frames so that the connected nodes
+        // don't have to wait for the potentially larger keyframes
+        if (!_keyframeConnections.empty()) {
+            using namespace std::chrono;
+            const steady_clock::time_point start = steady_clock::now();
+            for (const auto& [connection, frame] : _keyframeConnections) {
+                sendKeyframe(*connection, frame);
+                const double time = duration<double>(steady_clock::now() - start).count();
+                setSendTime(connection, time);
+            }
         }
+
+        return std::pair(minTime, maxTime);
     }
     else if (sm == SyncMode::Acknowledge) {
+        // The next frame can arrive as soon as the server received the acknowledgement.
+        // On a relay, the nodes that it forwards the next frame to acknowledge it as well
+        _syncBarrier.reset(static_cast<int>(std::count_if(
+            _syncConnections.cbegin(),
+            _syncConnections.cend(),
+            std::mem_fn(&Network::isConnected)
+        )));
         for (Network* connection : _syncConnections) {
             if (!connection->isServer() && connection->isConnected()) {
                 // The servers's render function is locked until a message starting with
@@ -437,6 +750,200 @@ std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) const
     return std::nullopt;
 }
 
+void NetworkManager::relayFrame(const std::array<char, Network::HeaderSize>& header,
+                                const char* data, uint32_t size,
+                                const std::function<void()>& decode)
+{
+    ZoneScoped;
+
+    RelayedFrame f;
+    for (Network* connection : _relayConnections) {
+        if (!connection->isConnected()) {
+            continue;
+        }
+
+        const int currentFrame = connection->iterateFrameCounter();
+        if (connection->consumeKeyframeRequest()) {
+            f.keyframeConnections.emplace_back(connection, currentFrame);
+            continue;
+        }
+
+        std::array<char, Network::HeaderSize>& h = f.headers.emplace_back(header);
+        std::memcpy(h.data() + 1, &currentFrame, sizeof(currentFrame));
+        f.connections.push_back(connection);
+    }
+
+    if (!f.connections.empty()) {
+        f.data = _relayBufferPool.acquire(size);
+        f.size = size;
+        std::memcpy(f.data.data(), data, size);
+    }
+
+    decode();
+
+    // The keyframe contains the state after the frame was decoded
+    if (!f.keyframeConnections.empty()) {
+        const std::span<std::byte> keyframe = SharedData::instance().keyframe();
+        f.keyframe = _relayBufferPool.acquire(keyframe.size());
+        f.keyframeSize = keyframe.size();
+        std::memcpy(f.keyframe.data(), keyframe.data(), keyframe.size());
+    }
+
+    if (f.connections.empty() && f.keyframeConnections.empty()) {
+        return;
+    }
+
+    {
+        const std::unique_lock lock(_relayMutex);
+        _relayedFrames.push_back(std::move(f));
+    }
+    _relayCond.notify_one();
+}
+
+void NetworkManager::sendRelayedFrames() {
+    while (true) {
+        RelayedFrame f;
+        {
+            std::unique_lock lock(_relayMutex);
+            _relayCond.wait(
+                lock,
+                [this]() { return !_isRelayRunning || !_relayedFrames.empty(); }
+            );
+            if (!_isRelayRunning) {
+                return;
+            }
+            f = std::move(_relayedFrames.front());
+            _relayedFrames.pop_front();
+        }
+
+        ZoneScopedN("Send relayed frame");
+        try {
+            if (!f.connections.empty()) {
+                Network::sendToAll(
+                    f.connections,
+                    f.headers,
+                    f.data.data(),
+                    static_cast<int>(f.size)
+                );
+            }
+            for (const auto& [connection, frame] : f.keyframeConnections) {
+                Log::Debug(std::format(
+                    "Sending keyframe of {} bytes to connection {}",
+                    f.keyframeSize, connection->id()
+                ));
+                std::memcpy(f.keyframe.data() + 1, &frame, sizeof(frame));
+                connection->sendData(f.keyframe.data(), static_cast<int>(f.keyframeSize));
+            }
+        }
+        catch (const std::runtime_error& e) {
+            // The NetworkReactor thread handles the node that disconnected
+            Log::Warning(std::format("Failed to relay frame: {}", e.what()));
+        }
+
+        _relayBufferPool.release(std::move(f.data));
+        _relayBufferPool.release(std::move(f.keyframe));
+    }
+}
+
+void NetworkManager::sendKeyframe(Network& connection, int frame) const {
+    const std::span<std::byte> keyframe = SharedData::instance().keyframe();
+    Log::Debug(std::format(
+        "Sending keyframe of {} bytes to connection {}", keyframe.size(), connection.id()
+    ));
+    std::memcpy(keyframe.data() + 1, &frame, sizeof(frame));
+    connection.sendData(keyframe.data(), static_cast<int>(keyframe.size()));
+}
+
+void NetworkManager::waitForMulticastAcknowledgements() {
+    ZoneScoped;
+
+    // A client that lags behind by more than the history can't get lost frames resent.
+    // This only makes a difference with loose sync as the server otherwise waits for all
+    // clients every frame anyway
+    auto isLagging = [](const Network* connection) {
+        return connection->isConnected() &&
+            connection->unacknowledgedFrames() >= MulticastSender::HistorySize - 1;
+    };
+
+    // Every acknowledgement and every closed connection releases the barrier. It is
+    // set up before the check so that an acknowledgement in between is not missed, and
+    // the timeout only guards against a connection that changes its state otherwise
+    while (isRunning()) {
+        _syncBarrier.reset(1);
+        if (std::none_of(_syncConnections.cbegin(), _syncConnections.cend(), isLagging)) {
+            break;
+        }
+        _syncBarrier.wait(std::chrono::milliseconds(100), std::chrono::nanoseconds(0));
+    }
+}
+
+void NetworkManager::resendMulticastFrame(Network& connection, uint32_t sequence) const {
+    ZoneScoped;
+
+    std::vector<char> frame = _multicastSender->frame(sequence);
+    if (frame.empty()) {
+        // This should not happen as we wait for the clients to acknowledge the frames
+        // before they are removed from the history. We send an empty frame so that the
+        // client can continue and a keyframe to correct any delta encoded frames
+        Log::Error(std::format(
+            "Multicast frame {} requested by connection {} is no longer available",
+            sequence, connection.id()
+        ));
+        SharedData::instance().requestKeyframe();
+
+        frame.resize(Network::HeaderSize, Network::DefaultId);
+        frame[0] = Network::DataId;
+    }
+    Log::Debug(std::format(
+        "Resending multicast frame {} to connection {}", sequence, connection.id()
+    ));
+
+    std::memcpy(frame.data() + 1, &sequence, sizeof(sequence));
+    connection.sendData(frame.data(), static_cast<int>(frame.size()));
+}
+
+const std::vector<double>& NetworkManager::sendTimes() const {
+    return _sendTimes;
+}
+
+std::vector<NetworkManager::ConnectionStatistics>
+NetworkManager::connectionStatistics() const
+{
+    const ClusterManager& cm = ClusterManager::instance();
+    auto percentiles = [](const LatencyHistogram& histogram) {
+        return ConnectionStatistics::Percentiles{
+            .p50 = histogram.percentile(0.5),
+            .p95 = histogram.percentile(0.95),
+            .p99 = histogram.percentile(0.99)
+        };
+    };
+
+    std::vector<ConnectionStatistics> statistics;
+    for (const Network* connection : _syncConnections) {
+        if (!connection->isServer()) {
+            continue;
+        }
+
+        ConnectionStatistics& s = statistics.emplace_back();
+        // Every node has its own sync port
+        for (int i = 0; i < cm.numberOfNodes(); i++) {
+            if (cm.node(i).syncPort() == connection->port()) {
+                s.node = i;
+                break;
+            }
+        }
+        s.nFrames = connection->loopTimes().count();
+        s.loopTime = percentiles(connection->loopTimes());
+        s.roundTripTime = percentiles(connection->roundTripTimes());
+        s.clockOffset = connection->clockOffset();
+    }
+    return statistics;
+}
+
+BandwidthLimiter::Statistics NetworkManager::transferBandwidthStatistics() const {
+    return _bandwidthLimiter.statistics();
+}
+
 bool NetworkManager::isSyncComplete() const {
     const unsigned int counter = static_cast<unsigned int>(std::count_if(
         _syncConnections.cbegin(),
@@ -446,24 +953,454 @@ bool NetworkManager::isSyncComplete() const {
     return (counter == _nActiveSyncConnections);
 }
 
+bool NetworkManager::waitForSync(std::chrono::nanoseconds timeout,
+                                 std::chrono::nanoseconds spin)
+{
+    return _syncBarrier.wait(timeout, spin);
+}
+
 void NetworkManager::transferData(const void* data, int length, int packageId) const {
-    std::vector<char> buffer;
-    prepareTransferData(data, buffer, length, packageId);
-    for (Network* connection : _dataTransferConnections) {
-        if (connection->isConnected()) {
-            connection->sendData(buffer.data(), length);
+    std::vector<Network*> connections;
+    std::copy_if(
+        _dataTransferConnections.cbegin(),
+        _dataTransferConnections.cend(),
+        std::back_inserter(connections),
+        std::mem_fn(&Network::isConnected)
+    );
+    connections = offerTransfer(std::move(connections), data, length, packageId);
+    const std::array<char, Network::HeaderSize> header =
+        transferHeader(length, packageId);
+
+    // A paced connection sends its slices only as fast as the common budget allows, so
+    // the connections are served one after another instead of all at once
+    if (_bandwidthLimiter.rate() > 0.0) {
+        const std::span<const char> payload(reinterpret_cast<const char*>(data), length);
+        for (const Network* connection : connections) {
+            connection->sendMessage(header, payload);
         }
+        return;
     }
+
+    const std::vector<std::array<char, Network::HeaderSize>> headers(
+        connections.size(),
+        header
+    );
+    Network::sendToAll(connections, headers, data, length);
 }
 
 void NetworkManager::transferData(const void* data, int length, int packageId,
                                   const Network& connection) const
 {
-    if (connection.isConnected()) {
-        std::vector<char> buffer;
-        prepareTransferData(data, buffer, length, packageId);
-        connection.sendData(buffer.data(), length);
+    if (!connection.isConnected()) {
+        return;
+    }
+
+    // The offer is answered on the data transfer connection that is managed here
+    const auto it = std::find(
+        _dataTransferConnections.cbegin(),
+        _dataTransferConnections.cend(),
+        &connection
+    );
+    if (it != _dataTransferConnections.cend() &&
+        offerTransfer({ *it }, data, length, packageId).empty())
+    {
+        return;
     }
+    connection.sendMessage(
+        transferHeader(length, packageId),
+        std::span(reinterpret_cast<const char*>(data), length)
+    );
+}
+
+std::vector<Network*> NetworkManager::offerTransfer(std::vector<Network*> connections,
+                                                    const void* data, int length,
+                                                    int packageId) const
+{
+    // The replies are received on the reactor's thread, so a callback of a connection
+    // would wait for them forever
+    if (!_transferCache || length < TransferCacheMinSize ||
+        NetworkReactor::instance().isReactorThread())
+    {
+        return connections;
+    }
+
+    ZoneScoped;
+
+    const uint64_t hash = TransferCache::hash(
+        std::span(reinterpret_cast<const char*>(data), length)
+    );
+
+    // All nodes are asked before waiting for any of them, so that the offer only takes
+    // a single round trip
+    std::vector<std::future<bool>> replies;
+    replies.reserve(connections.size());
+    for (Network* connection : connections) {
+        auto reply = std::make_shared<std::promise<bool>>();
+        replies.push_back(reply->get_future());
+        try {
+            connection->offerContent(
+                packageId,
+                hash,
+                static_cast<uint64_t>(length),
+                [reply](bool isAvailable) { reply->set_value(isAvailable); }
+            );
+        }
+        catch (const std::runtime_error& e) {
+            // The offer has been answered as unavailable already
+            Log::Warning(std::format(
+                "Offering transfer {} to connection {} failed: {}",
+                packageId, connection->id(), e.what()
+            ));
+        }
+    }
+
+    // A node that is too slow to reply is sent the package instead of stalling the
+    // caller. Its late reply is matched to this offer and then ignored
+    const auto deadline = std::chrono::steady_clock::now() + TransferOfferTimeout;
+    std::vector<Network*> res;
+    for (size_t i = 0; i < connections.size(); i++) {
+        const bool isReplied =
+            replies[i].wait_until(deadline) == std::future_status::ready;
+        if (isReplied && replies[i].get()) {
+            continue;
+        }
+        if (!isReplied) {
+            Log::Warning(std::format(
+                "Connection {} did not reply to the offer of transfer {} in time",
+                connections[i]->id(), packageId
+            ));
+        }
+        if (connections[i]->isConnected()) {
+            res.push_back(connections[i]);
+        }
+    }
+    return res;
+}
+
+std::future<bool> NetworkManager::transferDataAsync(std::vector<char> data,
+                                                     int packageId)
+{
+    ZoneScoped;
+
+    auto transfer = std::make_shared<AsyncTransfer>();
+    transfer->data = std::move(data);
+    transfer->packageId = packageId;
+    std::copy_if(
+        _dataTransferConnections.cbegin(),
+        _dataTransferConnections.cend(),
+        std::back_inserter(transfer->connections),
+        std::mem_fn(&Network::isConnected)
+    );
+    std::future<bool> result = transfer->result.get_future();
+    if (transfer->connections.empty()) {
+        transfer->result.set_value(true);
+        return result;
+    }
+    transfer->nPending = static_cast<int>(transfer->connections.size());
+
+    {
+        const std::unique_lock lock(_transferMutex);
+        _asyncTransfers.push_back(std::move(transfer));
+
+        // The thread is only needed once the first package is queued
+        if (!_transferThread.joinable()) {
+            _transferThread = std::thread([this]() { sendQueuedTransfers(); });
+        }
+    }
+    _transferCond.notify_all();
+    return result;
+}
+
+void NetworkManager::sendQueuedTransfers() {
+    std::vector<std::pair<std::shared_ptr<AsyncTransfer>, Network*>> packages;
+    // The number of packages that still fit into the transfer window of each connection
+    std::vector<std::pair<Network*, int>> space;
+
+    while (true) {
+        packages.clear();
+        {
+            std::unique_lock lock(_transferMutex);
+            while (_isTransferRunning && packages.empty()) {
+                // A connection receives the packages in order, so it is skipped for the
+                // later packages once its transfer window is full. The queue is only
+                // searched until the windows of all connections are full
+                space.clear();
+                int nFull = 0;
+                for (const std::shared_ptr<AsyncTransfer>& t : _asyncTransfers) {
+                    std::erase_if(
+                        t->connections,
+                        [&](Network* connection) {
+                            if (!connection->isConnected()) {
+                                t->complete(false);
+                                return true;
+                            }
+                            auto it = std::find_if(
+                                space.begin(),
+                                space.end(),
+                                [connection](const std::pair<Network*, int>& s) {
+                                    return s.first == connection;
+                                }
+                            );
+                            if (it == space.end()) {
+                                space.emplace_back(
+                                    connection,
+                                    connection->transferWindowSpace()
+                                );
+                                it = space.end() - 1;
+                                nFull += it->second == 0 ? 1 : 0;
+                            }
+                            if (it->second == 0) {
+                                return false;
+                            }
+                            it->second--;
+                            nFull += it->second == 0 ? 1 : 0;
+                            packages.emplace_back(t, connection);
+                            return true;
+                        }
+                    );
+                    if (nFull == static_cast<int>(_dataTransferConnections.size())) {
+                        break;
+                    }
+                }
+                std::erase_if(
+                    _asyncTransfers,
+                    [](const std::shared_ptr<AsyncTransfer>& t) {
+                        return t->connections.empty();
+                    }
+                );
+
+                if (packages.empty()) {
+                    _transferCond.wait(lock);
+                }
+            }
+            if (!_isTransferRunning) {
+                return;
+            }
+        }
+
+        for (const auto& [transfer, connection] : packages) {
+            try {
+                connection->sendPackage(
+                    transfer->packageId,
+                    transfer->data,
+                    [transfer](bool isAcknowledged) {
+                        transfer->complete(isAcknowledged);
+                    }
+                );
+            }
+            catch (const std::runtime_error& e) {
+                // The package is failed once the connection is closed
+                Log::Warning(std::format(
+                    "Transfer {} to connection {} failed: {}",
+                    transfer->packageId, connection->id(), e.what()
+                ));
+            }
+        }
+
+        // The payload is no longer needed once the package was sent to all connections,
+        // even though the package might not be acknowledged yet. The connections are
+        // only changed on this thread
+        for (const auto& [transfer, connection] : packages) {
+            if (transfer->connections.empty()) {
+                transfer->data = std::vector<char>();
+            }
+        }
+    }
+}
+
+void NetworkManager::notifyTransfers() {
+    {
+        // The transfer thread might be just about to wait
+        const std::unique_lock lock(_transferMutex);
+    }
+    _transferCond.notify_all();
+}
+
+void NetworkManager::updateTransferBackoff() {
+    if (_bandwidthLimiter.rate() == 0.0) {
+        return;
+    }
+
+    // The render thread starts a frame while the acknowledgements of the previous one
+    // are still arriving, so the decision is made by one thread at a time
+    const std::unique_lock lock(_backoffMutex);
+    const bool isInFlight = std::any_of(
+        _syncConnections.cbegin(),
+        _syncConnections.cend(),
+        [](const Network* c) {
+            return c->isServer() && c->isConnected() && c->unacknowledgedFrames() > 0;
+        }
+    );
+    _bandwidthLimiter.setBackoff(isInFlight || _isLoopTimeHigh);
+}
+
+void NetworkManager::AsyncTransfer::complete(bool isPackageAcknowledged) {
+    if (!isPackageAcknowledged) {
+        isAcknowledged = false;
+    }
+    if (--nPending == 0) {
+        result.set_value(isAcknowledged);
+    }
+}
+
+void NetworkManager::transferFile(const std::filesystem::path& path, int packageId) const
+{
+    ZoneScoped;
+
+#ifdef __linux__
+    const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    FileMapping mapping;
+    if (file != -1 && fstat(file, &status) == 0) {
+        mapping.size = static_cast<size_t>(status.st_size);
+        void* data = mapping.size > 0 ?
+            mmap(nullptr, mapping.size, PROT_READ, MAP_PRIVATE, file, 0) :
+            MAP_FAILED;
+        if (data != MAP_FAILED) {
+            madvise(data, mapping.size, MADV_SEQUENTIAL);
+            mapping.data = data;
+        }
+    }
+    if (file != -1) {
+        // The mapping stays valid after the file is closed
+        close(file);
+    }
+    if (file == -1 || (mapping.size > 0 && !mapping.data)) {
+        throw Err(
+            5056,
+            std::format("Could not open file '{}' for transfer", path.string())
+        );
+    }
+
+    const char* data = reinterpret_cast<const char*>(mapping.data);
+    const uint64_t totalSize = mapping.size;
+    transferChunks(
+        packageId,
+        totalSize,
+        [&](const Network& connection, uint64_t offset, uint32_t size) {
+            const std::span<const char> chunk(data + offset, size);
+            connection.sendChunk(packageId, offset, totalSize, chunk);
+            return size;
+        }
+    );
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        throw Err(
+            5056,
+            std::format("Could not open file '{}' for transfer", path.string())
+        );
+    }
+    const uint64_t totalSize = std::filesystem::file_size(path);
+
+    std::vector<char> buffer(std::min<uint64_t>(totalSize, TransferChunkSize));
+    transferChunks(
+        packageId,
+        totalSize,
+        [&](const Network& connection, uint64_t offset, uint32_t size) {
+            file.seekg(static_cast<std::streamoff>(offset));
+            if (!file.read(buffer.data(), size)) {
+                throw Err(
+                    5056,
+                    std::format("Could not read file '{}'", path.string())
+                );
+            }
+            const std::span<const char> chunk(buffer.data(), size);
+            connection.sendChunk(packageId, offset, totalSize, chunk);
+            return size;
+        }
+    );
+#endif // __linux__
+}
+
+void NetworkManager::transferStream(
+                               std::function<size_t(uint64_t, std::span<char>)> source,
+                                                  uint64_t totalSize, int packageId) const
+{
+    ZoneScoped;
+
+    std::vector<char> buffer(std::min<uint64_t>(totalSize, TransferChunkSize));
+    transferChunks(
+        packageId,
+        totalSize,
+        [&](const Network& connection, uint64_t offset, uint32_t size) {
+            const size_t n = std::min<size_t>(
+                source(offset, std::span(buffer.data(), size)),
+                size
+            );
+            if (n == 0 && size > 0) {
+                throw Err(5057, "Transfer source ended before the end of the transfer");
+            }
+            const std::span<const char> chunk(buffer.data(), n);
+            connection.sendChunk(packageId, offset, totalSize, chunk);
+            return static_cast<uint32_t>(n);
+        }
+    );
+}
+
+void NetworkManager::transferChunks(int packageId, uint64_t totalSize,
+            const std::function<uint32_t(const Network&, uint64_t, uint32_t)>& send) const
+{
+    for (Network* connection : _dataTransferConnections) {
+        if (!connection->isConnected()) {
+            continue;
+        }
+
+        // A connection that fails while the transfer is running only stops the transfer
+        // to that node, which continues from the bytes that it has received next time. A
+        // transfer of a single chunk has nothing to continue from
+        try {
+            uint64_t offset = totalSize > TransferChunkSize ?
+                resumeOffset(*connection, packageId, totalSize) :
+                0;
+            do {
+                const uint32_t size = static_cast<uint32_t>(
+                    std::min<uint64_t>(totalSize - offset, TransferChunkSize)
+                );
+                offset += send(*connection, offset, size);
+            } while (offset < totalSize);
+        }
+        catch (const std::runtime_error& e) {
+            Log::Warning(std::format(
+                "Transfer {} to connection {} was interrupted: {}",
+                packageId, connection->id(), e.what()
+            ));
+        }
+    }
+}
+
+uint64_t NetworkManager::resumeOffset(Network& connection, int packageId,
+                                      uint64_t totalSize) const
+{
+    // The reply is received on the reactor's thread, so a callback of a connection would
+    // wait for it forever
+    if (NetworkReactor::instance().isReactorThread()) {
+        return 0;
+    }
+
+    auto reply = std::make_shared<std::promise<uint64_t>>();
+    std::future<uint64_t> offset = reply->get_future();
+    connection.queryChunkOffset(
+        packageId,
+        totalSize,
+        [reply](uint64_t received) { reply->set_value(received); }
+    );
+    if (offset.wait_for(TransferResumeTimeout) != std::future_status::ready) {
+        Log::Warning(std::format(
+            "Connection {} did not reply where transfer {} continues in time",
+            connection.id(), packageId
+        ));
+        return 0;
+    }
+    const uint64_t received = offset.get();
+    if (received > 0 && received < totalSize) {
+        Log::Info(std::format(
+            "Transfer {} to connection {} continues at {} of {} bytes",
+            packageId, connection.id(), received, totalSize
+        ));
+        return received;
+    }
+    return 0;
 }
 
 unsigned int NetworkManager::activeConnectionsCount() const {
@@ -495,6 +1432,7 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
     int nConnections = 0;
     int nConnectedSync = 0;
     int nConnectedDataTransfer = 0;
+    int nConnectedUpstream = 0;
 
     mutex::DataSync.lock();
     int totalNConnections = static_cast<int>(_networkConnections.size());
@@ -508,6 +1446,9 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
             nConnections++;
             if (conn->type() == Network::ConnectionType::SyncConnection) {
                 nConnectedSync++;
+                if (!conn->isServer()) {
+                    nConnectedUpstream++;
+                }
             }
             else if (conn->type() == Network::ConnectionType::DataTransfer) {
                 nConnectedDataTransfer++;
@@ -531,12 +1472,29 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
     _nActiveSyncConnections = nConnectedSync;
     _nActiveDataTransferConnections = nConnectedDataTransfer;
 
-    // If client disconnects then it cannot run anymore
-    if (_nActiveSyncConnections == 0 && !_isServer) {
+    // If client disconnects then it cannot run anymore. A relay can continue if only the
+    // nodes that it relays to disconnect. As the client connects in the background, the
+    // other connections might change before it is connected for the first time
+    const bool isUpstreamClosed = !connection.isServer() && !connection.isConnected() &&
+        connection.type() == Network::ConnectionType::SyncConnection;
+    const bool isStopping = isUpstreamClosed && nConnectedUpstream == 0 && !_isServer;
+    if (isStopping) {
         _isRunning = false;
     }
     mutex::DataSync.unlock();
 
+    // A closed sync connection won't acknowledge or send the current frame anymore. Any
+    // other change lets the waiting thread check whether the frame is complete now
+    const bool isSyncClosed = !connection.isConnected() &&
+        connection.type() == Network::ConnectionType::SyncConnection;
+    if (isSyncClosed) {
+        _syncBarrier.drop();
+        updateTransferBackoff();
+    }
+    if (!isSyncClosed || isStopping) {
+        _syncBarrier.release();
+    }
+
     if (_isServer) {
         mutex::DataSync.lock();
         // Local copy (thread safe)
@@ -546,6 +1504,19 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
         _allNodesConnected = allNodesConnected;
         mutex::DataSync.unlock();
 
+        if (allNodesConnected) {
+            reportAllNodesConnected();
+        }
+
+        // A newly connected node has no previous frame to apply a delta to and might
+        // have missed changes of the shared variables, so it receives the full state
+        // while the other nodes continue to receive the regular frames
+        if (connection.type() == Network::ConnectionType::SyncConnection &&
+            connection.isConnected())
+        {
+            connection.requestKeyframe();
+        }
+
         // Send cluster connected message to clients
         if (allNodesConnected) {
             for (Network* syncConnection : _syncConnections) {
@@ -566,9 +1537,17 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
                 }
             }
         }
+    }
 
-        // Wake up the connection handler thread on server
-        connection.startConnectionConditionVar().notify_all();
+    else if (!_relayConnections.empty()) {
+        // A node that connects to a relay needs the full state just like one that
+        // connects to the server
+        if (connection.type() == Network::ConnectionType::SyncConnection &&
+            connection.isServer() && connection.isConnected())
+        {
+            connection.requestKeyframe();
+        }
+        updateAllNodesConnected();
     }
 
     if (connection.type() == Network::ConnectionType::DataTransfer) {
@@ -582,18 +1561,53 @@ void NetworkManager::updateConnectionStatus(Network& connection) {
 }
 
 void NetworkManager::setAllNodesConnected() {
-    const std::unique_lock lock(mutex::DataSync);
+    {
+        const std::unique_lock lock(mutex::DataSync);
+        if (_isServer) {
+            return;
+        }
+        _isClusterConnected = true;
+    }
+    updateAllNodesConnected();
+}
 
-    if (!_isServer) {
+void NetworkManager::updateAllNodesConnected() {
+    auto isUpstream = [](const Network* c) { return !c->isServer() && c->isConnected(); };
+    const bool isUpstreamConnected =
+        std::any_of(_syncConnections.cbegin(), _syncConnections.cend(), isUpstream);
+    const bool areRelayedNodesConnected = std::all_of(
+        _relayConnections.cbegin(),
+        _relayConnections.cend(),
+        std::mem_fn(&Network::isConnected)
+    );
+
+    {
+        const std::unique_lock lock(mutex::DataSync);
         const unsigned int nConn =
             static_cast<unsigned int>(_dataTransferConnections.size());
-        _allNodesConnected = (_nActiveSyncConnections == 1) &&
-                             (_nActiveDataTransferConnections == nConn);
+        const bool allNodesConnected = _isClusterConnected && isUpstreamConnected &&
+            areRelayedNodesConnected && (_nActiveDataTransferConnections == nConn);
+        const bool wasConnected = _allNodesConnected;
+        _allNodesConnected = allNodesConnected;
+        if (!allNodesConnected || wasConnected) {
+            return;
+        }
+    }
+    reportAllNodesConnected();
+    cond.notify_all();
+
+    // The nodes behind a relay are only notified once the relay itself is connected
+    for (Network* connection : _relayConnections) {
+        std::array<char, Network::HeaderSize> data = {};
+        std::fill(data.begin(), data.end(), Network::DefaultId);
+        data[0] = Network::ConnectedId;
+        connection->sendData(&data, Network::HeaderSize);
     }
 }
 
-void NetworkManager::addConnection(int port, std::string address,
-                                   Network::ConnectionType connectionType)
+void NetworkManager::addConnection(int port, std::string address, bool isServer,
+                                   Network::ConnectionType connectionType,
+                                   bool useSharedMemory)
 {
     ZoneScoped;
 
@@ -608,17 +1622,40 @@ void NetworkManager::addConnection(int port, std::string address,
     auto net = std::make_unique<Network>(
         port,
         std::move(address),
-        _isServer,
+        isServer,
         connectionType
     );
     Log::Debug(std::format(
         "Initiating connection {} at port {}", _networkConnections.size(), port
     ));
     net->setUpdateFunction([this](Network& c) { updateConnectionStatus(c); });
-    net->setConnectedFunction([this]() { setAllNodesConnected(); });
+    net->setSharedMemoryEnabled(useSharedMemory);
+    // The server also notifies the data transfer connections, but behind a relay only
+    // the message on the sync connection means that the relay's nodes are connected
+    const ClusterManager& cm = ClusterManager::instance();
+    if (connectionType == Network::ConnectionType::SyncConnection) {
+        net->setConnectedFunction([this]() { setAllNodesConnected(); });
+        net->setArrivalFunction([this]() {
+            _syncBarrier.arrive();
+            updateTransferBackoff();
+        });
+        net->setDscp(cm.syncDscp().value_or(DefaultSyncDscp));
+    }
+    else {
+        net->setConnectedFunction([this]() { updateAllNodesConnected(); });
+        net->setTransferWindowFunction([this]() { notifyTransfers(); });
+        net->setBandwidthLimiter(&_bandwidthLimiter);
+        net->setTransferCache(_transferCache.get());
+
+        if (cm.transferWindow()) {
+            net->setTransferWindow(*cm.transferWindow());
+        }
+        if (cm.transferBufferLimit()) {
+            const size_t limit = static_cast<size_t>(*cm.transferBufferLimit());
+            net->setBufferPoolLimit(limit * 1024 * 1024);
+        }
+    }
 
-    // Must be initialized after binding
-    net->initialize();
     _networkConnections.push_back(std::move(net));
 
     // Update the previously existing shortcuts (maybe remove them altogether?)
@@ -635,15 +1672,32 @@ void NetworkManager::addConnection(int port, std::string address,
                 break;
         }
     }
+
+    // Must be initialized after binding. The status of a connection is updated as soon
+    // as it is established, which has to take the connection itself into account
+    _networkConnections.back()->initialize();
 }
 
 bool NetworkManager::matchesAddress(std::string_view address) const {
     ZoneScoped;
 
+    waitForLocalAddresses();
     const auto it = std::find(_localAddresses.cbegin(), _localAddresses.cend(), address);
     return it != _localAddresses.cend();
 }
 
+void NetworkManager::waitForLocalAddresses() const {
+    if (!_localAddressesLookup.valid()) {
+        return;
+    }
+
+    _localAddresses = _localAddressesLookup.get();
+    Log::Debug("Detected local addresses:");
+    for (const std::string& address : _localAddresses) {
+        Log::Debug(std::format("  {}", address));
+    }
+}
+
 bool NetworkManager::isComputerServer() const {
     return _isServer;
 }
@@ -658,4 +1712,28 @@ bool NetworkManager::areAllNodesConnected() const {
     return _allNodesConnected;
 }
 
+bool NetworkManager::waitForAllNodesConnected(std::chrono::milliseconds timeout) const {
+    std::unique_lock lock(mutex::DataSync);
+    return cond.wait_for(lock, timeout, [this]() { return _allNodesConnected; });
+}
+
+std::optional<double> NetworkManager::timeToAllNodesConnected() const {
+    const std::unique_lock lock(mutex::DataSync);
+    return _timeToAllNodesConnected;
+}
+
+void NetworkManager::reportAllNodesConnected() {
+    using namespace std::chrono;
+
+    const duration<double> time = steady_clock::now() - _creationTime;
+    {
+        const std::unique_lock lock(mutex::DataSync);
+        if (_timeToAllNodesConnected.has_value()) {
+            return;
+        }
+        _timeToAllNodesConnected = time.count();
+    }
+    Log::Info(std::format("All nodes connected after {:.3f} s", time.count()));
+}
+
 } // namespace sgct
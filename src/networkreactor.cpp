@@ -0,0 +1,209 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/networkreactor.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#include <winsock2.h>
+#define SGCT_ERRNO WSAGetLastError()
+#elif defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include <unistd.h>
+#define SGCT_ERRNO errno
+#else // ^^^^ __linux__ // !WIN32 && !__linux__ vvvv
+#include <poll.h>
+#include <cerrno>
+#define SGCT_ERRNO errno
+#endif // WIN32
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
+
+namespace {
+#ifndef __linux__
+    // Without a way to interrupt `poll`, newly registered sockets are picked up after at
+    // most this duration
+    constexpr int PollTimeout = 10; // ms
+#endif // __linux__
+
+    // The number of events that are handled per call to `epoll_wait`
+    [[maybe_unused]] constexpr int MaxEvents = 64;
+} // namespace
+
+namespace sgct {
+
+NetworkReactor& NetworkReactor::instance() {
+    static NetworkReactor reactor;
+    return reactor;
+}
+
+NetworkReactor::NetworkReactor() {
+#ifdef __linux__
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll == -1) {
+        throw Err(5041, std::format("Failed to create epoll instance: {}", SGCT_ERRNO));
+    }
+
+    // Used to wake up the thread when it should terminate
+    _wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeup == -1) {
+        close(_epoll);
+        throw Err(5041, std::format("Failed to create wakeup event: {}", SGCT_ERRNO));
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = _wakeup;
+    epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+#endif // __linux__
+
+    _thread = std::thread([this]() { run(); });
+}
+
+NetworkReactor::~NetworkReactor() {
+    _shouldTerminate = true;
+#ifdef __linux__
+    const uint64_t value = 1;
+    [[maybe_unused]] const ssize_t res = write(_wakeup, &value, sizeof(value));
+#endif // __linux__
+    _thread.join();
+
+#ifdef __linux__
+    close(_wakeup);
+    close(_epoll);
+#endif // __linux__
+}
+
+void NetworkReactor::add(SGCT_SOCKET socket, std::function<void()> onReadable) {
+    const std::unique_lock lock(_mutex);
+    _handlers[socket] = std::make_shared<std::function<void()>>(std::move(onReadable));
+
+#ifdef __linux__
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = socket;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) == -1) {
+        _handlers.erase(socket);
+        throw Err(5042, std::format("Failed to observe socket: {}", SGCT_ERRNO));
+    }
+#endif // __linux__
+}
+
+void NetworkReactor::remove(SGCT_SOCKET socket) {
+    {
+        const std::unique_lock lock(_mutex);
+        if (_handlers.erase(socket) > 0) {
+#ifdef __linux__
+            epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+#endif // __linux__
+        }
+    }
+
+    // Wait for the function to finish in case it is currently running. This is also
+    // necessary if the socket was already removed by the running function itself
+    if (!isReactorThread()) {
+        const std::unique_lock lock(_dispatchMutex);
+    }
+}
+
+bool NetworkReactor::isReactorThread() const {
+    return std::this_thread::get_id() == _thread.get_id();
+}
+
+void NetworkReactor::run() {
+#ifdef __linux__
+    std::array<epoll_event, MaxEvents> events;
+    while (!_shouldTerminate) {
+        const int n = epoll_wait(_epoll, events.data(), MaxEvents, -1);
+        if (n == -1) {
+            if (SGCT_ERRNO != EINTR) {
+                Log::Error(std::format("Waiting for sockets failed: {}", SGCT_ERRNO));
+            }
+            continue;
+        }
+
+        ZoneScopedN("Dispatch");
+        const std::unique_lock lock(_dispatchMutex);
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd == _wakeup) {
+                uint64_t value = 0;
+                [[maybe_unused]] const ssize_t res = read(_wakeup, &value, sizeof(value));
+                continue;
+            }
+            dispatch(events[i].data.fd);
+        }
+    }
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    std::vector<pollfd> fds;
+    while (!_shouldTerminate) {
+        fds.clear();
+        {
+            const std::unique_lock lock(_mutex);
+            for (const auto& [socket, handler] : _handlers) {
+                pollfd fd = {};
+                fd.fd = socket;
+                fd.events = POLLIN;
+                fds.push_back(fd);
+            }
+        }
+        if (fds.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PollTimeout));
+            continue;
+        }
+
+#ifdef WIN32
+        const int n = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), PollTimeout);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        const int n = poll(fds.data(), static_cast<nfds_t>(fds.size()), PollTimeout);
+#endif // WIN32
+        if (n <= 0) {
+            continue;
+        }
+
+        ZoneScopedN("Dispatch");
+        const std::unique_lock lock(_dispatchMutex);
+        for (const pollfd& fd : fds) {
+            if (fd.revents != 0) {
+                dispatch(fd.fd);
+            }
+        }
+    }
+#endif // __linux__
+}
+
+void NetworkReactor::dispatch(SGCT_SOCKET socket) {
+    std::shared_ptr<std::function<void()>> handler;
+    {
+        const std::unique_lock lock(_mutex);
+        auto it = _handlers.find(socket);
+        if (it == _handlers.end()) {
+            // The socket was removed after the event was reported
+            return;
+        }
+        handler = it->second;
+    }
+
+    try {
+        (*handler)();
+    }
+    catch (const std::runtime_error& e) {
+        Log::Error(e.what());
+    }
+}
+
+} // namespace sgct
@@ -21,6 +21,7 @@ Node::Node(const config::Node& node, bool initializeWindows)
     : _address(node.address)
     , _syncPort(node.port)
     , _dataTransferPort(node.dataTransferPort.value_or(0))
+    , _parent(node.parent.value_or(-1))
     , _useSwapGroups(node.swapLock.value_or(false))
 {
     ZoneScoped;
@@ -90,4 +91,8 @@ int Node::dataTransferPort() const {
     return _dataTransferPort;
 }
 
+int Node::parent() const {
+    return _parent;
+}
+
 } // namespace sgct
@@ -8,13 +8,76 @@
 
 #include <sgct/shareddata.h>
 
+#include <sgct/error.h>
+#include <sgct/format.h>
 #include <sgct/log.h>
 #include <sgct/mutexes.h>
 #include <sgct/profiling.h>
+#include <sgct/sharedobject.h>
 #include <zlib.h>
+#include <algorithm>
 #include <cstring>
 #include <string>
 
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace {
+    // Ranges that are separated by fewer equal bytes than this are merged as the
+    // overhead of the offset and length is larger than sending the equal bytes
+    constexpr size_t DeltaMergeDistance = 2 * sizeof(uint32_t);
+
+    // Size of the blocks that are compared when searching for the next changed byte
+    constexpr size_t DeltaBlockSize = 64;
+
+    void appendUint32(std::vector<std::byte>& buffer, uint32_t value) {
+        const std::byte* p = reinterpret_cast<const std::byte*>(&value);
+        buffer.insert(buffer.end(), p, p + sizeof(uint32_t));
+    }
+
+    uint32_t readUint32(const char* data) {
+        uint32_t value = 0;
+        std::memcpy(&value, data, sizeof(uint32_t));
+        return value;
+    }
+
+    // Returns the first position in [begin, end) at which `prev` and `curr` differ, or
+    // `end` if they are equal in the entire range
+    size_t findFirstDifference(const std::byte* prev, const std::byte* curr, size_t begin,
+                               size_t end)
+    {
+        size_t i = begin;
+        while (i + DeltaBlockSize <= end &&
+               std::memcmp(prev + i, curr + i, DeltaBlockSize) == 0)
+        {
+            i += DeltaBlockSize;
+        }
+        while (i < end && prev[i] == curr[i]) {
+            i++;
+        }
+        return i;
+    }
+
+    // Returns the first position in [begin, end) at which `prev` and `curr` are equal
+    // for at least `DeltaMergeDistance` bytes, or `end` if there is no such position
+    size_t findFirstEqual(const std::byte* prev, const std::byte* curr, size_t begin,
+                          size_t end)
+    {
+        size_t run = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (prev[i] == curr[i]) {
+                run++;
+                if (run == DeltaMergeDistance) {
+                    return i + 1 - run;
+                }
+            }
+            else {
+                run = 0;
+            }
+        }
+        return end;
+    }
+} // namespace
+
 namespace sgct {
 
 SharedData* SharedData::_instance = nullptr;
@@ -43,12 +106,83 @@ SharedData::SharedData() {
 
 void SharedData::setEncodeFunction(std::function<std::vector<std::byte>()> function) {
     _encodeFn = std::move(function);
+    _encodeIntoFn = nullptr;
+}
+
+void SharedData::setEncodeFunction(
+                                  std::function<void(std::vector<std::byte>&)> function)
+{
+    _encodeIntoFn = std::move(function);
+    _encodeFn = nullptr;
 }
 
 void SharedData::setDecodeFunction(
                               std::function<void(const std::vector<std::byte>&)> function)
 {
     _decodeFn = std::move(function);
+    _decodeViewFn = nullptr;
+}
+
+void SharedData::setDecodeViewFunction(
+                                 std::function<void(std::span<const std::byte>)> function)
+{
+    _decodeViewFn = std::move(function);
+    _decodeFn = nullptr;
+}
+
+void SharedData::setCompression(bool enabled, int level) {
+    const std::unique_lock lock(mutex::DataSync);
+
+    _useCompression = enabled;
+    _compressionLevel = std::clamp(level, Z_BEST_SPEED, Z_BEST_COMPRESSION);
+    // The stream has to be recreated as the compression level is fixed at creation
+    _deflateStream = nullptr;
+}
+
+void SharedData::setDeltaEncoding(bool enabled, int keyframeInterval) {
+    const std::unique_lock lock(mutex::DataSync);
+
+    _useDeltaEncoding = enabled;
+    _keyframeInterval = std::max(keyframeInterval, 1);
+    _framesSinceKeyframe = 0;
+    _previousBlock.clear();
+}
+
+void SharedData::requestKeyframe() {
+    _keyframeRequested = true;
+    _allVariablesRequested = true;
+}
+
+std::span<std::byte> SharedData::keyframe() {
+    ZoneScoped;
+
+    if (_hasKeyframe) {
+        return _keyframeBlock;
+    }
+
+    _keyframeBlock.assign(_headerSpace.begin(), _headerSpace.end());
+    _keyframeBlock[0] = static_cast<std::byte>(Network::KeyframeId);
+
+    // The frame itself might only contain the shared variables that changed, so the
+    // values of all of them are placed in front of it
+    SharedObjectRegistry& registry = SharedObjectRegistry::instance();
+    if (registry.hasVariables()) {
+        registry.encodeAll(_keyframeBlock);
+    }
+    if (_dataBlock.size() > _dataBlockOffset) {
+        _keyframeBlock.insert(
+            _keyframeBlock.end(),
+            _dataBlock.begin() + _dataBlockOffset,
+            _dataBlock.end()
+        );
+    }
+
+    const uint32_t size =
+        static_cast<uint32_t>(_keyframeBlock.size() - Network::HeaderSize);
+    std::memcpy(_keyframeBlock.data() + 5, &size, sizeof(uint32_t));
+    std::memset(_keyframeBlock.data() + 9, 0, sizeof(uint32_t));
+    _hasKeyframe = true;
+    return _keyframeBlock;
 }
 
 void SharedData::decode(const char* receivedData, int receivedLength) {
@@ -57,26 +191,105 @@ void SharedData::decode(const char* receivedData, int receivedLength) {
     {
         const std::unique_lock lock(mutex::DataSync);
 
-        // Reset
-        _dataBlock.clear();
-
-        if (receivedLength > static_cast<int>(_dataBlock.capacity())) {
-            _dataBlock.reserve(receivedLength);
-        }
-        _dataBlock.insert(
-            _dataBlock.end(),
+        // The frame is kept as the reference for the next delta. The memory of the
+        // block is reused, so this is only a copy without an allocation
+        _dataBlock.assign(
             reinterpret_cast<const std::byte*>(receivedData),
             reinterpret_cast<const std::byte*>(receivedData) + receivedLength
         );
+        _dataBlockOffset = 0;
+        _hasReferenceFrame = true;
+        _hasKeyframe = false;
+    }
+
+    // The copy is decoded instead of the received data, which might not be aligned, for
+    // example when it follows the header of a multicast frame
+    decodeFrame(_dataBlock);
+}
+
+void SharedData::decodeDelta(const char* receivedData, int receivedLength) {
+    ZoneScoped;
+
+    {
+        const std::unique_lock lock(mutex::DataSync);
+
+        if (!_hasReferenceFrame) {
+            // We have connected in between keyframes and have nothing to apply the
+            // delta to. The server will send a keyframe as soon as it notices us
+            Log::Debug("Ignoring shared data delta as no keyframe was received yet");
+            return;
+        }
+
+        if (receivedLength < static_cast<int>(sizeof(uint32_t))) {
+            throw Err(5032, "Received malformed shared data delta");
+        }
+        const size_t size = readUint32(receivedData);
+        _dataBlock.resize(size);
+        _hasKeyframe = false;
+
+        size_t pos = sizeof(uint32_t);
+        const size_t length = static_cast<size_t>(receivedLength);
+        while (pos < length) {
+            if (length - pos < 2 * sizeof(uint32_t)) {
+                throw Err(5032, "Received malformed shared data delta");
+            }
+            const size_t offset = readUint32(receivedData + pos);
+            const size_t rangeLength = readUint32(receivedData + pos + sizeof(uint32_t));
+            pos += 2 * sizeof(uint32_t);
+
+            const bool isValid = rangeLength <= length - pos && offset <= size &&
+                rangeLength <= size - offset;
+            if (!isValid) {
+                throw Err(5032, "Received malformed shared data delta");
+            }
+            std::memcpy(_dataBlock.data() + offset, receivedData + pos, rangeLength);
+            pos += rangeLength;
+        }
     }
 
-    if (_decodeFn) {
-        std::vector<std::byte> data;
-        data.assign(
+    decodeFrame(_dataBlock);
+}
+
+void SharedData::decodeKeyframe(const char* receivedData, int receivedLength) {
+    ZoneScoped;
+
+    size_t offset = 0;
+    SharedObjectRegistry& registry = SharedObjectRegistry::instance();
+    if (registry.hasVariables()) {
+        Deserializer deserializer(std::span<const std::byte>(
             reinterpret_cast<const std::byte*>(receivedData),
-            reinterpret_cast<const std::byte*>(receivedData) + receivedLength
-        );
-        _decodeFn(data);
+            static_cast<size_t>(receivedLength)
+        ));
+        registry.decode(deserializer);
+        offset = deserializer.position();
+    }
+
+    // The rest is the same full frame that the other clients use as their reference
+    decode(receivedData + offset, receivedLength - static_cast<int>(offset));
+}
+
+void SharedData::decodeFrame(std::span<const std::byte> frame) {
+    // The shared variables are placed in front of the application's data
+    size_t offset = 0;
+    SharedObjectRegistry& registry = SharedObjectRegistry::instance();
+    if (registry.hasVariables()) {
+        Deserializer deserializer(frame);
+        registry.decode(deserializer);
+        offset = deserializer.position();
+    }
+
+    if (_decodeViewFn) {
+        _decodeViewFn(frame.subspan(offset));
+    }
+    else if (_decodeFn) {
+        if (offset == 0) {
+            // The `_dataBlock` always contains the entire frame at this point
+            _decodeFn(_dataBlock);
+        }
+        else {
+            _applicationBlock.assign(frame.begin() + offset, frame.end());
+            _decodeFn(_applicationBlock);
+        }
     }
 }
 
@@ -85,7 +298,16 @@ void SharedData::encode() {
 
     {
         const std::unique_lock lock(mutex::DataSync);
+        if (_useDeltaEncoding) {
+            // The last frame is kept as the reference for the delta. Swapping the buffers
+            // also means that we reuse the memory of the frame before that
+            std::swap(_dataBlock, _previousBlock);
+        }
         _dataBlock.clear();
+        _isCompressed = false;
+        _isDelta = false;
+        _hasKeyframe = false;
+        _dataBlockOffset = Network::HeaderSize;
 
         _dataBlock.insert(
             _dataBlock.begin(),
@@ -94,24 +316,182 @@ void SharedData::encode() {
         );
     }
 
-    if (_encodeFn) {
+    SharedObjectRegistry& registry = SharedObjectRegistry::instance();
+    if (registry.hasVariables()) {
+        registry.encode(_dataBlock, _allVariablesRequested.exchange(false));
+    }
+
+    if (_encodeIntoFn) {
+        _encodeIntoFn(_dataBlock);
+        if (_dataBlock.size() < Network::HeaderSize) {
+            throw Err(5043, "Shared data encode function removed the network header");
+        }
+    }
+    else if (_encodeFn) {
         std::vector<std::byte> data = _encodeFn();
         _dataBlock.insert(_dataBlock.end(), data.begin(), data.end());
     }
+
+    if (_useDeltaEncoding) {
+        encodeDelta();
+    }
+
+    if (_useCompression) {
+        compress();
+    }
+}
+
+void SharedData::encodeDelta() {
+    ZoneScoped;
+
+    _framesSinceKeyframe++;
+    const bool isKeyframe =
+        _keyframeRequested.exchange(false) || _previousBlock.empty() ||
+        _framesSinceKeyframe >= _keyframeInterval;
+    if (isKeyframe) {
+        _framesSinceKeyframe = 0;
+        return;
+    }
+
+    const std::byte* prev = _previousBlock.data() + Network::HeaderSize;
+    const std::byte* curr = _dataBlock.data() + Network::HeaderSize;
+    const size_t prevSize = _previousBlock.size() - Network::HeaderSize;
+    const size_t currSize = _dataBlock.size() - Network::HeaderSize;
+    const size_t commonSize = std::min(prevSize, currSize);
+
+    _deltaBlock.clear();
+    // The delta is discarded once it grows to the size of the full frame, so reserving
+    // that size up front means that the buffer never has to grow while it is filled
+    _deltaBlock.reserve(_dataBlock.size());
+    _deltaBlock.insert(
+        _deltaBlock.end(),
+        _headerSpace.cbegin(),
+        _headerSpace.cbegin() + Network::HeaderSize
+    );
+    _deltaBlock[0] = static_cast<std::byte>(Network::DeltaId);
+    appendUint32(_deltaBlock, static_cast<uint32_t>(currSize));
+
+    auto appendRange = [this, curr](size_t begin, size_t end) {
+        appendUint32(_deltaBlock, static_cast<uint32_t>(begin));
+        appendUint32(_deltaBlock, static_cast<uint32_t>(end - begin));
+        _deltaBlock.insert(_deltaBlock.end(), curr + begin, curr + end);
+    };
+
+    size_t pos = findFirstDifference(prev, curr, 0, commonSize);
+    while (pos < commonSize) {
+        const size_t end = findFirstEqual(prev, curr, pos, commonSize);
+        if (end == commonSize) {
+            // Merge the last changed range with the bytes that were added, if any
+            appendRange(pos, currSize);
+            pos = currSize;
+            break;
+        }
+        appendRange(pos, end);
+
+        // A delta that is larger than the full frame is not worth sending
+        if (_deltaBlock.size() >= _dataBlock.size()) {
+            _framesSinceKeyframe = 0;
+            return;
+        }
+        pos = findFirstDifference(prev, curr, end, commonSize);
+    }
+    if (pos < currSize) {
+        appendRange(pos, currSize);
+    }
+
+    if (_deltaBlock.size() >= _dataBlock.size()) {
+        _framesSinceKeyframe = 0;
+        return;
+    }
+    _isDelta = true;
+}
+
+const std::vector<std::byte>& SharedData::uncompressedBlock() const {
+    return _isDelta ? _deltaBlock : _dataBlock;
+}
+
+void SharedData::compress() {
+    ZoneScoped;
+
+    const std::vector<std::byte>& block = uncompressedBlock();
+    const size_t payloadSize = block.size() - Network::HeaderSize;
+    if (payloadSize < CompressionMinimumSize) {
+        return;
+    }
+
+    if (!_deflateStream) {
+        _deflateStream = std::unique_ptr<z_stream_s, DeflateDeleter>(new z_stream);
+        std::memset(_deflateStream.get(), 0, sizeof(z_stream));
+        const int res = deflateInit(_deflateStream.get(), _compressionLevel);
+        if (res != Z_OK) {
+            // Don't use the deleter as the stream was never successfully initialized
+            delete _deflateStream.release();
+            throw Err(5029, std::format("Failed to initialize compression: {}", res));
+        }
+    }
+    else {
+        deflateReset(_deflateStream.get());
+    }
+
+    // The vector is only ever grown so that we don't have to initialize the memory for
+    // every frame. `_compressedSize` contains the number of actually used bytes
+    const size_t bound =
+        deflateBound(_deflateStream.get(), static_cast<uLong>(payloadSize));
+    if (_compressedBlock.size() < Network::HeaderSize + bound) {
+        _compressedBlock.resize(Network::HeaderSize + bound);
+    }
+
+    z_stream& stream = *_deflateStream;
+    // The input is never modified, but zlib might be compiled without const pointers
+    std::byte* input = const_cast<std::byte*>(block.data()) + Network::HeaderSize;
+    stream.next_in = reinterpret_cast<Bytef*>(input);
+    stream.avail_in = static_cast<uInt>(payloadSize);
+    stream.next_out =
+        reinterpret_cast<Bytef*>(_compressedBlock.data() + Network::HeaderSize);
+    stream.avail_out = static_cast<uInt>(bound);
+    const int res = deflate(&stream, Z_FINISH);
+    if (res != Z_STREAM_END) {
+        Log::Warning(std::format("Failed to compress shared data: {}", res));
+        return;
+    }
+
+    // Only send the compressed data if it is actually worth it
+    const size_t compressedSize = stream.total_out;
+    if (compressedSize > payloadSize * CompressionMaximumRatio) {
+        return;
+    }
+
+    std::memcpy(_compressedBlock.data(), block.data(), Network::HeaderSize);
+    // The uncompressed size is stored in the last four bytes of the header, which is a
+    // signal to the clients that the payload has to be decompressed first
+    const uint32_t uncompressedSize = static_cast<uint32_t>(payloadSize);
+    std::memcpy(_compressedBlock.data() + 9, &uncompressedSize, sizeof(uint32_t));
+    _compressedSize = Network::HeaderSize + compressedSize;
+    _isCompressed = true;
 }
 
 unsigned char* SharedData::dataBlock() {
-    return reinterpret_cast<unsigned char*>(_dataBlock.data());
+    if (_isCompressed) {
+        return reinterpret_cast<unsigned char*>(_compressedBlock.data());
+    }
+    return reinterpret_cast<unsigned char*>(
+        _isDelta ? _deltaBlock.data() : _dataBlock.data()
+    );
 }
 
 int SharedData::dataSize() {
-    return static_cast<int>(_dataBlock.size());
+    return static_cast<int>(_isCompressed ? _compressedSize : uncompressedBlock().size());
 }
 
 int SharedData::bufferSize() {
     return static_cast<int>(_dataBlock.capacity());
 }
 
+void SharedData::DeflateDeleter::operator()(z_stream_s* stream) const {
+    deflateEnd(stream);
+    delete stream;
+}
+
 template <>
 void serializeObject(std::vector<std::byte>& buffer, std::string_view value) {
     uint32_t length = static_cast<uint32_t>(value.size());
@@ -174,4 +554,97 @@ void deserializeObject(const std::vector<std::byte>& buffer, unsigned int& pos,
     pos += size * sizeof(std::wstring::value_type);
 }
 
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+                       std::string_view& value)
+{
+    uint32_t size = 0;
+    deserializeObject(buffer, pos, size);
+
+    value = std::string_view(reinterpret_cast<const char*>(buffer.data() + pos), size);
+    pos += size;
+}
+
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+                       std::string& value)
+{
+    std::string_view view;
+    deserializeObject(buffer, pos, view);
+    value = view;
+}
+
+void deserializeObject(std::span<const std::byte> buffer, unsigned int& pos,
+                       std::wstring& value)
+{
+    uint32_t size = 0;
+    deserializeObject(buffer, pos, size);
+
+    value.resize(size);
+    std::memcpy(value.data(), buffer.data() + pos, size * sizeof(wchar_t));
+    pos += size * sizeof(wchar_t);
+}
+
+Deserializer::Deserializer(std::span<const std::byte> buffer)
+    : _buffer(buffer)
+{}
+
+bool Deserializer::read(std::string& value) {
+    std::string_view view;
+    if (!readView(view)) {
+        return false;
+    }
+    value = view;
+    return true;
+}
+
+bool Deserializer::read(std::wstring& value) {
+    uint32_t length = 0;
+    const std::byte* p = advanceArray(sizeof(wchar_t), length);
+    if (!p) {
+        return false;
+    }
+    value.resize(length);
+    std::memcpy(value.data(), p, length * sizeof(wchar_t));
+    return true;
+}
+
+bool Deserializer::readView(std::string_view& view) {
+    uint32_t length = 0;
+    const std::byte* p = advanceArray(sizeof(char), length);
+    if (!p) {
+        return false;
+    }
+    view = std::string_view(reinterpret_cast<const char*>(p), length);
+    return true;
+}
+
+size_t Deserializer::position() const {
+    return _pos;
+}
+
+size_t Deserializer::remaining() const {
+    return _buffer.size() - _pos;
+}
+
+bool Deserializer::hasError() const {
+    return _hasError;
+}
+
+void Deserializer::setError() {
+    _hasError = true;
+}
+
+const std::byte* Deserializer::advanceArray(size_t elementSize, uint32_t& length) {
+    uint32_t l = 0;
+    if (!read(l)) {
+        return nullptr;
+    }
+    // Check the number of elements rather than the bytes to prevent an overflow
+    if (l > remaining() / elementSize) {
+        _hasError = true;
+        return nullptr;
+    }
+    length = l;
+    return advance(l * elementSize);
+}
+
 } // namespace sgct
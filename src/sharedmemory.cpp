@@ -0,0 +1,299 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/sharedmemory.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define SGCT_ERRNO errno
+#endif // WIN32
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <thread>
+#include <utility>
+
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace {
+    std::filesystem::path pipePath(const std::string& name, int ring) {
+        // The name of the shared memory segment starts with a slash
+        return std::filesystem::temp_directory_path() /
+            std::format("{}-{}", name.substr(1), ring);
+    }
+
+    void copyToRing(std::byte* ring, size_t ringSize, uint64_t position,
+                    const char* data, size_t size)
+    {
+        const size_t offset = position % ringSize;
+        const size_t first = std::min(size, ringSize - offset);
+        std::memcpy(ring + offset, data, first);
+        std::memcpy(ring, data + first, size - first);
+    }
+
+    void copyFromRing(const std::byte* ring, size_t ringSize, uint64_t position,
+                      char* data, size_t size)
+    {
+        const size_t offset = position % ringSize;
+        const size_t first = std::min(size, ringSize - offset);
+        std::memcpy(data, ring + offset, first);
+        std::memcpy(data + first, ring, size - first);
+    }
+} // namespace
+
+namespace sgct {
+
+// The atomics are shared between processes, which only works if they don't use a lock
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+std::string SharedMemoryChannel::uniqueName(int port) {
+    // Names are limited to 31 characters on macOS
+    std::random_device device;
+    const uint64_t id = (static_cast<uint64_t>(device()) << 32) | device();
+    return std::format("/sgct-{}-{:016x}", port, id);
+}
+
+SharedMemoryChannel::SharedMemoryChannel(std::string name, Mode mode)
+    : _name(std::move(name))
+    , _mode(mode)
+{
+    ZoneScoped;
+
+#ifdef WIN32
+    throw Err(5050, "Shared memory channels are not supported on Windows");
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    if (_mode == Mode::Open) {
+        _writeRing = 1;
+        _readRing = 0;
+    }
+
+    try {
+        const int file = _mode == Mode::Create ?
+            shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) :
+            shm_open(_name.c_str(), O_RDWR, 0);
+        if (file == -1) {
+            throw Err(
+                5050,
+                std::format("Failed to open shared memory '{}': {}", _name, SGCT_ERRNO)
+            );
+        }
+        _isLinked = _mode == Mode::Create;
+
+        if (_mode == Mode::Create) {
+            _size = DataOffset + 2 * RingSize;
+            if (ftruncate(file, static_cast<off_t>(_size)) == -1) {
+                ::close(file);
+                throw Err(
+                    5051,
+                    std::format("Failed to resize shared memory: {}", SGCT_ERRNO)
+                );
+            }
+        }
+        else {
+            struct stat info = {};
+            fstat(file, &info);
+            _size = static_cast<size_t>(info.st_size);
+            if (_size != DataOffset + 2 * RingSize) {
+                ::close(file);
+                throw Err(
+                    5053,
+                    std::format("'{}' is not a shared memory channel", _name)
+                );
+            }
+        }
+
+        void* memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        ::close(file);
+        if (memory == MAP_FAILED) {
+            throw Err(5051, std::format("Failed to map shared memory: {}", SGCT_ERRNO));
+        }
+        _memory = reinterpret_cast<std::byte*>(memory);
+
+        if (_mode == Mode::Create) {
+            _control = new (_memory) Control;
+        }
+        else {
+            _control = reinterpret_cast<Control*>(_memory);
+            if (_control->magic != Control().magic || _control->ringSize != RingSize) {
+                throw Err(
+                    5053,
+                    std::format("'{}' is not a shared memory channel", _name)
+                );
+            }
+        }
+
+        for (int i = 0; i < 2; i++) {
+            const std::filesystem::path path = pipePath(_name, i);
+            if (_mode == Mode::Create && mkfifo(path.c_str(), 0600) == -1) {
+                throw Err(
+                    5052,
+                    std::format(
+                        "Failed to create pipe '{}': {}", path.string(), SGCT_ERRNO
+                    )
+                );
+            }
+            // Opening the pipe for reading and writing never blocks, regardless of
+            // whether the other side has opened it yet
+            _pipes[i] = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (_pipes[i] == -1) {
+                throw Err(
+                    5052,
+                    std::format(
+                        "Failed to open pipe '{}': {}", path.string(), SGCT_ERRNO
+                    )
+                );
+            }
+        }
+    }
+    catch (const Error&) {
+        unlink();
+        for (int pipe : _pipes) {
+            if (pipe != -1) {
+                ::close(pipe);
+            }
+        }
+        if (_memory) {
+            munmap(_memory, _size);
+        }
+        throw;
+    }
+#endif // WIN32
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+#ifndef WIN32
+    close();
+    unlink();
+    for (int pipe : _pipes) {
+        ::close(pipe);
+    }
+    munmap(_memory, _size);
+#endif // WIN32
+}
+
+const std::string& SharedMemoryChannel::name() const {
+    return _name;
+}
+
+void SharedMemoryChannel::unlink() {
+#ifndef WIN32
+    if (!_isLinked) {
+        return;
+    }
+
+    shm_unlink(_name.c_str());
+    for (int i = 0; i < 2; i++) {
+        ::unlink(pipePath(_name, i).c_str());
+    }
+    _isLinked = false;
+#endif // WIN32
+}
+
+void SharedMemoryChannel::close() {
+    if (_control) {
+        _control->isClosed = 1;
+    }
+}
+
+bool SharedMemoryChannel::write(std::initializer_list<std::span<const char>> buffers) {
+    ZoneScoped;
+
+    Control::Ring& ring = _control->rings[_writeRing];
+    std::byte* data = _memory + DataOffset + _writeRing * RingSize;
+
+    // Makes the data up to `tail` visible to the reader and wakes it up if it is waiting.
+    // The reader announces that it waits before checking the position for the last
+    // time, so either it sees the new position or we see that it is waiting
+    auto publish = [this, &ring](uint64_t tail) {
+        ring.tail.store(tail, std::memory_order_seq_cst);
+        if (ring.isWaiting.exchange(0, std::memory_order_seq_cst) != 0) {
+#ifndef WIN32
+            // If the pipe is full, the reader has not consumed the previous wakeups yet
+            constexpr char Wakeup = 0;
+            [[maybe_unused]] const ssize_t res = ::write(_pipes[_writeRing], &Wakeup, 1);
+#endif // WIN32
+        }
+    };
+
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    for (std::span<const char> buffer : buffers) {
+        size_t offset = 0;
+        while (offset < buffer.size()) {
+            const uint64_t head = ring.head.load(std::memory_order_acquire);
+            const size_t available = RingSize - static_cast<size_t>(tail - head);
+            if (available == 0) {
+                // Just like a socket, data is only refused if it can't be buffered
+                if (_control->isClosed) {
+                    return false;
+                }
+
+                // The reader can only make space once it knows about the data so far.
+                // A full ring means that the reader is far behind, so there is no need
+                // for a notification when the space becomes available
+                publish(tail);
+                std::this_thread::yield();
+                continue;
+            }
+
+            const size_t size = std::min(available, buffer.size() - offset);
+            copyToRing(data, RingSize, tail, buffer.data() + offset, size);
+            tail += size;
+            offset += size;
+        }
+    }
+    publish(tail);
+    return true;
+}
+
+size_t SharedMemoryChannel::read(char* buffer, size_t size) {
+    ZoneScoped;
+
+    Control::Ring& ring = _control->rings[_readRing];
+    const std::byte* data = _memory + DataOffset + _readRing * RingSize;
+
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head == tail) {
+        // The wakeups are consumed before announcing that we wait, as the writer only
+        // writes to the pipe after it saw us waiting
+#ifndef WIN32
+        std::array<char, 64> wakeups;
+        while (::read(_pipes[_readRing], wakeups.data(), wakeups.size()) > 0) {}
+#endif // WIN32
+
+        ring.isWaiting.store(1, std::memory_order_seq_cst);
+        tail = ring.tail.load(std::memory_order_seq_cst);
+        if (head == tail) {
+            return 0;
+        }
+        ring.isWaiting.store(0, std::memory_order_relaxed);
+    }
+
+    const size_t n = std::min(size, static_cast<size_t>(tail - head));
+    copyFromRing(data, RingSize, head, buffer, n);
+    ring.head.store(head + n, std::memory_order_release);
+    return n;
+}
+
+SGCT_SOCKET SharedMemoryChannel::notification() const {
+    return static_cast<SGCT_SOCKET>(_pipes[_readRing]);
+}
+
+} // namespace sgct
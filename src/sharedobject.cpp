@@ -0,0 +1,189 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/sharedobject.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/profiling.h>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <span>
+
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace {
+    // The application's data follows the shared variables in the frame
+    constexpr size_t SectionAlignment = alignof(std::max_align_t);
+
+    // Returns the number of padding bytes that follow a section of \p size bytes
+    size_t paddingSize(size_t size) {
+        return (SectionAlignment - size % SectionAlignment) % SectionAlignment;
+    }
+} // namespace
+
+namespace sgct {
+
+SharedVariable::~SharedVariable() {
+    // Only in case the derived class did not remove the variable itself already
+    unregisterVariable();
+}
+
+void SharedVariable::registerVariable() {
+    SharedObjectRegistry::instance().add(this);
+}
+
+void SharedVariable::unregisterVariable() {
+    SharedObjectRegistry::instance().remove(this);
+}
+
+uint16_t SharedVariable::id() const {
+    return _id;
+}
+
+bool SharedVariable::isDirty() const {
+    const std::unique_lock lock(valueMutex());
+    return _isDirty;
+}
+
+std::mutex& SharedVariable::valueMutex() {
+    return SharedObjectRegistry::instance()._mutex;
+}
+
+void SharedVariable::markDirty() {
+    if (!_isDirty) {
+        _isDirty = true;
+        SharedObjectRegistry::instance().markDirty(this);
+    }
+}
+
+SharedObjectRegistry& SharedObjectRegistry::instance() {
+    static SharedObjectRegistry registry;
+    return registry;
+}
+
+bool SharedObjectRegistry::hasVariables() {
+    const std::unique_lock lock(_mutex);
+    return _nVariables > 0;
+}
+
+void SharedObjectRegistry::encode(std::vector<std::byte>& buffer, bool includeAll) {
+    ZoneScoped;
+
+    const std::unique_lock lock(_mutex);
+
+    // The number of variables is only known at the end, so we reserve its space first
+    const size_t countPos = buffer.size();
+    const size_t start = buffer.size();
+    serializeObject(buffer, uint16_t(0));
+
+    auto encodeVariable = [&buffer](SharedVariable& variable) {
+        serializeObject(buffer, variable._id);
+        variable.serializeValue(buffer);
+        variable._isDirty = false;
+    };
+
+    uint16_t count = 0;
+    if (includeAll) {
+        for (SharedVariable* variable : _variables) {
+            if (variable) {
+                encodeVariable(*variable);
+                count++;
+            }
+        }
+    }
+    else {
+        for (uint16_t id : _dirtyVariables) {
+            // Variables that were removed after they were changed are skipped
+            if (_variables[id]) {
+                encodeVariable(*_variables[id]);
+                count++;
+            }
+        }
+    }
+    _dirtyVariables.clear();
+    std::memcpy(buffer.data() + countPos, &count, sizeof(uint16_t));
+    buffer.resize(buffer.size() + paddingSize(buffer.size() - start), std::byte(0));
+}
+
+void SharedObjectRegistry::encodeAll(std::vector<std::byte>& buffer) {
+    ZoneScoped;
+
+    const std::unique_lock lock(_mutex);
+
+    const size_t start = buffer.size();
+    serializeObject(buffer, static_cast<uint16_t>(_nVariables));
+    for (SharedVariable* variable : _variables) {
+        if (variable) {
+            serializeObject(buffer, variable->_id);
+            variable->serializeValue(buffer);
+        }
+    }
+    buffer.resize(buffer.size() + paddingSize(buffer.size() - start), std::byte(0));
+}
+
+void SharedObjectRegistry::decode(Deserializer& deserializer) {
+    ZoneScoped;
+
+    const std::unique_lock lock(_mutex);
+
+    const size_t start = deserializer.position();
+    uint16_t count = 0;
+    deserializer.read(count);
+    for (uint16_t i = 0; i < count && !deserializer.hasError(); i++) {
+        uint16_t id = 0;
+        if (!deserializer.read(id)) {
+            break;
+        }
+        if (id >= _variables.size() || !_variables[id]) {
+            throw Err(
+                5044,
+                std::format("Received value for unknown shared variable {}", id)
+            );
+        }
+        _variables[id]->deserializeValue(deserializer);
+    }
+
+    std::array<std::byte, SectionAlignment> padding;
+    const size_t size = deserializer.position() - start;
+    deserializer.read(std::span(padding.data(), paddingSize(size)));
+
+    if (deserializer.hasError()) {
+        throw Err(5044, "Received malformed shared variables");
+    }
+}
+
+void SharedObjectRegistry::add(SharedVariable* variable) {
+    const std::unique_lock lock(_mutex);
+
+    if (_variables.size() >= std::numeric_limits<uint16_t>::max()) {
+        throw Err(5045, "Too many shared variables have been created");
+    }
+    variable->_id = static_cast<uint16_t>(_variables.size());
+    _variables.push_back(variable);
+    _nVariables++;
+    // New variables are always sent in the next frame
+    _dirtyVariables.push_back(variable->_id);
+}
+
+void SharedObjectRegistry::remove(SharedVariable* variable) {
+    const std::unique_lock lock(_mutex);
+
+    if (variable->_id < _variables.size() && _variables[variable->_id] == variable) {
+        _variables[variable->_id] = nullptr;
+        _nVariables--;
+    }
+}
+
+void SharedObjectRegistry::markDirty(SharedVariable* variable) {
+    _dirtyVariables.push_back(variable->_id);
+}
+
+} // namespace sgct
@@ -0,0 +1,462 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/syncrecording.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#define SGCT_ERRNO GetLastError()
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define SGCT_ERRNO errno
+#endif // WIN32
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/network.h>
+#include <sgct/profiling.h>
+#include <sgct/shareddata.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace {
+    // The size of the file when the recording starts. The file grows by doubling its
+    // size whenever it is full and is truncated to its used size when it is closed
+    constexpr size_t InitialFileSize = 16 * 1024 * 1024;
+
+    // The size of the number of frames, the index offset, and the magic at the end
+    constexpr size_t TrailerSize =
+        2 * sizeof(uint64_t) + sgct::SyncRecorder::IndexMagic.size();
+
+    // The position of the frame size within each record
+    constexpr size_t FrameSizeOffset = sizeof(uint64_t) + sizeof(double);
+
+    template <typename T>
+    T readValue(const std::byte* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void appendValue(std::vector<std::byte>& buffer, T value) {
+        const std::byte* p = reinterpret_cast<const std::byte*>(&value);
+        buffer.insert(buffer.end(), p, p + sizeof(T));
+    }
+} // namespace
+
+namespace sgct {
+
+MappedFile::MappedFile(const std::filesystem::path& path, Mode mode)
+    : _mode(mode)
+{
+#ifdef WIN32
+    _file = CreateFileW(
+        path.c_str(),
+        mode == Mode::Write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        mode == Mode::Write ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        throw Err(
+            5046,
+            std::format("Failed to open file '{}': {}", path.string(), SGCT_ERRNO)
+        );
+    }
+
+    if (mode == Mode::Read) {
+        LARGE_INTEGER size;
+        GetFileSizeEx(_file, &size);
+        _size = static_cast<size_t>(size.QuadPart);
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    _file = mode == Mode::Write ?
+        open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) :
+        open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_file == -1) {
+        throw Err(
+            5046,
+            std::format("Failed to open file '{}': {}", path.string(), SGCT_ERRNO)
+        );
+    }
+
+    if (mode == Mode::Read) {
+        struct stat info = {};
+        fstat(_file, &info);
+        _size = static_cast<size_t>(info.st_size);
+    }
+#endif // WIN32
+
+    if (_size > 0) {
+        try {
+            map();
+        }
+        catch (const Error&) {
+#ifdef WIN32
+            CloseHandle(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            close(_file);
+#endif // WIN32
+            throw;
+        }
+    }
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+#ifdef WIN32
+    CloseHandle(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    close(_file);
+#endif // WIN32
+}
+
+void MappedFile::resize(size_t size) {
+    unmap();
+
+#ifdef WIN32
+    LARGE_INTEGER s;
+    s.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(_file, s, nullptr, FILE_BEGIN) || !SetEndOfFile(_file)) {
+        throw Err(5047, std::format("Failed to resize file: {}", SGCT_ERRNO));
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    if (ftruncate(_file, static_cast<off_t>(size)) == -1) {
+        throw Err(5047, std::format("Failed to resize file: {}", SGCT_ERRNO));
+    }
+#endif // WIN32
+
+    _size = size;
+    if (_size > 0) {
+        map();
+    }
+}
+
+std::byte* MappedFile::data() {
+    return _data;
+}
+
+const std::byte* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+void MappedFile::map() {
+#ifdef WIN32
+    const uint64_t size = _size;
+    _mapping = CreateFileMappingW(
+        _file,
+        nullptr,
+        _mode == Mode::Write ? PAGE_READWRITE : PAGE_READONLY,
+        static_cast<DWORD>(size >> 32),
+        static_cast<DWORD>(size & 0xFFFFFFFF),
+        nullptr
+    );
+    if (!_mapping) {
+        throw Err(5047, std::format("Failed to map file: {}", SGCT_ERRNO));
+    }
+    void* data = MapViewOfFile(
+        _mapping,
+        _mode == Mode::Write ? FILE_MAP_WRITE : FILE_MAP_READ,
+        0,
+        0,
+        _size
+    );
+    if (!data) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+        throw Err(5047, std::format("Failed to map file: {}", SGCT_ERRNO));
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    void* data = mmap(
+        nullptr,
+        _size,
+        _mode == Mode::Write ? PROT_READ | PROT_WRITE : PROT_READ,
+        _mode == Mode::Write ? MAP_SHARED : MAP_PRIVATE,
+        _file,
+        0
+    );
+    if (data == MAP_FAILED) {
+        throw Err(5047, std::format("Failed to map file: {}", SGCT_ERRNO));
+    }
+#endif // WIN32
+    _data = reinterpret_cast<std::byte*>(data);
+}
+
+void MappedFile::unmap() {
+    if (!_data) {
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+    _mapping = nullptr;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    munmap(_data, _size);
+#endif // WIN32
+    _data = nullptr;
+}
+
+SyncRecorder::SyncRecorder(const std::filesystem::path& path)
+    : _file(path, MappedFile::Mode::Write)
+    , _start(std::chrono::steady_clock::now())
+{
+    _file.resize(InitialFileSize);
+
+    std::vector<std::byte> header(FileHeaderSize, std::byte(0));
+    std::memcpy(header.data(), Magic.data(), Magic.size());
+    std::memcpy(header.data() + Magic.size(), &Version, sizeof(Version));
+    append(header);
+
+    _thread = std::thread([this]() { writeFrames(); });
+    Log::Info(std::format("Recording shared data to '{}'", path.string()));
+}
+
+SyncRecorder::~SyncRecorder() {
+    {
+        const std::unique_lock lock(_mutex);
+        _shouldTerminate = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+
+    try {
+        std::vector<std::byte> index;
+        index.reserve(_offsets.size() * sizeof(uint64_t) + TrailerSize);
+        for (uint64_t offset : _offsets) {
+            appendValue(index, offset);
+        }
+        appendValue(index, static_cast<uint64_t>(_offsets.size()));
+        appendValue(index, static_cast<uint64_t>(_writePos));
+        const std::byte* magic = reinterpret_cast<const std::byte*>(IndexMagic.data());
+        index.insert(index.end(), magic, magic + IndexMagic.size());
+        append(index);
+
+        _file.resize(_writePos);
+    }
+    catch (const Error& e) {
+        Log::Error(std::format("Failed to finish recording: {}", e.what()));
+    }
+}
+
+void SyncRecorder::record(std::span<const std::byte> frame) {
+    ZoneScoped;
+
+    const double timestamp = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - _start
+    ).count();
+
+    {
+        const std::unique_lock lock(_mutex);
+        appendValue(_pending, _frameNumber);
+        appendValue(_pending, timestamp);
+        appendValue(_pending, static_cast<uint32_t>(frame.size()));
+        _pending.insert(_pending.end(), frame.begin(), frame.end());
+    }
+    _frameNumber++;
+    _cv.notify_one();
+}
+
+void SyncRecorder::writeFrames() {
+    while (true) {
+        {
+            std::unique_lock lock(_mutex);
+            _cv.wait(lock, [this]() { return _shouldTerminate || !_pending.empty(); });
+            if (_pending.empty()) {
+                // We only terminate once all recorded frames have been written
+                return;
+            }
+            std::swap(_pending, _writing);
+        }
+
+        ZoneScopedN("Write recorded frames");
+        try {
+            size_t pos = 0;
+            while (pos + RecordHeaderSize <= _writing.size()) {
+                const uint32_t size =
+                    readValue<uint32_t>(_writing.data() + pos + FrameSizeOffset);
+                _offsets.push_back(_writePos);
+                append(std::span(_writing).subspan(pos, RecordHeaderSize + size));
+                pos += RecordHeaderSize + size;
+            }
+        }
+        catch (const Error& e) {
+            Log::Error(std::format("Failed to record shared data: {}", e.what()));
+        }
+        _writing.clear();
+    }
+}
+
+void SyncRecorder::append(std::span<const std::byte> data) {
+    if (_writePos + data.size() > _file.size()) {
+        _file.resize(std::max(2 * _file.size(), _writePos + data.size()));
+    }
+    std::memcpy(_file.data() + _writePos, data.data(), data.size());
+    _writePos += data.size();
+}
+
+SyncReplayer::SyncReplayer(const std::filesystem::path& path, bool useOriginalRate)
+    : _file(path, MappedFile::Mode::Read)
+    , _useOriginalRate(useOriginalRate)
+{
+    const std::byte* data = _file.data();
+    const size_t size = _file.size();
+
+    const bool hasHeader = size >= SyncRecorder::FileHeaderSize &&
+        std::memcmp(data, SyncRecorder::Magic.data(), SyncRecorder::Magic.size()) == 0;
+    if (!hasHeader) {
+        throw Err(5048, std::format("'{}' is not a recording", path.string()));
+    }
+    const uint32_t version = readValue<uint32_t>(data + SyncRecorder::Magic.size());
+    if (version != SyncRecorder::Version) {
+        throw Err(5048, std::format("Unsupported recording version {}", version));
+    }
+
+    const std::byte* magic = data + size - SyncRecorder::IndexMagic.size();
+    const bool hasIndex = size >= SyncRecorder::FileHeaderSize + TrailerSize &&
+        std::memcmp(
+            magic,
+            SyncRecorder::IndexMagic.data(),
+            SyncRecorder::IndexMagic.size()
+        ) == 0;
+    if (hasIndex) {
+        const std::byte* trailer = data + size - TrailerSize;
+        const uint64_t nFrames = readValue<uint64_t>(trailer);
+        const uint64_t indexOffset = readValue<uint64_t>(trailer + sizeof(uint64_t));
+        const bool isValid = indexOffset <= size - TrailerSize &&
+            nFrames == (size - TrailerSize - indexOffset) / sizeof(uint64_t);
+        if (!isValid) {
+            throw Err(5048, "Recording has an invalid index");
+        }
+
+        _offsets.resize(nFrames);
+        std::memcpy(_offsets.data(), data + indexOffset, nFrames * sizeof(uint64_t));
+        for (uint64_t offset : _offsets) {
+            constexpr size_t HeaderSize = SyncRecorder::RecordHeaderSize;
+            const bool isInside = offset + HeaderSize <= indexOffset &&
+                offset + HeaderSize +
+                readValue<uint32_t>(data + offset + FrameSizeOffset) <= indexOffset;
+            if (!isInside) {
+                throw Err(5048, "Recording has an invalid index");
+            }
+        }
+    }
+    else {
+        // The recording was not finished, for example because the application crashed,
+        // so we have to find the frames ourselves. The unused space at the end of the
+        // file is filled with zeros, which can't be a valid frame size
+        Log::Warning("Recording has no index. Reading all frames that are complete");
+        size_t pos = SyncRecorder::FileHeaderSize;
+        while (pos + SyncRecorder::RecordHeaderSize <= size) {
+            const uint32_t frameSize = readValue<uint32_t>(data + pos + FrameSizeOffset);
+            const size_t end = pos + SyncRecorder::RecordHeaderSize + frameSize;
+            if (frameSize == 0 || end > size) {
+                break;
+            }
+            _offsets.push_back(pos);
+            pos = end;
+        }
+    }
+
+    Log::Info(std::format(
+        "Replaying {} frames from '{}'", _offsets.size(), path.string()
+    ));
+}
+
+size_t SyncReplayer::nFrames() const {
+    return _offsets.size();
+}
+
+SyncReplayer::Frame SyncReplayer::frame(size_t index) const {
+    const std::byte* record = _file.data() + _offsets[index];
+    Frame frame;
+    frame.frameNumber = readValue<uint64_t>(record);
+    frame.timestamp = readValue<double>(record + sizeof(uint64_t));
+    const uint32_t size = readValue<uint32_t>(record + FrameSizeOffset);
+    frame.data = std::span(record + SyncRecorder::RecordHeaderSize, size);
+    return frame;
+}
+
+bool SyncReplayer::decodeNextFrame() {
+    ZoneScoped;
+
+    if (_nextFrame >= _offsets.size()) {
+        return false;
+    }
+
+    const Frame f = frame(_nextFrame);
+    if (_nextFrame == 0) {
+        _start = std::chrono::steady_clock::now() -
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(f.timestamp)
+            );
+    }
+    _nextFrame++;
+
+    if (_useOriginalRate) {
+        std::this_thread::sleep_until(
+            _start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(f.timestamp)
+            )
+        );
+    }
+
+    if (f.data.size() < Network::HeaderSize) {
+        throw Err(5048, "Recording contains an invalid frame");
+    }
+    const char id = static_cast<char>(f.data[0]);
+    const uint32_t uncompressedSize = readValue<uint32_t>(f.data.data() + 9);
+    const char* payload =
+        reinterpret_cast<const char*>(f.data.data()) + Network::HeaderSize;
+    int payloadSize = static_cast<int>(f.data.size() - Network::HeaderSize);
+
+    // The frames are recorded as they are sent, so they might have to be decompressed
+    if (uncompressedSize > 0) {
+        if (_uncompressBuffer.size() < uncompressedSize) {
+            _uncompressBuffer.resize(uncompressedSize);
+        }
+        uLongf size = uncompressedSize;
+        const int res = uncompress(
+            reinterpret_cast<Bytef*>(_uncompressBuffer.data()),
+            &size,
+            reinterpret_cast<const Bytef*>(payload),
+            static_cast<uLong>(payloadSize)
+        );
+        if (res != Z_OK) {
+            throw Err(5049, std::format("Failed to uncompress recorded frame: {}", res));
+        }
+        payload = _uncompressBuffer.data();
+        payloadSize = static_cast<int>(size);
+    }
+
+    if (id == Network::DeltaId) {
+        SharedData::instance().decodeDelta(payload, payloadSize);
+    }
+    else {
+        SharedData::instance().decode(payload, payloadSize);
+    }
+    return true;
+}
+
+} // namespace sgct
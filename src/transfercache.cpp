@@ -0,0 +1,252 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/transfercache.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // __linux__
+
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
+
+namespace {
+    // The constants of the 64 bit variant of xxHash
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+    uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // The words are read in the byte order of the machine, like the headers of the
+    // network messages
+    uint64_t read64(const char* data) {
+        uint64_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t read32(const char* data) {
+        uint32_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t hashRound(uint64_t accumulator, uint64_t input) {
+        accumulator += input * Prime2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * Prime1;
+    }
+
+    uint64_t mergeRound(uint64_t accumulator, uint64_t value) {
+        accumulator ^= hashRound(0, value);
+        return accumulator * Prime1 + Prime4;
+    }
+} // namespace
+
+namespace sgct {
+
+TransferCache::Payload::Payload(Payload&& rhs) noexcept
+    : _data(std::exchange(rhs._data, nullptr))
+    , _size(std::exchange(rhs._size, 0))
+    , _isMapped(std::exchange(rhs._isMapped, false))
+    , _buffer(std::move(rhs._buffer))
+{
+    if (!_isMapped) {
+        _data = _buffer.data();
+    }
+}
+
+TransferCache::Payload::~Payload() {
+#ifdef __linux__
+    if (_isMapped) {
+        munmap(_data, _size);
+    }
+#endif // __linux__
+}
+
+char* TransferCache::Payload::data() {
+    return _data;
+}
+
+size_t TransferCache::Payload::size() const {
+    return _size;
+}
+
+uint64_t TransferCache::hash(std::span<const char> data) {
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    uint64_t h = 0;
+    if (data.size() >= 32) {
+        // Four lanes consume the data in stripes of 32 bytes
+        uint64_t v1 = Prime1 + Prime2;
+        uint64_t v2 = Prime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - Prime1;
+        const char* limit = end - 32;
+        do {
+            v1 = hashRound(v1, read64(p));
+            v2 = hashRound(v2, read64(p + 8));
+            v3 = hashRound(v3, read64(p + 16));
+            v4 = hashRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) +
+            rotateLeft(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else {
+        h = Prime5;
+    }
+    h += static_cast<uint64_t>(data.size());
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= hashRound(0, read64(p));
+        h = rotateLeft(h, 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * Prime1;
+        h = rotateLeft(h, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= static_cast<uint64_t>(static_cast<unsigned char>(*p)) * Prime5;
+        h = rotateLeft(h, 11) * Prime1;
+    }
+
+    // Avalanche the bits of the last bytes
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+TransferCache::TransferCache(std::filesystem::path directory)
+    : _directory(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(_directory, ec);
+    if (ec) {
+        throw Err(
+            5059,
+            std::format(
+                "Could not create transfer cache '{}': {}",
+                _directory.string(), ec.message()
+            )
+        );
+    }
+
+    std::random_device device;
+    _suffix = std::format("{:08x}", device());
+}
+
+std::optional<TransferCache::Payload> TransferCache::find(uint64_t hash,
+                                                          uint64_t size) const
+{
+    // A file of the wrong size is left over from an incomplete write or belongs to a
+    // different payload with the same hash, so it is replaced once the payload arrives
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    const std::filesystem::path file = path(hash);
+#ifdef __linux__
+    const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+    struct stat status;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && static_cast<uint64_t>(status.st_size) == size) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    Payload payload;
+    payload._data = reinterpret_cast<char*>(data);
+    payload._size = size;
+    payload._isMapped = true;
+    return payload;
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    std::error_code ec;
+    if (std::filesystem::file_size(file, ec) != size || ec) {
+        return std::nullopt;
+    }
+    std::ifstream stream(file, std::ios::binary);
+    Payload payload;
+    payload._buffer.resize(size);
+    if (!stream.read(payload._buffer.data(), static_cast<std::streamsize>(size))) {
+        return std::nullopt;
+    }
+    payload._data = payload._buffer.data();
+    payload._size = size;
+    return payload;
+#endif // __linux__
+}
+
+bool TransferCache::store(uint64_t hash, std::span<const char> data) const {
+    const std::filesystem::path file = path(hash);
+    std::filesystem::path temporary = file;
+    temporary += std::format(".{}.tmp", _suffix);
+
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    stream.close();
+    if (stream.fail()) {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+        Log::Warning(std::format(
+            "Could not write '{}' to the transfer cache", file.string()
+        ));
+        return false;
+    }
+
+    // Readers only ever see the complete file
+    std::error_code ec;
+    std::filesystem::rename(temporary, file, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        Log::Warning(std::format(
+            "Could not add '{}' to the transfer cache", file.string()
+        ));
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path TransferCache::path(uint64_t hash) const {
+    return _directory / std::format("{:016x}", hash);
+}
+
+} // namespace sgct
@@ -0,0 +1,149 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/bufferpool.h>
+#include <sgct/format.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int NPackages = 2000;
+
+    // The idle time of the pool, which is shorter than the default to keep this quick
+    constexpr std::chrono::milliseconds IdleTime(100);
+
+    // The payload that is copied into the receive buffer, which stands in for `recv`
+    const std::vector<char>& payload() {
+        static const std::vector<char> Payload(16 * 1024 * 1024, 'x');
+        return Payload;
+    }
+
+    // The previous receive path of the data transfer connections, which resizes the
+    // cleared buffer for every package. This fills the whole package with zeros before it
+    // is received and keeps the largest buffer that was ever needed
+    struct Regrow {
+        std::vector<char>& acquire(size_t size) {
+            const size_t capacity = buffer.capacity();
+            buffer.resize(size);
+            if (buffer.capacity() != capacity) {
+                nAllocations++;
+            }
+            return buffer;
+        }
+
+        void release() {
+            buffer.clear();
+        }
+
+        void trim() {}
+
+        size_t retainedBytes() const {
+            return buffer.capacity();
+        }
+
+        std::vector<char> buffer;
+        uint64_t nAllocations = 0;
+    };
+
+    struct Pool {
+        std::vector<char>& acquire(size_t size) {
+            buffer = pool.acquire(size);
+            return buffer;
+        }
+
+        void release() {
+            pool.release(std::exchange(buffer, {}));
+        }
+
+        void trim() {
+            pool.trim();
+        }
+
+        size_t retainedBytes() const {
+            return pool.statistics().retainedBytes;
+        }
+
+        BufferPool pool = BufferPool(BufferPool::DefaultHighWaterMark, IdleTime);
+        std::vector<char> buffer;
+    };
+
+    uint64_t allocations(const Regrow& model) {
+        return model.nAllocations;
+    }
+
+    uint64_t allocations(const Pool& model) {
+        return model.pool.statistics().nAllocations;
+    }
+
+    // A stream of packages with the given sizes, followed by a burst of a single package
+    // that is larger than all others. The retained memory is reported right after that
+    // package and once the connection was idle for a while
+    template <typename Model>
+    void runBufferBenchmark(std::string_view name, std::string_view pattern,
+                            const std::vector<size_t>& sizes)
+    {
+        Model model;
+        uint64_t nBytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NPackages; i++) {
+            const size_t size = sizes[i % sizes.size()];
+            std::vector<char>& buffer = model.acquire(size);
+            std::memcpy(buffer.data(), payload().data(), size);
+            nBytes += size;
+            model.release();
+        }
+        const std::chrono::duration<double> duration =
+            std::chrono::steady_clock::now() - start;
+
+        std::vector<char>& burst = model.acquire(payload().size());
+        std::memcpy(burst.data(), payload().data(), payload().size());
+        model.release();
+        const size_t retained = model.retainedBytes();
+        std::this_thread::sleep_for(2 * IdleTime);
+        model.trim();
+
+        std::cout << std::format(
+            "{} ({}): {:.1f} us per package, {:.2f} GB/s, {:.3f} allocations per "
+            "package, {:.1f} MiB retained after a 16 MiB package, {:.1f} MiB when idle\n",
+            name, pattern,
+            1e6 * duration.count() / NPackages,
+            static_cast<double>(nBytes) / duration.count() / 1e9,
+            static_cast<double>(allocations(model)) / NPackages,
+            static_cast<double>(retained) / (1024.0 * 1024.0),
+            static_cast<double>(model.retainedBytes()) / (1024.0 * 1024.0)
+        );
+    }
+
+    template <typename Model>
+    void runBufferBenchmarks(std::string_view name) {
+        runBufferBenchmark<Model>(name, "constant 1 MiB", { 1024 * 1024 });
+        runBufferBenchmark<Model>(
+            name,
+            "mixed 4 KiB to 4 MiB",
+            { 4096, 4 * 1024 * 1024, 65536, 1024 * 1024, 300000, 2 * 1024 * 1024 }
+        );
+    }
+} // namespace
+
+TEST_CASE("BufferPool: Regrowing buffer", "[bufferpool]") {
+    runBufferBenchmarks<Regrow>("Regrowing buffer");
+}
+
+TEST_CASE("BufferPool: Pool", "[bufferpool]") {
+    runBufferBenchmarks<Pool>("Pool");
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/latencyhistogram.h>
+#include <sgct/shareddata.h>
+#include "loopbackcluster.h"
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int FirstPort = 20800;
+
+    // Every payload size is measured for this long, or until the maximum number of frames
+    // has been sent, after a few frames to warm up the connections
+    constexpr std::chrono::seconds Duration = std::chrono::seconds(1);
+    constexpr int MaxFrames = 2000;
+    constexpr int WarmupFrames = 10;
+
+    void runClusterBenchmark(int nClients, int firstPort) {
+        LoopbackCluster cluster(nClients, firstPort);
+
+        for (int size : { 1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024 })
+        {
+            const std::vector<std::byte> payload(size, std::byte(1));
+            SharedData::instance().setEncodeFunction(
+                [&payload](std::vector<std::byte>& buffer) {
+                    buffer.insert(buffer.end(), payload.begin(), payload.end());
+                }
+            );
+
+            for (int i = 0; i < WarmupFrames; i++) {
+                cluster.runFrame();
+            }
+
+            // The processor time includes the reactor threads of the master and of all
+            // clients, as all of them are part of this process
+            LatencyHistogram latencies;
+            const std::clock_t cpuStart = std::clock();
+            const auto start = std::chrono::steady_clock::now();
+            auto end = start;
+            while (latencies.count() < MaxFrames && end - start < Duration) {
+                latencies.add(cluster.runFrame());
+                end = std::chrono::steady_clock::now();
+            }
+            const double cpu =
+                static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            const double wall = std::chrono::duration<double>(end - start).count();
+            const double nFrames = static_cast<double>(latencies.count());
+
+            std::cout << std::format(
+                "{} clients, {} bytes: {:.0f} frames/s, latency p50 {:.3f} ms, "
+                "p95 {:.3f} ms, p99 {:.3f} ms, {:.3f} ms processor time per frame\n",
+                nClients, size, nFrames / wall,
+                1000.0 * latencies.percentile(0.5),
+                1000.0 * latencies.percentile(0.95),
+                1000.0 * latencies.percentile(0.99),
+                1000.0 * cpu / nFrames
+            );
+        }
+    }
+} // namespace
+
+TEST_CASE("Cluster: 1 client", "[cluster]") {
+    runClusterBenchmark(1, FirstPort);
+}
+
+TEST_CASE("Cluster: 4 clients", "[cluster]") {
+    runClusterBenchmark(4, FirstPort + 10);
+}
+
+TEST_CASE("Cluster: 8 clients", "[cluster]") {
+    runClusterBenchmark(8, FirstPort + 20);
+}
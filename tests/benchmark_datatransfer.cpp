@@ -0,0 +1,601 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/clustermanager.h>
+#include <sgct/config.h>
+#include <sgct/format.h>
+#include <sgct/latencyhistogram.h>
+#include <sgct/network.h>
+#include <sgct/networkmanager.h>
+#include <sgct/shareddata.h>
+#include <sgct/transfercache.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int FirstPort = 20840;
+
+    constexpr int NPackages = 400;
+    constexpr size_t PackageSize = 64 * 1024;
+
+    // The delay in each direction, which is about the round trip time of a local network
+    // including the network stacks of both nodes
+    constexpr std::chrono::microseconds Delay(250);
+
+    // The outgoing network interface of a node, which sends the bytes of all connections
+    // one after another at its bandwidth. Like the queue of a real interface, it only
+    // holds a limited backlog, and further bytes have to wait until there is room again,
+    // which pushes back on the sender's TCP connection
+    class Link {
+    public:
+        explicit Link(double bytesPerSecond) : _rate(bytesPerSecond) {}
+
+        // Waits until the link has room for the bytes and returns the time at which
+        // they have been sent
+        std::chrono::steady_clock::time_point transmit(size_t bytes) {
+            using namespace std::chrono;
+
+            std::unique_lock lock(_mutex);
+            steady_clock::time_point now = steady_clock::now();
+            while (_free - now > MaxBacklog) {
+                const steady_clock::time_point wake = _free - MaxBacklog;
+                lock.unlock();
+                std::this_thread::sleep_until(wake);
+                lock.lock();
+                now = steady_clock::now();
+            }
+            _free = std::max(_free, now) + duration_cast<steady_clock::duration>(
+                duration<double>(static_cast<double>(bytes) / _rate)
+            );
+            return _free;
+        }
+
+    private:
+        static constexpr std::chrono::milliseconds MaxBacklog =
+            std::chrono::milliseconds(5);
+
+        const double _rate;
+        std::chrono::steady_clock::time_point _free;
+        std::mutex _mutex;
+    };
+
+    // Forwards a single TCP connection on the loopback interface and delays everything
+    // that is sent through it in both directions, which stands in for the network between
+    // two nodes. If a `Link` is provided, the bytes from the listening side to the
+    // connecting side also have to pass through it
+    class DelayProxy {
+    public:
+        DelayProxy(int listenPort, int targetPort, std::chrono::microseconds delay,
+                   Link* link = nullptr)
+            : _delay(delay)
+            , _link(link)
+        {
+            _listener = socket(AF_INET, SOCK_STREAM, 0);
+            const int reuse = 1;
+            setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(static_cast<uint16_t>(listenPort));
+            bind(_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            listen(_listener, 1);
+
+            _thread = std::thread([this, targetPort]() {
+                _client = accept(_listener, nullptr, nullptr);
+                _server = socket(AF_INET, SOCK_STREAM, 0);
+                sockaddr_in target = {};
+                target.sin_family = AF_INET;
+                target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                target.sin_port = htons(static_cast<uint16_t>(targetPort));
+                connect(_server, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+                const int noDelay = 1;
+                setsockopt(_client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                setsockopt(_server, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                _upstream.start(_client, _server, _delay, nullptr);
+                _downstream.start(_server, _client, _delay, _link);
+            });
+        }
+
+        ~DelayProxy() {
+            _thread.join();
+            shutdown(_client, SHUT_RDWR);
+            shutdown(_server, SHUT_RDWR);
+            _upstream.stop();
+            _downstream.stop();
+            close(_client);
+            close(_server);
+            close(_listener);
+        }
+
+    private:
+        // Forwards everything that is received on one socket to the other one once the
+        // delay has passed since it was received
+        struct Direction {
+            struct Segment {
+                std::chrono::steady_clock::time_point due;
+                std::vector<char> data;
+            };
+
+            void start(int from, int to, std::chrono::microseconds delay, Link* link) {
+                reader = std::thread([this, from, delay, link]() {
+                    std::vector<char> buffer(256 * 1024);
+                    long n = 0;
+                    while ((n = recv(from, buffer.data(), buffer.size(), 0)) > 0) {
+                        const std::chrono::steady_clock::time_point sent = link ?
+                            link->transmit(static_cast<size_t>(n)) :
+                            std::chrono::steady_clock::now();
+                        {
+                            const std::unique_lock lock(mutex);
+                            segments.push_back({
+                                sent + delay,
+                                std::vector<char>(buffer.data(), buffer.data() + n)
+                            });
+                        }
+                        cond.notify_one();
+                    }
+                    const std::unique_lock lock(mutex);
+                    isClosed = true;
+                    cond.notify_one();
+                });
+                writer = std::thread([this, to]() {
+                    while (true) {
+                        std::unique_lock lock(mutex);
+                        cond.wait(lock, [this]() {
+                            return !segments.empty() || isClosed;
+                        });
+                        if (segments.empty()) {
+                            return;
+                        }
+                        Segment s = std::move(segments.front());
+                        segments.pop_front();
+                        lock.unlock();
+
+                        std::this_thread::sleep_until(s.due);
+                        size_t offset = 0;
+                        while (offset < s.data.size()) {
+                            const long n = send(
+                                to,
+                                s.data.data() + offset,
+                                s.data.size() - offset,
+                                MSG_NOSIGNAL
+                            );
+                            if (n <= 0) {
+                                return;
+                            }
+                            offset += static_cast<size_t>(n);
+                        }
+                    }
+                });
+            }
+
+            void stop() {
+                if (reader.joinable()) {
+                    reader.join();
+                }
+                if (writer.joinable()) {
+                    writer.join();
+                }
+            }
+
+            std::mutex mutex;
+            std::condition_variable cond;
+            std::deque<Segment> segments;
+            bool isClosed = false;
+            std::thread reader;
+            std::thread writer;
+        };
+
+        const std::chrono::microseconds _delay;
+        Link* _link = nullptr;
+        int _listener = -1;
+        int _client = -1;
+        int _server = -1;
+        std::thread _thread;
+        Direction _upstream;
+        Direction _downstream;
+    };
+
+    // A master whose data transfer connection to a single client goes through the
+    // `DelayProxy`. The client is represented by its data transfer connection, which
+    // decodes the packages by touching every byte of them. If a \p transferCache is
+    // provided, the client keeps its cache in a subdirectory of it
+    struct DelayedTransfer {
+        DelayedTransfer(int firstPort, std::optional<int> transferWindow,
+                        std::optional<std::filesystem::path> transferCache = std::nullopt)
+        {
+            config::Cluster cluster;
+            cluster.masterAddress = "127.0.0.1";
+            cluster.transferWindow = transferWindow;
+            cluster.transferCache = transferCache;
+            cluster.nodes.push_back({
+                .address = "127.0.0.1",
+                .port = static_cast<uint16_t>(firstPort)
+            });
+            cluster.nodes.push_back({
+                .address = "127.0.0.2",
+                .port = static_cast<uint16_t>(firstPort + 1),
+                .dataTransferPort = static_cast<uint16_t>(firstPort + 2)
+            });
+            ClusterManager::create(cluster, 0);
+            NetworkManager::create(
+                NetworkManager::NetworkMode::LocalServer,
+                nullptr,
+                nullptr,
+                [this](int packageId, int) {
+                    if (onAcknowledged) {
+                        onAcknowledged(packageId);
+                    }
+                    nAcknowledged++;
+                    nAcknowledged.notify_all();
+                },
+                nullptr,
+                nullptr
+            );
+            NetworkManager::instance().initialize();
+
+            proxy = std::make_unique<DelayProxy>(firstPort + 3, firstPort + 2, Delay);
+            client = std::make_unique<Network>(
+                firstPort + 3,
+                "127.0.0.1",
+                false,
+                Network::ConnectionType::DataTransfer
+            );
+            client->setUpdateFunction([](Network&) {});
+            client->setConnectedFunction([]() {});
+            if (transferCache) {
+                clientCache = std::make_unique<TransferCache>(*transferCache / "client");
+                client->setTransferCache(clientCache.get());
+            }
+            client->setPackageDecodeFunction([this](void* data, int size, int, int) {
+                const char* bytes = reinterpret_cast<const char*>(data);
+                for (int i = 0; i < size; i++) {
+                    checksum += bytes[i];
+                }
+            });
+            client->initialize();
+            while (!client->isConnected() ||
+                   NetworkManager::instance().activeConnectionsCount() == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        ~DelayedTransfer() {
+            client->initShutdown();
+            NetworkManager::destroy();
+            ClusterManager::destroy();
+            client = nullptr;
+            proxy = nullptr;
+        }
+
+        std::unique_ptr<DelayProxy> proxy;
+        std::unique_ptr<TransferCache> clientCache;
+        std::unique_ptr<Network> client;
+        // Called on the reactor's thread before an acknowledgement is counted
+        std::function<void(int)> onAcknowledged;
+        std::atomic_int nAcknowledged = 0;
+        int64_t checksum = 0;
+    };
+
+    // The bandwidth of the master's network interface in Mbit/s, which is shared by the
+    // frames and the transfers
+    constexpr float LinkBandwidth = 400.f;
+
+    // The frames of shared data are sent at a fixed frame rate while the transfers run
+    constexpr size_t FrameSize = 16 * 1024;
+    constexpr std::chrono::milliseconds FrameTime = std::chrono::milliseconds(10);
+    constexpr std::chrono::seconds SyncDuration = std::chrono::seconds(2);
+
+    // A master that sends frames of shared data to a single client while it transfers
+    // data to the same client. Both connections go through a `DelayProxy` and leave the
+    // master through the same `Link`, so that the transfers compete with the frames for
+    // the bandwidth in the same way as on the master's network interface
+    struct SharedLinkCluster {
+        SharedLinkCluster(int firstPort, std::optional<float> transferBandwidth)
+            : link(LinkBandwidth * 1e6 / 8.0)
+        {
+            config::Cluster cluster;
+            cluster.masterAddress = "127.0.0.1";
+            cluster.firmSync = true;
+            cluster.transferBandwidth = transferBandwidth;
+            cluster.nodes.push_back({
+                .address = "127.0.0.1",
+                .port = static_cast<uint16_t>(firstPort)
+            });
+            cluster.nodes.push_back({
+                .address = "127.0.0.2",
+                .port = static_cast<uint16_t>(firstPort + 1),
+                .dataTransferPort = static_cast<uint16_t>(firstPort + 2)
+            });
+            ClusterManager::create(cluster, 0);
+            NetworkManager::create(
+                NetworkManager::NetworkMode::LocalServer,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr
+            );
+            NetworkManager::instance().initialize();
+
+            syncProxy =
+                std::make_unique<DelayProxy>(firstPort + 3, firstPort + 1, Delay, &link);
+            transferProxy =
+                std::make_unique<DelayProxy>(firstPort + 4, firstPort + 2, Delay, &link);
+
+            // The client acknowledges every frame as soon as it was received
+            sync = std::make_unique<Network>(
+                firstPort + 3,
+                "127.0.0.1",
+                false,
+                Network::ConnectionType::SyncConnection
+            );
+            sync->setUpdateFunction([](Network&) {});
+            sync->setConnectedFunction([]() {});
+            Network* s = sync.get();
+            auto acknowledge = [s](const char*, int) { s->pushClientMessage(); };
+            sync->setDecodeFunction(acknowledge);
+            sync->setKeyframeDecodeFunction(acknowledge);
+            sync->initialize();
+
+            transfer = std::make_unique<Network>(
+                firstPort + 4,
+                "127.0.0.1",
+                false,
+                Network::ConnectionType::DataTransfer
+            );
+            transfer->setUpdateFunction([](Network&) {});
+            transfer->setConnectedFunction([]() {});
+            transfer->setPackageDecodeFunction([](void*, int, int, int) {});
+            transfer->initialize();
+
+            while (!NetworkManager::instance().areAllNodesConnected()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        ~SharedLinkCluster() {
+            sync->initShutdown();
+            transfer->initShutdown();
+            NetworkManager::destroy();
+            ClusterManager::destroy();
+            sync = nullptr;
+            transfer = nullptr;
+            syncProxy = nullptr;
+            transferProxy = nullptr;
+        }
+
+        // Runs the master's render loop at the frame rate for the \p length of time and
+        // adds the time from encoding the shared data until the client acknowledged it
+        // to the \p latencies for every frame
+        void runFrames(std::chrono::steady_clock::duration length,
+                       LatencyHistogram& latencies)
+        {
+            using namespace std::chrono;
+            NetworkManager& nm = NetworkManager::instance();
+
+            const steady_clock::time_point start = steady_clock::now();
+            steady_clock::time_point next = start;
+            while (next - start < length) {
+                std::this_thread::sleep_until(next);
+                next += FrameTime;
+
+                const steady_clock::time_point frameStart = steady_clock::now();
+                SharedData::instance().encode();
+                nm.sync(NetworkManager::SyncMode::SendDataToClients);
+                while (nm.isRunning() && !nm.isSyncComplete()) {
+                    nm.waitForSync(milliseconds(100), seconds(0));
+                }
+                nm.sync(NetworkManager::SyncMode::Acknowledge);
+                const steady_clock::time_point frameEnd = steady_clock::now();
+                latencies.add(duration<double>(frameEnd - frameStart).count());
+            }
+        }
+
+        Link link;
+        std::unique_ptr<DelayProxy> syncProxy;
+        std::unique_ptr<DelayProxy> transferProxy;
+        std::unique_ptr<Network> sync;
+        std::unique_ptr<Network> transfer;
+    };
+
+    // Measures the latency of the frames while packages are transferred as fast as the
+    // master allows if \p isLoaded is `true`, with the transfers limited to the
+    // \p transferBandwidth in Mbit/s if it is provided
+    void runSyncBenchmark(std::string_view name, int firstPort, bool isLoaded,
+                          std::optional<float> transferBandwidth)
+    {
+        SharedLinkCluster cluster(firstPort, transferBandwidth);
+        const std::vector<std::byte> payload(FrameSize, std::byte(1));
+        SharedData::instance().setEncodeFunction(
+            [&payload](std::vector<std::byte>& buffer) {
+                buffer.insert(buffer.end(), payload.begin(), payload.end());
+            }
+        );
+        LatencyHistogram warmup;
+        cluster.runFrames(std::chrono::milliseconds(200), warmup);
+
+        // The transfer window of the client is kept full with packages
+        std::atomic_bool isTransferring = true;
+        std::atomic<int64_t> nTransferred = 0;
+        std::thread load;
+        if (isLoaded) {
+            load = std::thread([&isTransferring, &nTransferred]() {
+                const std::vector<char> package(PackageSize, 'x');
+                std::deque<std::future<bool>> results;
+                int id = 0;
+                while (isTransferring) {
+                    results.push_back(
+                        NetworkManager::instance().transferDataAsync(package, id++)
+                    );
+                    if (results.size() > 32) {
+                        if (results.front().get()) {
+                            nTransferred += PackageSize;
+                        }
+                        results.pop_front();
+                    }
+                }
+                for (std::future<bool>& result : results) {
+                    result.get();
+                }
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        LatencyHistogram latencies;
+        cluster.runFrames(SyncDuration, latencies);
+        const auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        const double throughput = static_cast<double>(nTransferred) / seconds / 1e6;
+        isTransferring = false;
+        if (load.joinable()) {
+            load.join();
+        }
+
+        std::cout << std::format(
+            "{}: frame latency p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, "
+            "transfers {:.1f} MB/s\n",
+            name,
+            1000.0 * latencies.percentile(0.5),
+            1000.0 * latencies.percentile(0.95),
+            1000.0 * latencies.percentile(0.99),
+            throughput
+        );
+    }
+
+    void report(std::string_view name, std::chrono::steady_clock::duration duration) {
+        const double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << std::format(
+            "{}: {:.1f} us per package, {:.1f} MB/s\n",
+            name,
+            1e6 * seconds / NPackages,
+            static_cast<double>(NPackages * PackageSize) / seconds / 1e6
+        );
+    }
+} // namespace
+
+TEST_CASE("DataTransfer: Wait for each acknowledgement", "[datatransfer]") {
+    DelayedTransfer transfer(FirstPort, std::nullopt);
+    const std::vector<char> package(PackageSize, 'x');
+
+    // The sender waits for the acknowledgement callback before sending the next package,
+    // which is all that the synchronous `transferData` allows for
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NPackages; i++) {
+        NetworkManager::instance().transferData(
+            package.data(),
+            static_cast<int>(package.size()),
+            i
+        );
+        transfer.nAcknowledged.wait(i);
+    }
+    report("Wait for each acknowledgement", std::chrono::steady_clock::now() - start);
+}
+
+TEST_CASE("DataTransfer: Transfer window", "[datatransfer]") {
+    for (int window : { 1, 4, 16 }) {
+        DelayedTransfer transfer(FirstPort + 10 * window, window);
+        const std::vector<char> package(PackageSize, 'x');
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<bool>> results;
+        for (int i = 0; i < NPackages; i++) {
+            results.push_back(NetworkManager::instance().transferDataAsync(package, i));
+        }
+        for (std::future<bool>& result : results) {
+            REQUIRE(result.get());
+        }
+        report(
+            std::format("Transfer window of {} packages", window),
+            std::chrono::steady_clock::now() - start
+        );
+    }
+}
+
+TEST_CASE("DataTransfer: Frame latency without transfers", "[datatransfer]") {
+    runSyncBenchmark("Without transfers", FirstPort + 200, false, std::nullopt);
+}
+
+TEST_CASE("DataTransfer: Frame latency with unpaced transfers", "[datatransfer]") {
+    runSyncBenchmark("Unpaced transfers", FirstPort + 210, true, std::nullopt);
+}
+
+TEST_CASE("DataTransfer: Frame latency with paced transfers", "[datatransfer]") {
+    // The transfers may use three quarters of the link, which leaves room for the frames
+    runSyncBenchmark(
+        std::format("Transfers paced to {} Mbit/s", 0.75f * LinkBandwidth),
+        FirstPort + 220,
+        true,
+        0.75f * LinkBandwidth
+    );
+}
+
+TEST_CASE("DataTransfer: Transfer cache", "[datatransfer]") {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "sgct-benchmark-transfercache";
+    std::filesystem::remove_all(directory);
+    {
+        DelayedTransfer transfer(FirstPort + 230, std::nullopt, directory);
+        const std::vector<char> package(256 * PackageSize, 'x');
+        const int length = static_cast<int>(package.size());
+
+        // The first transfer sends the package and adds it to the client's cache, the
+        // second one only sends the offer
+        for (int i = 0; i < 2; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            NetworkManager::instance().transferData(package.data(), length, i);
+            transfer.nAcknowledged.wait(i);
+            const auto end = std::chrono::steady_clock::now();
+            std::cout << std::format(
+                "{} transfer of {} MiB: {:.2f} ms\n",
+                i == 0 ? "Cold" : "Cached",
+                package.size() / (1024 * 1024),
+                std::chrono::duration<double, std::milli>(end - start).count()
+            );
+        }
+        CHECK(transfer.checksum == 2 * static_cast<int64_t>(package.size()) * 'x');
+
+        // The acknowledgement callback runs on the thread that receives the replies to
+        // the offers, so a transfer from it is sent without waiting for them
+        transfer.onAcknowledged = [&package, length](int packageId) {
+            if (packageId == 2) {
+                NetworkManager::instance().transferData(package.data(), length, 3);
+            }
+        };
+        NetworkManager::instance().transferData(package.data(), length, 2);
+        for (int n = transfer.nAcknowledged; n < 4; n = transfer.nAcknowledged) {
+            transfer.nAcknowledged.wait(n);
+        }
+        CHECK(transfer.checksum == 4 * static_cast<int64_t>(package.size()) * 'x');
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,187 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/framebarrier.h>
+#include <sgct/latencyhistogram.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int NFrames = 2000;
+
+    // The frame lock wakes up at least this often to print the waiting message
+    constexpr std::chrono::milliseconds FrameLockTimeout(100);
+
+    int64_t now() {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    // The state of the connections that the frame lock checks, which is what
+    // `NetworkManager::isSyncComplete` does with the frame numbers of the connections
+    struct Frame {
+        explicit Frame(int nClients) : isArrived(nClients), arrivalTimes(nClients) {}
+
+        bool isComplete() const {
+            return std::all_of(
+                isArrived.cbegin(),
+                isArrived.cend(),
+                [](const std::atomic_bool& b) { return b.load(); }
+            );
+        }
+
+        std::vector<std::atomic_bool> isArrived;
+        std::vector<std::atomic<int64_t>> arrivalTimes;
+    };
+
+    // The previous design in which every arrival notifies the condition variable that is
+    // shared by all connections and the render thread checks all connections on every
+    // wake-up. The timeout stands in for the thread that notified the condition variable
+    // every 100 ms, which also catches the wake-ups that are lost between checking the
+    // connections and waiting
+    struct SharedCondition {
+        void reset(int) {}
+
+        void arrive() {
+            cond.notify_all();
+        }
+
+        void wait(const Frame& frame) {
+            while (!frame.isComplete()) {
+                std::unique_lock lock(mutex);
+                cond.wait_for(lock, FrameLockTimeout);
+                nWakeUps++;
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        int64_t nWakeUps = 0;
+    };
+
+    // The render thread is only woken up once all connections have arrived, optionally
+    // after spinning for a while
+    template <int SpinMicroseconds>
+    struct Barrier {
+        void reset(int nClients) {
+            barrier.reset(nClients);
+        }
+
+        void arrive() {
+            barrier.arrive();
+        }
+
+        void wait(const Frame& frame) {
+            const std::chrono::microseconds spin(SpinMicroseconds);
+            while (!frame.isComplete()) {
+                barrier.wait(FrameLockTimeout, spin);
+                nWakeUps++;
+            }
+        }
+
+        FrameBarrier barrier;
+        int64_t nWakeUps = 0;
+    };
+
+    // Each client is represented by a thread that arrives as soon as a frame starts, like
+    // the acknowledgements of the clients that are received at about the same time. The
+    // release latency is the time from the last arrival until the render thread notices
+    // that the frame is complete
+    template <typename Model>
+    void runBarrierBenchmark(std::string_view name) {
+        for (int nClients : { 1, 4, 8, 16 }) {
+            Model model;
+            Frame frame(nClients);
+            std::atomic_int frameNumber = 0;
+            std::atomic_bool isRunning = true;
+
+            std::vector<std::thread> clients;
+            for (int i = 0; i < nClients; i++) {
+                clients.emplace_back([&, i]() {
+                    int seen = 0;
+                    while (true) {
+                        frameNumber.wait(seen);
+                        seen = frameNumber;
+                        if (!isRunning) {
+                            return;
+                        }
+                        frame.arrivalTimes[i] = now();
+                        frame.isArrived[i] = true;
+                        model.arrive();
+                    }
+                });
+            }
+
+            LatencyHistogram latencies;
+            const std::clock_t cpuStart = std::clock();
+            for (int f = 0; f < NFrames; f++) {
+                for (std::atomic_bool& isArrived : frame.isArrived) {
+                    isArrived = false;
+                }
+                model.reset(nClients);
+                frameNumber++;
+                frameNumber.notify_all();
+
+                model.wait(frame);
+                const int64_t release = now();
+                int64_t lastArrival = 0;
+                for (const std::atomic<int64_t>& t : frame.arrivalTimes) {
+                    lastArrival = std::max(lastArrival, t.load());
+                }
+                latencies.add(static_cast<double>(release - lastArrival) / 1e9);
+            }
+            const double cpu =
+                static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+            isRunning = false;
+            frameNumber++;
+            frameNumber.notify_all();
+            for (std::thread& client : clients) {
+                client.join();
+            }
+
+            std::cout << std::format(
+                "{} with {} clients: release latency p50 {:.1f} us, p95 {:.1f} us, "
+                "p99 {:.1f} us, {:.2f} wake-ups per frame, {:.1f} us processor time "
+                "per frame\n",
+                name, nClients,
+                1e6 * latencies.percentile(0.5),
+                1e6 * latencies.percentile(0.95),
+                1e6 * latencies.percentile(0.99),
+                static_cast<double>(model.nWakeUps) / NFrames,
+                1e6 * cpu / NFrames
+            );
+        }
+    }
+} // namespace
+
+TEST_CASE("FrameBarrier: Shared condition variable", "[framebarrier]") {
+    runBarrierBenchmark<SharedCondition>("Shared condition variable");
+}
+
+TEST_CASE("FrameBarrier: Barrier", "[framebarrier]") {
+    runBarrierBenchmark<Barrier<0>>("Barrier");
+}
+
+TEST_CASE("FrameBarrier: Barrier with 50 us spin", "[framebarrier]") {
+    runBarrierBenchmark<Barrier<50>>("Barrier with 50 us spin");
+}
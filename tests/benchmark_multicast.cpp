@@ -0,0 +1,99 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/config.h>
+#include <sgct/format.h>
+#include <sgct/shareddata.h>
+#include "loopbackcluster.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr std::string_view Address = "239.255.42.10";
+    constexpr int MulticastPort = 20710;
+    constexpr int FirstPort = 20720;
+    constexpr int FrameSize = 256 * 1024;
+    constexpr int WarmupFrames = 10;
+
+    // The loopback interface has a much larger MTU than Ethernet, so we can use the
+    // largest possible datagrams without them being fragmented by the IP layer
+    constexpr int LoopbackDatagramSize = 65507;
+
+    void runMulticastBenchmark(bool useMulticast) {
+        std::optional<config::Multicast> multicast;
+        if (useMulticast) {
+            config::Multicast m;
+            m.address = std::string(Address);
+            m.port = MulticastPort;
+            m.interfaceAddress = "127.0.0.1";
+            m.datagramSize = LoopbackDatagramSize;
+            m.ttl = 0;
+            multicast = m;
+        }
+
+        const std::vector<std::byte> payload(FrameSize, std::byte(1));
+        SharedData::instance().setEncodeFunction(
+            [&payload](std::vector<std::byte>& buffer) {
+                buffer.insert(buffer.end(), payload.begin(), payload.end());
+            }
+        );
+
+        for (int nClients : { 2, 4, 8, 16, 32 }) {
+            LoopbackCluster cluster(nClients, FirstPort, multicast);
+
+            // The first frame after connecting is a keyframe, which is sent via TCP, and
+            // the receivers only learn the session of the sender with the next frame, so
+            // that frame has to be resent via TCP as well
+            for (int i = 0; i < WarmupFrames; i++) {
+                cluster.runFrame();
+            }
+
+            // The time that the master spends in the sync is measured separately from the
+            // time until all clients have acknowledged the frame. Note that on the
+            // loopback interface the operating system delivers the multicast datagrams to
+            // every receiving socket as part of the send call, which a network card would
+            // not
+            double sendTime = 0.0;
+            int nFrames = 0;
+            BENCHMARK(std::format("{} clients", nClients)) {
+                using namespace std::chrono;
+                const steady_clock::time_point start = steady_clock::now();
+                cluster.sendFrame();
+                const steady_clock::time_point end = steady_clock::now();
+                sendTime += duration<double, std::milli>(end - start).count();
+                nFrames++;
+                cluster.waitForAcknowledgements();
+                return nFrames;
+            };
+
+            std::cout << std::format(
+                "{} with {} clients: {:.3f} ms average send time\n",
+                useMulticast ? "Multicast" : "TCP", nClients,
+                sendTime / std::max(nFrames, 1)
+            );
+        }
+    }
+} // namespace
+
+TEST_CASE("Multicast: TCP", "[multicast]") {
+    runMulticastBenchmark(false);
+}
+
+TEST_CASE("Multicast: Multicast", "[multicast]") {
+    runMulticastBenchmark(true);
+}
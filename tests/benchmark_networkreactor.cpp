@@ -0,0 +1,188 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/networkreactor.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // Creates a connected pair of TCP sockets on the loopback interface
+    std::pair<int, int> createSocketPair() {
+        const int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listener, 1);
+        socklen_t length = sizeof(addr);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &length);
+
+        const int sender = socket(AF_INET, SOCK_STREAM, 0);
+        connect(sender, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        const int receiver = accept(listener, nullptr, nullptr);
+        close(listener);
+
+        const int noDelay = 1;
+        setsockopt(sender, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return { sender, receiver };
+    }
+
+    struct Connections {
+        explicit Connections(int n) : received(n) {
+            for (int i = 0; i < n; i++) {
+                std::pair<int, int> p = createSocketPair();
+                senders.push_back(p.first);
+                receivers.push_back(p.second);
+            }
+        }
+
+        ~Connections() {
+            for (int s : senders) {
+                close(s);
+            }
+            for (int s : receivers) {
+                close(s);
+            }
+        }
+
+        // Sends a single byte on the connection and waits until it has been received
+        void ping(int i) {
+            const int expected = received[i] + 1;
+            const char data = 1;
+            send(senders[i], &data, 1, 0);
+            while (received[i] < expected) {
+                std::this_thread::yield();
+            }
+        }
+
+        std::vector<int> senders;
+        std::vector<int> receivers;
+        std::vector<std::atomic_int> received;
+    };
+
+    // The previous model in which every connection has its own thread that is blocked in
+    // `recv` until data arrives
+    struct ThreadPerSocket {
+        explicit ThreadPerSocket(Connections& connections) {
+            for (size_t i = 0; i < connections.receivers.size(); i++) {
+                threads.emplace_back([&connections, i]() {
+                    char buffer[64];
+                    long n = 0;
+                    while ((n = recv(connections.receivers[i], buffer, 64, 0)) > 0) {
+                        connections.received[i] += static_cast<int>(n);
+                    }
+                });
+            }
+        }
+
+        ~ThreadPerSocket() {
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+
+        std::vector<std::thread> threads;
+    };
+
+    // All connections are observed by a single reactor thread
+    struct Reactor {
+        explicit Reactor(Connections& c) : connections(c) {
+            for (size_t i = 0; i < connections.receivers.size(); i++) {
+                reactor.add(connections.receivers[i], [this, i]() {
+                    char buffer[64];
+                    const int s = connections.receivers[i];
+                    long n = 0;
+                    while ((n = recv(s, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+                        connections.received[i] += static_cast<int>(n);
+                    }
+                });
+            }
+        }
+
+        ~Reactor() {
+            for (int s : connections.receivers) {
+                reactor.remove(s);
+            }
+        }
+
+        Connections& connections;
+        NetworkReactor reactor;
+    };
+
+    template <typename Model>
+    void runReactorBenchmark(std::string_view name) {
+        for (int nConnections : { 4, 16, 64 }) {
+            Connections connections(nConnections);
+
+            // The receiving threads are shut down when the sending sockets are closed,
+            // which happens after the model has been destroyed
+            auto model = std::make_unique<Model>(connections);
+
+            int next = 0;
+            BENCHMARK(std::format("{}: {} connections", name, nConnections)) {
+                connections.ping(next);
+                next = (next + 1) % nConnections;
+                return next;
+            };
+
+            // Measures the processor time that is used by the whole process, including
+            // the sending thread, for messages that arrive on all connections at once
+            constexpr int NRounds = 1000;
+            const std::clock_t start = std::clock();
+            for (int round = 0; round < NRounds; round++) {
+                std::vector<int> expected;
+                for (size_t i = 0; i < connections.senders.size(); i++) {
+                    expected.push_back(connections.received[i] + 1);
+                    const char data = 1;
+                    send(connections.senders[i], &data, 1, 0);
+                }
+                for (size_t i = 0; i < connections.received.size(); i++) {
+                    while (connections.received[i] < expected[i]) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            const double cpu = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+            std::cout << std::format(
+                "{} with {} connections: {:.2f} us processor time per message\n",
+                name, nConnections, 1e6 * cpu / (NRounds * nConnections)
+            );
+
+            for (int s : connections.senders) {
+                shutdown(s, SHUT_RDWR);
+            }
+            model = nullptr;
+        }
+    }
+} // namespace
+
+TEST_CASE("NetworkReactor: Thread per socket", "[networkreactor]") {
+    runReactorBenchmark<ThreadPerSocket>("Thread per socket");
+}
+
+TEST_CASE("NetworkReactor: Reactor", "[networkreactor]") {
+    runReactorBenchmark<Reactor>("Reactor");
+}
@@ -0,0 +1,276 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/network.h>
+#include "loopbackcluster.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int FirstPort = 20760;
+    // Larger than the socket buffers, so that forwarding a frame has to wait for the
+    // nodes to receive it
+    constexpr int FrameSize = 4 * 1024 * 1024;
+
+    using Headers = std::vector<std::array<char, Network::HeaderSize>>;
+
+    // A node of the loopback cluster. Every node except for the master has a client that
+    // receives the frames from its parent, and every node that sends frames has one
+    // server per node that it sends to
+    struct LoopbackNode {
+        std::unique_ptr<Network> upstream;
+        std::vector<std::unique_ptr<Network>> servers;
+        std::vector<Network*> sendServers;
+        // Set by a relay when it decoded a frame that it has not acknowledged yet
+        std::atomic_bool hasFrame = false;
+
+        // A relay forwards the frames on its own thread like the NetworkManager does, as
+        // the reactor thread also has to receive the frames for the nodes it sends to
+        std::deque<std::pair<Headers, std::vector<char>>> frames;
+        bool isForwarding = true;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::thread forwarder;
+    };
+
+    // The nodes of a cluster that are connected via loopback in the same process. Unlike
+    // in the LoopbackCluster, the master is also represented by its sync connections, as
+    // every relay would need a NetworkManager of its own. In a star, all nodes receive
+    // the frames from the master. In a tree, the master only sends to about sqrt(N)
+    // relays, which forward the frames to the remaining nodes and acknowledge a frame
+    // once all of their nodes have acknowledged it
+    struct LoopbackTree {
+        LoopbackTree(int nNodes, bool useTree) : nodes(nNodes) {
+            const int nRelays = useTree ?
+                static_cast<int>(std::round(std::sqrt(nNodes - 1))) :
+                0;
+            for (int i = 1; i < nNodes; i++) {
+                // The relays are the first nodes after the master and the remaining
+                // nodes are distributed between them
+                const bool isRelay = i <= nRelays;
+                const int parent = (useTree && !isRelay) ?
+                    1 + (i - nRelays - 1) % nRelays :
+                    0;
+
+                std::unique_ptr<Network> server =
+                    createLoopbackConnection(FirstPort + i, true);
+                server->initialize();
+                nodes[parent].sendServers.push_back(server.get());
+                nodes[parent].servers.push_back(std::move(server));
+
+                std::unique_ptr<Network> client =
+                    createLoopbackConnection(FirstPort + i, false);
+                LoopbackNode& node = nodes[i];
+                if (isRelay) {
+                    client->setRelayFunction(
+                        [&node](const std::array<char, Network::HeaderSize>& header,
+                                const char* data, uint32_t size,
+                                const std::function<void()>& decode)
+                        {
+                            // The frame counters are increased right away, so that
+                            // the relay only acknowledges the frame once its nodes did
+                            Headers headers = frameHeaders(node, header);
+                            {
+                                const std::unique_lock lock(node.mutex);
+                                node.frames.emplace_back(
+                                    std::move(headers),
+                                    std::vector<char>(data, data + size)
+                                );
+                            }
+                            node.cond.notify_one();
+                            decode();
+                        }
+                    );
+                    client->setDecodeFunction(
+                        [&node](const char*, int) { node.hasFrame = true; }
+                    );
+                    node.forwarder = std::thread([&node]() { forwardFrames(node); });
+                }
+                else {
+                    // A leaf acknowledges the frame as soon as it was received, just
+                    // like a client does before rendering the frame
+                    Network* c = client.get();
+                    client->setDecodeFunction(
+                        [c](const char*, int) { c->pushClientMessage(); }
+                    );
+                }
+                client->initialize();
+                node.upstream = std::move(client);
+            }
+
+            for (const LoopbackNode& node : nodes) {
+                for (const std::unique_ptr<Network>& server : node.servers) {
+                    waitForConnection(*server);
+                }
+            }
+        }
+
+        ~LoopbackTree() {
+            for (LoopbackNode& node : nodes) {
+                {
+                    const std::unique_lock lock(node.mutex);
+                    node.isForwarding = false;
+                }
+                node.cond.notify_one();
+                if (node.forwarder.joinable()) {
+                    node.forwarder.join();
+                }
+            }
+            for (LoopbackNode& node : nodes) {
+                if (node.upstream) {
+                    node.upstream->initShutdown();
+                }
+            }
+            for (LoopbackNode& node : nodes) {
+                for (std::unique_ptr<Network>& server : node.servers) {
+                    server->initShutdown();
+                }
+            }
+            nodes.clear();
+        }
+
+        // Returns a copy of the header with the next frame number for each node that the
+        // `node` sends to
+        static Headers frameHeaders(LoopbackNode& node,
+                                    const std::array<char, Network::HeaderSize>& header)
+        {
+            Headers headers;
+            for (Network* server : node.sendServers) {
+                const int frame = server->iterateFrameCounter();
+                std::array<char, Network::HeaderSize>& h = headers.emplace_back(header);
+                std::memcpy(h.data() + 1, &frame, sizeof(frame));
+            }
+            return headers;
+        }
+
+        static void forwardFrames(LoopbackNode& node) {
+            while (true) {
+                std::pair<Headers, std::vector<char>> f;
+                {
+                    std::unique_lock lock(node.mutex);
+                    node.cond.wait(
+                        lock,
+                        [&node]() { return !node.isForwarding || !node.frames.empty(); }
+                    );
+                    if (!node.isForwarding) {
+                        return;
+                    }
+                    f = std::move(node.frames.front());
+                    node.frames.pop_front();
+                }
+                Network::sendToAll(
+                    node.sendServers,
+                    f.first,
+                    f.second.data(),
+                    static_cast<int>(f.second.size())
+                );
+            }
+        }
+
+        static bool isAcknowledged(const LoopbackNode& node) {
+            return std::all_of(
+                node.servers.cbegin(),
+                node.servers.cend(),
+                [](const std::unique_ptr<Network>& server) {
+                    return server->recvFrameCurrent() == server->sendFrameCurrent();
+                }
+            );
+        }
+
+        // Sends a frame from the master and returns the time that was spent sending. The
+        // frame is complete once all nodes have acknowledged it, which is checked by
+        // `isComplete`
+        double sendFrame(const std::array<char, Network::HeaderSize>& header,
+                         const std::vector<char>& payload)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            Network::sendToAll(
+                nodes[0].sendServers,
+                frameHeaders(nodes[0], header),
+                payload.data(),
+                static_cast<int>(payload.size())
+            );
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        // Acknowledges the frame on every relay whose nodes have acknowledged it, which
+        // is what a relay's render loop does, and returns whether the master has
+        // received the acknowledgements of all of its nodes
+        bool isComplete() {
+            for (LoopbackNode& node : nodes) {
+                if (node.hasFrame && isAcknowledged(node)) {
+                    node.hasFrame = false;
+                    node.upstream->pushClientMessage();
+                }
+            }
+            return isAcknowledged(nodes[0]);
+        }
+
+        std::vector<LoopbackNode> nodes;
+    };
+
+    void runRelayBenchmark(bool useTree) {
+        std::array<char, Network::HeaderSize> header = {};
+        header[0] = Network::DataId;
+        const uint32_t dataSize = FrameSize;
+        std::memcpy(header.data() + 5, &dataSize, sizeof(dataSize));
+        const std::vector<char> payload(FrameSize, 1);
+
+        for (int nNodes : { 4, 8, 16, 32 }) {
+            LoopbackTree cluster(nNodes, useTree);
+
+            // The time that the master spends sending is measured separately from the
+            // time until the acknowledgements of all nodes have arrived at the master,
+            // which is the time that the master waits for in each frame
+            double sendTime = 0.0;
+            int nFrames = 0;
+            BENCHMARK(std::format("{} nodes", nNodes)) {
+                sendTime += cluster.sendFrame(header, payload);
+                nFrames++;
+                while (!cluster.isComplete()) {
+                    std::this_thread::yield();
+                }
+                return nFrames;
+            };
+
+            std::cout << std::format(
+                "{} with {} nodes: {:.3f} ms average send time\n",
+                useTree ? "Tree" : "Star", nNodes, sendTime / std::max(nFrames, 1)
+            );
+        }
+    }
+} // namespace
+
+TEST_CASE("Relay: Star", "[relay]") {
+    runRelayBenchmark(false);
+}
+
+TEST_CASE("Relay: Tree", "[relay]") {
+    runRelayBenchmark(true);
+}
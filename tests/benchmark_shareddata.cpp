@@ -0,0 +1,457 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/network.h>
+#include <sgct/shareddata.h>
+#include <sgct/sharedobject.h>
+#include <sgct/syncrecording.h>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    struct SceneObject {
+        std::array<float, 16> transform;
+        std::array<float, 4> color;
+        uint32_t id;
+        uint32_t flags;
+    };
+
+    // Creates a scene state of the provided number of objects in which most of the
+    // transformations are static, which roughly approximates a real scene graph
+    std::vector<SceneObject> createScene(size_t nObjects) {
+        std::vector<SceneObject> scene(nObjects);
+        for (size_t i = 0; i < nObjects; i++) {
+            SceneObject& obj = scene[i];
+            obj.transform = {
+                1.f, 0.f, 0.f, 0.f,
+                0.f, 1.f, 0.f, 0.f,
+                0.f, 0.f, 1.f, 0.f,
+                static_cast<float>(i % 100), static_cast<float>(i / 100), 0.f, 1.f
+            };
+            obj.color = { 1.f, 0.5f, 0.25f, 1.f };
+            obj.id = static_cast<uint32_t>(i);
+            obj.flags = (i % 3 == 0) ? 1 : 0;
+        }
+        return scene;
+    }
+
+    // Every tenth object is animated
+    void animateScene(std::vector<SceneObject>& scene, int frame) {
+        for (size_t i = 0; i < scene.size(); i += 10) {
+            scene[i].transform[14] =
+                static_cast<float>(frame) * 0.01f * static_cast<float>(i);
+        }
+    }
+
+    // The complete state of an application that is shared every frame
+    struct SceneState {
+        double time;
+        std::array<float, 16> camera;
+        std::vector<SceneObject> objects;
+        std::vector<std::string> labels;
+        std::map<std::string, float> parameters;
+        std::optional<SceneObject> selected;
+    };
+
+    SceneState createSceneState() {
+        SceneState state;
+        state.time = 1.5;
+        state.camera = createScene(1)[0].transform;
+        state.objects = createScene(4000);
+        for (int i = 0; i < 200; i++) {
+            state.labels.push_back(std::format("Label of object {}", i));
+        }
+        for (int i = 0; i < 50; i++) {
+            state.parameters[std::format("parameter{}", i)] = static_cast<float>(i);
+        }
+        state.selected = state.objects[10];
+        return state;
+    }
+
+    void runSharedDataBenchmark(bool useCompression, bool useDelta) {
+        constexpr size_t NObjects = 4000;
+        std::vector<SceneObject> scene = createScene(NObjects);
+        int frameNumber = 0;
+
+        SharedData& sd = SharedData::instance();
+        sd.setEncodeFunction([&scene, &frameNumber]() {
+            animateScene(scene, frameNumber++);
+            std::vector<std::byte> data;
+            serializeObject(data, scene);
+            return data;
+        });
+        std::vector<SceneObject> decoded;
+        sd.setDecodeFunction([&decoded](const std::vector<std::byte>& data) {
+            unsigned int pos = 0;
+            deserializeObject(data, pos, decoded);
+        });
+        sd.setCompression(useCompression);
+        sd.setDeltaEncoding(useDelta);
+
+        // The first frame is always a keyframe, so we need a second one to measure deltas
+        sd.encode();
+        const std::vector<char> keyframe(sd.dataBlock(), sd.dataBlock() + sd.dataSize());
+        sd.encode();
+        const int rawSize =
+            static_cast<int>(NObjects * sizeof(SceneObject) + sizeof(uint32_t));
+        std::cout << std::format(
+            "{}{}: {} bytes payload, {} bytes on the wire\n",
+            useCompression ? "Compressed" : "Uncompressed", useDelta ? " delta" : "",
+            rawSize, sd.dataSize()
+        );
+
+        // Simulates the work that the client has to do for each received frame. The
+        // frame is copied as the decoding overwrites the data block of the SharedData
+        const std::vector<char> frame(sd.dataBlock(), sd.dataBlock() + sd.dataSize());
+
+        BENCHMARK("Encode") {
+            sd.encode();
+            return sd.dataSize();
+        };
+
+        std::vector<char> uncompressBuffer(rawSize);
+        auto decodeFrame = [&](const std::vector<char>& f) {
+            const char* payload = f.data() + Network::HeaderSize;
+            int payloadSize = static_cast<int>(f.size() - Network::HeaderSize);
+            uint32_t uncompressedSize = 0;
+            std::memcpy(&uncompressedSize, f.data() + 9, sizeof(uint32_t));
+            if (uncompressedSize > 0) {
+                uLongf size = uncompressedSize;
+                uncompress(
+                    reinterpret_cast<Bytef*>(uncompressBuffer.data()),
+                    &size,
+                    reinterpret_cast<const Bytef*>(payload),
+                    static_cast<uLong>(payloadSize)
+                );
+                payload = uncompressBuffer.data();
+                payloadSize = static_cast<int>(size);
+            }
+
+            if (f[0] == Network::DeltaId) {
+                sd.decodeDelta(payload, payloadSize);
+            }
+            else {
+                sd.decode(payload, payloadSize);
+            }
+        };
+
+        // Applying the same delta repeatedly is idempotent, so we only need the keyframe
+        // once to provide the reference
+        decodeFrame(keyframe);
+        BENCHMARK("Decode") {
+            decodeFrame(frame);
+            return decoded.size();
+        };
+
+        SharedData::destroy();
+    }
+} // namespace
+
+TEST_CASE("SharedData: Uncompressed", "[shareddata]") {
+    runSharedDataBenchmark(false, false);
+}
+
+TEST_CASE("SharedData: Compressed", "[shareddata]") {
+    runSharedDataBenchmark(true, false);
+}
+
+TEST_CASE("SharedData: Delta", "[shareddata]") {
+    runSharedDataBenchmark(false, true);
+}
+
+TEST_CASE("SharedData: Compressed delta", "[shareddata]") {
+    runSharedDataBenchmark(true, true);
+}
+
+TEST_CASE("SharedData: Deserialize", "[shareddata]") {
+    constexpr size_t NObjects = 4000;
+    const std::vector<SceneObject> scene = createScene(NObjects);
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, scene);
+
+    // The previous implementation of reading a single value without any checks
+    auto rawRead = []<typename T>(const std::vector<std::byte>& b, size_t& pos, T& v) {
+        v = *reinterpret_cast<const T*>(&b[pos]);
+        pos += sizeof(T);
+    };
+
+    // The decoded objects are reused between frames, just like in the applications
+    std::vector<SceneObject> objects;
+    BENCHMARK("Objects: Raw cast") {
+        size_t pos = 0;
+        uint32_t size = 0;
+        rawRead(buffer, pos, size);
+        objects.resize(size);
+        for (SceneObject& obj : objects) {
+            rawRead(buffer, pos, obj);
+        }
+        return objects.size();
+    };
+
+    BENCHMARK("Objects: deserializeObject") {
+        unsigned int pos = 0;
+        deserializeObject(buffer, pos, objects);
+        return objects.size();
+    };
+
+    BENCHMARK("Objects: Deserializer") {
+        Deserializer d(buffer);
+        d.read(objects);
+        return objects.size();
+    };
+
+    BENCHMARK("Objects: Deserializer bulk") {
+        Deserializer d(buffer);
+        uint32_t size = 0;
+        d.read(size);
+        objects.resize(size);
+        d.read(std::span<SceneObject>(objects));
+        return d.hasError();
+    };
+
+    // Reading many small values individually is the worst case for the bounds checks
+    constexpr size_t NValues = 100000;
+    std::vector<std::byte> values;
+    for (size_t i = 0; i < NValues; i++) {
+        serializeObject(values, static_cast<float>(i));
+    }
+
+    BENCHMARK("Values: Raw cast") {
+        size_t pos = 0;
+        float sum = 0.f;
+        for (size_t i = 0; i < NValues; i++) {
+            float v = 0.f;
+            rawRead(values, pos, v);
+            sum += v;
+        }
+        return sum;
+    };
+
+    BENCHMARK("Values: Deserializer") {
+        Deserializer d(values);
+        float sum = 0.f;
+        for (size_t i = 0; i < NValues; i++) {
+            float v = 0.f;
+            d.read(v);
+            sum += v;
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("SharedData: Serialize", "[shareddata]") {
+    const SceneState state = createSceneState();
+
+    // The way an application would currently write its encode function by hand
+    auto encodeByHand = [&state]() {
+        std::vector<std::byte> data;
+        serializeObject(data, state.time);
+        serializeObject(data, state.camera);
+        serializeObject(data, state.objects);
+        serializeObject(data, static_cast<uint32_t>(state.labels.size()));
+        for (const std::string& label : state.labels) {
+            serializeObject(data, label);
+        }
+        serializeObject(data, static_cast<uint32_t>(state.parameters.size()));
+        for (const auto& [key, value] : state.parameters) {
+            serializeObject(data, key);
+            serializeObject(data, value);
+        }
+        serializeObject(data, static_cast<uint8_t>(state.selected.has_value()));
+        if (state.selected.has_value()) {
+            serializeObject(data, *state.selected);
+        }
+        return data;
+    };
+
+    auto decodeByHand = [](const std::vector<std::byte>& data, SceneState& s) {
+        unsigned int pos = 0;
+        deserializeObject(data, pos, s.time);
+        deserializeObject(data, pos, s.camera);
+        deserializeObject(data, pos, s.objects);
+        uint32_t size = 0;
+        deserializeObject(data, pos, size);
+        s.labels.resize(size);
+        for (std::string& label : s.labels) {
+            deserializeObject(data, pos, label);
+        }
+        deserializeObject(data, pos, size);
+        s.parameters.clear();
+        for (uint32_t i = 0; i < size; i++) {
+            std::string key;
+            deserializeObject(data, pos, key);
+            float value = 0.f;
+            deserializeObject(data, pos, value);
+            s.parameters[key] = value;
+        }
+        uint8_t hasSelected = 0;
+        deserializeObject(data, pos, hasSelected);
+        if (hasSelected) {
+            deserializeObject(data, pos, s.selected.emplace());
+        }
+        else {
+            s.selected = std::nullopt;
+        }
+    };
+
+    const std::vector<std::byte> handEncoded = encodeByHand();
+    std::vector<std::byte> encoded;
+    serialize(encoded, state);
+    REQUIRE(encoded == handEncoded);
+
+    BENCHMARK("Encode: By hand") {
+        return encodeByHand();
+    };
+
+    BENCHMARK("Encode: serialize") {
+        std::vector<std::byte> data;
+        serialize(data, state);
+        return data;
+    };
+
+    // With the encode function that writes into the persistent shared data buffer, the
+    // memory of the previous frame is reused
+    std::vector<std::byte> buffer;
+    BENCHMARK("Encode: serialize into reused buffer") {
+        buffer.clear();
+        serialize(buffer, state);
+        return buffer.size();
+    };
+
+    SceneState decoded;
+    BENCHMARK("Decode: By hand") {
+        decodeByHand(encoded, decoded);
+        return decoded.objects.size();
+    };
+
+    BENCHMARK("Decode: deserialize") {
+        Deserializer d(encoded);
+        deserialize(d, decoded);
+        return decoded.objects.size();
+    };
+}
+
+TEST_CASE("SharedData: Shared variables", "[shareddata]") {
+    // Hundreds of parameters of which only a handful change every frame
+    constexpr int NParameters = 500;
+    constexpr int NChanged = 5;
+
+    SharedData& sd = SharedData::instance();
+
+    {
+        std::vector<float> parameters(NParameters);
+        std::vector<std::string> names(NParameters / 10, "Some parameter name");
+        int frame = 0;
+        sd.setEncodeFunction([&](std::vector<std::byte>& buffer) {
+            for (int i = 0; i < NChanged; i++) {
+                parameters[(frame * NChanged + i) % NParameters] += 1.f;
+            }
+            frame++;
+            serialize(buffer, parameters);
+            serialize(buffer, names);
+        });
+        sd.encode();
+        std::cout << std::format("Monolithic: {} bytes per frame\n", sd.dataSize());
+        BENCHMARK("Monolithic") {
+            sd.encode();
+            return sd.dataSize();
+        };
+        SharedData::destroy();
+    }
+
+    {
+        std::vector<std::unique_ptr<SharedObject<float>>> parameters;
+        for (int i = 0; i < NParameters; i++) {
+            parameters.push_back(std::make_unique<SharedObject<float>>(0.f));
+        }
+        std::vector<std::unique_ptr<SharedObject<std::string>>> names;
+        for (int i = 0; i < NParameters / 10; i++) {
+            names.push_back(
+                std::make_unique<SharedObject<std::string>>("Some parameter name")
+            );
+        }
+        SharedData& registrySd = SharedData::instance();
+        int frame = 0;
+        auto encode = [&]() {
+            for (int i = 0; i < NChanged; i++) {
+                const int index = (frame * NChanged + i) % NParameters;
+                parameters[index]->setValue(parameters[index]->value() + 1.f);
+            }
+            frame++;
+            registrySd.encode();
+            return registrySd.dataSize();
+        };
+        // The first frame contains all variables
+        encode();
+        std::cout << std::format("Shared variables: {} bytes per frame\n", encode());
+        BENCHMARK("Shared variables") {
+            return encode();
+        };
+        SharedData::destroy();
+    }
+}
+
+TEST_CASE("SharedData: Recording", "[shareddata]") {
+    // The recording grows with every frame, so the number of frames is fixed instead of
+    // letting the benchmark decide how often to run. The frames are recorded with a
+    // pause in between to simulate the time that is spent rendering each frame
+    constexpr int NFrames = 1000;
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "sgct-benchmark.sync";
+
+    for (size_t frameSize : { size_t(3 * 1024), size_t(64 * 1024) }) {
+        const std::vector<std::byte> frame(frameSize, std::byte(1));
+
+        using namespace std::chrono;
+        const steady_clock::time_point start = steady_clock::now();
+        std::unique_ptr<SyncRecorder> recorder = std::make_unique<SyncRecorder>(path);
+        const steady_clock::time_point created = steady_clock::now();
+        double totalTime = 0.0;
+        double maxTime = 0.0;
+        for (int i = 0; i < NFrames; i++) {
+            const steady_clock::time_point t = steady_clock::now();
+            recorder->record(frame);
+            const double time = duration<double>(steady_clock::now() - t).count();
+            totalTime += time;
+            maxTime = std::max(maxTime, time);
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        const steady_clock::time_point finishing = steady_clock::now();
+        recorder = nullptr;
+        const steady_clock::time_point finished = steady_clock::now();
+
+        std::cout << std::format(
+            "Recording {} byte frames: {:.2f} us per frame on average, {:.2f} us at "
+            "most, {:.2f} ms to create and {:.2f} ms to finish the file\n",
+            frameSize, 1e6 * totalTime / NFrames, 1e6 * maxTime,
+            1e3 * duration<double>(created - start).count(),
+            1e3 * duration<double>(finished - finishing).count()
+        );
+    }
+
+    std::filesystem::remove(path);
+}
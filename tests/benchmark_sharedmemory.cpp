@@ -0,0 +1,112 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/format.h>
+#include <sgct/network.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int FirstPort = 20780;
+
+    // A server and a client on the same machine, where the client acknowledges every
+    // frame as soon as it was received, which is what a client does before rendering
+    struct LoopbackConnection {
+        LoopbackConnection(int port, bool useSharedMemory) {
+            server = std::make_unique<Network>(
+                port,
+                "127.0.0.1",
+                true,
+                Network::ConnectionType::SyncConnection
+            );
+            server->setUpdateFunction([](Network&) {});
+            server->setConnectedFunction([]() {});
+            server->setSharedMemoryEnabled(useSharedMemory);
+            server->initialize();
+
+            client = std::make_unique<Network>(
+                port,
+                "127.0.0.1",
+                false,
+                Network::ConnectionType::SyncConnection
+            );
+            client->setUpdateFunction([](Network&) {});
+            client->setConnectedFunction([]() {});
+            Network* c = client.get();
+            client->setDecodeFunction([c](const char*, int) { c->pushClientMessage(); });
+            client->setSharedMemoryEnabled(useSharedMemory);
+            client->initialize();
+
+            while (!server->isConnected() || !client->isConnected()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            // Gives both sides the time to switch to shared memory before measuring
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        ~LoopbackConnection() {
+            client->initShutdown();
+            server->initShutdown();
+        }
+
+        // Sends a frame to the client and waits for its acknowledgement
+        void roundTrip(const std::vector<char>& payload) {
+            std::array<char, Network::HeaderSize> header = {};
+            header[0] = Network::DataId;
+            const int frame = server->iterateFrameCounter();
+            const uint32_t size = static_cast<uint32_t>(payload.size());
+            std::memcpy(header.data() + 1, &frame, sizeof(frame));
+            std::memcpy(header.data() + 5, &size, sizeof(size));
+
+            Network::sendToAll(
+                { server.get() },
+                { header },
+                payload.data(),
+                static_cast<int>(payload.size())
+            );
+            while (server->recvFrameCurrent() != server->sendFrameCurrent()) {
+                std::this_thread::yield();
+            }
+        }
+
+        std::unique_ptr<Network> server;
+        std::unique_ptr<Network> client;
+    };
+
+    void runRoundTripBenchmark(bool useSharedMemory) {
+        int port = FirstPort + (useSharedMemory ? 5 : 0);
+        for (int size : { 64, 64 * 1024, 1024 * 1024 }) {
+            LoopbackConnection connection(port, useSharedMemory);
+            port++;
+
+            const std::vector<char> payload(size, 1);
+            BENCHMARK(std::format("{} bytes", size)) {
+                connection.roundTrip(payload);
+                return connection.server->sendFrameCurrent();
+            };
+        }
+    }
+} // namespace
+
+TEST_CASE("SharedMemory: TCP", "[sharedmemory]") {
+    runRoundTripBenchmark(false);
+}
+
+TEST_CASE("SharedMemory: Shared Memory", "[sharedmemory]") {
+    runRoundTripBenchmark(true);
+}
@@ -0,0 +1,146 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT_TEST__LOOPBACKCLUSTER__H__
+#define __SGCT_TEST__LOOPBACKCLUSTER__H__
+
+#include <sgct/clustermanager.h>
+#include <sgct/config.h>
+#include <sgct/format.h>
+#include <sgct/multicast.h>
+#include <sgct/network.h>
+#include <sgct/networkmanager.h>
+#include <sgct/shareddata.h>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Creates one side of a sync connection via loopback. The connection still has to be
+// initialized once the caller has set the remaining callbacks
+inline std::unique_ptr<sgct::Network> createLoopbackConnection(int port, bool isServer) {
+    auto network = std::make_unique<sgct::Network>(
+        port,
+        "127.0.0.1",
+        isServer,
+        sgct::Network::ConnectionType::SyncConnection
+    );
+    network->setUpdateFunction([](sgct::Network&) {});
+    network->setConnectedFunction([]() {});
+    return network;
+}
+
+inline void waitForConnection(const sgct::Network& network) {
+    while (!network.isConnected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// A master and its clients that are connected via loopback in the same process. The
+// master is a regular NetworkManager that is configured by a cluster without windows.
+// As there can only be one NetworkManager per process, the clients are represented by
+// their sync connections, which acknowledge every frame as soon as it was received, just
+// like a client does before rendering the frame. The clients don't accept the offer to
+// use shared memory, so that the frames are sent via TCP like they would be to other
+// machines. If a `multicast` group is passed, the master sends the frames to the group
+// and the clients receive them from there
+struct LoopbackCluster {
+    LoopbackCluster(int nClients, int firstPort,
+                    std::optional<sgct::config::Multicast> multicast = std::nullopt)
+    {
+        using namespace sgct;
+
+        config::Cluster cluster;
+        cluster.masterAddress = "127.0.0.1";
+        // Otherwise the master would not wait for the acknowledgements of the clients
+        cluster.firmSync = true;
+        cluster.multicast = multicast;
+        for (int i = 0; i <= nClients; i++) {
+            config::Node node;
+            node.address = std::format("127.0.0.{}", i + 1);
+            node.port = static_cast<uint16_t>(firstPort + i);
+            cluster.nodes.push_back(node);
+        }
+        ClusterManager::create(cluster, 0);
+        NetworkManager::create(
+            NetworkManager::NetworkMode::LocalServer,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr
+        );
+        NetworkManager::instance().initialize();
+
+        for (int i = 1; i <= nClients; i++) {
+            std::unique_ptr<Network> client =
+                createLoopbackConnection(firstPort + i, false);
+            // The first frame after connecting is a keyframe
+            Network* c = client.get();
+            auto acknowledge = [c](const char*, int) { c->pushClientMessage(); };
+            client->setDecodeFunction(acknowledge);
+            client->setKeyframeDecodeFunction(acknowledge);
+            if (multicast) {
+                client->setMulticastReceiver(std::make_unique<MulticastReceiver>(
+                    multicast->address,
+                    multicast->port,
+                    multicast->interfaceAddress.value_or(""),
+                    MulticastReceiver::DefaultTimeout
+                ));
+            }
+            client->initialize();
+            clients.push_back(std::move(client));
+        }
+
+        while (!NetworkManager::instance().areAllNodesConnected()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    ~LoopbackCluster() {
+        for (std::unique_ptr<sgct::Network>& client : clients) {
+            client->initShutdown();
+        }
+        clients.clear();
+        sgct::NetworkManager::destroy();
+        sgct::ClusterManager::destroy();
+    }
+
+    // Encodes the shared data and sends it to all clients, like the master's render loop
+    // does at the start of every frame
+    void sendFrame() {
+        sgct::SharedData::instance().encode();
+        sgct::NetworkManager::instance().sync(
+            sgct::NetworkManager::SyncMode::SendDataToClients
+        );
+    }
+
+    // Waits until all clients have acknowledged the frame that was sent last
+    void waitForAcknowledgements() {
+        sgct::NetworkManager& nm = sgct::NetworkManager::instance();
+        while (nm.isRunning() && !nm.isSyncComplete()) {
+            nm.waitForSync(std::chrono::milliseconds(100), std::chrono::seconds(0));
+        }
+        nm.sync(sgct::NetworkManager::SyncMode::Acknowledge);
+    }
+
+    // Runs one frame of the master's render loop and returns the time in seconds from
+    // encoding the shared data until all clients have acknowledged it
+    double runFrame() {
+        const auto start = std::chrono::steady_clock::now();
+        sendFrame();
+        waitForAcknowledgements();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    std::vector<std::unique_ptr<sgct::Network>> clients;
+};
+
+#endif // __SGCT_TEST__LOOPBACKCLUSTER__H__
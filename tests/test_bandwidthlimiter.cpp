@@ -0,0 +1,87 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/bandwidthlimiter.h>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+using namespace sgct;
+
+namespace {
+    constexpr size_t Slice = BandwidthLimiter::SliceSize;
+
+    // Sends the bytes in slices and returns the time that it took
+    std::chrono::steady_clock::duration send(BandwidthLimiter& limiter, size_t bytes) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t sent = 0; sent < bytes; sent += Slice) {
+            limiter.acquire(Slice);
+        }
+        return std::chrono::steady_clock::now() - start;
+    }
+} // namespace
+
+TEST_CASE("BandwidthLimiter: Unlimited", "[bandwidthlimiter]") {
+    BandwidthLimiter limiter;
+    CHECK(limiter.rate() == 0.0);
+    CHECK(send(limiter, 64 * Slice) < std::chrono::milliseconds(50));
+
+    // Backing off has no effect without a budget
+    limiter.setBackoff(true);
+    CHECK_FALSE(limiter.isBackingOff());
+    CHECK(send(limiter, 64 * Slice) < std::chrono::milliseconds(50));
+
+    const BandwidthLimiter::Statistics stats = limiter.statistics();
+    CHECK(stats.nBytes == 128 * Slice);
+    CHECK(stats.nDelays == 0);
+}
+
+TEST_CASE("BandwidthLimiter: Rate", "[bandwidthlimiter]") {
+    // 32 slices at 16 slices per second take two seconds, except for the first slice
+    BandwidthLimiter limiter(16.0 * Slice);
+    const auto duration = send(limiter, 32 * Slice);
+    CHECK(duration > std::chrono::milliseconds(1800));
+    CHECK(duration < std::chrono::milliseconds(2500));
+
+    const BandwidthLimiter::Statistics stats = limiter.statistics();
+    CHECK(stats.nBytes == 32 * Slice);
+    CHECK(stats.nDelays == 31);
+    CHECK(stats.delay > std::chrono::seconds(1));
+}
+
+TEST_CASE("BandwidthLimiter: Backoff", "[bandwidthlimiter]") {
+    BandwidthLimiter limiter(160.0 * Slice);
+    CHECK(send(limiter, 16 * Slice) < std::chrono::milliseconds(250));
+
+    // A tenth of the rate lets the same slices take ten times as long
+    limiter.setBackoff(true);
+    CHECK(limiter.isBackingOff());
+    CHECK(send(limiter, 16 * Slice) > std::chrono::milliseconds(800));
+
+    limiter.setBackoff(false);
+    CHECK_FALSE(limiter.isBackingOff());
+    CHECK(send(limiter, 16 * Slice) < std::chrono::milliseconds(250));
+}
+
+TEST_CASE("BandwidthLimiter: Stop", "[bandwidthlimiter]") {
+    // A single slice per minute would block the second sender for a long time
+    BandwidthLimiter limiter(Slice / 60.0);
+    limiter.acquire(Slice);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread sender([&limiter]() { limiter.acquire(Slice); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    limiter.stop();
+    sender.join();
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+
+    // Every following sender passes immediately
+    CHECK(send(limiter, 16 * Slice) < std::chrono::milliseconds(50));
+}
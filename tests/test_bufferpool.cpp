@@ -0,0 +1,135 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/bufferpool.h>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace sgct;
+
+TEST_CASE("BufferPool: Size Classes", "[bufferpool]") {
+    BufferPool pool;
+    CHECK(pool.acquire(0).size() == BufferPool::MinBufferSize);
+    CHECK(pool.acquire(1).size() == BufferPool::MinBufferSize);
+    CHECK(pool.acquire(BufferPool::MinBufferSize).size() == BufferPool::MinBufferSize);
+    CHECK(pool.acquire(BufferPool::MinBufferSize + 1).size() == 8192);
+    CHECK(pool.acquire(1000000).size() == 1048576);
+    CHECK(pool.acquire(1048576).size() == 1048576);
+}
+
+TEST_CASE("BufferPool: Reuse", "[bufferpool]") {
+    BufferPool pool;
+
+    std::vector<char> buffer = pool.acquire(100000);
+    buffer[0] = 42;
+    const char* data = buffer.data();
+    pool.release(std::move(buffer));
+    CHECK(pool.statistics().retainedBytes == 131072);
+
+    // Any size of the same class reuses the buffer without clearing its content
+    std::vector<char> reused = pool.acquire(70000);
+    CHECK(reused.data() == data);
+    CHECK(reused.size() == 131072);
+    CHECK(reused[0] == 42);
+
+    // A different size class has to be allocated
+    std::vector<char> other = pool.acquire(1000);
+    CHECK(other.size() == BufferPool::MinBufferSize);
+
+    const BufferPool::Statistics stats = pool.statistics();
+    CHECK(stats.nAcquired == 3);
+    CHECK(stats.nAllocations == 2);
+    CHECK(stats.nFreed == 0);
+    CHECK(stats.retainedBytes == 0);
+}
+
+TEST_CASE("BufferPool: Foreign Buffers", "[bufferpool]") {
+    BufferPool pool;
+    pool.release(std::vector<char>(5000));
+    pool.release(std::vector<char>(100));
+    pool.release(std::vector<char>());
+    CHECK(pool.statistics().retainedBytes == 0);
+}
+
+TEST_CASE("BufferPool: High-Water Mark", "[bufferpool]") {
+    BufferPool pool(3 * 65536);
+
+    std::vector<char> b1 = pool.acquire(65536);
+    std::vector<char> b2 = pool.acquire(65536);
+    std::vector<char> b3 = pool.acquire(65536);
+    std::vector<char> b4 = pool.acquire(65536);
+    const char* d2 = b2.data();
+    const char* d4 = b4.data();
+    pool.release(std::move(b1));
+    pool.release(std::move(b2));
+    pool.release(std::move(b3));
+    CHECK(pool.statistics().retainedBytes == 3 * 65536);
+
+    // The least recently released buffer is freed to stay below the high-water mark
+    pool.release(std::move(b4));
+    BufferPool::Statistics stats = pool.statistics();
+    CHECK(stats.retainedBytes == 3 * 65536);
+    CHECK(stats.nFreed == 1);
+
+    // The most recently released buffer is reused first
+    CHECK(pool.acquire(65536).data() == d4);
+    pool.acquire(65536);
+    CHECK(pool.acquire(65536).data() == d2);
+
+    // A buffer that is larger than the high-water mark is never kept
+    pool.release(pool.acquire(4 * 65536));
+    stats = pool.statistics();
+    CHECK(stats.retainedBytes == 0);
+    CHECK(stats.nFreed == 2);
+}
+
+TEST_CASE("BufferPool: Lower High-Water Mark", "[bufferpool]") {
+    BufferPool pool;
+    std::vector<char> small = pool.acquire(4096);
+    std::vector<char> large = pool.acquire(65536);
+    pool.release(std::move(large));
+    pool.release(std::move(small));
+    CHECK(pool.statistics().retainedBytes == 65536 + 4096);
+
+    pool.setHighWaterMark(4096);
+    CHECK(pool.statistics().retainedBytes == 4096);
+
+    pool.setHighWaterMark(0);
+    CHECK(pool.statistics().retainedBytes == 0);
+
+    // Nothing is kept while the high-water mark is 0
+    pool.release(pool.acquire(4096));
+    CHECK(pool.statistics().retainedBytes == 0);
+}
+
+TEST_CASE("BufferPool: Idle Buffers", "[bufferpool]") {
+    BufferPool pool(BufferPool::DefaultHighWaterMark, std::chrono::milliseconds(20));
+    pool.release(pool.acquire(4096));
+    pool.trim();
+    CHECK(pool.statistics().retainedBytes == 4096);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pool.trim();
+    const BufferPool::Statistics stats = pool.statistics();
+    CHECK(stats.retainedBytes == 0);
+    CHECK(stats.nFreed == 1);
+}
+
+TEST_CASE("BufferPool: Clear", "[bufferpool]") {
+    BufferPool pool;
+    pool.release(pool.acquire(4096));
+    pool.release(pool.acquire(100000));
+    pool.clear();
+    const BufferPool::Statistics stats = pool.statistics();
+    CHECK(stats.retainedBytes == 0);
+    CHECK(stats.nFreed == 2);
+}
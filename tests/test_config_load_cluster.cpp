@@ -182,6 +182,167 @@ TEST_CASE("Load: Cluster/FirmSync", "[parse]") {
     }
 }
 
+TEST_CASE("Load: Cluster/MaxFrameLag", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "maxframelag": 2
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .maxFrameLag = 2
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/TransferWindow", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferwindow": 4
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .transferWindow = 4
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/TransferBufferLimit", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbufferlimit": 16
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .transferBufferLimit = 16
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/TransferBandwidth", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbandwidth": 250.5
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .transferBandwidth = 250.5f
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/TransferBackoffThreshold", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbackoffthreshold": 4.5
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .transferBackoffThreshold = 4.5f
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/SyncDscp", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "syncdscp": 34
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .syncDscp = 34
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Cluster/TransferCache", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transfercache": "cache/transfers"
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .transferCache = "cache/transfers"
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
 
 
 
@@ -299,6 +460,158 @@ TEST_CASE("Validate: Cluster/ThreadAffinity/Illegal Value", "[validate]") {
     );
 }
 
+TEST_CASE("Validate: Cluster/MaxFrameLag/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "maxframelag": -1
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6092): Maximum frame lag must be between 0 and 64"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/MaxFrameLag/Too Large", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "maxframelag": 65
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6092): Maximum frame lag must be between 0 and 64"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/TransferWindow/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferwindow": 0
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6094): Transfer window must be positive"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/TransferBufferLimit/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbufferlimit": -1
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6093): Transfer buffer limit must be 0 or positive"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/TransferBandwidth/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbandwidth": 0
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6095): Transfer bandwidth must be positive"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/TransferBackoffThreshold/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transferbackoffthreshold": -1
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6096): Transfer backoff threshold must be positive"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/SyncDscp/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "syncdscp": 64
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6097): Sync DSCP must be between 0 and 63"
+        )
+    );
+}
+
+TEST_CASE("Validate: Cluster/TransferCache/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "transfercache": ""
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6098): Transfer cache must not be empty"
+        )
+    );
+}
+
 TEST_CASE("Validate: Cluster/FirmSync/Wrong Type", "[validate]") {
     constexpr std::string_view Config = R"(
 {
@@ -0,0 +1,154 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_exception.hpp>
+
+#include <sgct/config.h>
+#include "schema.h"
+
+using namespace sgct;
+using namespace sgct::config;
+
+TEST_CASE("Load: Multicast/Minimal", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.1",
+    "port": 20500
+  }
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .multicast = Multicast {
+            .address = "239.255.0.1",
+            .port = 20500
+        }
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Multicast/Full", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.2",
+    "port": 20501,
+    "interface": "192.168.0.10",
+    "datagramsize": 8972,
+    "ttl": 2,
+    "timeout": 50
+  }
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .multicast = Multicast {
+            .address = "239.255.0.2",
+            .port = 20501,
+            .interfaceAddress = "192.168.0.10",
+            .datagramSize = 8972,
+            .ttl = 2,
+            .timeout = 50
+        }
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
+TEST_CASE("Load: Multicast/Missing Address", "[parse]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "port": 20500
+  }
+}
+)";
+
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6090): Missing field address in multicast"
+        )
+    );
+}
+
+TEST_CASE("Load: Multicast/Missing Port", "[parse]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.1"
+  }
+}
+)";
+
+    CHECK_THROWS_MATCHES(
+        readJsonConfig(Config),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6091): Missing field port in multicast"
+        )
+    );
+}
+
+TEST_CASE("Validate: Multicast/Datagram Size/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.1",
+    "port": 20500,
+    "datagramsize": 32
+  }
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+}
+
+TEST_CASE("Validate: Multicast/TTL/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.1",
+    "port": 20500,
+    "ttl": 256
+  }
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+}
@@ -218,6 +218,49 @@ TEST_CASE("Load: Node/SwapLock", "[parse]") {
     }
 }
 
+TEST_CASE("Load: Node/Parent", "[parse]") {
+    constexpr std::string_view String = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "nodes": [
+    {
+      "address": "abc",
+      "port": 1
+    },
+    {
+      "address": "def",
+      "port": 2,
+      "parent": 0
+    }
+  ]
+}
+)";
+
+    const Cluster Object = {
+        .success = true,
+        .masterAddress = "localhost",
+        .nodes = {
+            Node {
+                .address = "abc",
+                .port = 1
+            },
+            Node {
+                .address = "def",
+                .port = 2,
+                .parent = 0
+            }
+        }
+    };
+
+    Cluster res = sgct::readJsonConfig(String);
+    CHECK(res == Object);
+
+    const std::string str = serializeConfig(Object);
+    const config::Cluster output = readJsonConfig(str);
+    CHECK(output == Object);
+}
+
 TEST_CASE("Load: Node/Full", "[parse]") {
     constexpr std::string_view String = R"(
 {
@@ -392,3 +435,21 @@ TEST_CASE("Validate: Node/Windows/Wrong Type", "[validate]") {
 
     CHECK_THROWS_AS(validate(Config), ParsingError);
 }
+
+TEST_CASE("Validate: Node/Parent/Illegal Value", "[validate]") {
+    constexpr std::string_view Config = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "nodes": [
+    {
+      "address": "localhost",
+      "port": 123,
+      "parent": -1
+    }
+  ]
+}
+)";
+
+    CHECK_THROWS_AS(validate(Config), ParsingError);
+}
@@ -0,0 +1,127 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/framebarrier.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr std::chrono::milliseconds ShortTimeout(10);
+    constexpr std::chrono::seconds LongTimeout(10);
+} // namespace
+
+TEST_CASE("FrameBarrier: Complete", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(3);
+
+    barrier.arrive();
+    barrier.arrive();
+    CHECK_FALSE(barrier.wait(ShortTimeout));
+
+    barrier.arrive();
+    CHECK(barrier.wait(ShortTimeout));
+
+    // Each release is only consumed once
+    CHECK_FALSE(barrier.wait(ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Late Arrivals", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(1);
+    barrier.arrive();
+    CHECK(barrier.wait(ShortTimeout));
+
+    // Every arrival after the frame is complete releases the barrier again
+    barrier.arrive();
+    CHECK(barrier.wait(ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Reset", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(2);
+    barrier.arrive();
+
+    // The arrivals of the previous frame don't count for the next one
+    barrier.reset(2);
+    barrier.arrive();
+    CHECK_FALSE(barrier.wait(ShortTimeout));
+    barrier.arrive();
+    CHECK(barrier.wait(ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Drop", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(3);
+    barrier.arrive();
+    barrier.arrive();
+    CHECK_FALSE(barrier.wait(ShortTimeout));
+
+    barrier.drop();
+    CHECK(barrier.wait(ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Release", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(2);
+    barrier.release();
+    CHECK(barrier.wait(ShortTimeout));
+    CHECK_FALSE(barrier.wait(ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Spin", "[framebarrier]") {
+    FrameBarrier barrier;
+    barrier.reset(1);
+    CHECK_FALSE(barrier.wait(ShortTimeout, LongTimeout));
+
+    barrier.arrive();
+    CHECK(barrier.wait(ShortTimeout, ShortTimeout));
+}
+
+TEST_CASE("FrameBarrier: Threads", "[framebarrier]") {
+    constexpr int NThreads = 8;
+    constexpr int NFrames = 100;
+
+    FrameBarrier barrier;
+    std::atomic_int frame = 0;
+    std::atomic_int nArrivals = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NThreads; i++) {
+        threads.emplace_back([&]() {
+            for (int f = 1; f <= NFrames; f++) {
+                while (frame < f) {
+                    std::this_thread::yield();
+                }
+                nArrivals++;
+                barrier.arrive();
+            }
+        });
+    }
+
+    // The barrier might be released by a late arrival of the previous frame, so the
+    // arrivals have to be checked after every release, just like the frame lock does
+    bool isComplete = true;
+    for (int f = 1; f <= NFrames && isComplete; f++) {
+        barrier.reset(NThreads);
+        frame = f;
+        while (nArrivals < f * NThreads && isComplete) {
+            isComplete = barrier.wait(LongTimeout);
+        }
+    }
+    CHECK(isComplete);
+    CHECK(nArrivals == NFrames * NThreads);
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
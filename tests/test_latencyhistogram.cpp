@@ -0,0 +1,74 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/latencyhistogram.h>
+#include <cmath>
+
+using namespace sgct;
+
+namespace {
+    // The estimates are off by less than the width of a bucket
+    bool isEstimateOf(double estimate, double value) {
+        const double error = LatencyHistogram::BucketRatio - 1.0;
+        return std::abs(estimate - value) <= value * error;
+    }
+} // namespace
+
+TEST_CASE("LatencyHistogram: Empty", "[latencyhistogram]") {
+    const LatencyHistogram histogram;
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.min() == 0.0);
+    CHECK(histogram.max() == 0.0);
+    CHECK(histogram.percentile(0.5) == 0.0);
+}
+
+TEST_CASE("LatencyHistogram: Percentiles", "[latencyhistogram]") {
+    // 1 ms to 100 ms in steps of 1 ms, so that the n-th percentile is n ms
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; i++) {
+        histogram.add(i / 1000.0);
+    }
+
+    CHECK(histogram.count() == 100);
+    CHECK(histogram.min() == 0.001);
+    CHECK(histogram.max() == 0.1);
+
+    CHECK(isEstimateOf(histogram.percentile(0.5), 0.05));
+    CHECK(isEstimateOf(histogram.percentile(0.95), 0.095));
+    CHECK(isEstimateOf(histogram.percentile(0.99), 0.099));
+    CHECK(isEstimateOf(histogram.percentile(0.0), 0.001));
+    CHECK(isEstimateOf(histogram.percentile(1.0), 0.1));
+}
+
+TEST_CASE("LatencyHistogram: Out of Range", "[latencyhistogram]") {
+    LatencyHistogram histogram;
+    histogram.add(0.0);
+    histogram.add(-1.0);
+    histogram.add(1000.0);
+
+    CHECK(histogram.count() == 3);
+    CHECK(histogram.min() == 0.0);
+    CHECK(histogram.max() == 1000.0);
+    CHECK(histogram.percentile(0.5) == 0.0);
+    CHECK(histogram.percentile(1.0) == 1000.0);
+}
+
+TEST_CASE("LatencyHistogram: Reset", "[latencyhistogram]") {
+    LatencyHistogram histogram;
+    histogram.add(0.5);
+    histogram.reset();
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.percentile(0.5) == 0.0);
+
+    histogram.add(0.25);
+    CHECK(histogram.min() == 0.25);
+    CHECK(histogram.max() == 0.25);
+    CHECK(histogram.percentile(0.5) == 0.25);
+}
@@ -0,0 +1,267 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/error.h>
+#include <sgct/multicast.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // All tests run on the loopback interface so that no datagrams leave the computer
+    constexpr std::string_view Interface = "127.0.0.1";
+    constexpr std::chrono::milliseconds Timeout = std::chrono::milliseconds(200);
+
+    std::vector<char> createFrame(size_t size, int seed) {
+        std::vector<char> frame(size);
+        for (size_t i = 0; i < size; i++) {
+            frame[i] = static_cast<char>((i * 31 + seed) % 251);
+        }
+        return frame;
+    }
+} // namespace
+
+TEST_CASE("Multicast: Roundtrip", "[multicast]") {
+    constexpr std::string_view Address = "239.255.42.1";
+    constexpr int Port = 20701;
+
+    MulticastSender sender(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+    std::array<std::unique_ptr<MulticastReceiver>, 3> receivers;
+    for (std::unique_ptr<MulticastReceiver>& r : receivers) {
+        r = std::make_unique<MulticastReceiver>(
+            std::string(Address),
+            Port,
+            std::string(Interface),
+            Timeout
+        );
+        r->setSession(sender.session());
+    }
+
+    // Empty frames, frames that fit into a single datagram, frames that exactly fill a
+    // number of datagrams, and frames that are split into many datagrams
+    constexpr int PayloadSize =
+        MulticastSender::DefaultDatagramSize - MulticastSender::DatagramHeaderSize;
+    const std::array<size_t, 6> sizes = {
+        0, 1, PayloadSize, PayloadSize + 1, 3 * PayloadSize, 100000
+    };
+    for (size_t i = 0; i < sizes.size(); i++) {
+        const std::vector<char> frame = createFrame(sizes[i], static_cast<int>(i));
+        const int size = static_cast<int>(frame.size());
+        const uint32_t sequence = sender.send(frame.data(), size);
+        CHECK(sequence == i + 1);
+
+        for (std::unique_ptr<MulticastReceiver>& r : receivers) {
+            std::vector<char> received;
+            REQUIRE(r->receiveFrame(sequence, received));
+            CHECK(received == frame);
+        }
+    }
+}
+
+TEST_CASE("Multicast: History", "[multicast]") {
+    MulticastSender sender(
+        "239.255.42.2",
+        20702,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+
+    const std::vector<char> first = createFrame(5000, 1);
+    const uint32_t sequence = sender.send(first.data(), static_cast<int>(first.size()));
+    CHECK(sender.frame(sequence) == first);
+    CHECK(sender.frame(sequence + 1).empty());
+
+    for (int i = 0; i < MulticastSender::HistorySize - 1; i++) {
+        const std::vector<char> frame = createFrame(100, i);
+        sender.send(frame.data(), static_cast<int>(frame.size()));
+    }
+    CHECK(sender.frame(sequence) == first);
+
+    // Sending one more frame pushes the first frame out of the history
+    const std::vector<char> last = createFrame(100, 2);
+    sender.send(last.data(), static_cast<int>(last.size()));
+    CHECK(sender.frame(sequence).empty());
+}
+
+TEST_CASE("Multicast: Lost Frame", "[multicast]") {
+    MulticastReceiver receiver("239.255.42.3", 20703, std::string(Interface), Timeout);
+
+    // A frame that was never sent is reported as lost after the timeout has passed
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<char> frame;
+    CHECK_FALSE(receiver.receiveFrame(1, frame));
+    CHECK(std::chrono::steady_clock::now() - start >= Timeout);
+    CHECK(frame.empty());
+}
+
+TEST_CASE("Multicast: Out Of Order", "[multicast]") {
+    constexpr std::string_view Address = "239.255.42.4";
+    constexpr int Port = 20704;
+
+    MulticastSender sender(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+    MulticastReceiver receiver(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        Timeout
+    );
+    receiver.setSession(sender.session());
+
+    const std::vector<char> first = createFrame(10000, 1);
+    const std::vector<char> second = createFrame(20000, 2);
+    const uint32_t s1 = sender.send(first.data(), static_cast<int>(first.size()));
+    const uint32_t s2 = sender.send(second.data(), static_cast<int>(second.size()));
+
+    // Waiting for the newer frame discards the older one
+    std::vector<char> received;
+    REQUIRE(receiver.receiveFrame(s2, received));
+    CHECK(received == second);
+    received.clear();
+    CHECK_FALSE(receiver.receiveFrame(s1, received));
+    CHECK(received.empty());
+}
+
+TEST_CASE("Multicast: Foreign Session", "[multicast]") {
+    constexpr std::string_view Address = "239.255.42.6";
+    constexpr int Port = 20706;
+
+    // Two clusters that use the same group and port
+    MulticastSender sender(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+    MulticastSender foreign(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+    REQUIRE(sender.session() != foreign.session());
+    MulticastReceiver receiver(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        Timeout
+    );
+    receiver.setSession(sender.session());
+
+    // The frame of the other cluster has the same sequence number but is ignored
+    const std::vector<char> other = createFrame(10000, 1);
+    const std::vector<char> frame = createFrame(10000, 2);
+    foreign.send(other.data(), static_cast<int>(other.size()));
+    const uint32_t sequence = sender.send(frame.data(), static_cast<int>(frame.size()));
+    std::vector<char> received;
+    REQUIRE(receiver.receiveFrame(sequence, received));
+    CHECK(received == frame);
+
+    // Once the other cluster is the only one sending, its frames count as lost
+    foreign.send(other.data(), static_cast<int>(other.size()));
+    received.clear();
+    CHECK_FALSE(receiver.receiveFrame(sequence + 1, received));
+    CHECK(received.empty());
+}
+
+TEST_CASE("Multicast: Take Frame", "[multicast]") {
+    constexpr std::string_view Address = "239.255.42.7";
+    constexpr int Port = 20707;
+
+    MulticastSender sender(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+    MulticastReceiver receiver(
+        std::string(Address),
+        Port,
+        std::string(Interface),
+        Timeout
+    );
+    receiver.setSession(sender.session());
+
+    // Taking a frame that did not arrive yet doesn't wait for it
+    std::vector<char> received;
+    const auto start = std::chrono::steady_clock::now();
+    CHECK(receiver.takeFrame(1, received) == MulticastReceiver::FrameStatus::Pending);
+    CHECK(std::chrono::steady_clock::now() - start < Timeout);
+
+    const std::vector<char> frame = createFrame(50000, 1);
+    const uint32_t sequence = sender.send(frame.data(), static_cast<int>(frame.size()));
+    REQUIRE(sequence == 1);
+    MulticastReceiver::FrameStatus status = MulticastReceiver::FrameStatus::Pending;
+    while (status == MulticastReceiver::FrameStatus::Pending) {
+        REQUIRE(std::chrono::steady_clock::now() - start < 10 * Timeout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        status = receiver.takeFrame(sequence, received);
+    }
+    CHECK(status == MulticastReceiver::FrameStatus::Received);
+    CHECK(received == frame);
+
+    // A frame that is never sent is lost once the timeout has passed
+    const auto lostStart = std::chrono::steady_clock::now();
+    status = MulticastReceiver::FrameStatus::Pending;
+    while (status == MulticastReceiver::FrameStatus::Pending) {
+        REQUIRE(std::chrono::steady_clock::now() - lostStart < 10 * Timeout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        status = receiver.takeFrame(sequence + 1, received);
+    }
+    CHECK(status == MulticastReceiver::FrameStatus::Lost);
+    CHECK(std::chrono::steady_clock::now() - lostStart >= Timeout);
+}
+
+TEST_CASE("Multicast: Frame Size", "[multicast]") {
+    MulticastSender sender(
+        "239.255.42.8",
+        20708,
+        std::string(Interface),
+        MulticastSender::DefaultDatagramSize,
+        0
+    );
+
+    // The receivers would not reserve the memory for a larger frame
+    const std::vector<char> frame(MulticastSender::MaxFrameSize + 1);
+    CHECK_THROWS_AS(sender.send(frame.data(), static_cast<int>(frame.size())), Error);
+}
+
+TEST_CASE("Multicast: Invalid Address", "[multicast]") {
+    CHECK_THROWS_AS(
+        MulticastSender("abc", 20705, "", MulticastSender::DefaultDatagramSize, 1),
+        Error
+    );
+
+    // 10.0.0.1 is a valid address, but not a multicast group
+    CHECK_THROWS_AS(
+        MulticastSender("10.0.0.1", 20705, "", MulticastSender::DefaultDatagramSize, 1),
+        Error
+    );
+}
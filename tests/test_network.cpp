@@ -0,0 +1,633 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/clustermanager.h>
+#include <sgct/config.h>
+#include <sgct/network.h>
+#include <sgct/sharedmemory.h>
+#include <sgct/transfercache.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int FirstPort = 20730;
+
+    struct Connection {
+        std::unique_ptr<Network> server;
+        std::unique_ptr<Network> client;
+        std::vector<char> received;
+        std::atomic_int nReceived = 0;
+    };
+
+    // The longest time that a test waits for a connection to do something, so that a
+    // broken connection fails the test instead of making it hang
+    constexpr std::chrono::seconds Deadline = std::chrono::seconds(10);
+
+    // The connection attempts and the shutdown give up after one second at the latest.
+    // Finishing below this bound shows that they did not run into these timeouts, while
+    // leaving enough room for a slow or loaded machine
+    constexpr std::chrono::milliseconds TimeoutBound = std::chrono::milliseconds(900);
+
+    void waitUntil(const std::function<bool()>& isDone) {
+        const auto end = std::chrono::steady_clock::now() + Deadline;
+        while (!isDone()) {
+            if (std::chrono::steady_clock::now() > end) {
+                FAIL("Timed out after " << Deadline.count() << " s");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void connect(Connection& c, int port, bool useSharedMemory = false,
+                 Network::ConnectionType type = Network::ConnectionType::SyncConnection)
+    {
+        c.server = std::make_unique<Network>(port, "127.0.0.1", true, type);
+        c.server->setUpdateFunction([](Network&) {});
+        c.server->setConnectedFunction([]() {});
+        c.server->setSharedMemoryEnabled(useSharedMemory);
+        c.server->initialize();
+
+        c.client = std::make_unique<Network>(port, "127.0.0.1", false, type);
+        c.client->setUpdateFunction([](Network&) {});
+        c.client->setConnectedFunction([]() {});
+        c.client->setDecodeFunction([&c](const char* data, int length) {
+            c.received.assign(data, data + length);
+            c.nReceived++;
+        });
+        c.client->setSharedMemoryEnabled(useSharedMemory);
+        c.client->initialize();
+
+        waitUntil([&]() { return c.server->isConnected() && c.client->isConnected(); });
+    }
+
+    void disconnect(Connection& c) {
+        c.client->initShutdown();
+        c.server->initShutdown();
+        c.client = nullptr;
+        c.server = nullptr;
+    }
+
+    std::array<char, Network::HeaderSize> createHeader(int frame, int size) {
+        std::array<char, Network::HeaderSize> header = {};
+        header[0] = Network::DataId;
+        std::memcpy(header.data() + 1, &frame, sizeof(frame));
+        std::memcpy(header.data() + 5, &size, sizeof(size));
+        return header;
+    }
+
+    void waitForFrames(const Connection& c, int nFrames) {
+        waitUntil([&]() { return c.nReceived >= nFrames; });
+    }
+} // namespace
+
+TEST_CASE("Network: SendToAll", "[network]") {
+    std::array<Connection, 3> connections;
+    for (size_t i = 0; i < connections.size(); i++) {
+        connect(connections[i], FirstPort + static_cast<int>(i));
+    }
+
+    std::vector<Network*> servers;
+    std::vector<std::array<char, Network::HeaderSize>> headers;
+    for (Connection& c : connections) {
+        servers.push_back(c.server.get());
+        headers.push_back(createHeader(c.server->iterateFrameCounter(), 0));
+    }
+
+    SECTION("Payload") {
+        constexpr int Size = 1024 * 1024;
+        std::vector<char> payload(Size);
+        for (int i = 0; i < Size; i++) {
+            payload[i] = static_cast<char>(i % 127);
+        }
+        for (std::array<char, Network::HeaderSize>& header : headers) {
+            std::memcpy(header.data() + 5, &Size, sizeof(Size));
+        }
+
+        const std::vector<double> times =
+            Network::sendToAll(servers, headers, payload.data(), Size);
+        CHECK(times.size() == connections.size());
+
+        for (Connection& c : connections) {
+            waitForFrames(c, 1);
+            CHECK(c.received == payload);
+        }
+    }
+
+    SECTION("Small") {
+        constexpr int Size = 1;
+        const char payload = 42;
+        for (std::array<char, Network::HeaderSize>& header : headers) {
+            std::memcpy(header.data() + 5, &Size, sizeof(Size));
+        }
+
+        const std::vector<double> times =
+            Network::sendToAll(servers, headers, &payload, Size);
+        CHECK(times.size() == connections.size());
+
+        for (Connection& c : connections) {
+            waitForFrames(c, 1);
+            CHECK(c.received == std::vector<char>{ payload });
+        }
+    }
+
+    for (Connection& c : connections) {
+        disconnect(c);
+    }
+}
+
+TEST_CASE("Network: Reconnect", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 10);
+
+    // The server has to accept the next client after the first one disconnected
+    c.client->initShutdown();
+    c.client = nullptr;
+    waitUntil([&]() { return !c.server->isConnected(); });
+
+    c.client = std::make_unique<Network>(
+        FirstPort + 10,
+        "127.0.0.1",
+        false,
+        Network::ConnectionType::SyncConnection
+    );
+    c.client->setUpdateFunction([](Network&) {});
+    c.client->setConnectedFunction([]() {});
+    c.client->setDecodeFunction([&c](const char* data, int length) {
+        c.received.assign(data, data + length);
+        c.nReceived++;
+    });
+    c.client->initialize();
+    waitUntil([&]() { return c.server->isConnected() && c.client->isConnected(); });
+
+    constexpr int Size = 4;
+    const std::array<char, Size> payload = { 1, 2, 3, 4 };
+    const std::vector<Network*> servers = { c.server.get() };
+    const std::vector<std::array<char, Network::HeaderSize>> headers = {
+        createHeader(c.server->iterateFrameCounter(), Size)
+    };
+    Network::sendToAll(servers, headers, payload.data(), Size);
+    waitForFrames(c, 1);
+    CHECK(c.received == std::vector<char>(payload.begin(), payload.end()));
+
+    disconnect(c);
+}
+
+TEST_CASE("Network: Relay", "[network]") {
+    // The relay receives the frames on the client of `upstream` and forwards them to the
+    // servers of `relayed` before they are decoded
+    Connection upstream;
+    connect(upstream, FirstPort + 20);
+    std::array<Connection, 2> relayed;
+    for (size_t i = 0; i < relayed.size(); i++) {
+        connect(relayed[i], FirstPort + 21 + static_cast<int>(i));
+    }
+
+    std::atomic_int nForwarded = 0;
+    std::atomic_int nForwardedBeforeDecode = -1;
+    upstream.client->setRelayFunction(
+        [&](const std::array<char, Network::HeaderSize>& header, const char* data,
+            uint32_t size, const std::function<void()>& decode)
+        {
+            std::vector<Network*> servers;
+            std::vector<std::array<char, Network::HeaderSize>> headers;
+            for (Connection& c : relayed) {
+                servers.push_back(c.server.get());
+                std::array<char, Network::HeaderSize>& h = headers.emplace_back(header);
+                const int frame = c.server->iterateFrameCounter();
+                std::memcpy(h.data() + 1, &frame, sizeof(frame));
+            }
+            Network::sendToAll(servers, headers, data, static_cast<int>(size));
+            nForwarded++;
+            nForwardedBeforeDecode = upstream.nReceived.load();
+            decode();
+        }
+    );
+
+    constexpr int Size = 4;
+    const std::array<char, Size> payload = { 5, 6, 7, 8 };
+    const std::vector<Network*> servers = { upstream.server.get() };
+    const std::vector<std::array<char, Network::HeaderSize>> headers = {
+        createHeader(upstream.server->iterateFrameCounter(), Size)
+    };
+    Network::sendToAll(servers, headers, payload.data(), Size);
+
+    waitForFrames(upstream, 1);
+    CHECK(nForwarded == 1);
+    CHECK(nForwardedBeforeDecode == 0);
+    CHECK(upstream.received == std::vector<char>(payload.begin(), payload.end()));
+    for (Connection& c : relayed) {
+        waitForFrames(c, 1);
+        CHECK(c.received == std::vector<char>(payload.begin(), payload.end()));
+        CHECK(c.client->recvFrameCurrent() == 1);
+    }
+
+    disconnect(upstream);
+    for (Connection& c : relayed) {
+        disconnect(c);
+    }
+}
+
+TEST_CASE("Network: Shared Memory", "[network]") {
+    // Both sides are on the same machine, so the messages are exchanged through shared
+    // memory on the platforms that support it and over TCP otherwise
+    Connection c;
+    connect(c, FirstPort + 30, true);
+
+    // The frames are larger than the ring buffer, so the server has to wait for the
+    // client to make space while sending
+    constexpr int Size = 3 * static_cast<int>(SharedMemoryChannel::RingSize) / 2;
+    std::vector<char> payload(Size);
+    for (int i = 0; i < Size; i++) {
+        payload[i] = static_cast<char>(i % 127);
+    }
+
+    const std::vector<Network*> servers = { c.server.get() };
+    for (int i = 1; i <= 3; i++) {
+        payload[0] = static_cast<char>(i);
+        const std::vector<std::array<char, Network::HeaderSize>> headers = {
+            createHeader(c.server->iterateFrameCounter(), Size)
+        };
+        Network::sendToAll(servers, headers, payload.data(), Size);
+        waitForFrames(c, i);
+        CHECK(c.received == payload);
+
+        // The acknowledgement travels in the other direction
+        c.client->pushClientMessage();
+        waitUntil([&]() {
+            return c.server->recvFrameCurrent() == c.server->sendFrameCurrent();
+        });
+    }
+
+    disconnect(c);
+}
+
+TEST_CASE("Network: Latency Statistics", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 31);
+
+    // The client takes some time before it acknowledges each frame, which is part of the
+    // loop time but not of the round trip time
+    constexpr int NFrames = 5;
+    const std::vector<Network*> servers = { c.server.get() };
+    for (int i = 1; i <= NFrames; i++) {
+        const std::vector<std::array<char, Network::HeaderSize>> headers = {
+            createHeader(c.server->iterateFrameCounter(), 0)
+        };
+        Network::sendToAll(servers, headers, nullptr, 0);
+        waitUntil([&]() {
+            return c.client->recvFrameCurrent() == c.server->sendFrameCurrent();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        c.client->pushClientMessage();
+        waitUntil([&]() {
+            return c.server->loopTimes().count() >= static_cast<uint64_t>(i);
+        });
+    }
+
+    CHECK(c.server->loopTimes().count() == NFrames);
+    CHECK(c.server->roundTripTimes().count() == NFrames);
+    CHECK(c.server->loopTimes().min() >= 0.005);
+    CHECK(c.server->roundTripTimes().max() <= c.server->loopTimes().max());
+    CHECK(
+        c.server->roundTripTimes().percentile(0.5) <
+        c.server->loopTimes().percentile(0.5)
+    );
+
+    // Both sides use the same clock, so the estimated offset is only the error of the
+    // estimation, which is at most half of the round trip time of the sample it used
+    CHECK(std::abs(c.server->clockOffset()) <= c.server->roundTripTimes().max());
+
+    // Only the server measures the latency
+    CHECK(c.client->loopTimes().count() == 0);
+
+    disconnect(c);
+}
+
+TEST_CASE("Network: Client Before Server", "[network]") {
+    // The client keeps trying to connect in the background until the server is started
+    Connection c;
+    c.client = std::make_unique<Network>(
+        FirstPort + 32,
+        "127.0.0.1",
+        false,
+        Network::ConnectionType::SyncConnection
+    );
+    c.client->setUpdateFunction([](Network&) {});
+    c.client->setConnectedFunction([]() {});
+    c.client->initialize();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_FALSE(c.client->isConnected());
+
+    c.server = std::make_unique<Network>(
+        FirstPort + 32,
+        "127.0.0.1",
+        true,
+        Network::ConnectionType::SyncConnection
+    );
+    c.server->setUpdateFunction([](Network&) {});
+    c.server->setConnectedFunction([]() {});
+    c.server->initialize();
+
+    // The delay between the attempts is still short after a few failed ones
+    const auto start = std::chrono::steady_clock::now();
+    waitUntil([&]() { return c.server->isConnected() && c.client->isConnected(); });
+    CHECK(std::chrono::steady_clock::now() - start < TimeoutBound);
+
+    disconnect(c);
+}
+
+TEST_CASE("Network: Shutdown While Connecting", "[network]") {
+    // A client that never reaches a server can still be shut down right away
+    auto client = std::make_unique<Network>(
+        FirstPort + 33,
+        "127.0.0.1",
+        false,
+        Network::ConnectionType::SyncConnection
+    );
+    client->setUpdateFunction([](Network&) {});
+    client->setConnectedFunction([]() {});
+    client->initialize();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const auto start = std::chrono::steady_clock::now();
+    client->initShutdown();
+    client = nullptr;
+    CHECK(std::chrono::steady_clock::now() - start < TimeoutBound);
+}
+
+TEST_CASE("Network: Shutdown", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 34);
+
+    // The server only waits until the client has closed the connection in response to
+    // the disconnect message, which takes a single round trip
+    const auto start = std::chrono::steady_clock::now();
+    c.server->initShutdown();
+    const auto duration = std::chrono::steady_clock::now() - start;
+    CHECK(duration < TimeoutBound);
+    CHECK_FALSE(c.client->isConnected());
+
+    c.client->initShutdown();
+    c.client = nullptr;
+    c.server = nullptr;
+}
+
+TEST_CASE("Network: Simultaneous Shutdown", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 35);
+
+    // Both sides announce the shutdown before either of them waits for the other one
+    const auto start = std::chrono::steady_clock::now();
+    c.client->sendDisconnect();
+    c.server->sendDisconnect();
+    c.client->initShutdown();
+    c.server->initShutdown();
+    CHECK(std::chrono::steady_clock::now() - start < TimeoutBound);
+
+    c.client = nullptr;
+    c.server = nullptr;
+}
+
+TEST_CASE("Network: Bounded Frame Lag", "[network]") {
+    // The server may send two frames more than the client has acknowledged
+    config::Cluster cluster;
+    cluster.masterAddress = "127.0.0.1";
+    cluster.nodes.push_back({ .address = "127.0.0.1", .port = FirstPort + 36 });
+    cluster.maxFrameLag = 2;
+    ClusterManager::create(cluster, 0);
+
+    Connection c;
+    connect(c, FirstPort + 36);
+
+    const std::vector<Network*> servers = { c.server.get() };
+    for (int i = 1; i <= 3; i++) {
+        const std::vector<std::array<char, Network::HeaderSize>> headers = {
+            createHeader(c.server->iterateFrameCounter(), 0)
+        };
+        Network::sendToAll(servers, headers, nullptr, 0);
+        CHECK(c.server->isUpdated() == (i <= 2));
+    }
+    waitUntil([&]() { return c.client->recvFrameCurrent() == 3; });
+    CHECK(c.client->isUpdated());
+
+    // The client skips to the newest frame, whose acknowledgement covers all frames
+    c.client->pushClientMessage();
+    CHECK_FALSE(c.client->isUpdated());
+    waitUntil([&]() { return c.server->recvFrameCurrent() == 3; });
+    CHECK(c.server->unacknowledgedFrames() == 0);
+    CHECK(c.server->isUpdated());
+    CHECK(c.server->loopTimes().count() == 1);
+
+    disconnect(c);
+    ClusterManager::destroy();
+}
+
+TEST_CASE("Network: Chunked Transfer", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 37, false, Network::ConnectionType::DataTransfer);
+
+    constexpr int PackageId = 7;
+    constexpr uint32_t ChunkSize = 1000;
+    constexpr uint64_t TotalSize = 2500;
+    std::vector<char> payload(TotalSize);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<char>(i % 127);
+    }
+
+    // The receiver writes every chunk at its offset, like it would write it to a file
+    std::vector<char> received(TotalSize);
+    c.client->setChunkDecodeFunction(
+        [&received](const char* data, int size, int, uint64_t offset, uint64_t, int) {
+            std::memcpy(received.data() + offset, data, size);
+        }
+    );
+    std::atomic<uint64_t> nAcknowledged = 0;
+    c.server->setChunkAcknowledgeFunction(
+        [&nAcknowledged](int, uint64_t n, uint64_t, int) { nAcknowledged = n; }
+    );
+    std::atomic_int completedPackage = -1;
+    c.server->setAcknowledgeFunction(
+        [&completedPackage](int packageId, int) { completedPackage = packageId; }
+    );
+
+    auto sendChunks = [&](uint64_t offset, uint64_t end) {
+        for (; offset < end; offset += ChunkSize) {
+            const size_t size = std::min<uint64_t>(ChunkSize, end - offset);
+            const std::span<const char> chunk(payload.data() + offset, size);
+            c.server->sendChunk(PackageId, offset, TotalSize, chunk);
+        }
+    };
+
+    auto queryOffset = [&c](uint64_t totalSize) {
+        std::atomic<int64_t> offset = -1;
+        c.server->queryChunkOffset(
+            PackageId,
+            totalSize,
+            [&offset](uint64_t received) { offset = static_cast<int64_t>(received); }
+        );
+        waitUntil([&]() { return offset != -1; });
+        return offset.load();
+    };
+
+    sendChunks(0, ChunkSize);
+    waitUntil([&]() { return nAcknowledged == ChunkSize; });
+    CHECK(completedPackage == -1);
+
+    // The receiver reports the bytes that it has received, but only for a transfer of
+    // the same size, which is a different transfer otherwise
+    CHECK(queryOffset(TotalSize) == ChunkSize);
+    CHECK(queryOffset(TotalSize + 1) == 0);
+
+    // An interrupted transfer continues after the received bytes
+    sendChunks(static_cast<uint64_t>(queryOffset(TotalSize)), TotalSize);
+
+    // The last chunk also acknowledges the package as a whole
+    waitUntil([&]() { return completedPackage == PackageId; });
+    CHECK(nAcknowledged == TotalSize);
+    CHECK(received == payload);
+    CHECK(queryOffset(TotalSize) == 0);
+
+    disconnect(c);
+}
+
+TEST_CASE("Network: Transfer Window", "[network]") {
+    Connection c;
+    connect(c, FirstPort + 38, false, Network::ConnectionType::DataTransfer);
+    c.server->setTransferWindow(2);
+
+    // The receiver only decodes the packages once it is allowed to, so that they stay in
+    // flight until then
+    std::atomic_bool isDecoding = false;
+    std::vector<int> decoded;
+    c.client->setPackageDecodeFunction([&](void*, int, int packageId, int) {
+        isDecoding.wait(false);
+        decoded.push_back(packageId);
+    });
+    std::atomic_int nWindowUpdates = 0;
+    c.server->setTransferWindowFunction([&nWindowUpdates]() { nWindowUpdates++; });
+
+    const std::vector<char> payload(100, 'x');
+    std::array<std::atomic_int, 3> results = { -1, -1, -1 };
+    auto send = [&](int packageId) {
+        c.server->sendPackage(
+            packageId,
+            payload,
+            [&results, packageId](bool isAcknowledged) {
+                results[packageId] = isAcknowledged ? 1 : 0;
+            }
+        );
+    };
+
+    CHECK(c.server->transferWindowSpace() == 2);
+    send(0);
+    CHECK(c.server->transferWindowSpace() == 1);
+    send(1);
+    CHECK(c.server->transferWindowSpace() == 0);
+
+    isDecoding = true;
+    isDecoding.notify_all();
+    waitUntil([&]() { return results[1] != -1; });
+    CHECK(results[0] == 1);
+    CHECK(results[1] == 1);
+    CHECK(c.server->transferWindowSpace() == 2);
+    CHECK(nWindowUpdates > 0);
+    CHECK(decoded == std::vector<int>{ 0, 1 });
+
+    // The packages that are still in flight when the connection is closed have failed
+    c.client->initShutdown();
+    try {
+        send(2);
+    }
+    catch (const std::runtime_error&) {}
+    c.server->initShutdown();
+    CHECK(results[2] == 0);
+
+    c.client = nullptr;
+    c.server = nullptr;
+}
+
+TEST_CASE("Network: Transfer Cache", "[network]") {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "sgct-test-network-transfercache";
+    std::filesystem::remove_all(directory);
+    const TransferCache cache(directory);
+
+    Connection c;
+    connect(c, FirstPort + 39, false, Network::ConnectionType::DataTransfer);
+    c.client->setTransferCache(&cache);
+
+    std::vector<std::vector<char>> decoded;
+    std::atomic_int nDecoded = 0;
+    c.client->setPackageDecodeFunction([&](void* data, int size, int, int) {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        decoded.emplace_back(bytes, bytes + size);
+        nDecoded++;
+    });
+    std::atomic_int nAcknowledged = 0;
+    c.server->setAcknowledgeFunction([&nAcknowledged](int, int) { nAcknowledged++; });
+
+    std::vector<char> payload(10000);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<char>(i % 127);
+    }
+    const uint64_t hash = TransferCache::hash(payload);
+    constexpr int PackageId = 3;
+
+    auto offer = [&]() {
+        std::atomic_int reply = -1;
+        c.server->offerContent(
+            PackageId,
+            hash,
+            payload.size(),
+            [&reply](bool isAvailable) { reply = isAvailable ? 1 : 0; }
+        );
+        waitUntil([&]() { return reply != -1; });
+        return reply == 1;
+    };
+    auto waitFor = [](const std::atomic_int& value, int expected) {
+        waitUntil([&]() { return value == expected; });
+    };
+
+    // The first offer is declined, so the package is sent and added to the cache
+    CHECK_FALSE(offer());
+    c.server->sendMessage(
+        createHeader(PackageId, static_cast<int>(payload.size())),
+        payload
+    );
+    waitFor(nDecoded, 1);
+    waitFor(nAcknowledged, 1);
+    CHECK(std::filesystem::exists(cache.path(hash)));
+
+    // The second offer is accepted, and the package is decoded from the cache and
+    // acknowledged without being sent
+    CHECK(offer());
+    waitFor(nDecoded, 2);
+    waitFor(nAcknowledged, 2);
+    REQUIRE(decoded.size() == 2);
+    CHECK(decoded[0] == payload);
+    CHECK(decoded[1] == payload);
+
+    disconnect(c);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,875 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/error.h>
+#include <sgct/network.h>
+#include <sgct/shareddata.h>
+#include <zlib.h>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // Number of heap allocations that were made by the current thread
+    thread_local int nAllocations = 0;
+} // namespace
+
+void* operator new(std::size_t size) {
+    nAllocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace sgct;
+
+namespace {
+    uint32_t uncompressedSize(const unsigned char* block) {
+        uint32_t size = 0;
+        std::memcpy(&size, block + 9, sizeof(uint32_t));
+        return size;
+    }
+} // namespace
+
+TEST_CASE("SharedData: Compression/Disabled", "[shareddata]") {
+    std::vector<std::byte> payload(64 * 1024, std::byte(1));
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.encode();
+
+    CHECK(sd.dataSize() == static_cast<int>(Network::HeaderSize + payload.size()));
+    CHECK(uncompressedSize(sd.dataBlock()) == 0);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Compression/Compressible", "[shareddata]") {
+    std::vector<std::byte> payload(64 * 1024);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<std::byte>(i / 256);
+    }
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setCompression(true);
+    sd.encode();
+
+    REQUIRE(sd.dataSize() < static_cast<int>(Network::HeaderSize + payload.size()));
+    REQUIRE(uncompressedSize(sd.dataBlock()) == payload.size());
+    CHECK(sd.dataBlock()[0] == Network::DataId);
+
+    std::vector<std::byte> decompressed(payload.size());
+    uLongf size = static_cast<uLongf>(decompressed.size());
+    const int res = uncompress(
+        reinterpret_cast<Bytef*>(decompressed.data()),
+        &size,
+        sd.dataBlock() + Network::HeaderSize,
+        static_cast<uLong>(sd.dataSize() - Network::HeaderSize)
+    );
+    REQUIRE(res == Z_OK);
+    CHECK(size == payload.size());
+    CHECK(decompressed == payload);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Compression/Small", "[shareddata]") {
+    std::vector<std::byte> payload(SharedData::CompressionMinimumSize - 1, std::byte(0));
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setCompression(true);
+    sd.encode();
+
+    CHECK(sd.dataSize() == static_cast<int>(Network::HeaderSize + payload.size()));
+    CHECK(uncompressedSize(sd.dataBlock()) == 0);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Compression/Incompressible", "[shareddata]") {
+    // A simple linear congruential generator produces data that zlib can't compress
+    std::vector<std::byte> payload(64 * 1024);
+    uint32_t state = 1;
+    for (std::byte& b : payload) {
+        state = state * 1664525 + 1013904223;
+        b = static_cast<std::byte>(state >> 24);
+    }
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setCompression(true);
+    sd.encode();
+
+    CHECK(sd.dataSize() == static_cast<int>(Network::HeaderSize + payload.size()));
+    CHECK(uncompressedSize(sd.dataBlock()) == 0);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Compression/Alternating", "[shareddata]") {
+    std::vector<std::byte> payload;
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setCompression(true);
+
+    payload = std::vector<std::byte>(32 * 1024, std::byte(2));
+    sd.encode();
+    CHECK(uncompressedSize(sd.dataBlock()) == payload.size());
+
+    payload = std::vector<std::byte>(16, std::byte(2));
+    sd.encode();
+    CHECK(uncompressedSize(sd.dataBlock()) == 0);
+    CHECK(sd.dataSize() == static_cast<int>(Network::HeaderSize + payload.size()));
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/Keyframe", "[shareddata]") {
+    std::vector<std::byte> payload(4096, std::byte(3));
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setDeltaEncoding(true);
+
+    // The first frame has no reference and has to be sent in full
+    sd.encode();
+    CHECK(sd.dataBlock()[0] == Network::DataId);
+    CHECK(sd.dataSize() == static_cast<int>(Network::HeaderSize + payload.size()));
+
+    payload[100] = std::byte(4);
+    sd.encode();
+    CHECK(sd.dataBlock()[0] == Network::DeltaId);
+    CHECK(sd.dataSize() < static_cast<int>(Network::HeaderSize + payload.size()));
+
+    sd.requestKeyframe();
+    sd.encode();
+    CHECK(sd.dataBlock()[0] == Network::DataId);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/KeyframeInterval", "[shareddata]") {
+    std::vector<std::byte> payload(4096, std::byte(3));
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setDeltaEncoding(true, 4);
+
+    std::vector<char> ids;
+    for (int i = 0; i < 9; i++) {
+        payload[i] = std::byte(i);
+        sd.encode();
+        ids.push_back(static_cast<char>(sd.dataBlock()[0]));
+    }
+
+    const std::vector<char> expected = {
+        Network::DataId, Network::DeltaId, Network::DeltaId, Network::DeltaId,
+        Network::DataId, Network::DeltaId, Network::DeltaId, Network::DeltaId,
+        Network::DataId
+    };
+    CHECK(ids == expected);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/Roundtrip", "[shareddata]") {
+    std::vector<std::byte> payload(8192);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<std::byte>(i);
+    }
+
+    // The frames that a client would receive from the server
+    std::vector<std::vector<char>> frames;
+    std::vector<std::vector<std::byte>> payloads;
+    {
+        SharedData& sd = SharedData::instance();
+        sd.setEncodeFunction([&payload]() { return payload; });
+        sd.setDeltaEncoding(true);
+
+        auto encode = [&]() {
+            sd.encode();
+            frames.emplace_back(sd.dataBlock(), sd.dataBlock() + sd.dataSize());
+            payloads.push_back(payload);
+        };
+
+        encode();
+
+        // Scattered changes
+        payload[0] = std::byte(200);
+        payload[1000] = std::byte(201);
+        payload[1003] = std::byte(202);
+        payload[8191] = std::byte(203);
+        encode();
+
+        // Growing the payload
+        payload.resize(9000, std::byte(7));
+        payload[10] = std::byte(204);
+        encode();
+
+        // Shrinking the payload
+        payload.resize(5000);
+        payload[4999] = std::byte(205);
+        encode();
+
+        // No changes at all
+        encode();
+
+        SharedData::destroy();
+    }
+
+    REQUIRE(frames.size() == payloads.size());
+    CHECK(frames[0][0] == Network::DataId);
+    for (size_t i = 1; i < frames.size(); i++) {
+        CHECK(frames[i][0] == Network::DeltaId);
+    }
+
+    SharedData& sd = SharedData::instance();
+    std::vector<std::byte> decoded;
+    sd.setDecodeFunction([&decoded](const std::vector<std::byte>& data) {
+        decoded = data;
+    });
+    for (size_t i = 0; i < frames.size(); i++) {
+        const char* data = frames[i].data() + Network::HeaderSize;
+        const int size = static_cast<int>(frames[i].size() - Network::HeaderSize);
+        if (frames[i][0] == Network::DataId) {
+            sd.decode(data, size);
+        }
+        else {
+            sd.decodeDelta(data, size);
+        }
+        CHECK(decoded == payloads[i]);
+    }
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/LateClient", "[shareddata]") {
+    std::vector<std::byte> payload(8192);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<std::byte>(i);
+    }
+
+    // A client connects after the server has sent a few frames and receives a keyframe,
+    // after which it receives the same deltas as every other client
+    std::vector<char> keyframe;
+    std::vector<std::vector<char>> frames;
+    std::vector<std::vector<std::byte>> payloads;
+    {
+        SharedData& sd = SharedData::instance();
+        sd.setEncodeFunction([&payload]() { return payload; });
+        sd.setDeltaEncoding(true);
+
+        for (int i = 0; i < 6; i++) {
+            payload[i * 500] = std::byte(200);
+            sd.encode();
+            CHECK(sd.dataBlock()[0] == (i == 0 ? Network::DataId : Network::DeltaId));
+            if (i == 2) {
+                const std::span<std::byte> k = sd.keyframe();
+                // The keyframe is only created once per frame
+                CHECK(sd.keyframe().data() == k.data());
+                keyframe.assign(
+                    reinterpret_cast<const char*>(k.data()),
+                    reinterpret_cast<const char*>(k.data() + k.size())
+                );
+                payloads.push_back(payload);
+            }
+            if (i > 2) {
+                frames.emplace_back(sd.dataBlock(), sd.dataBlock() + sd.dataSize());
+                payloads.push_back(payload);
+            }
+        }
+
+        SharedData::destroy();
+    }
+
+    REQUIRE(keyframe.size() == Network::HeaderSize + payload.size());
+    CHECK(keyframe[0] == Network::KeyframeId);
+    uint32_t keyframeSize = 0;
+    std::memcpy(&keyframeSize, keyframe.data() + 5, sizeof(uint32_t));
+    CHECK(keyframeSize == payload.size());
+    CHECK(uncompressedSize(reinterpret_cast<unsigned char*>(keyframe.data())) == 0);
+
+    SharedData& sd = SharedData::instance();
+    std::vector<std::vector<std::byte>> decoded;
+    sd.setDecodeFunction([&decoded](const std::vector<std::byte>& data) {
+        decoded.push_back(data);
+    });
+    sd.decodeKeyframe(
+        keyframe.data() + Network::HeaderSize,
+        static_cast<int>(keyframe.size() - Network::HeaderSize)
+    );
+    for (const std::vector<char>& frame : frames) {
+        REQUIRE(frame[0] == Network::DeltaId);
+        sd.decodeDelta(
+            frame.data() + Network::HeaderSize,
+            static_cast<int>(frame.size() - Network::HeaderSize)
+        );
+    }
+    CHECK(decoded == payloads);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/NoReference", "[shareddata]") {
+    SharedData& sd = SharedData::instance();
+    bool wasCalled = false;
+    sd.setDecodeFunction([&wasCalled](const std::vector<std::byte>&) {
+        wasCalled = true;
+    });
+
+    // A delta received before the first keyframe can't be applied and is ignored
+    const std::array<uint32_t, 4> delta = { 16, 0, 4, 0xFFFFFFFF };
+    const int size = static_cast<int>(sizeof(delta));
+    sd.decodeDelta(reinterpret_cast<const char*>(delta.data()), size);
+    CHECK_FALSE(wasCalled);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/Malformed", "[shareddata]") {
+    SharedData& sd = SharedData::instance();
+    const std::array<char, 16> keyframe = {};
+    sd.decode(keyframe.data(), static_cast<int>(keyframe.size()));
+
+    // The range ends outside of the frame
+    const std::array<uint32_t, 4> delta = { 16, 14, 4, 0xFFFFFFFF };
+    const int size = static_cast<int>(sizeof(delta));
+    CHECK_THROWS_AS(
+        sd.decodeDelta(reinterpret_cast<const char*>(delta.data()), size),
+        Error
+    );
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: Delta/Compressed", "[shareddata]") {
+    std::vector<std::byte> payload(64 * 1024, std::byte(1));
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&payload]() { return payload; });
+    sd.setCompression(true);
+    sd.setDeltaEncoding(true);
+
+    sd.encode();
+    CHECK(sd.dataBlock()[0] == Network::DataId);
+    CHECK(uncompressedSize(sd.dataBlock()) == payload.size());
+
+    // Change a large block so that the delta itself is worth compressing
+    std::fill(payload.begin() + 1000, payload.begin() + 9000, std::byte(2));
+    sd.encode();
+    CHECK(sd.dataBlock()[0] == Network::DeltaId);
+    const uint32_t deltaSize = uncompressedSize(sd.dataBlock());
+    CHECK(deltaSize > 8000);
+    CHECK(deltaSize < payload.size());
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: EncodeInto/Roundtrip", "[shareddata]") {
+    const std::string text = "Lorem ipsum dolor sit amet";
+    const double time = 123.5;
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&](std::vector<std::byte>& buffer) {
+        serializeObject(buffer, time);
+        serializeObject(buffer, text);
+    });
+    sd.encode();
+
+    REQUIRE(sd.dataBlock()[0] == Network::DataId);
+    const size_t size = sizeof(double) + sizeof(uint32_t) + text.size();
+    REQUIRE(sd.dataSize() == static_cast<int>(Network::HeaderSize + size));
+
+    std::vector<std::byte> data(size);
+    std::memcpy(data.data(), sd.dataBlock() + Network::HeaderSize, size);
+    unsigned int pos = 0;
+    double decodedTime = 0.0;
+    deserializeObject(data, pos, decodedTime);
+    std::string decodedText;
+    deserializeObject(data, pos, decodedText);
+    CHECK(decodedTime == time);
+    CHECK(decodedText == text);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: EncodeInto/RemovedHeader", "[shareddata]") {
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([](std::vector<std::byte>& buffer) { buffer.clear(); });
+    CHECK_THROWS_AS(sd.encode(), Error);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: EncodeInto/NoAllocations", "[shareddata]") {
+    std::vector<float> values(16 * 1024, 1.f);
+    uint64_t frame = 0;
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([&](std::vector<std::byte>& buffer) {
+        serializeObject(buffer, frame);
+        serializeObject(buffer, values);
+    });
+
+    SECTION("Full") {}
+
+    SECTION("Delta") {
+        sd.setDeltaEncoding(true, 4);
+    }
+
+    // The first frames grow the buffers to their final size
+    for (int i = 0; i < 8; i++) {
+        frame++;
+        sd.encode();
+    }
+
+    const int before = nAllocations;
+    for (int i = 0; i < 100; i++) {
+        frame++;
+        values[i] = static_cast<float>(i);
+        sd.encode();
+    }
+    CHECK(nAllocations == before);
+    CHECK(sd.dataSize() > static_cast<int>(Network::HeaderSize));
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: DecodeView/Roundtrip", "[shareddata]") {
+    const std::vector<float> values = { 1.f, 2.f, 3.f, 4.f };
+    const std::string text = "Lorem ipsum dolor sit amet";
+
+    std::vector<std::byte> payload;
+    serializeObject(payload, values);
+    serializeObject(payload, text);
+
+    std::span<const float> decodedValues;
+    std::string_view decodedText;
+    bool pointsIntoBuffer = false;
+
+    SharedData& sd = SharedData::instance();
+    sd.setDecodeViewFunction([&](std::span<const std::byte> data) {
+        unsigned int pos = 0;
+        deserializeObject(data, pos, decodedValues);
+        deserializeObject(data, pos, decodedText);
+        CHECK(pos == data.size());
+
+        const std::byte* p = reinterpret_cast<const std::byte*>(decodedText.data());
+        pointsIntoBuffer = p >= data.data() && p < data.data() + data.size();
+        CHECK(std::vector<float>(decodedValues.begin(), decodedValues.end()) == values);
+        CHECK(decodedText == text);
+    });
+    sd.decode(
+        reinterpret_cast<const char*>(payload.data()),
+        static_cast<int>(payload.size())
+    );
+    CHECK(pointsIntoBuffer);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: DecodeView/Delta", "[shareddata]") {
+    std::vector<std::byte> payload(4096, std::byte(3));
+
+    SharedData& encoder = SharedData::instance();
+    encoder.setEncodeFunction([&payload]() { return payload; });
+    encoder.setDeltaEncoding(true);
+    encoder.encode();
+    const std::byte* keyframeData =
+        reinterpret_cast<const std::byte*>(encoder.dataBlock()) + Network::HeaderSize;
+    std::vector<std::byte> keyframe(
+        keyframeData,
+        keyframeData + encoder.dataSize() - Network::HeaderSize
+    );
+    payload[100] = std::byte(4);
+    encoder.encode();
+    REQUIRE(encoder.dataBlock()[0] == Network::DeltaId);
+    const std::byte* deltaData =
+        reinterpret_cast<const std::byte*>(encoder.dataBlock()) + Network::HeaderSize;
+    std::vector<std::byte> delta(
+        deltaData,
+        deltaData + encoder.dataSize() - Network::HeaderSize
+    );
+    SharedData::destroy();
+
+    std::vector<std::byte> decoded;
+    SharedData& decoder = SharedData::instance();
+    decoder.setDecodeViewFunction([&decoded](std::span<const std::byte> data) {
+        decoded.assign(data.begin(), data.end());
+    });
+    decoder.decode(
+        reinterpret_cast<const char*>(keyframe.data()),
+        static_cast<int>(keyframe.size())
+    );
+    decoder.decodeDelta(
+        reinterpret_cast<const char*>(delta.data()),
+        static_cast<int>(delta.size())
+    );
+    CHECK(decoded == payload);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedData: DecodeView/Vector", "[shareddata]") {
+    const std::vector<int> values = { 1, 2, 3 };
+    const std::string text = "abc";
+
+    std::vector<std::byte> payload;
+    serializeObject(payload, values);
+    serializeObject(payload, text);
+
+    unsigned int pos = 0;
+    std::span<const int> decodedValues;
+    deserializeObject(payload, pos, decodedValues);
+    std::string_view decodedText;
+    deserializeObject(payload, pos, decodedText);
+    CHECK(std::vector<int>(decodedValues.begin(), decodedValues.end()) == values);
+    CHECK(decodedText == text);
+    CHECK(pos == payload.size());
+
+    // The copying deserializers can be used with spans as well
+    pos = 0;
+    std::vector<int> copiedValues;
+    deserializeObject(std::span<const std::byte>(payload), pos, copiedValues);
+    std::string copiedText;
+    deserializeObject(std::span<const std::byte>(payload), pos, copiedText);
+    CHECK(copiedValues == values);
+    CHECK(copiedText == text);
+}
+
+TEST_CASE("SharedData: DecodeView/Malformed", "[shareddata]") {
+    const std::vector<int> values = { 1, 2, 3 };
+    std::vector<std::byte> payload;
+    serializeObject(payload, values);
+
+    // An array that claims more elements than the buffer contains
+    const std::span<const std::byte> truncated =
+        std::span<const std::byte>(payload).first(payload.size() - 1);
+    unsigned int pos = 0;
+    std::span<const int> view;
+    CHECK_THROWS_AS(deserializeObject(truncated, pos, view), Error);
+    pos = 0;
+    std::vector<int> copy;
+    CHECK_THROWS_AS(deserializeObject(truncated, pos, copy), Error);
+    pos = 2;
+    uint32_t size = 0;
+    CHECK_THROWS_AS(deserializeObject(truncated.first(4), pos, size), Error);
+
+    // The view requires the array to be aligned, a copy doesn't
+    std::vector<std::byte> buffer(1);
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+    const std::span<const std::byte> shifted = buffer;
+    pos = 1;
+    CHECK_THROWS_AS(deserializeObject(shifted, pos, view), Error);
+    pos = 1;
+    deserializeObject(shifted, pos, copy);
+    CHECK(copy == values);
+}
+
+TEST_CASE("SharedData: DecodeView/NoAllocations", "[shareddata]") {
+    std::vector<float> values(16 * 1024, 1.f);
+    std::vector<std::byte> payload;
+    serializeObject(payload, values);
+
+    double sum = 0.0;
+    SharedData& sd = SharedData::instance();
+    sd.setDecodeViewFunction([&sum](std::span<const std::byte> data) {
+        unsigned int pos = 0;
+        std::span<const float> view;
+        deserializeObject(data, pos, view);
+        sum += view[0];
+    });
+
+    const char* data = reinterpret_cast<const char*>(payload.data());
+    const int size = static_cast<int>(payload.size());
+    sd.decode(data, size);
+    const int before = nAllocations;
+    for (int i = 0; i < 100; i++) {
+        sd.decode(data, size);
+    }
+    CHECK(nAllocations == before);
+    CHECK(sum == 101.0);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("Deserializer: Roundtrip", "[shareddata]") {
+    const std::vector<int> values = { 1, 2, 3 };
+    const std::string text = "abc";
+    const std::wstring wtext = L"def";
+
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, 1.5);
+    serializeObject(buffer, values);
+    serializeObject(buffer, text);
+    serializeObject(buffer, wtext);
+    serializeObject(buffer, text);
+
+    Deserializer d(buffer);
+    double decodedDouble = 0.0;
+    CHECK(d.read(decodedDouble));
+    std::vector<int> decodedValues;
+    CHECK(d.read(decodedValues));
+    std::string decodedText;
+    CHECK(d.read(decodedText));
+    std::wstring decodedWtext;
+    CHECK(d.read(decodedWtext));
+    std::string_view view;
+    CHECK(d.readView(view));
+
+    CHECK(decodedDouble == 1.5);
+    CHECK(decodedValues == values);
+    CHECK(decodedText == text);
+    CHECK(decodedWtext == wtext);
+    CHECK(view == text);
+    CHECK(d.position() == buffer.size());
+    CHECK(d.remaining() == 0);
+    CHECK_FALSE(d.hasError());
+}
+
+TEST_CASE("Deserializer: Bulk", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    for (int i = 0; i < 5; i++) {
+        serializeObject(buffer, i);
+    }
+
+    Deserializer d(buffer);
+    std::array<int, 5> values = {};
+    CHECK(d.read(std::span<int>(values)));
+    CHECK(values == std::array<int, 5>{ 0, 1, 2, 3, 4 });
+    CHECK_FALSE(d.hasError());
+
+    // Reading more values than are available must not touch the values
+    Deserializer d2(buffer);
+    std::array<int, 6> tooMany = {};
+    CHECK_FALSE(d2.read(std::span<int>(tooMany)));
+    CHECK(tooMany == std::array<int, 6>{});
+    CHECK(d2.hasError());
+}
+
+TEST_CASE("Deserializer: Truncated", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, uint64_t(42));
+    serializeObject(buffer, std::vector<float>{ 1.f, 2.f });
+    serializeObject(buffer, std::string("abc"));
+
+    // Every prefix of the buffer has to fail cleanly without reading past its end
+    for (size_t size = 0; size < buffer.size(); size++) {
+        std::vector<std::byte> truncated(buffer.begin(), buffer.begin() + size);
+        Deserializer d(truncated);
+        uint64_t value = 0;
+        std::vector<float> values;
+        std::string text;
+        d.read(value);
+        d.read(values);
+        d.read(text);
+        CHECK(d.hasError());
+        CHECK(d.position() <= size);
+    }
+}
+
+TEST_CASE("Deserializer: ErrorIsSticky", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, uint16_t(1));
+    serializeObject(buffer, uint16_t(2));
+
+    Deserializer d(buffer);
+    uint64_t value = 0;
+    CHECK_FALSE(d.read(value));
+    // Even though there would be enough data for this read, it fails after an error
+    uint32_t next = 0;
+    CHECK_FALSE(d.read(next));
+    CHECK(next == 0);
+    CHECK(d.hasError());
+}
+
+TEST_CASE("Deserializer: InvalidLength", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, std::numeric_limits<uint32_t>::max());
+    serializeObject(buffer, 1.f);
+
+    Deserializer d(buffer);
+    std::vector<double> values = { 1.0 };
+    CHECK_FALSE(d.read(values));
+    CHECK(values == std::vector<double>{ 1.0 });
+    CHECK(d.hasError());
+}
+
+TEST_CASE("Deserializer: Unaligned", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, uint8_t(1));
+    serializeObject(buffer, 2.5);
+    serializeObject(buffer, std::vector<double>{ 3.5 });
+
+    // The double is at an odd offset, which is fine for the copying reads
+    Deserializer d(buffer);
+    uint8_t byte = 0;
+    double value = 0.0;
+    CHECK(d.read(byte));
+    CHECK(d.read(value));
+    CHECK(value == 2.5);
+
+    // The view on the other hand requires the array to be aligned
+    std::span<const double> view;
+    const size_t pos = d.position();
+    const bool isAligned =
+        reinterpret_cast<std::uintptr_t>(buffer.data() + pos + sizeof(uint32_t)) %
+        alignof(double) == 0;
+    CHECK(d.readView(view) == isAligned);
+    CHECK(d.hasError() != isAligned);
+}
+
+namespace {
+    struct Camera {
+        std::array<float, 3> position;
+        std::optional<float> fieldOfView;
+    };
+
+    struct Scene {
+        double time;
+        std::string name;
+        Camera camera;
+        std::vector<std::vector<int>> layers;
+        std::map<std::string, std::optional<std::string>> properties;
+        std::unordered_map<int, Camera> cameras;
+
+        bool operator==(const Scene&) const = default;
+    };
+
+    bool operator==(const Camera& lhs, const Camera& rhs) {
+        return lhs.position == rhs.position && lhs.fieldOfView == rhs.fieldOfView;
+    }
+
+    class Explicit {
+    public:
+        static constexpr auto serializedFields() {
+            return std::tuple(&Explicit::a, &Explicit::c);
+        }
+
+        int a = 0;
+        int b = 0;
+        std::string c;
+    };
+
+    Scene createScene() {
+        Scene scene;
+        scene.time = 12.5;
+        scene.name = "Scene";
+        scene.camera = { { 1.f, 2.f, 3.f }, 60.f };
+        scene.layers = { { 1, 2 }, {}, { 3 } };
+        scene.properties = { { "a", "b" }, { "c", std::nullopt } };
+        scene.cameras = { { 1, Camera{ { 4.f, 5.f, 6.f }, std::nullopt } } };
+        return scene;
+    }
+} // namespace
+
+TEST_CASE("Serialize: Roundtrip", "[shareddata]") {
+    const Scene scene = createScene();
+
+    std::vector<std::byte> buffer;
+    serialize(buffer, scene);
+    CHECK(buffer.size() == serializedSize(scene));
+
+    Deserializer d(buffer);
+    Scene decoded;
+    CHECK(deserialize(d, decoded));
+    CHECK(d.remaining() == 0);
+    CHECK(decoded == scene);
+}
+
+TEST_CASE("Serialize: ExplicitFields", "[shareddata]") {
+    Explicit value;
+    value.a = 1;
+    value.b = 2;
+    value.c = "abc";
+
+    std::vector<std::byte> buffer;
+    serialize(buffer, value);
+    CHECK(buffer.size() == sizeof(int) + sizeof(uint32_t) + 3);
+
+    Deserializer d(buffer);
+    Explicit decoded;
+    CHECK(deserialize(d, decoded));
+    CHECK(decoded.a == 1);
+    CHECK(decoded.b == 0);
+    CHECK(decoded.c == "abc");
+}
+
+TEST_CASE("Serialize: SerializeObjectCompatible", "[shareddata]") {
+    const std::vector<float> values = { 1.f, 2.f };
+    const std::string text = "abc";
+
+    std::vector<std::byte> expected;
+    serializeObject(expected, 1.5);
+    serializeObject(expected, values);
+    serializeObject(expected, text);
+
+    std::vector<std::byte> buffer;
+    serialize(buffer, 1.5);
+    serialize(buffer, values);
+    serialize(buffer, text);
+    CHECK(buffer == expected);
+}
+
+TEST_CASE("Serialize: SingleAllocation", "[shareddata]") {
+    const Scene scene = createScene();
+
+    std::vector<std::byte> buffer;
+    const int before = nAllocations;
+    serialize(buffer, scene);
+    CHECK(nAllocations == before + 1);
+    CHECK(buffer.capacity() == serializedSize(scene));
+}
+
+TEST_CASE("Serialize: Truncated", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serialize(buffer, createScene());
+
+    for (size_t size = 0; size < buffer.size(); size++) {
+        std::vector<std::byte> truncated(buffer.begin(), buffer.begin() + size);
+        Deserializer d(truncated);
+        Scene decoded;
+        CHECK_FALSE(deserialize(d, decoded));
+    }
+}
+
+TEST_CASE("Serialize: InvalidSize", "[shareddata]") {
+    std::vector<std::byte> buffer;
+    serializeObject(buffer, std::numeric_limits<uint32_t>::max());
+
+    Deserializer d(buffer);
+    std::vector<std::string> values;
+    CHECK_FALSE(deserialize(d, values));
+    CHECK(values.empty());
+}
@@ -0,0 +1,126 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/error.h>
+#include <sgct/sharedmemory.h>
+#include <poll.h>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr int Port = 20790;
+
+    std::vector<char> readAll(SharedMemoryChannel& channel, size_t size) {
+        std::vector<char> data(size);
+        size_t nRead = 0;
+        while (nRead < size) {
+            nRead += channel.read(data.data() + nRead, size - nRead);
+        }
+        return data;
+    }
+
+    bool isReadable(SGCT_SOCKET descriptor) {
+        pollfd fd = { descriptor, POLLIN, 0 };
+        return poll(&fd, 1, 0) == 1;
+    }
+} // namespace
+
+TEST_CASE("SharedMemory: Roundtrip", "[sharedmemory]") {
+    SharedMemoryChannel server(
+        SharedMemoryChannel::uniqueName(Port),
+        SharedMemoryChannel::Mode::Create
+    );
+    SharedMemoryChannel client(server.name(), SharedMemoryChannel::Mode::Open);
+    server.unlink();
+
+    const std::string message = "Hello client";
+    const std::string reply = "Hello server";
+    CHECK(server.write({ std::span(message), std::span(reply) }));
+    CHECK(client.write({ std::span(reply) }));
+
+    CHECK(readAll(client, message.size()) == std::vector(message.begin(), message.end()));
+    CHECK(readAll(client, reply.size()) == std::vector(reply.begin(), reply.end()));
+    CHECK(readAll(server, reply.size()) == std::vector(reply.begin(), reply.end()));
+
+    std::vector<char> buffer(1);
+    CHECK(server.read(buffer.data(), buffer.size()) == 0);
+    CHECK(client.read(buffer.data(), buffer.size()) == 0);
+}
+
+TEST_CASE("SharedMemory: Wrap Around", "[sharedmemory]") {
+    SharedMemoryChannel server(
+        SharedMemoryChannel::uniqueName(Port + 1),
+        SharedMemoryChannel::Mode::Create
+    );
+    SharedMemoryChannel client(server.name(), SharedMemoryChannel::Mode::Open);
+
+    // Fills the ring buffer almost completely, so that the next message continues at the
+    // beginning of the ring buffer
+    const std::vector<char> first(SharedMemoryChannel::RingSize - 10, 1);
+    CHECK(server.write({ std::span(first) }));
+    CHECK(readAll(client, first.size()) == first);
+
+    std::vector<char> second(100);
+    for (size_t i = 0; i < second.size(); i++) {
+        second[i] = static_cast<char>(i);
+    }
+    CHECK(server.write({ std::span(second) }));
+    CHECK(readAll(client, second.size()) == second);
+}
+
+TEST_CASE("SharedMemory: Notification", "[sharedmemory]") {
+    SharedMemoryChannel server(
+        SharedMemoryChannel::uniqueName(Port + 2),
+        SharedMemoryChannel::Mode::Create
+    );
+    SharedMemoryChannel client(server.name(), SharedMemoryChannel::Mode::Open);
+
+    // The writer only notifies the reader after it found the ring buffer empty
+    const std::string message = "Wake up";
+    CHECK(server.write({ std::span(message) }));
+    CHECK_FALSE(isReadable(client.notification()));
+
+    CHECK(readAll(client, message.size()).size() == message.size());
+    std::vector<char> buffer(1);
+    CHECK(client.read(buffer.data(), buffer.size()) == 0);
+    CHECK_FALSE(isReadable(client.notification()));
+
+    CHECK(server.write({ std::span(message) }));
+    CHECK(isReadable(client.notification()));
+    CHECK(readAll(client, message.size()).size() == message.size());
+    CHECK(client.read(buffer.data(), buffer.size()) == 0);
+    CHECK_FALSE(isReadable(client.notification()));
+}
+
+TEST_CASE("SharedMemory: Closed", "[sharedmemory]") {
+    SharedMemoryChannel server(
+        SharedMemoryChannel::uniqueName(Port + 3),
+        SharedMemoryChannel::Mode::Create
+    );
+    SharedMemoryChannel client(server.name(), SharedMemoryChannel::Mode::Open);
+
+    // Data that fits into the ring buffer is accepted even if nobody reads it, but a
+    // writer that waits for space gives up
+    client.close();
+    const std::string message = "Anyone there?";
+    CHECK(server.write({ std::span(message) }));
+    const std::vector<char> large(SharedMemoryChannel::RingSize, 1);
+    CHECK_FALSE(server.write({ std::span(large) }));
+}
+
+TEST_CASE("SharedMemory: Invalid", "[sharedmemory]") {
+    CHECK_THROWS_AS(
+        SharedMemoryChannel("/sgct-test-missing", SharedMemoryChannel::Mode::Open),
+        Error
+    );
+}
@@ -0,0 +1,219 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/error.h>
+#include <sgct/network.h>
+#include <sgct/shareddata.h>
+#include <sgct/sharedobject.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // Encodes a frame and returns its payload without the header
+    std::vector<std::byte> encodeFrame() {
+        SharedData& sd = SharedData::instance();
+        sd.encode();
+        const std::byte* data = reinterpret_cast<const std::byte*>(sd.dataBlock());
+        return std::vector<std::byte>(data + Network::HeaderSize, data + sd.dataSize());
+    }
+
+    void decodeFrame(const std::vector<std::byte>& frame) {
+        SharedData::instance().decode(
+            reinterpret_cast<const char*>(frame.data()),
+            static_cast<int>(frame.size())
+        );
+    }
+
+    uint16_t variableCount(const std::vector<std::byte>& frame) {
+        Deserializer d(frame);
+        uint16_t count = 0;
+        d.read(count);
+        return count;
+    }
+} // namespace
+
+TEST_CASE("SharedObject: Roundtrip", "[sharedobject]") {
+    SharedObject<int> number(1);
+    SharedObject<std::string> text("abc");
+    SharedObject<std::vector<float>> values({ 1.f, 2.f });
+
+    const std::vector<std::byte> frame = encodeFrame();
+    CHECK(variableCount(frame) == 3);
+
+    // Pretend to be a client whose replicas are outdated
+    number.setValue(2);
+    text.setValue("def");
+    values.modify([](std::vector<float>& v) { v.push_back(3.f); });
+    decodeFrame(frame);
+
+    CHECK(number.value() == 1);
+    CHECK(text.value() == "abc");
+    CHECK(values.value() == std::vector<float>{ 1.f, 2.f });
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedObject: OnlyDirty", "[sharedobject]") {
+    std::vector<std::unique_ptr<SharedObject<float>>> parameters;
+    for (int i = 0; i < 100; i++) {
+        const float value = static_cast<float>(i);
+        parameters.push_back(std::make_unique<SharedObject<float>>(value));
+    }
+
+    // Initially all variables have to be sent
+    CHECK(variableCount(encodeFrame()) == 100);
+    CHECK(variableCount(encodeFrame()) == 0);
+
+    parameters[5]->setValue(-1.f);
+    parameters[50]->setValue(-2.f);
+    // Setting the same value does not make a variable dirty
+    parameters[70]->setValue(70.f);
+    CHECK(parameters[5]->isDirty());
+    CHECK_FALSE(parameters[70]->isDirty());
+
+    const std::vector<std::byte> frame = encodeFrame();
+    CHECK(variableCount(frame) == 2);
+    // The section is padded so that the application's data after it stays aligned
+    constexpr size_t Size = sizeof(uint16_t) + 2 * (sizeof(uint16_t) + sizeof(float));
+    constexpr size_t Alignment = alignof(std::max_align_t);
+    CHECK(frame.size() == (Size + Alignment - 1) / Alignment * Alignment);
+    CHECK_FALSE(parameters[5]->isDirty());
+
+    // A keyframe for all clients contains all variables
+    SharedData::instance().requestKeyframe();
+    CHECK(variableCount(encodeFrame()) == 100);
+    CHECK(variableCount(encodeFrame()) == 0);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedObject: Keyframe", "[sharedobject]") {
+    SharedObject<int> a(1);
+    SharedObject<int> b(2);
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([](std::vector<std::byte>& buffer) {
+        serializeObject(buffer, 42);
+    });
+    encodeFrame();
+
+    a.setValue(5);
+    const std::vector<std::byte> frame = encodeFrame();
+    CHECK(variableCount(frame) == 1);
+
+    // The keyframe for a client that just connected contains all variables in front of
+    // the frame, but the variables stay dirty for the other clients
+    b.setValue(7);
+    const std::span<const std::byte> keyframe = sd.keyframe();
+    REQUIRE(keyframe.size() > Network::HeaderSize);
+    CHECK(static_cast<char>(keyframe[0]) == Network::KeyframeId);
+    const std::vector<std::byte> payload(
+        keyframe.begin() + Network::HeaderSize,
+        keyframe.end()
+    );
+    CHECK(variableCount(payload) == 2);
+    CHECK(b.isDirty());
+
+    int decoded = 0;
+    sd.setDecodeFunction([&decoded](const std::vector<std::byte>& data) {
+        REQUIRE(data.size() == sizeof(int));
+        unsigned int pos = 0;
+        deserializeObject(data, pos, decoded);
+    });
+    a.setValue(0);
+    b.setValue(0);
+    sd.decodeKeyframe(
+        reinterpret_cast<const char*>(payload.data()),
+        static_cast<int>(payload.size())
+    );
+    CHECK(a.value() == 5);
+    CHECK(b.value() == 7);
+    CHECK(decoded == 42);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedObject: ApplicationData", "[sharedobject]") {
+    SharedObject<double> time(2.5);
+
+    SharedData& sd = SharedData::instance();
+    sd.setEncodeFunction([](std::vector<std::byte>& buffer) {
+        serializeObject(buffer, 42);
+    });
+    const std::vector<std::byte> frame = encodeFrame();
+
+    // The decode function only receives the data that was added by the application
+    int decoded = 0;
+    sd.setDecodeFunction([&decoded](const std::vector<std::byte>& data) {
+        REQUIRE(data.size() == sizeof(int));
+        unsigned int pos = 0;
+        deserializeObject(data, pos, decoded);
+    });
+    time.setValue(0.0);
+    decodeFrame(frame);
+    CHECK(decoded == 42);
+    CHECK(time.value() == 2.5);
+
+    decoded = 0;
+    sd.setDecodeViewFunction([&decoded](std::span<const std::byte> data) {
+        REQUIRE(data.size() == sizeof(int));
+        const uintptr_t address = reinterpret_cast<uintptr_t>(data.data());
+        CHECK(address % alignof(std::max_align_t) == 0);
+        unsigned int pos = 0;
+        deserializeObject(data, pos, decoded);
+    });
+    decodeFrame(frame);
+    CHECK(decoded == 42);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedObject: Ids", "[sharedobject]") {
+    SharedObject<int> a;
+    uint16_t idB = 0;
+    {
+        SharedObject<int> b;
+        idB = b.id();
+        CHECK(idB == a.id() + 1);
+    }
+
+    // The ids of destroyed variables are not reused
+    SharedObject<int> c;
+    CHECK(c.id() == idB + 1);
+}
+
+TEST_CASE("SharedObject: UnknownId", "[sharedobject]") {
+    SharedObject<int> a;
+
+    std::vector<std::byte> frame;
+    serializeObject(frame, uint16_t(1));
+    serializeObject(frame, static_cast<uint16_t>(a.id() + 1));
+    serializeObject(frame, 1);
+    CHECK_THROWS_AS(decodeFrame(frame), Error);
+
+    SharedData::destroy();
+}
+
+TEST_CASE("SharedObject: Malformed", "[sharedobject]") {
+    SharedObject<int> a;
+
+    std::vector<std::byte> frame;
+    serializeObject(frame, uint16_t(1));
+    serializeObject(frame, a.id());
+    serializeObject(frame, uint16_t(1));
+    CHECK_THROWS_AS(decodeFrame(frame), Error);
+
+    SharedData::destroy();
+}
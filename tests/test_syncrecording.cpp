@@ -0,0 +1,137 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/error.h>
+#include <sgct/network.h>
+#include <sgct/shareddata.h>
+#include <sgct/syncrecording.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    std::filesystem::path recordingPath(const std::string& name) {
+        return std::filesystem::temp_directory_path() / ("sgct-test-" + name + ".sync");
+    }
+
+    // Records the frames that are created by changing parts of a large payload with
+    // compression and delta encoding enabled and returns the payloads
+    std::vector<std::vector<std::byte>> recordFrames(const std::filesystem::path& path) {
+        std::vector<std::byte> payload(16 * 1024, std::byte(1));
+        std::vector<std::vector<std::byte>> payloads;
+
+        SharedData& sd = SharedData::instance();
+        sd.setEncodeFunction([&payload]() { return payload; });
+        sd.setCompression(true);
+        sd.setDeltaEncoding(true);
+
+        {
+            SyncRecorder recorder(path);
+            for (int i = 0; i < 10; i++) {
+                payload[i * 100] = static_cast<std::byte>(i);
+                if (i == 5) {
+                    std::fill(payload.begin() + 2000, payload.end(), std::byte(i));
+                }
+                sd.encode();
+                recorder.record(std::span(
+                    reinterpret_cast<const std::byte*>(sd.dataBlock()),
+                    sd.dataSize()
+                ));
+                payloads.push_back(payload);
+            }
+        }
+
+        SharedData::destroy();
+        return payloads;
+    }
+
+    // Replays all frames in the recording and returns the decoded payloads
+    std::vector<std::vector<std::byte>> replayFrames(SyncReplayer& replayer) {
+        std::vector<std::vector<std::byte>> decoded;
+        SharedData::instance().setDecodeFunction(
+            [&decoded](const std::vector<std::byte>& data) { decoded.push_back(data); }
+        );
+        while (replayer.decodeNextFrame()) {}
+        SharedData::destroy();
+        return decoded;
+    }
+} // namespace
+
+TEST_CASE("SyncRecording: Roundtrip", "[syncrecording]") {
+    const std::filesystem::path path = recordingPath("roundtrip");
+    const std::vector<std::vector<std::byte>> payloads = recordFrames(path);
+
+    SyncReplayer replayer(path, false);
+    REQUIRE(replayer.nFrames() == payloads.size());
+
+    double previousTimestamp = 0.0;
+    for (size_t i = 0; i < replayer.nFrames(); i++) {
+        const SyncReplayer::Frame frame = replayer.frame(i);
+        CHECK(frame.frameNumber == i);
+        CHECK(frame.timestamp >= previousTimestamp);
+        previousTimestamp = frame.timestamp;
+
+        const char id = static_cast<char>(frame.data[0]);
+        CHECK(id == (i == 0 ? Network::DataId : Network::DeltaId));
+    }
+
+    CHECK(replayFrames(replayer) == payloads);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SyncRecording: Unfinished", "[syncrecording]") {
+    const std::filesystem::path path = recordingPath("unfinished");
+    const std::vector<std::vector<std::byte>> payloads = recordFrames(path);
+
+    // Without the index, the frames are found by reading the file from the beginning.
+    // The unused space at the end of a file that was not finished is filled with zeros
+    const size_t indexSize = payloads.size() * sizeof(uint64_t) + 2 * sizeof(uint64_t) +
+        SyncRecorder::IndexMagic.size();
+    const size_t framesEnd = std::filesystem::file_size(path) - indexSize;
+    std::filesystem::resize_file(path, framesEnd);
+    std::filesystem::resize_file(path, framesEnd + 4096);
+    {
+        SyncReplayer replayer(path, false);
+        REQUIRE(replayer.nFrames() == payloads.size());
+        CHECK(replayFrames(replayer) == payloads);
+    }
+
+    // The last frame was interrupted while it was written
+    std::filesystem::resize_file(path, framesEnd - 5);
+    {
+        SyncReplayer replayer(path, false);
+        REQUIRE(replayer.nFrames() == payloads.size() - 1);
+        const std::vector<std::vector<std::byte>> decoded = replayFrames(replayer);
+        CHECK(decoded == std::vector(payloads.begin(), payloads.end() - 1));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SyncRecording: Invalid", "[syncrecording]") {
+    const std::filesystem::path path = recordingPath("invalid");
+
+    CHECK_THROWS_AS(SyncReplayer(recordingPath("missing"), false), Error);
+
+    {
+        std::ofstream file(path, std::ofstream::binary);
+        file << "This is not a recording of the shared data";
+    }
+    CHECK_THROWS_AS(SyncReplayer(path, false), Error);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sgct/transfercache.h>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // Removes the directory of a cache when the test is done with it
+    struct CacheDirectory {
+        CacheDirectory() {
+            std::filesystem::remove_all(path);
+        }
+
+        ~CacheDirectory() {
+            std::filesystem::remove_all(path);
+        }
+
+        const std::filesystem::path path =
+            std::filesystem::temp_directory_path() / "sgct-test-transfercache";
+    };
+
+    std::vector<char> createPayload(size_t size) {
+        std::vector<char> payload(size);
+        for (size_t i = 0; i < payload.size(); i++) {
+            payload[i] = static_cast<char>(i * 7 % 251);
+        }
+        return payload;
+    }
+} // namespace
+
+TEST_CASE("TransferCache: Hash", "[transfercache]") {
+    // The reference values of the 64 bit variant of xxHash with a seed of 0
+    CHECK(TransferCache::hash(std::string_view("")) == 0xEF46DB3751D8E999ULL);
+    CHECK(TransferCache::hash(std::string_view("a")) == 0xD24EC4F1A98C6E5BULL);
+    CHECK(TransferCache::hash(std::string_view("abc")) == 0x44BC2CF5AD770999ULL);
+    const std::string_view sentence = "Nobody inspects the spammish repetition";
+    CHECK(TransferCache::hash(sentence) == 0xFBCEA83C8A378BF1ULL);
+
+    // Changing a single byte changes the hash
+    std::vector<char> payload = createPayload(1000);
+    const uint64_t hash = TransferCache::hash(payload);
+    payload[500]++;
+    CHECK(TransferCache::hash(payload) != hash);
+}
+
+TEST_CASE("TransferCache: Store and Find", "[transfercache]") {
+    CacheDirectory directory;
+    const TransferCache cache(directory.path);
+    CHECK(std::filesystem::is_directory(directory.path));
+
+    const std::vector<char> payload = createPayload(100000);
+    const uint64_t hash = TransferCache::hash(payload);
+    CHECK_FALSE(cache.find(hash, payload.size()).has_value());
+
+    REQUIRE(cache.store(hash, payload));
+    CHECK(std::filesystem::file_size(cache.path(hash)) == payload.size());
+
+    std::optional<TransferCache::Payload> cached = cache.find(hash, payload.size());
+    REQUIRE(cached.has_value());
+    REQUIRE(cached->size() == payload.size());
+    CHECK(std::vector<char>(cached->data(), cached->data() + cached->size()) == payload);
+
+    // A file of a different size belongs to a different payload
+    CHECK_FALSE(cache.find(hash, payload.size() - 1).has_value());
+}
+
+TEST_CASE("TransferCache: Changing a Payload", "[transfercache]") {
+    CacheDirectory directory;
+    const TransferCache cache(directory.path);
+
+    const std::vector<char> payload = createPayload(4096);
+    const uint64_t hash = TransferCache::hash(payload);
+    REQUIRE(cache.store(hash, payload));
+
+    // The decoder may change the bytes that it is given without changing the cache
+    {
+        std::optional<TransferCache::Payload> cached = cache.find(hash, payload.size());
+        REQUIRE(cached.has_value());
+        cached->data()[0] = 'x';
+    }
+
+    std::optional<TransferCache::Payload> cached = cache.find(hash, payload.size());
+    REQUIRE(cached.has_value());
+    CHECK(cached->data()[0] == payload[0]);
+}